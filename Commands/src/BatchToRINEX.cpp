@@ -0,0 +1,1093 @@
+/** @file BatchToRINEX.cpp
+ * Contains the command line program to convert in a single run a batch of OSP data files and RINEX files to new RINEX files,
+ * or RINEX files to CSV files.
+ *<p>Usage:
+ *<p>BatchToRINEX.exe {options} [BATCH]
+ *<p>BATCH is a manifest file containing the names of the files to convert (one per line, lines starting with # are comments),
+ *or a directory whose files (including the ones in its subdirectories) are converted, or a single OSP or RINEX file. Files are converted according to their contents:
+ *	- RINEX observation or navigation files are converted to a new RINEX file of the same type, as RINEXtoRINEX does or,
+ *	  when the csv option is set, to CSV files, as RINEXtoCSV does.
+ *	- Files with extension .OSP are converted to a RINEX observation file, and optionally navigation files, as OSPtoRINEX does.
+ *	- Other files are skipped.
+ *<p>Files are converted in-process by a pool of worker threads. Files are dealt to workers largest first, and a worker which runs
+ *out of files steals pending ones from the worker having more pending data, to limit the time the last conversions take.
+ *The status of each file is printed to stdout as its conversion ends, and a summary is printed at the end.
+ *<p>The results of the conversion are written to a results file (see writeResults), with the checksums of the output files.
+ *<p>A batch can be converted by several processes, in the same or different hosts, each one converting a shard of the batch.
+ *Files are assigned to shards by a hash of their name as given in the batch, so all processes shall use the same manifest
+ *or directory name. Each process writes a results file and a log file for its shard. As shards usually write to the same
+ *output directory, a shard never overwrites an existing output file: the conversion of a file whose output already exists
+ *(because another shard has created a file with the same name, or from a previous run) fails. When all shards have been converted,
+ *a process run with the merge option validates that all files have been converted once and that output files match their
+ *checksums, and writes the merged results file. For example, to convert a batch in three shards and merge them:
+ *<p>	BatchToRINEX.exe -p 0/3 batch.txt
+ *<p>	BatchToRINEX.exe -p 1/3 batch.txt
+ *<p>	BatchToRINEX.exe -p 2/3 batch.txt
+ *<p>	BatchToRINEX.exe -m 3 batch.txt
+ *<p>Options are:
+ *	- -b or --bias : Apply receiver clock bias to OSP measurements (and time). Default value TRUE
+ *	- -c or --csv : Generate CSV files from RINEX files, as RINEXtoCSV does, instead of RINEX files. CSV files for RINEX V3 mixed
+ *	  navigation files are generated for GPS and each system in SYSLST. Default value FALSE
+ *	- -f RESULTS or --results=RESULTS : Results file name prefix. Shard results are written to RESULTS_INDEX_COUNT.txt, and merged ones
+ *	  to RESULTS.txt. Default value RESULTS = BatchResults
+ *	- -h or --help : Show usage data and stops. Default value HELP=FALSE
+ *	- -i MINSV or --minsv=MINSV : Minimun satellites in a fix to acquire OSP observations. Default value MINSV = 4
+ *	- -j THREADS or --threads=THREADS : Number of worker threads converting files. Default value THREADS = 0 (one per hardware thread)
+ *	- -l LOGLEVEL or --llevel=LOGLEVEL : Maximum level to log (SEVERE, WARNING, INFO, CONFIG, FINE, FINER, FINEST). Default value LOGLEVEL = INFO
+ *	- -m MERGE or --merge=MERGE : Merge and validate the results of the given number of shards instead of converting files. Default value MERGE = 0 (no merge)
+ *	- -n or --nRINEX : Generate RINEX navigation files from OSP files. Default value FALSE
+ *	- -o OUTDIR or --outdir=OUTDIR : Directory where output files are created. Default value: the current directory
+ *	- -p SHARD or --shard=SHARD : Shard of the batch to convert, as INDEX/COUNT. Default value SHARD = 0/1 (the whole batch)
+ *	- -r RINEX or --rinex=RINEX : RINEX file name prefix. Default value RINEX = PNT1
+ *	- -s SYSLST or --selsys=SYSLST : List of additional systems to GPS (R or S or R,S) to be included in the RINEX files from OSP files,
+ *	  and in the CSV files from RINEX V3 mixed navigation files. Default value an empty list
+ *	- -u RUNBY or --runby=RUNBY : Who runs the RINEX file generation. Default value RUNBY = RUNBY
+ *	- -v VER or --ver=VER : RINEX version to generate (V210, V302). Default value VER = TBD (V210 for OSP files, same as input for RINEX files)
+ *	- -w HDSATS or --hdsats=HDSATS : Patch the observation file headers with the INTERVAL, TIME OF LAST OBS, # OF SATELLITES and PRN / # OF OBS
+ *	  records computed from the epochs printed, reserving PRN / # OF OBS lines for up to HDSATS satellites. Default value HDSATS = 0 (no patching)
+ *Default value for operator is: . (the current directory)
+ *<p>
+ *Copyright 2015 Francisco Cancillo
+ *<p>
+ *This file is part of the RXtoRINEX tool.
+ *<p>
+ *RXtoRINEX is free software: you can redistribute it and/or modify it under the terms of the GNU General Public License
+ *as published by the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+ *RXtoRINEX is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ *warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *See the GNU General Public License for more details.
+ *A copy of the GNU General Public License can be found at <http://www.gnu.org/licenses/>.
+ *
+ *Ver.	|Date	|Reason for change
+ *------+-------+------------------
+ *V1.0	|10/2026	|First release
+ */
+#include <stdio.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <errno.h>
+#ifdef _WIN32
+#include <windows.h>
+#include <io.h>
+#ifndef S_ISDIR
+#define S_ISDIR(m) (((m) & _S_IFMT) == _S_IFDIR)
+#define S_ISREG(m) (((m) & _S_IFMT) == _S_IFREG)
+#endif
+#else
+#include <dirent.h>
+#endif
+#include <deque>
+#include <set>
+#include <map>
+#include <algorithm>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+
+//from CommonClasses
+#include "ArgParser.h"
+#include "Logger.h"
+#include "Utilities.h"
+#include "GNSSdataFromOSP.h"
+#include "RinexData.h"
+#include "RinexCSV.h"
+
+using namespace std;
+
+//@cond DUMMY
+///Compilation date to identify program full version
+const string COMPDATE = __DATE__;
+///Program name
+const string THISPRG = "BatchToRINEX";
+///The command line format
+const string CMDLINE = THISPRG + ".exe {options} [BATCH]";
+///Current program version
+const string MYVER = " V1.0 ";
+///A common message
+const string FILENOK = "Cannot open or create file ";
+///The receiver name
+const string RECEIVER_NAME = "SiRF";
+//The parser object to store options and operators passed in the comman line
+ArgParser parser;
+//Metavariables for options
+int APBIAS, CSV, HDSATS, HELP, LOGLEVEL, MERGE, MINSV, NAVI, OUTDIR, RESULTS, RINEX, RUNBY, SELSYS, SHARD, THREADS, VER;
+//Metavariables for operators
+int BATCH;
+//@endcond
+
+/**OutputFile defines an output file created converting a file in the batch.
+ */
+struct OutputFile {
+	string name;		//the output file name
+	long long size;		//the file size in bytes
+	unsigned int crc;	//the CRC-32 checksum of the file contents
+};
+
+/**BatchFile defines a file in the batch and the results of its conversion.
+ */
+struct BatchFile {
+	enum FileType {FT_UNKNOWN, FT_OSP, FT_RINEX};
+	enum Status {ST_PENDING, ST_DONE, ST_FAILED, ST_SKIPPED};
+	string name;		//the input file name
+	long long size;		//the input file size in bytes
+	FileType type;		//the kind of input file
+	Status status;		//the conversion status
+	int epochs;			//the number of epochs converted
+	double seconds;		//the time taken by the conversion
+	vector<OutputFile> outputs;	//the output files created
+	string error;		//the reason of a failed conversion
+};
+
+/**WorkQueue defines the files pending conversion by a worker thread, largest first.
+ * The owner takes files from the front, and other workers steal them from the back.
+ */
+struct WorkQueue {
+	mutex lock;				//to access the queue
+	deque<size_t> files;	//the indexes in the batch of the files pending conversion
+	long long pendingBytes;	//the size of the files pending conversion
+};
+
+//@cond DUMMY
+///The text for each conversion status in results files
+const char* STATUSNAME[] = {"PENDING", "OK", "FAILED", "SKIPPED"};
+//The batch shared by worker threads
+vector<BatchFile> batch;		//the files to convert
+int shardIndex;					//the shard of the batch to convert
+int shardCount;					//the number of shards the batch is split into
+vector<WorkQueue*> queues;		//the queue of each worker
+atomic<int> filesEnded;			//the number of files whose conversion has ended
+mutex reportLock;				//to report conversion results to the log and stdout one file at a time
+set<string> outputNames;		//the output files created in this run, to avoid overwriting them
+mutex outputLock;				//to access outputNames
+//functions in this file
+int shardOf(const string &, int);
+bool fileChecksum(const string &, unsigned int &, long long &);
+bool writeResults(const string &, const string &, double, Logger*);
+bool readResults(const string &, vector<BatchFile> &, double &, Logger*);
+int mergeResults(string, int, Logger*);
+int printSummary(const string &, double, Logger*);
+bool loadBatch(string, Logger*);
+bool listDirFiles(const string &, vector<string> &, Logger*);
+BatchFile::FileType getFileType(const string &);
+void convertFiles(size_t, Logger*);
+bool nextFile(size_t, size_t &);
+void convertFile(BatchFile &, Logger*);
+int convertOSP(BatchFile &, FILE*, Logger*);
+int convertRINEX(BatchFile &, FILE*, Logger*);
+int convertCSV(BatchFile &, FILE*, Logger*);
+int printCSVFiles(BatchFile &, FILE*, const string &, char, bool, char &, Logger*);
+bool createOutput(BatchFile &, const string &, FILE* &, Logger*);
+void printNavFile(BatchFile &, RinexData &, RinexData::RINEXversion, char, Logger*);
+void reportFile(BatchFile &, Logger &, Logger*);
+//@endcond
+
+/**main
+ * gets the command line arguments, builds the batch of files to convert, and converts them using a pool of worker threads.
+ * Files are sorted by size and dealt round robin to the workers, so that each one starts with its largest files.
+ *
+ *@param argc the number of arguments passed from the command line
+ *@param argv the array of arguments passed from the command line
+ *@return  the exit status according to the following values and meaning::
+ *		- (0) all files in the batch have been converted or skipped
+ *		- (1) an error has been detected in arguments
+ *		- (2) the batch cannot be read or is empty, or the results file cannot be written
+ *		- (3) the conversion of some files has failed
+ *		- (4) when merging, results of some shards are missing or not valid
+ */
+int main(int argc, char* argv[]) {
+	/**The main process sequence follows:*/
+	/// 1- Defines and sets the error logger object
+	Logger log("LogFile.txt", string(), string(argv[0]) + MYVER + COMPDATE + string(" START"));
+	/// 2- Setups the valid options in the command line. They will be used by the argument/option parser
+	HDSATS = parser.addOption("-w", "--hdsats", "HDSATS", "Patch observation header records computed from epochs, reserving PRN / # OF OBS lines for up to HDSATS satellites", "0");
+	VER = parser.addOption("-v", "--ver", "VER", "RINEX version to generate (V210, V302)", "TBD");
+	RUNBY = parser.addOption("-u", "--runby", "RUNBY", "Who runs the RINEX file generation", "RUNBY");
+	SELSYS = parser.addOption("-s", "--selsys", "SELSYS", "Systems from OSP input in addition to GPS (R,S or R or S)", "");
+	RINEX = parser.addOption("-r", "--rinex", "RINEX", "RINEX file name prefix", "PNT1");
+	SHARD = parser.addOption("-p", "--shard", "SHARD", "Shard of the batch to convert, as INDEX/COUNT", "0/1");
+	OUTDIR = parser.addOption("-o", "--outdir", "OUTDIR", "Directory where output files are created", "");
+	NAVI = parser.addOption("-n", "--nRINEX", "NAVI", "Generate RINEX navigation files from OSP files", false);
+	MERGE = parser.addOption("-m", "--merge", "MERGE", "Merge and validate the results of the given number of shards instead of converting files", "0");
+	LOGLEVEL = parser.addOption("-l", "--llevel", "LOGLEVEL", "Maximum level to log (SEVERE, WARNING, INFO, CONFIG, FINE, FINER, FINEST)", "INFO");
+	THREADS = parser.addOption("-j", "--threads", "THREADS", "Number of worker threads converting files (0 means one per hardware thread)", "0");
+	MINSV = parser.addOption("-i", "--minsv", "MINSV", "Minimun satellites in a fix to acquire OSP observations", "4");
+	HELP = parser.addOption("-h", "--help", "HELP", "Show usage data and stops", false);
+	RESULTS = parser.addOption("-f", "--results", "RESULTS", "Results file name prefix", "BatchResults");
+	CSV = parser.addOption("-c", "--csv", "CSV", "Generate CSV files from RINEX files instead of RINEX files", false);
+	APBIAS = parser.addOption("-b", "--bias", "APBIAS", "Apply receiver clock bias to OSP measurements (and time)", true);
+	/// 3- Setups the default values for operators in the command line
+	BATCH = parser.addOperator(".");
+	/// 4- Parses arguments in the command line extracting options and operators
+	try {
+		parser.parseArgs(argc, argv);
+	}  catch (string error) {
+		parser.usage("Argument error: " + error, CMDLINE);
+		log.severe(error);
+		return 1;
+	}
+	log.info(parser.showOptValues());
+	log.info(parser.showOpeValues());
+	if (parser.getBoolOpt(HELP)) {
+		//help info has been requested
+		parser.usage("Converts a batch of OSP and RINEX files to RINEX files, or RINEX files to CSV files, using several threads", CMDLINE);
+		return 0;
+	}
+	/// 5- Sets logging level stated in option
+	log.setLevel(parser.getStrOpt(LOGLEVEL));
+	/// 6- Gets the shard of the batch to process, and merges the results of all shards if requested
+	if ((sscanf(parser.getStrOpt(SHARD).c_str(), "%d/%d", &shardIndex, &shardCount) != 2) || (shardCount < 1) || (shardIndex < 0) || (shardIndex >= shardCount)) {
+		parser.usage("Argument error: wrong shard " + parser.getStrOpt(SHARD), CMDLINE);
+		log.severe("Wrong shard " + parser.getStrOpt(SHARD));
+		return 1;
+	}
+	int nMerge = stoi(parser.getStrOpt(MERGE));
+	if (nMerge > 0) return mergeResults(parser.getOperator(BATCH), nMerge, &log);
+	/// 7- Builds the batch of files to convert from the manifest or directory given, keeping only those in the shard
+	if (!loadBatch(parser.getOperator(BATCH), &log)) return 2;
+	size_t nFiles = batch.size();
+	batch.erase(remove_if(batch.begin(), batch.end(), [](const BatchFile &f) {return shardOf(f.name, shardCount) != shardIndex;}), batch.end());
+	//when the batch is sharded, conversion logs are reported to a log file for the shard
+	Logger* reportLog = &log;
+	if (shardCount > 1) {
+		reportLog = new Logger("LogFile_" + to_string((long long) shardIndex) + "_" + to_string((long long) shardCount) + ".txt", string(), string(argv[0]) + MYVER + COMPDATE + string(" START"));
+		reportLog->setLevel(parser.getStrOpt(LOGLEVEL));
+		log.info("Shard " + parser.getStrOpt(SHARD) + ": " + to_string((long long) batch.size()) + " of " + to_string((long long) nFiles) + " files");
+	}
+	/// 8- Deals files to the worker queues largest first, and starts the workers
+	size_t nThreads = (size_t) stoi(parser.getStrOpt(THREADS));
+	if (nThreads == 0) nThreads = thread::hardware_concurrency();
+	if (nThreads == 0) nThreads = 1;
+	if (nThreads > batch.size()) nThreads = batch.size();
+	vector<size_t> order;
+	for (size_t i = 0; i < batch.size(); i++) order.push_back(i);
+	sort(order.begin(), order.end(), [](size_t a, size_t b) {return batch[a].size > batch[b].size;});
+	for (size_t i = 0; i < nThreads; i++) {
+		queues.push_back(new WorkQueue());
+		queues.back()->pendingBytes = 0;
+	}
+	for (size_t i = 0; i < order.size(); i++) {
+		queues[i % nThreads]->files.push_back(order[i]);
+		queues[i % nThreads]->pendingBytes += batch[order[i]].size;
+	}
+	reportLog->info("Files to convert: " + to_string((long long) batch.size()) + ". Worker threads: " + to_string((long long) nThreads));
+	filesEnded = 0;
+	chrono::steady_clock::time_point start = chrono::steady_clock::now();
+	vector<thread> workers;
+	for (size_t i = 0; i < nThreads; i++) workers.push_back(thread(convertFiles, i, reportLog));
+	for (size_t i = 0; i < nThreads; i++) workers[i].join();
+	for (size_t i = 0; i < nThreads; i++) delete queues[i];
+	double elapsed = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+	/// 9- Writes the results file of the shard, and prints and logs the summary of the batch conversion
+	string resultsName = parser.getStrOpt(RESULTS) + "_" + to_string((long long) shardIndex) + "_" + to_string((long long) shardCount) + ".txt";
+	bool resultsWritten = writeResults(resultsName, "shard " + parser.getStrOpt(SHARD), elapsed, reportLog);
+	int nFailed = printSummary(to_string((long long) nThreads) + " threads", elapsed, reportLog);
+	if (reportLog != &log) delete reportLog;
+	if (!resultsWritten) return 2;
+	return nFailed == 0? 0:3;
+}
+
+/**shardOf states the shard a file belongs to, from a hash (FNV-1a, with final bit mixing) of its name as given in the batch.
+ * The assignment only depends on the name and the number of shards, so it is the same in all processes converting the batch.
+ *
+ *@param name the file name
+ *@param nShards the number of shards
+ *@return the index of the shard the file belongs to
+ */
+int shardOf(const string &name, int nShards) {
+	unsigned int hash = 2166136261U;
+	for (string::const_iterator it = name.begin(); it != name.end(); it++) {
+		hash ^= (unsigned char) *it;
+		hash *= 16777619U;
+	}
+	hash ^= hash >> 16;
+	hash *= 0x85EBCA6BU;
+	hash ^= hash >> 13;
+	hash *= 0xC2B2AE35U;
+	hash ^= hash >> 16;
+	return (int) (hash % (unsigned int) nShards);
+}
+
+/**fileChecksum computes the CRC-32 (as in zip files) and the size of the given file.
+ *
+ *@param name the file name
+ *@param crc the checksum computed
+ *@param size the file size in bytes
+ *@return true if the file has been read, false otherwise
+ */
+bool fileChecksum(const string &name, unsigned int &crc, long long &size) {
+	static const struct CrcTable {
+		unsigned int value[256];
+		CrcTable() {
+			for (unsigned int i = 0; i < 256; i++) {
+				unsigned int c = i;
+				for (int k = 0; k < 8; k++) c = (c & 1)? 0xEDB88320U ^ (c >> 1) : c >> 1;
+				value[i] = c;
+			}
+		};
+	} table;
+	FILE* f;
+	unsigned char buffer[65536];
+	size_t n;
+	if ((f = fopen(name.c_str(), "rb")) == NULL) return false;
+	crc = 0xFFFFFFFFU;
+	size = 0;
+	while ((n = fread(buffer, 1, sizeof buffer, f)) > 0) {
+		for (size_t i = 0; i < n; i++) crc = table.value[(crc ^ buffer[i]) & 0xFF] ^ (crc >> 8);
+		size += n;
+	}
+	fclose(f);
+	crc ^= 0xFFFFFFFFU;
+	return true;
+}
+
+/**writeResults writes a results file with a line for each file in the batch stating, tab separated: the status (OK, FAILED, SKIPPED),
+ * the file name and size, the epochs converted, the conversion time, the number of output files followed by the name, size and
+ * checksum of each one, and the error message if any. The last line states the number of files and the elapsed time, and allows
+ * checking the results file is complete.
+ *
+ *@param name the results file name
+ *@param title the description of the results in the first line
+ *@param elapsed the elapsed time of the batch conversion, in seconds
+ *@param plog point to the Logger
+ *@return true if the results file has been written, false otherwise
+ */
+bool writeResults(const string &name, const string &title, double elapsed, Logger* plog) {
+	FILE* out;
+	if ((out = fopen(name.c_str(), "w")) == NULL) {
+		plog->severe(FILENOK + name);
+		return false;
+	}
+	fprintf(out, "# %s%sresults: %s\n", THISPRG.c_str(), MYVER.c_str(), title.c_str());
+	for (vector<BatchFile>::iterator it = batch.begin(); it != batch.end(); it++) {
+		fprintf(out, "%s\t%s\t%lld\t%d\t%.3f\t%d", STATUSNAME[it->status], it->name.c_str(), it->size, it->epochs, it->seconds, (int) it->outputs.size());
+		for (vector<OutputFile>::iterator ot = it->outputs.begin(); ot != it->outputs.end(); ot++)
+			fprintf(out, "\t%s\t%lld\t%08X", ot->name.c_str(), ot->size, ot->crc);
+		if (!it->error.empty()) fprintf(out, "\t%s", it->error.c_str());
+		fprintf(out, "\n");
+	}
+	fprintf(out, "# END files=%d elapsed=%.3f\n", (int) batch.size(), elapsed);
+	fclose(out);
+	plog->info("Results written to " + name);
+	return true;
+}
+
+/**readResults reads the data in a results file written by writeResults.
+ *
+ *@param name the results file name
+ *@param files the files whose results have been read
+ *@param elapsed the elapsed time of the batch conversion stated in the file
+ *@param plog point to the Logger
+ *@return true if the file has been read and it is complete, false otherwise
+ */
+bool readResults(const string &name, vector<BatchFile> &files, double &elapsed, Logger* plog) {
+	FILE* in;
+	char line[8192];
+	int nFiles;
+	bool complete = false;
+	if ((in = fopen(name.c_str(), "r")) == NULL) {
+		plog->severe("Results file missing: " + name);
+		return false;
+	}
+	while (!complete && (fgets(line, sizeof line, in) != NULL)) {
+		if (line[0] == '#') {
+			complete = (sscanf(line, "# END files=%d elapsed=%lf", &nFiles, &elapsed) == 2) && (nFiles == (int) files.size());
+			continue;
+		}
+		string text = line;
+		text.erase(text.find_last_not_of("\r\n") + 1);
+		vector<string> fields = getTokens(text, '\t');
+		BatchFile file;
+		int status = -1;
+		for (int i = 0; i <= BatchFile::ST_SKIPPED; i++)
+			if ((fields.size() > 0) && (fields[0].compare(STATUSNAME[i]) == 0)) status = i;
+		int nOut = fields.size() >= 6? atoi(fields[5].c_str()) : -1;
+		if ((status < 0) || (nOut < 0) || (fields.size() < (size_t) (6 + 3 * nOut))) break;
+		file.status = (BatchFile::Status) status;
+		file.name = fields[1];
+		file.size = atoll(fields[2].c_str());
+		file.type = BatchFile::FT_UNKNOWN;
+		file.epochs = atoi(fields[3].c_str());
+		file.seconds = atof(fields[4].c_str());
+		for (int i = 0; i < nOut; i++) {
+			OutputFile output = {fields[6 + 3 * i], atoll(fields[7 + 3 * i].c_str()), (unsigned int) strtoul(fields[8 + 3 * i].c_str(), NULL, 16)};
+			file.outputs.push_back(output);
+		}
+		if (fields.size() > (size_t) (6 + 3 * nOut)) file.error = fields[6 + 3 * nOut];
+		files.push_back(file);
+	}
+	fclose(in);
+	if (!complete) plog->severe("Results file incomplete or wrong: " + name);
+	return complete;
+}
+
+/**mergeResults merges the results files of the given number of shards of the batch, validating that all files in the batch
+ * have been processed once, by the shard they belong to, and that output files exist and have the checksums stated.
+ * The merged results are written into a results file for the whole batch, and the summary is printed.
+ *
+ *@param source the manifest file name, or the directory name, of the batch
+ *@param nShards the number of shards
+ *@param plog point to the Logger
+ *@return the exit status: 0 if the batch is complete without failures, 2 if it cannot be read, 3 if some files failed,
+ * 4 if results are missing or not valid
+ */
+int mergeResults(string source, int nShards, Logger* plog) {
+	map<string, size_t> inBatch;	//the files in the batch and their index
+	map<string, string> outputs;	//the output files and the file they come from
+	vector<bool> merged;			//if results for each file in the batch have been merged
+	int nErrors = 0;
+	double elapsed = 0.0;			//the elapsed time of the slowest shard
+	unsigned int crc;
+	long long size;
+	if (!loadBatch(source, plog)) return 2;
+	for (size_t i = 0; i < batch.size(); i++) inBatch[batch[i].name] = i;
+	merged.assign(batch.size(), false);
+	for (int shard = 0; shard < nShards; shard++) {
+		vector<BatchFile> files;
+		double shardElapsed = 0.0;
+		string name = parser.getStrOpt(RESULTS) + "_" + to_string((long long) shard) + "_" + to_string((long long) nShards) + ".txt";
+		if (!readResults(name, files, shardElapsed, plog)) nErrors++;
+		if (shardElapsed > elapsed) elapsed = shardElapsed;
+		for (vector<BatchFile>::iterator it = files.begin(); it != files.end(); it++) {
+			map<string, size_t>::iterator found = inBatch.find(it->name);
+			if (found == inBatch.end()) {
+				plog->severe("File not in the batch: " + it->name + " in " + name);
+				nErrors++;
+				continue;
+			}
+			if (merged[found->second]) {
+				plog->severe("File processed by several shards: " + it->name);
+				nErrors++;
+				continue;
+			}
+			if (shardOf(it->name, nShards) != shard) {
+				plog->severe("File processed by a wrong shard: " + it->name + " in " + name);
+				nErrors++;
+			}
+			for (vector<OutputFile>::iterator ot = it->outputs.begin(); ot != it->outputs.end(); ot++) {
+				if (!outputs.insert(make_pair(ot->name, it->name)).second) {
+					plog->severe("Output file " + ot->name + " created from " + it->name + " and " + outputs[ot->name]);
+					nErrors++;
+				} else if (!fileChecksum(ot->name, crc, size) || (crc != ot->crc) || (size != ot->size)) {
+					plog->severe("Output file " + ot->name + " from " + it->name + " missing or not matching its checksum");
+					nErrors++;
+				}
+			}
+			it->type = batch[found->second].type;
+			batch[found->second] = *it;
+			merged[found->second] = true;
+		}
+	}
+	for (size_t i = 0; i < batch.size(); i++)
+		if (!merged[i]) {
+			plog->severe("File not processed by any shard: " + batch[i].name);
+			nErrors++;
+		}
+	writeResults(parser.getStrOpt(RESULTS) + ".txt", "merged " + to_string((long long) nShards) + " shards", elapsed, plog);
+	int nFailed = printSummary(to_string((long long) nShards) + " shards", elapsed, plog);
+	if (nErrors > 0) {
+		printf("Merge errors: %d. Results are not complete or not valid (see log)\n", nErrors);
+		plog->severe("Merge errors: " + to_string((long long) nErrors));
+		return 4;
+	}
+	return nFailed == 0? 0:3;
+}
+
+/**printSummary prints to stdout and logs the summary of the batch conversion, and lists the files whose conversion failed.
+ *
+ *@param workers a description of the workers converting the batch (threads or shards)
+ *@param elapsed the elapsed time of the conversion, in seconds
+ *@param plog point to the Logger
+ *@return the number of files whose conversion failed
+ */
+int printSummary(const string &workers, double elapsed, Logger* plog) {
+	int nDone = 0, nFailed = 0, nSkipped = 0, nPending = 0;
+	long long epochs = 0, bytes = 0;
+	double busy = 0.0;
+	char buffer[256];
+	for (vector<BatchFile>::iterator it = batch.begin(); it != batch.end(); it++) {
+		switch (it->status) {
+		case BatchFile::ST_DONE: nDone++; break;
+		case BatchFile::ST_FAILED: nFailed++; break;
+		case BatchFile::ST_SKIPPED: nSkipped++; continue;
+		default: nPending++; continue;
+		}
+		epochs += it->epochs;
+		bytes += it->size;
+		busy += it->seconds;
+	}
+	sprintf(buffer, "Batch summary: %d files, %d converted, %d failed, %d skipped. %lld epochs, %.1f MB in %.2f s (%.2f MB/s, %.2f s of conversion work on %s)",
+		(int) batch.size(), nDone, nFailed, nSkipped, epochs, bytes / 1048576.0, elapsed, elapsed > 0.0? bytes / 1048576.0 / elapsed : 0.0, busy, workers.c_str());
+	printf("%s\n", buffer);
+	plog->info(buffer);
+	if (nPending > 0) printf("Not processed: %d files\n", nPending);
+	for (vector<BatchFile>::iterator it = batch.begin(); it != batch.end(); it++)
+		if (it->status == BatchFile::ST_FAILED) printf("Failed: %s (%s)\n", it->name.c_str(), it->error.c_str());
+	return nFailed;
+}
+
+/**loadBatch builds the batch of files to convert from the names in a manifest file, or from the files in a directory and its subdirectories.
+ * When an OSP or RINEX file is given instead of a manifest, the batch is this file. The type and size of each file are stated. Files which cannot be read are included to be reported as failed.
+ *
+ *@param source the manifest file name, or the directory name
+ *@param plog point to the Logger
+ *@return true if the batch contains files, false otherwise
+ */
+bool loadBatch(string source, Logger* plog) {
+	struct stat fileStat;
+	vector<string> names;
+	if (stat(source.c_str(), &fileStat) != 0) {
+		plog->severe(FILENOK + source);
+		return false;
+	}
+	if (S_ISDIR(fileStat.st_mode)) {
+		//the batch is the regular files in the directory and its subdirectories (as station or day folders), in name order
+		if (!listDirFiles(source, names, plog)) {
+			plog->severe("Cannot open directory " + source);
+			return false;
+		}
+		sort(names.begin(), names.end());
+	} else if (getFileType(source) != BatchFile::FT_UNKNOWN) {
+		//the batch is the given OSP or RINEX file
+		names.push_back(source);
+	} else {
+		//the batch is the file names in the manifest, one per line
+		FILE* manifest;
+		char line[1024];
+		if ((manifest = fopen(source.c_str(), "r")) == NULL) {
+			plog->severe(FILENOK + source);
+			return false;
+		}
+		while (fgets(line, sizeof line, manifest) != NULL) {
+			string name = line;
+			name.erase(name.find_last_not_of(" \t\r\n") + 1);
+			name.erase(0, name.find_first_not_of(" \t"));
+			if (!name.empty() && (name[0] != '#')) names.push_back(name);
+		}
+		fclose(manifest);
+	}
+	for (vector<string>::iterator it = names.begin(); it != names.end(); it++) {
+		BatchFile file;
+		file.name = *it;
+		file.size = stat(it->c_str(), &fileStat) == 0? (long long) fileStat.st_size : 0;
+		file.type = getFileType(*it);
+		file.status = BatchFile::ST_PENDING;
+		file.epochs = 0;
+		file.seconds = 0.0;
+		batch.push_back(file);
+	}
+	if (batch.empty()) {
+		plog->severe("No files to convert in " + source);
+		return false;
+	}
+	return true;
+}
+
+/**listDirFiles appends to the given list the names of the regular files in a directory and, recursively, in its subdirectories.
+ * Links to directories are not followed. Subdirectories which cannot be read are logged and skipped.
+ *
+ *@param dir the directory name
+ *@param names the list where the file names are appended
+ *@param plog point to the Logger
+ *@return true if the directory can be read, false otherwise
+ */
+bool listDirFiles(const string &dir, vector<string> &names, Logger* plog) {
+	vector<string> subdirs;
+#ifdef _WIN32
+	WIN32_FIND_DATAA entry;
+	HANDLE find;
+	if ((find = FindFirstFileA((dir + "/*").c_str(), &entry)) == INVALID_HANDLE_VALUE) return false;
+	do {
+		string name = entry.cFileName;
+		if ((name.compare(".") == 0) || (name.compare("..") == 0)) continue;
+		if ((entry.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) == 0) names.push_back(dir + "/" + name);
+		else if ((entry.dwFileAttributes & FILE_ATTRIBUTE_REPARSE_POINT) == 0) subdirs.push_back(dir + "/" + name);
+	} while (FindNextFileA(find, &entry));
+	FindClose(find);
+#else
+	DIR* dirp;
+	struct dirent* entry;
+	struct stat fileStat;
+	if ((dirp = opendir(dir.c_str())) == NULL) return false;
+	while ((entry = readdir(dirp)) != NULL) {
+		string name = entry->d_name;
+		if ((name.compare(".") == 0) || (name.compare("..") == 0)) continue;
+		name = dir + "/" + name;
+		if (lstat(name.c_str(), &fileStat) != 0) continue;
+		if (S_ISDIR(fileStat.st_mode)) subdirs.push_back(name);
+		else if ((stat(name.c_str(), &fileStat) == 0) && S_ISREG(fileStat.st_mode)) names.push_back(name);
+	}
+	closedir(dirp);
+#endif
+	for (vector<string>::iterator it = subdirs.begin(); it != subdirs.end(); it++)
+		if (!listDirFiles(*it, names, plog)) plog->warning("Cannot open directory " + *it + ". Skipped");
+	return true;
+}
+
+/**getFileType states the type of a file from its contents or name: a RINEX file has the RINEX VERSION / TYPE record
+ * in its first line, and an OSP file has the .OSP extension.
+ *
+ *@param name the file name
+ *@return the file type
+ */
+BatchFile::FileType getFileType(const string &name) {
+	FILE* f;
+	char line[100];
+	if ((f = fopen(name.c_str(), "r")) != NULL) {
+		bool rinex = (fgets(line, sizeof line, f) != NULL) && (strlen(line) >= 80) && (strncmp(line + 60, "RINEX VERSION / TYPE", 20) == 0);
+		fclose(f);
+		if (rinex) return BatchFile::FT_RINEX;
+	}
+	size_t n = name.find_last_of('.');
+	if (n == string::npos) return BatchFile::FT_UNKNOWN;
+	string ext = name.substr(n + 1);
+	transform(ext.begin(), ext.end(), ext.begin(), ::toupper);
+	return ext.compare("OSP") == 0? BatchFile::FT_OSP : BatchFile::FT_UNKNOWN;
+}
+
+/**convertFiles is the body of each worker thread: it converts the files in its queue and, when the queue is empty,
+ * files stolen from other queues, until no files remain pending.
+ *
+ *@param worker the index of this worker, and its queue
+ *@param plog point to the Logger where the conversion logs are reported
+ */
+void convertFiles(size_t worker, Logger* plog) {
+	size_t index;
+	while (nextFile(worker, index)) {
+		BatchFile &file = batch[index];
+		Logger fileLog(plog);	//messages are deferred to report them together when the conversion ends
+		chrono::steady_clock::time_point start = chrono::steady_clock::now();
+		convertFile(file, &fileLog);
+		file.seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+		reportFile(file, fileLog, plog);
+	}
+}
+
+/**nextFile gets the next file to be converted by a worker: the largest one in its queue or, if it is empty,
+ * the smallest one in the queue having more data pending.
+ *
+ *@param worker the index of the worker
+ *@param index the index in the batch of the file to convert
+ *@return true if a file has been taken, false if no files remain pending
+ */
+bool nextFile(size_t worker, size_t &index) {
+	WorkQueue* own = queues[worker];
+	{
+		lock_guard<mutex> guard(own->lock);
+		if (!own->files.empty()) {
+			index = own->files.front();
+			own->files.pop_front();
+			own->pendingBytes -= batch[index].size;
+			return true;
+		}
+	}
+	for (;;) {
+		WorkQueue* victim = NULL;
+		long long maxPending = -1;
+		for (size_t i = 0; i < queues.size(); i++) {
+			lock_guard<mutex> guard(queues[i]->lock);
+			if (!queues[i]->files.empty() && (queues[i]->pendingBytes > maxPending)) {
+				victim = queues[i];
+				maxPending = queues[i]->pendingBytes;
+			}
+		}
+		if (victim == NULL) return false;
+		lock_guard<mutex> guard(victim->lock);
+		//the victim could have been emptied meanwhile: try again
+		if (victim->files.empty()) continue;
+		index = victim->files.back();
+		victim->files.pop_back();
+		victim->pendingBytes -= batch[index].size;
+		return true;
+	}
+}
+
+/**convertFile converts the given file according to its type.
+ *
+ *@param file the file to convert
+ *@param plog point to the Logger for this file
+ */
+void convertFile(BatchFile &file, Logger* plog) {
+	FILE* inFile;
+	if (file.type == BatchFile::FT_UNKNOWN) {
+		file.status = BatchFile::ST_SKIPPED;
+		file.error = "not an OSP or RINEX file";
+		return;
+	}
+	if ((inFile = fopen(file.name.c_str(), file.type == BatchFile::FT_OSP? "rb" : "r")) == NULL) {
+		file.status = BatchFile::ST_FAILED;
+		file.error = FILENOK + file.name;
+		plog->severe(file.error);
+		return;
+	}
+	if (file.type == BatchFile::FT_OSP) file.epochs = convertOSP(file, inFile, plog);
+	else file.epochs = parser.getBoolOpt(CSV)? convertCSV(file, inFile, plog) : convertRINEX(file, inFile, plog);
+	fclose(inFile);
+	for (vector<OutputFile>::iterator it = file.outputs.begin(); it != file.outputs.end(); it++)
+		if (!fileChecksum(it->name, it->crc, it->size) && file.error.empty()) file.error = "Cannot read output file " + it->name;
+	if (file.error.empty() && (file.epochs == 0)) file.error = "no epoch data";
+	file.status = file.error.empty()? BatchFile::ST_DONE : BatchFile::ST_FAILED;
+}
+
+/**convertOSP generates RINEX files from an OSP file, as OSPtoRINEX does with its default options.
+ *
+ *@param file the file to convert, where output file names and errors are stated
+ *@param inFile the open input file
+ *@param plog point to the Logger for this file
+ *@return the number of epochs read in the inFile
+ */
+int convertOSP(BatchFile &file, FILE* inFile, Logger* plog) {
+	int epochCount = 0;		//to count the number of epochs processed
+	FILE* obsFile;			//the file where RINEX observation data will be printed
+	vector<string> selSys;	//the selected systems
+	vector<string> selObs;	//the empty selected observations
+	vector<string> observables = getTokens("C1C,L1C,D1C,S1C", ',');	//the defined observables in OSP
+	bool glonassSel = false;	//if GLONASS data (observation or navigation) are requested or not
+	/// 1- Setups the RinexData object members with data given in command line options
+	string aStr = parser.getStrOpt(SELSYS);
+	if (aStr.empty()) aStr = "G";
+	else aStr = "G," + aStr;
+	selSys = getTokens(aStr, ',');
+	RinexData::RINEXversion rinexVer = RinexData::V210;		//default version is 2.10
+	if (parser.getStrOpt(VER).compare("V302") == 0) rinexVer = RinexData::V302;
+	RinexData rinex(rinexVer, plog);
+	try {
+		rinex.setHdLnData(RinexData::RUNBY, THISPRG + MYVER, parser.getStrOpt(RUNBY));
+		rinex.setHdLnData(RinexData::MRKNAME, string("MRKNAM"));
+		rinex.setHdLnData(RinexData::MRKNUMBER, string("MRKNUM"));
+		rinex.setHdLnData(RinexData::ANTTYPE, string("Antenna#"), string("AntennaType"));
+		rinex.setHdLnData(RinexData::ANTHEN, (double) 0.0, (double) 0.0, (double) 0.0);
+		rinex.setHdLnData(RinexData::AGENCY, string("OBSERVER"), string("AGENCY"));
+		rinex.setHdLnData(RinexData::TOFO, string("GPS"));
+		rinex.setHdLnData(RinexData::WVLEN, (int) 1, (int) 0);
+		for (vector<string>::iterator it = selSys.begin(); it != selSys.end(); it++) {
+			rinex.setHdLnData(RinexData::TOBS, it->at(0), observables);
+			if (it->at(0) == 'R') glonassSel = true;
+		}
+		if (!rinex.setFilter(selSys, selObs)) plog->warning("Error in selected systems. Erroneous data ignored");
+	} catch (string error) {
+		plog->severe(error);
+	}
+	/// 2- Acquires header data from the OSP file, creates the observation file and prints the header
+	GNSSdataFromOSP gnssAcq(RECEIVER_NAME, stoi(parser.getStrOpt(MINSV)), parser.getBoolOpt(APBIAS), inFile, plog);
+	if(!gnssAcq.acqHeaderData(rinex)) plog->warning("All, or some header data not acquired");
+	if (glonassSel) gnssAcq.acqGLOparams();
+	if (!createOutput(file, rinex.getObsFileName(parser.getStrOpt(RINEX)), obsFile, plog)) return 0;
+	/// 3- Iterates over the OSP file extracting epoch by epoch data and printing them
+	try {
+		rinex.setHeaderPatch(stoi(parser.getStrOpt(HDSATS)));
+		rinex.printObsHeader(obsFile);
+		gnssAcq.rewind();
+		while (gnssAcq.acqEpochData(rinex, false, false)) {
+			rinex.printObsEpoch(obsFile);
+			epochCount++;
+		}
+		rinex.patchObsHeader(obsFile);
+	} catch (string error) {
+		plog->severe(error);
+		file.error = error;
+	}
+	fclose(obsFile);
+	/// 4- Prints the navigation files, if requested
+	if (parser.getBoolOpt(NAVI)) {
+		if (rinexVer == RinexData::V302) printNavFile(file, rinex, rinexVer, 'M', plog);
+		else for (vector<string>::iterator it = selSys.begin(); it != selSys.end(); it++) printNavFile(file, rinex, rinexVer, it->at(0), plog);
+	}
+	return epochCount;
+}
+
+/**convertRINEX generates a RINEX file from an input RINEX observation or navigation file, as RINEXtoRINEX does with its default options.
+ *
+ *@param file the file to convert, where output file names and errors are stated
+ *@param inFile the open input file
+ *@param plog point to the Logger for this file
+ *@return the number of epochs printed
+ */
+int convertRINEX(BatchFile &file, FILE* inFile, Logger* plog) {
+	int epochCount = 0;
+	FILE* outFile;
+	double aDouble;
+	int anInt;
+	string aStr;
+	char fileType = ' ';
+	char sysId = ' ';
+	RinexData::RINEXversion rinexVer = RinexData::VTBD;		//default version is the input one
+	aStr = parser.getStrOpt(VER);
+	if (aStr.compare("V210") == 0) rinexVer = RinexData::V210;
+	else if (aStr.compare("V302") == 0) rinexVer = RinexData::V302;
+	RinexData rinex(rinexVer, plog);
+	try {
+		rinex.readRinexHeader(inFile);
+		if (!rinex.getHdLnData(RinexData::INFILEVER, aDouble, fileType, sysId)) {
+			file.error = "This RINEX input file version cannot be processed";
+			plog->severe(file.error);
+			return 0;
+		}
+		rinex.setHdLnData(RinexData::RUNBY, THISPRG + MYVER, parser.getStrOpt(RUNBY));
+		switch (fileType) {
+		case 'O':
+			//name the output file from the time of the first observation, print the header, and print epochs read
+			if (rinex.getHdLnData(RinexData::TOFO, anInt, aDouble, aStr)) rinex.setEpochTime(anInt, aDouble);
+			else plog->warning("Time of first observation not set. File name will not be standard");
+			if (!createOutput(file, rinex.getObsFileName(parser.getStrOpt(RINEX)), outFile, plog)) return 0;
+			rinex.setHeaderPatch(stoi(parser.getStrOpt(HDSATS)));
+			rinex.printObsHeader(outFile);
+			rinex.clearHeaderData();
+			while ((anInt = rinex.readObsEpoch(inFile)) != 0) {
+				switch (anInt) {
+				case 1:
+				case 3:
+					rinex.printObsEpoch(outFile);
+					epochCount++;
+					break;
+				case 2:
+				case 5:
+				case 6:
+				case 7:
+					rinex.printObsEpoch(outFile);
+					epochCount++;
+					rinex.clearHeaderData();
+					break;
+				default:
+					break;
+				}
+			}
+			rinex.patchObsHeader(outFile);
+			fclose(outFile);
+			break;
+		case 'N':
+		case 'G':
+		case 'E':
+		case 'R':
+			if (!createOutput(file, rinex.getNavFileName(parser.getStrOpt(RINEX)), outFile, plog)) return 0;
+			rinex.printNavHeader(outFile);
+			while (((anInt = rinex.readNavEpoch(inFile)) != 0) && (anInt != 9))
+				if (anInt == 1) {
+					rinex.printNavEpoch(outFile);
+					epochCount++;
+				}
+			fclose(outFile);
+			break;
+		default:
+			file.error = "RINEX file type cannot be processed";
+			plog->severe(file.error);
+			break;
+		}
+	}  catch (string error) {
+		plog->severe(error + string(". Incomplete RINEX file"));
+		file.error = error;
+	}
+	return epochCount;
+}
+
+/**convertCSV generates CSV files from an input RINEX observation or navigation file, as RINEXtoCSV does with its default options.
+ * Output file names are the input file name, without directory and with . replaced by _, followed by the suffixes used by RINEXtoCSV.
+ * RINEX V3 mixed navigation files are read once for GPS and each additional system selected, generating a CSV file for each one.
+ *
+ *@param file the file to convert, where output file names and errors are stated
+ *@param inFile the open input file
+ *@param plog point to the Logger for this file
+ *@return the number of epochs transferred to CSV files
+ */
+int convertCSV(BatchFile &file, FILE* inFile, Logger* plog) {
+	int epochCount = 0;
+	char sysId = ' ';
+	string aStr = parser.getStrOpt(SELSYS);
+	vector<string> selSys = getTokens(aStr.empty()? "G" : "G," + aStr, ',');
+	string baseName = file.name.substr(file.name.find_last_of("/\\") + 1);
+	replace(baseName.begin(), baseName.end(), '.', '_');
+	for (size_t i = 0; i < selSys.size(); i++) {
+		if (i > 0) rewind(inFile);
+		epochCount += printCSVFiles(file, inFile, baseName, selSys[i].at(0), i == 0, sysId, plog);
+		if ((sysId != 'M') || !file.error.empty()) break;
+	}
+	return epochCount;
+}
+
+/**printCSVFiles reads the header of the given RINEX file, and generates its CSV files: the header file (if requested) and
+ * the observation or navigation epochs file.
+ *
+ *@param file the file to convert, where output file names and errors are stated
+ *@param inFile the input file, positioned at its beginning
+ *@param baseName the name of the CSV files without suffix
+ *@param navSys the system whose navigation data are generated when the input is a mixed navigation file
+ *@param withHeader if the CSV file for header data is generated or not
+ *@param sysId the system identifier of the input file, M for mixed files
+ *@param plog point to the Logger for this file
+ *@return the number of epochs transferred to the CSV file
+ */
+int printCSVFiles(BatchFile &file, FILE* inFile, const string &baseName, char navSys, bool withHeader, char &sysId, Logger* plog) {
+	int epochCount = 0;
+	FILE* outFile;
+	double aDouble;
+	char fileType = ' ';
+	string suffix;
+	int (*generateNavCSV)(FILE*, FILE*, RinexData &, TimeIntervalParams &, Logger*);
+	vector<string> selSat;		//the system selected for mixed navigation files
+	vector<string> selObs;		//the empty selected observations
+	TimeIntervalParams timeInterval;	//all epochs are selected
+	timeInterval.fromTime = timeInterval.toTime = timeInterval.timeOrdered = false;
+	RinexData rinex(RinexData::VTBD, plog);
+	try {
+		rinex.readRinexHeader(inFile);
+		if (!rinex.getHdLnData(RinexData::INFILEVER, aDouble, fileType, sysId)) {
+			file.error = "This RINEX input file version cannot be processed";
+			plog->severe(file.error);
+			return 0;
+		}
+		if ((fileType == 'N') && (sysId == 'M')) selSat.push_back(string(1, navSys));
+		if (!rinex.setFilter(selSat, selObs)) plog->warning("Ignored inconsistent data filtering parameters for observation files.");
+		if (withHeader) {
+			if (!createOutput(file, baseName + "_HDR.CSV", outFile, plog)) return 0;
+			generateHeaderCSV(outFile, rinex, plog);
+			fclose(outFile);
+		}
+		rinex.clearHeaderData();
+		switch (fileType) {
+		case 'O':
+			if (!createOutput(file, baseName + "_OBS.CSV", outFile, plog)) return 0;
+			epochCount = generateObsCSV(inFile, outFile, rinex, timeInterval, plog);
+			fclose(outFile);
+			break;
+		case 'N':
+			switch (sysId == 'M'? navSys : sysId) {
+			case 'G': suffix = "_GPSNAV.CSV"; generateNavCSV = generateGPSNavCSV; break;
+			case 'E': suffix = "_GALNAV.CSV"; generateNavCSV = generateGalNavCSV; break;
+			case 'R': suffix = "_GLONAV.CSV"; generateNavCSV = generateGloNavCSV; break;
+			case 'S': suffix = "_SBASNAV.CSV"; generateNavCSV = generateSBASNavCSV; break;
+			default:
+				file.error = "Unexpected system type for navigation file";
+				plog->severe(file.error);
+				return 0;
+			}
+			if (!createOutput(file, baseName + suffix, outFile, plog)) return 0;
+			epochCount = generateNavCSV(inFile, outFile, rinex, timeInterval, plog);
+			fclose(outFile);
+			break;
+		default:
+			file.error = "Unexpected file type, different from Observation or Navigation";
+			plog->severe(file.error);
+			break;
+		}
+	}  catch (string error) {
+		plog->severe(error);
+		file.error = error;
+	}
+	return epochCount;
+}
+
+/**createOutput creates an output file in the output directory, unless a file with the same name has been created in this run.
+ *When a shard of the batch is converted, the file is not created if it already exists, as it could be the output of another shard.
+ *
+ *@param file the file being converted, where the output name, or the error, is stated
+ *@param name the output file name
+ *@param outFile the output FILE created
+ *@param plog point to the Logger for this file
+ *@return true if the file has been created, false otherwise
+ */
+bool createOutput(BatchFile &file, const string &name, FILE* &outFile, Logger* plog) {
+	string outDir = parser.getStrOpt(OUTDIR);
+	string path = outDir.empty()? name : outDir + "/" + name;
+	{
+		lock_guard<mutex> guard(outputLock);
+		if (!outputNames.insert(path).second) {
+			file.error = "Output file " + path + " already created from another file in the batch";
+			plog->severe(file.error);
+			return false;
+		}
+	}
+	if (shardCount > 1) {
+		//other shards may write to the same output directory: never overwrite an existing file
+#ifdef _WIN32
+		int fd = _open(path.c_str(), _O_WRONLY | _O_CREAT | _O_EXCL | _O_TEXT, _S_IREAD | _S_IWRITE);
+		outFile = fd < 0? NULL : _fdopen(fd, "w");
+#else
+		int fd = open(path.c_str(), O_WRONLY | O_CREAT | O_EXCL, 0666);
+		outFile = fd < 0? NULL : fdopen(fd, "w");
+#endif
+		if ((outFile == NULL) && (errno == EEXIST)) {
+			file.error = "Output file " + path + " already exists (from another shard or a previous run)";
+			plog->severe(file.error);
+			return false;
+		}
+	} else outFile = fopen(path.c_str(), "w");
+	if (outFile == NULL) {
+		file.error = FILENOK + path;
+		plog->severe(file.error);
+		return false;
+	}
+	OutputFile output = {path, 0, 0};
+	file.outputs.push_back(output);
+	return true;
+}
+
+/**printNavFile prints a RINEX navigation file from the navigation data stored in the given RinexData object.
+ *File format will be according the given version, and for the given satellite system if version to be generated is 2.10.
+ *
+ *@param file the file being converted, where the output name is stated
+ *@param rinex is the RinexData object containing navigation data for the file to be printed
+ *@param ver is the RINEX version of the file to be generated
+ *@param sysId is the identification of the satellite system data to be printed. Only relevant for version 2.10 files.
+ *@param plog point to the Logger for this file
+ */
+void printNavFile(BatchFile &file, RinexData &rinex, RinexData::RINEXversion ver, char sysId, Logger* plog) {
+	FILE* navFile;		//the file where RINEX navigation data will be printed
+	string outFileName;	//the output file name for RINEX files
+	char fnameSfx;
+	if (ver == RinexData::V302) outFileName = rinex.getNavFileName(parser.getStrOpt(RINEX));
+	else {
+		switch (sysId) {
+		case 'G': fnameSfx = 'N'; break;
+		case 'R': fnameSfx = 'G'; break;
+		case 'S': fnameSfx = 'H'; break;
+		default:
+			plog->warning("Cannot print RINEX V2.10 navigation file for system " + string(1, sysId));
+			return;
+		}
+		outFileName = rinex.getNavFileName(parser.getStrOpt(RINEX), fnameSfx);
+	}
+	if (!createOutput(file, outFileName, navFile, plog)) return;
+	try {
+		rinex.setFilter(vector<string>(1,string(1,sysId)), vector<string>());
+		rinex.printNavHeader(navFile);
+		rinex.printNavEpoch(navFile);
+	} catch (string error) {
+		plog->severe(error);
+		file.error = error;
+	}
+	fclose(navFile);
+}
+
+/**reportFile reports the conversion of a file: forwards to the target Logger the messages deferred during the conversion,
+ * and logs and prints to stdout the file status.
+ *
+ *@param file the converted file
+ *@param fileLog the Logger where conversion messages have been deferred
+ *@param plog point to the target Logger
+ */
+void reportFile(BatchFile &file, Logger &fileLog, Logger* plog) {
+	char buffer[128];
+	string status;
+	switch (file.status) {
+	case BatchFile::ST_DONE:
+		sprintf(buffer, "OK %d epochs in %.2f s", file.epochs, file.seconds);
+		status = buffer;
+		for (vector<OutputFile>::iterator it = file.outputs.begin(); it != file.outputs.end(); it++) status += " " + it->name;
+		break;
+	case BatchFile::ST_FAILED:
+		status = "FAILED " + file.error;
+		break;
+	default:
+		status = "SKIPPED " + file.error;
+		break;
+	}
+	lock_guard<mutex> guard(reportLock);
+	int n = ++filesEnded;
+	sprintf(buffer, "[%d/%d] ", n, (int) batch.size());
+	plog->info("Converting " + file.name);
+	fileLog.forward(0, fileLog.deferredSize());
+	plog->info(string(buffer) + file.name + ": " + status);
+	printf("%s%s: %s\n", buffer, file.name.c_str(), status.c_str());
+	fflush(stdout);
+}
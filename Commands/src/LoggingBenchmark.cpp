@@ -0,0 +1,147 @@
+/** @file LoggingBenchmark.cpp
+ * Contains the command line program to measure the cost of logging call sites, when messages are logged calling directly
+ * the Logger methods, and when they are logged using the LOG_... macros.
+ *<p>Usage:
+ *<p>LoggingBenchmark.exe {options}
+ *<p>Messages like the ones logged in hot paths of RinexData and GNSSdataFromOSP are logged many times at the given log level
+ *(INFO by default, where none of them are recorded), and the time taken per call is given, to stdout. Call sites measured are:
+ *	- A FINE message composed using to_string and string concatenation, as the MID28 epoch message.
+ *	- A FINER message composed using sprintf, as the MID8 GPS subframe message.
+ *	- A FINEST message with constant text, to show the cost of the call itself.
+ *<p>For each call site, the time taken calling directly the Logger method (fine, finer, finest), and using the corresponding macro
+ *(LOG_FINE, LOG_FINER, LOG_FINEST, or the isLevel guard for sprintf) is given.
+ *<p>Options are:
+ *	- -h or --help : Show usage data and stops. Default value HELP=FALSE
+ *	- -l LOGLEVEL or --llevel=LOGLEVEL : Maximum level to log (SEVERE, WARNING, INFO, CONFIG, FINE, FINER, FINEST). Default value LOGLEVEL = INFO
+ *	- -n CALLS or --calls=CALLS : Number of calls measured for each call site. Default value CALLS = 1000000
+ *<p>
+ *Copyright 2015 Francisco Cancillo
+ *<p>
+ *This file is part of the RXtoRINEX tool.
+ *<p>
+ *RXtoRINEX is free software: you can redistribute it and/or modify it under the terms of the GNU General Public License
+ *as published by the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+ *RXtoRINEX is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ *warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *See the GNU General Public License for more details.
+ *A copy of the GNU General Public License can be found at <http://www.gnu.org/licenses/>.
+ *
+ *Ver.	|Date	|Reason for change
+ *------+-------+------------------
+ *V1.0	|10/2026	|First release
+ */
+#include <stdio.h>
+#include <chrono>
+
+//from CommonClasses
+#include "ArgParser.h"
+#include "Logger.h"
+
+using namespace std;
+
+//@cond DUMMY
+///Program name
+const string THISPRG = "LoggingBenchmark";
+///The command line format
+const string CMDLINE = THISPRG + ".exe {options}";
+///Current program version
+const string MYVER = " V1.0 ";
+//The parser object to store options and operators passed in the comman line
+ArgParser parser;
+//Metavariables for options
+int HELP, LOGLEVEL, CALLS;
+//@endcond
+
+//@cond DUMMY
+//functions in this file
+double nsPerCall(chrono::steady_clock::time_point, int);
+//@endcond
+
+/**main
+ * gets the command line arguments, and measures the time per call of each logging call site, called directly and using macros.
+ *
+ *@param argc the number of arguments passed from the command line
+ *@param argv the array of arguments passed from the command line
+ *@return  the exit status according to the following values and meaning::
+ *		- (0) no errors have been detected
+ *		- (1) an error has been detected in arguments
+ */
+int main(int argc, char* argv[]) {
+	/**The main process sequence follows:*/
+	/// 1- Defines and sets the error logger object
+	Logger log("LogFile.txt", string(), string(argv[0]) + MYVER + string(" START"));
+	/// 2- Setups the valid options in the command line. They will be used by the argument/option parser
+	CALLS = parser.addOption("-n", "--calls", "CALLS", "Number of calls measured for each call site", "1000000");
+	LOGLEVEL = parser.addOption("-l", "--llevel", "LOGLEVEL", "Maximum level to log (SEVERE, WARNING, INFO, CONFIG, FINE, FINER, FINEST)", "INFO");
+	HELP = parser.addOption("-h", "--help", "HELP", "Show usage data and stops", false);
+	/// 3- Parses arguments in the command line extracting options
+	try {
+		parser.parseArgs(argc, argv);
+	}  catch (string error) {
+		parser.usage("Argument error: " + error, CMDLINE);
+		log.severe(error);
+		return 1;
+	}
+	log.info(parser.showOptValues());
+	if (parser.getBoolOpt(HELP)) {
+		//help info has been requested
+		parser.usage("Measures the cost of logging call sites, called directly and using macros", CMDLINE);
+		return 0;
+	}
+	/// 4- Sets logging level stated in option
+	log.setLevel(parser.getStrOpt(LOGLEVEL));
+	int calls = atoi(parser.getStrOpt(CALLS).c_str());
+	if (calls < 1) calls = 1;
+	/// 5- Measures the time per call of each call site, calling directly the Logger method and using the macro or guard
+	Logger* plog = &log;
+	char msgBuf[100];
+	double tDirect, tMacro;
+	chrono::steady_clock::time_point start;
+	printf("Logging call sites at %s (%d calls, ns per call)\n", parser.getStrOpt(LOGLEVEL).c_str(), calls);
+	printf("%-28s %12s %12s\n", "Call site", "Direct", "Macro");
+	//a FINE message composed using to_string and concatenation
+	start = chrono::steady_clock::now();
+	for (int i = 0; i < calls; i++)
+		plog->fine("Epoch " + to_string((long double) (i * 0.5)) + " sats=" + to_string((long long) (i & 15)));
+	tDirect = nsPerCall(start, calls);
+	start = chrono::steady_clock::now();
+	for (int i = 0; i < calls; i++)
+		LOG_FINE(plog, "Epoch " + to_string((long double) (i * 0.5)) + " sats=" + to_string((long long) (i & 15)));
+	tMacro = nsPerCall(start, calls);
+	printf("%-28s %12.1f %12.1f\n", "fine(to_string + concat)", tDirect, tMacro);
+	//a FINER message composed using sprintf
+	start = chrono::steady_clock::now();
+	for (int i = 0; i < calls; i++) {
+		sprintf(msgBuf, "MID8 GPS ch=%d sv=%d subfrm=%d page=%d", i & 15, i & 31, i % 5 + 1, i & 63);
+		plog->finer(string(msgBuf));
+	}
+	tDirect = nsPerCall(start, calls);
+	start = chrono::steady_clock::now();
+	for (int i = 0; i < calls; i++) {
+		if (plog->isLevel(Logger::FINER)) {
+			sprintf(msgBuf, "MID8 GPS ch=%d sv=%d subfrm=%d page=%d", i & 15, i & 31, i % 5 + 1, i & 63);
+			plog->finer(string(msgBuf));
+		}
+	}
+	tMacro = nsPerCall(start, calls);
+	printf("%-28s %12.1f %12.1f\n", "finer(sprintf)", tDirect, tMacro);
+	//a FINEST message with constant text
+	start = chrono::steady_clock::now();
+	for (int i = 0; i < calls; i++) plog->finest("Nav epoch for sys=G");
+	tDirect = nsPerCall(start, calls);
+	start = chrono::steady_clock::now();
+	for (int i = 0; i < calls; i++) LOG_FINEST(plog, "Nav epoch for sys=G");
+	tMacro = nsPerCall(start, calls);
+	printf("%-28s %12.1f %12.1f\n", "finest(constant text)", tDirect, tMacro);
+	return 0;
+}
+
+/**nsPerCall gives the time per call elapsed since the given time point.
+ *
+ *@param start the time point
+ *@param calls the number of calls made since the time point
+ *@return the nanoseconds elapsed per call
+ */
+double nsPerCall(chrono::steady_clock::time_point start, int calls) {
+	return chrono::duration<double, nano>(chrono::steady_clock::now() - start).count() / calls;
+}
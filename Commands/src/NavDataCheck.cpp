@@ -0,0 +1,336 @@
+/** @file NavDataCheck.cpp
+ * Contains the command line program to check the GPS navigation data acquired from an OSP data file against a reference RINEX navigation file.
+ *<p>Usage:
+ *<p>NavDataCheck.exe {options} [OSPfilename]
+ *<p>GPS ephemeris are acquired from MID15 messages in the OSP file as OSPtoRINEX does, in the acquisition mode stated in options,
+ *and printed into a temporary RINEX navigation file of the version stated. The ephemeris printed are compared with the ones in the
+ *reference file, usually the navigation file generated by a previous version of OSPtoRINEX from the same OSP file:
+ *	- For V2.10, the ephemeris records (the lines after the header) are compared line by line.
+ *	- For V3.02, the epoch lines printed shall follow the RINEX 3 layout (seconds as I2.2 and SV clock data from column 24),
+ *	  and the ephemeris printed and the reference ones are read back using RinexData and compared. This way a reference
+ *	  printed with F4.1 seconds, as previous versions of OSPtoRINEX did, can be used.
+ *<p>The differences found, including the transmission time of ephemeris, are given to stdout.
+ *<p>Options are:
+ *	- -f THREADS or --threads=THREADS : Number of threads used to decode OSP messages in parallel (not in single pass). Default value THREADS = 1
+ *	- -g or --onepass : Acquire header and epoch data in a single pass over the OSP file. Default value FALSE
+ *	- -h or --help : Show usage data and stops. Default value HELP=FALSE
+ *	- -l LOGLEVEL or --llevel=LOGLEVEL : Maximum level to log (SEVERE, WARNING, INFO, CONFIG, FINE, FINER, FINEST). Default value LOGLEVEL = WARNING
+ *	- -r REFNAV or --refnav=REFNAV : Reference RINEX navigation file. Default value: the one in Data/GStarIV/LRZ01 for the version
+ *	  (PNT1011m00.14N for V210, PNT100---_R_20140111200_00U_GN.rnx for V302)
+ *	- -v VER or --ver=VER : RINEX version to print (V210, V302). Default value VER = V210
+ *Default value for operator is: Data/GStarIV/LRZ01/20140111_131833.OSP
+ *<p>
+ *Copyright 2015 Francisco Cancillo
+ *<p>
+ *This file is part of the RXtoRINEX tool.
+ *<p>
+ *RXtoRINEX is free software: you can redistribute it and/or modify it under the terms of the GNU General Public License
+ *as published by the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+ *RXtoRINEX is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ *warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *See the GNU General Public License for more details.
+ *A copy of the GNU General Public License can be found at <http://www.gnu.org/licenses/>.
+ *
+ *Ver.	|Date	|Reason for change
+ *------+-------+------------------
+ *V1.0	|10/2026	|First release
+ */
+#include <stdio.h>
+#include <string.h>
+#include <ctype.h>
+
+//from CommonClasses
+#include "ArgParser.h"
+#include "Logger.h"
+#include "Utilities.h"
+#include "RinexData.h"
+#include "GNSSdataFromOSP.h"
+
+using namespace std;
+
+//@cond DUMMY
+///Program name
+const string THISPRG = "NavDataCheck";
+///The command line format
+const string CMDLINE = THISPRG + ".exe {options} [OSPfilename]";
+///Current program version
+const string MYVER = " V1.0 ";
+///Message when a file cannot be opened
+const string FILENOK = "Cannot open or create file ";
+///The receiver name
+const string RECEIVER_NAME = "SiRF";
+//The parser object to store options and operators passed in the comman line
+ArgParser parser;
+//Metavariables for options
+int HELP, LOGLEVEL, ONEPASS, REFNAV, THREADS, VER;
+//Metavariables for operators
+int OSPF;
+//@endcond
+
+//@cond DUMMY
+//functions in this file
+bool acqNavData(FILE*, RinexData &, Logger*);
+bool skipHeader(FILE*);
+int compareRecords(FILE*, FILE*);
+int checkV3Layout(FILE*);
+int compareEphemeris(FILE*, FILE*, Logger*);
+char* trimRight(char*);
+//@endcond
+
+/**main
+ * gets the command line arguments, acquires GPS navigation data from the OSP file, and compares the navigation records printed with the reference file.
+ *
+ *@param argc the number of arguments passed from the command line
+ *@param argv the array of arguments passed from the command line
+ *@return  the exit status according to the following values and meaning::
+ *		- (0) navigation records are the same as in the reference file
+ *		- (1) an error has been detected in arguments
+ *		- (2) error when opening the input files or creating the temporary one
+ *		- (3) navigation records differ from the reference file, or cannot be printed
+ */
+int main(int argc, char* argv[]) {
+	/**The main process sequence follows:*/
+	/// 1- Defines and sets the error logger object
+	Logger log("LogFile.txt", string(), string(argv[0]) + MYVER + string(" START"));
+	/// 2- Setups the valid options in the command line. They will be used by the argument/option parser
+	VER = parser.addOption("-v", "--ver", "VER", "RINEX version to print (V210, V302)", "V210");
+	REFNAV = parser.addOption("-r", "--refnav", "REFNAV", "Reference RINEX navigation file (default: the one in Data/GStarIV/LRZ01 for the version)", "");
+	LOGLEVEL = parser.addOption("-l", "--llevel", "LOGLEVEL", "Maximum level to log (SEVERE, WARNING, INFO, CONFIG, FINE, FINER, FINEST)", "WARNING");
+	HELP = parser.addOption("-h", "--help", "HELP", "Show usage data and stops", false);
+	ONEPASS = parser.addOption("-g", "--onepass", "ONEPASS", "Acquire header and epoch data in a single pass over the OSP file", false);
+	THREADS = parser.addOption("-f", "--threads", "THREADS", "Number of threads used to decode OSP messages in parallel", "1");
+	/// 3- Setups the default values for operators in the command line
+	OSPF = parser.addOperator("Data/GStarIV/LRZ01/20140111_131833.OSP");
+	/// 4- Parses arguments in the command line extracting options and operators
+	try {
+		parser.parseArgs(argc, argv);
+	}  catch (string error) {
+		parser.usage("Argument error: " + error, CMDLINE);
+		log.severe(error);
+		return 1;
+	}
+	log.info(parser.showOptValues());
+	log.info(parser.showOpeValues());
+	if (parser.getBoolOpt(HELP)) {
+		//help info has been requested
+		parser.usage("Checks GPS navigation data acquired from an OSP file against a reference RINEX navigation file", CMDLINE);
+		return 0;
+	}
+	/// 5- Sets logging level stated in option
+	log.setLevel(parser.getStrOpt(LOGLEVEL));
+	/// 6- Checks the version, and opens the OSP file, the reference file, and the temporary file where navigation data are printed
+	FILE* inFile;
+	FILE* refFile;
+	FILE* navFile;
+	string fileName = parser.getOperator(OSPF);
+	if ((inFile = fopen(fileName.c_str(), "rb")) == NULL) {
+		log.severe(FILENOK + fileName);
+		return 2;
+	}
+	RinexData::RINEXversion version;
+	if (parser.getStrOpt(VER).compare("V210") == 0) version = RinexData::V210;
+	else if (parser.getStrOpt(VER).compare("V302") == 0) version = RinexData::V302;
+	else {
+		log.severe("Unknown RINEX version " + parser.getStrOpt(VER));
+		fclose(inFile);
+		return 1;
+	}
+	fileName = parser.getStrOpt(REFNAV);
+	if (fileName.empty()) fileName = version == RinexData::V210? "Data/GStarIV/LRZ01/PNT1011m00.14N" : "Data/GStarIV/LRZ01/PNT100---_R_20140111200_00U_GN.rnx";
+	if ((refFile = fopen(fileName.c_str(), "r")) == NULL) {
+		log.severe(FILENOK + fileName);
+		fclose(inFile);
+		return 2;
+	}
+	if ((navFile = tmpfile()) == NULL) {
+		log.severe("Cannot create temporary file for navigation data");
+		fclose(refFile);
+		fclose(inFile);
+		return 2;
+	}
+	/// 7- Acquires navigation data, prints them into the temporary file, and compares them with the reference ones
+	int exitCode = 3;
+	RinexData rinex(version, &log);
+	if (acqNavData(inFile, rinex, &log)) {
+		try {
+			rinex.printNavHeader(navFile);
+			rinex.printNavEpoch(navFile);
+			rewind(navFile);
+			int n = -1;
+			if (version == RinexData::V210) {
+				if (skipHeader(navFile) && skipHeader(refFile)) n = compareRecords(navFile, refFile);
+				else log.severe("END OF HEADER not found");
+			} else {
+				if (skipHeader(navFile)) n = checkV3Layout(navFile);
+				else log.severe("END OF HEADER not found");
+				if (n >= 0) n += compareEphemeris(navFile, refFile, &log);
+			}
+			if (n >= 0) printf("%s navigation data compared: %s\n", parser.getOperator(OSPF).c_str(), n == 0? "OK" : "DIFFERENT");
+			if (n == 0) exitCode = 0;
+		} catch (string error) {
+			log.severe(error);
+		}
+	}
+	fclose(navFile);
+	fclose(refFile);
+	fclose(inFile);
+	return exitCode;
+}
+
+/**acqNavData acquires the GPS navigation data in the OSP file as OSPtoRINEX does, using the acquisition mode stated in options.
+ *Observation data acquired are discarded.
+ *
+ *@param inFile the OSP file
+ *@param rinex the RinexData object where navigation data are saved
+ *@param plog a pointer to the Logger object where logging messages will be printed
+ *@return true if data have been acquired, false otherwise
+ */
+bool acqNavData(FILE* inFile, RinexData &rinex, Logger* plog) {
+	vector<string> selSys(1, string("G"));
+	vector<string> selObs;
+	try {
+		rinex.setHdLnData(RinexData::RUNBY, THISPRG + MYVER, string("RUNBY"));
+		rinex.setHdLnData(RinexData::TOBS, 'G', getTokens("C1C,L1C,D1C,S1C", ','));
+		rinex.setFilter(selSys, selObs);
+		GNSSdataFromOSP gnssAcq(RECEIVER_NAME, 4, true, inFile, plog);
+		gnssAcq.setDecodeThreads(stoi(parser.getStrOpt(THREADS)));
+		if (parser.getBoolOpt(ONEPASS)) {
+			rinex.prepareObsHeader();
+			gnssAcq.setSinglePass(rinex);
+			while (gnssAcq.acqEpochData(rinex, false, false)) rinex.clearObsData();
+			gnssAcq.endSinglePass(rinex);
+		} else {
+			gnssAcq.acqHeaderData(rinex);
+			gnssAcq.rewind();
+			while (gnssAcq.acqEpochData(rinex, false, false)) rinex.clearObsData();
+		}
+	} catch (string error) {
+		plog->severe(error);
+		return false;
+	}
+	return true;
+}
+
+/**skipHeader reads lines from the given RINEX file until the END OF HEADER one.
+ *
+ *@param file the RINEX file
+ *@return true if the END OF HEADER line has been read, false otherwise
+ */
+bool skipHeader(FILE* file) {
+	char line[100];
+	while (fgets(line, sizeof line, file) != NULL)
+		if (strstr(line, "END OF HEADER") != NULL) return true;
+	return false;
+}
+
+/**compareRecords compares line by line the records in the navigation file printed with the ones in the reference file,
+ *and prints to stdout the differences found, ignoring trailing blanks.
+ *
+ *@param navFile the navigation file printed, positioned after its header
+ *@param refFile the reference navigation file, positioned after its header
+ *@return the number of lines which differ
+ */
+int compareRecords(FILE* navFile, FILE* refFile) {
+	char navLine[100], refLine[100];
+	int lineNum = 0, diffs = 0;
+	bool navEOF, refEOF;
+	for (;;) {
+		navEOF = fgets(navLine, sizeof navLine, navFile) == NULL;
+		refEOF = fgets(refLine, sizeof refLine, refFile) == NULL;
+		if (navEOF || refEOF) break;
+		lineNum++;
+		if (strcmp(trimRight(navLine), trimRight(refLine)) != 0) {
+			printf("Record %d differs:\n acquired : %s\n reference: %s\n", lineNum, navLine, refLine);
+			diffs++;
+		}
+	}
+	if (navEOF != refEOF) {
+		printf("Record %d: %s has more records\n", lineNum + 1, navEOF? "reference" : "acquired");
+		diffs++;
+	}
+	return diffs;
+}
+
+/**checkV3Layout checks that the epoch lines in the navigation file printed follow the RINEX 3 layout: epoch time fields as I2.2
+ *(the seconds ending in column 23), followed by the SV clock data, and prints to stdout the lines not following it.
+ *
+ *@param navFile the V3.02 navigation file printed, positioned after its header
+ *@return the number of epoch lines with a wrong layout
+ */
+int checkV3Layout(FILE* navFile) {
+	const char* layout = "Ann nnnn nn nn nn nn nn";	//A1,I2.2,1X,I4,5(1X,I2.2): A is the system, n a digit
+	char line[100];
+	int lineNum = 0, diffs = 0;
+	while (fgets(line, sizeof line, navFile) != NULL) {
+		lineNum++;
+		if (line[0] == ' ') continue;	//a broadcast orbit line
+		trimRight(line);
+		bool ok = strlen(line) == 80;
+		for (int pos = 1; ok && (layout[pos] != 0); pos++)
+			ok = layout[pos] == 'n'? isdigit(line[pos]) != 0 : line[pos] == layout[pos];
+		//the SV clock bias (D19.12) follows
+		if (ok) ok = ((line[23] == ' ') || (line[23] == '-')) && isdigit(line[24]);
+		if (!ok) {
+			printf("Record %d is not a RINEX 3 epoch line: %s\n", lineNum, line);
+			diffs++;
+		}
+	}
+	return diffs;
+}
+
+/**compareEphemeris reads the ephemeris in the navigation file printed and in the reference file, and compares their data,
+ *printing to stdout the differences found.
+ *
+ *@param navFile the navigation file printed
+ *@param refFile the reference navigation file
+ *@param plog a pointer to the Logger object where logging messages will be printed
+ *@return the number of ephemeris which differ
+ */
+int compareEphemeris(FILE* navFile, FILE* refFile, Logger* plog) {
+	RinexData navData(RinexData::VTBD, plog);
+	RinexData refData(RinexData::VTBD, plog);
+	char navSys, refSys;
+	int navSat, refSat, navStat, refStat;
+	double navBo[8][4], refBo[8][4], navTag, refTag;
+	int ephNum = 0, diffs = 0;
+	rewind(navFile);
+	rewind(refFile);
+	navData.readRinexHeader(navFile);
+	refData.readRinexHeader(refFile);
+	for (;;) {
+		navStat = navData.readNavEpoch(navFile);
+		refStat = refData.readNavEpoch(refFile);
+		if ((navStat == 0) || (refStat == 0)) break;
+		ephNum++;
+		if ((navStat > 2) || (refStat > 2)) {
+			printf("Ephemeris %d cannot be read: status %d acquired, %d reference\n", ephNum, navStat, refStat);
+			diffs++;
+			continue;
+		}
+		navData.getNavData(navSys, navSat, navBo, navTag);
+		refData.getNavData(refSys, refSat, refBo, refTag);
+		bool same = (navSys == refSys) && (navSat == refSat) && (navTag == refTag);
+		for (int i = 0; same && (i < 8); i++)
+			for (int j = 0; same && (j < 4); j++) same = navBo[i][j] == refBo[i][j];
+		if (!same) {
+			printf("Ephemeris %d differs: %c%02d at %.0f acquired, %c%02d at %.0f reference\n", ephNum, navSys, navSat, navTag, refSys, refSat, refTag);
+			diffs++;
+		}
+	}
+	if (navStat != refStat) {
+		printf("Ephemeris %d: %s has more ephemeris\n", ephNum + 1, navStat == 0? "reference" : "acquired");
+		diffs++;
+	}
+	return diffs;
+}
+
+/**trimRight removes the trailing blanks and end of line characters of the given line.
+ *
+ *@param line the line to trim
+ *@return the line trimmed
+ */
+char* trimRight(char* line) {
+	size_t n = strlen(line);
+	while ((n > 0) && ((line[n-1] == ' ') || (line[n-1] == '\n') || (line[n-1] == '\r'))) line[--n] = 0;
+	return line;
+}
@@ -7,6 +7,10 @@
  *	- -b or --bias : Apply receiver clock bias to measurements and time. Default value TRUE
  *	- -c or --glo50bps : Use MID8 GLONASS 50bps data to generate GLONASS navigation file, instead of MID70. Default value FALSE
  *	- -d or --gps50bps : Use MID8 GPS 50bps data to generate nav file, instead of MID15. Default value FALSE
+ *	- -e MINELEV or --minelev=MINELEV : Minimum elevation in degrees of satellites whose observations are acquired. Default value: no elevation mask
+ *	- -f THREADS or --threads=THREADS : Number of threads used to decode OSP messages in parallel when acquiring epochs (not in single pass).
+ *	  Default value THREADS = 1 (messages decoded sequentially)
+ *	- -g or --onepass : Acquire header and epoch data in a single pass over the OSP file. Header is printed at the end. Default value FALSE
  *	- -h or --help : Show usage data and stops. Default value HELP=FALSE
  *	- -i MINSV or --minsv=MINSV : Minimun satellites in a fix to acquire observations. Default value MINSV = 4
  *	- -j ANTN or --antnum=ANTN : Receiver antenna number. Default value ANTN = Antenna#
@@ -19,9 +23,15 @@
  *	- -q RUNBY or --runby=RUNBY : Who runs the RINEX file generator. Default value RUNBY = RUNBY
  *	- -r RINEX or --rinex=RINEX : RINEX file name prefix. Default value RINEX = PNT1
  *	- -s SYSLST or --selsys=SYSLST : List of additional systems to GPS (R or S or R,S) to be included in the RINEX files. Default value an empty list
+ *	- -t or --prthread : Print observation epochs by a separate thread while next epochs are acquired. Default value: epochs printed sequentially
  *	- -u MRKNUM or --mrknum=MRKNUM : Marker number. Default value MRKNUM = MRKNUM
  *	- -v VER or --ver=VER : RINEX version to generate (V210, V300). Default value VER = V210
+ *	- -w HDSATS or --hdsats=HDSATS : Patch the observation file header with the INTERVAL, TIME OF LAST OBS, # OF SATELLITES and PRN / # OF OBS
+ *	  records computed from the epochs printed, reserving PRN / # OF OBS lines for up to HDSATS satellites. Default value HDSATS = 0 (no patching)
+ *	- -x or --index : Use a message index file (the input file name with .idx appended) to read only the messages needed in each pass.
+ *	  The index is built and saved if it does not exist or is outdated. Default value: index not used
  *	- -y AGENCY or --agency=AGENCY : Agency name. Default value AGENCY = AGENCY
+ *	- -z MINSNR or --minsnr=MINSNR : Minimum signal to noise ratio (S1C, dB-Hz) of satellites whose observations are acquired. Default value: no SNR mask
  *Default value for operator is: DATA.OSP 
  *<p>
  *Copyright 2015 Francisco Cancillo
@@ -70,11 +80,13 @@ const string RECEIVER_NAME = "SiRF";
 //The parser object to store options and operators passed in the comman line
 ArgParser parser;
 //Metavariables for options
-int AGENCY, APPEND, ANTN, ANTT, APBIAS, MID8G, MID8R, HELP, LOGLEVEL, NAVI, MINSV, MRKNAM, MRKNUM, OBSERVER, PGM, RINEX, RUNBY, SELSYS, TOFO, VER;
+int AGENCY, APPEND, ANTN, ANTT, APBIAS, THREADS, MID8G, MID8R, HDSATS, HELP, INDEX, LOGLEVEL, NAVI, MINELEV, MINSNR, MINSV, MRKNAM, MRKNUM, OBSERVER, ONEPASS, PGM, PRTTHR, RINEX, RUNBY, SELSYS, TOFO, VER;
 //Metavariables for operators
 int OSPF;
 //functions in this file
 int generateRINEX(FILE*, Logger*);
+int printObsSinglePass(GNSSdataFromOSP &, RinexData &, Logger*);
+void endPrinting(RinexData &, Logger*);
 void prinfNavFile(RinexData &, RinexData::RINEXversion, char, Logger*);
 //@endcond 
 /**main
@@ -98,9 +110,13 @@ int main(int argc, char* argv[]) {
 	/// 1- Defines and sets the error logger object
 	Logger log("LogFile.txt", string(), string(argv[0]) + MYVER + COMPDATE + string(" START"));
 	/// 2- Setups the valid options in the command line. They will be used by the argument/option parser
+	MINSNR = parser.addOption("-z", "--minsnr", "MINSNR", "Minimum signal to noise ratio (S1C, dB-Hz) of satellites whose observations are acquired", "");
 	AGENCY = parser.addOption("-y", "--agency", "AGENCY", "Agency name", "AGENCY");
+	INDEX = parser.addOption("-x", "--index", "INDEX", "Use a message index file (input file name + .idx) to read only the messages needed", false);
+	HDSATS = parser.addOption("-w", "--hdsats", "HDSATS", "Patch observation header records computed from epochs, reserving PRN / # OF OBS lines for up to HDSATS satellites", "0");
 	VER = parser.addOption("-v", "--ver", "VER", "RINEX version to generate (V210, V302)", "V210");
 	MRKNUM = parser.addOption("-u", "--mrknum", "MRKNUM", "Marker number", "MRKNUM");
+	PRTTHR = parser.addOption("-t", "--prthread", "PRTTHR", "Print observation epochs by a separate thread while next epochs are acquired", false);
 	SELSYS = parser.addOption("-s", "--selsys", "SELSYS", "Systems from input in addition to GPS (R,S or R or S)", "");
 	RINEX = parser.addOption("-r", "--rinex", "RINEX", "RINEX file name prefix", "PNT1");
 	RUNBY = parser.addOption("-q", "--runby", "RUNBY", "Who runs the RINEX file generation", "RUNBY");
@@ -113,6 +129,9 @@ int main(int argc, char* argv[]) {
 	ANTN = parser.addOption("-j", "--antnum", "ANTN", "Receiver antenna number", "Antenna#");
 	MINSV = parser.addOption("-i", "--minsv", "MINSV", "Minimun satellites in a fix to acquire observations", "4");
 	HELP = parser.addOption("-h", "--help", "HELP", "Show usage data and stops", false);
+	ONEPASS = parser.addOption("-g", "--onepass", "ONEPASS", "Acquire header and epoch data in a single pass over the OSP file", false);
+	THREADS = parser.addOption("-f", "--threads", "THREADS", "Number of threads used to decode OSP messages in parallel", "1");
+	MINELEV = parser.addOption("-e", "--minelev", "MINELEV", "Minimum elevation (degrees) of satellites whose observations are acquired", "");
 	MID8G = parser.addOption("-d", "--gps50bps", "MID8G", "Use MID8 GPS 50bps data to generate nav file", false);
 	MID8R = parser.addOption("-c", "--glo50bps", "MID8R", "Use MID8 GLONASS 50bps data to generate nav file", false);
 	APBIAS = parser.addOption("-b", "--bias", "APBIAS", "Apply receiver clock bias to measurements (and time)", true);
@@ -188,36 +207,61 @@ int generateRINEX(FILE* inFile, Logger* plog) {
 			if (it->at(0) == 'R') glonassSel = true;
 		}
 		if (!rinex.setFilter(selSys, selObs)) plog->warning("Error in selected systems. Erroneous data ignored");
+		//elevations are computed using the ephemerides acquired from the OSP file up to each epoch
+		double aDouble;
+		aStr = parser.getStrOpt(MINELEV);
+		if (!aStr.empty()) {
+			if (sscanf(aStr.c_str(), "%lf", &aDouble) == 1) rinex.setElevationMask(aDouble);
+			else plog->warning("Wrong elevation mask. Ignored");
+		}
+		aStr = parser.getStrOpt(MINSNR);
+		if (!aStr.empty()) {
+			if (sscanf(aStr.c_str(), "%lf", &aDouble) == 1) rinex.setSnrMask(aDouble);
+			else plog->warning("Wrong signal to noise ratio mask. Ignored");
+		}
+		rinex.setPrintThread(parser.getBoolOpt(PRTTHR));
 	} catch (string error) {
 			plog->severe(error);
 	}
 	/// 2- Setups the GNSSdataFromOSP object used to extract message data from the OSP file
 	GNSSdataFromOSP gnssAcq(RECEIVER_NAME, stoi(parser.getStrOpt(MINSV)), parser.getBoolOpt(APBIAS), inFile, plog);
-	/// 3- Starts data acquisition extracting RINEX header data located in the binary file
-	if(!gnssAcq.acqHeaderData(rinex)) {
-		plog->warning("All, or some header data not acquired");
-	};
-	if (glonassSel) gnssAcq.acqGLOparams();
-	/// 4- For the observation RINEX file, generate the filename in standard format, create it, print header,
-	outFileName = rinex.getObsFileName(parser.getStrOpt(RINEX));
-	if ((obsFile = fopen(outFileName.c_str(), "w")) == NULL) {
-		plog->severe(FILENOK + outFileName);
-		return 0;
-	}
-	try {
-		rinex.printObsHeader(obsFile);
-	/// and iterate over the binary OSP file extracting epoch by epoch data and printing them
-		epochCount = 0;
-		rewind(inFile);
-		while (gnssAcq.acqEpochData(rinex, parser.getBoolOpt(MID8G), parser.getBoolOpt(MID8R))) {
-			rinex.printObsEpoch(obsFile);
-			epochCount++;
+	if (parser.getBoolOpt(INDEX)) gnssAcq.setIndex(parser.getOperator(OSPF) + ".idx");
+	gnssAcq.setDecodeThreads(stoi(parser.getStrOpt(THREADS)));
+	/// 3- If single pass acquisition is requested, acquire header and epoch data reading once the binary file, and print the observation file
+	if (parser.getBoolOpt(ONEPASS)) {
+		if ((epochCount = printObsSinglePass(gnssAcq, rinex, plog)) < 0) return 0;
+	} else {
+		///Otherwise, starts data acquisition extracting RINEX header data located in the binary file
+		if(!gnssAcq.acqHeaderData(rinex)) {
+			plog->warning("All, or some header data not acquired");
+		};
+		if (glonassSel) gnssAcq.acqGLOparams();
+		/// 4- For the observation RINEX file, generate the filename in standard format, create it, print header,
+		outFileName = rinex.getObsFileName(parser.getStrOpt(RINEX));
+		if ((obsFile = fopen(outFileName.c_str(), "w")) == NULL) {
+			plog->severe(FILENOK + outFileName);
+			return 0;
 		}
-		if (parser.getBoolOpt(APPEND)) rinex.printObsEOF(obsFile);
-	} catch (string error) {
-		plog->severe(error);
+		try {
+			rinex.setHeaderPatch(stoi(parser.getStrOpt(HDSATS)));
+			rinex.printObsHeader(obsFile);
+		/// and iterate over the binary OSP file extracting epoch by epoch data and printing them
+			epochCount = 0;
+			gnssAcq.rewind();
+			while (gnssAcq.acqEpochData(rinex, parser.getBoolOpt(MID8G), parser.getBoolOpt(MID8R))) {
+				rinex.printObsEpoch(obsFile);
+				epochCount++;
+			}
+			rinex.endPrintThread();
+			if (parser.getBoolOpt(APPEND)) rinex.printObsEOF(obsFile);
+		/// and patch the header records reserved with data from epochs printed, if requested
+			rinex.patchObsHeader(obsFile);
+		} catch (string error) {
+			plog->severe(error);
+		}
+		endPrinting(rinex, plog);
+		fclose(obsFile);
 	}
-	fclose(obsFile);
 	/// 5- If navigation RINEX file requested, generate the filename in standard format, create it, print header,
 	if (prtNav) {
 		if (rinexVer == RinexData::V302) {
@@ -232,6 +276,81 @@ int generateRINEX(FILE* inFile, Logger* plog) {
 	return epochCount;
 }
 
+/**printObsSinglePass acquires header and epoch data reading once the input OSP file, and prints the RINEX observation file.
+ *As header data are not complete until the end of the OSP file, epochs are printed into a temporary file while data are acquired.
+ *At the end, the observation file is created using the standard file name from header data acquired, the header is printed,
+ *and the epochs are copied from the temporary file.
+ *When header patching is requested, statistics of the epochs are accumulated while printing them into the temporary file,
+ *and the records computed from them are patched after copying the epochs.
+ *
+ *@param gnssAcq the GNSSdataFromOSP object used to extract message data from the OSP file
+ *@param rinex is the RinexData object where acquired data are stored
+ *@param plog a pointer to the Logger object where logging messages will be printed
+ *@return the number of epochs read in the OSP file, or -1 if the output files cannot be created
+ */
+int printObsSinglePass(GNSSdataFromOSP &gnssAcq, RinexData &rinex, Logger* plog) {
+	int epochCount = 0;	//to count the number of epochs processed
+	string outFileName;	//the output file name for RINEX observation file
+	FILE* obsFile;		//the file where RINEX observation data will be printed
+	FILE* epochFile;	//the temporary file where RINEX observation epochs will be printed
+	char buffer[8192];	//a buffer to copy epochs
+	size_t n;
+	if ((epochFile = tmpfile()) == NULL) {
+		plog->severe("Cannot create temporary file for observation epochs");
+		return -1;
+	}
+	try {
+		rinex.prepareObsHeader();
+		rinex.setHeaderPatch(stoi(parser.getStrOpt(HDSATS)));
+		gnssAcq.setSinglePass(rinex);
+		while (gnssAcq.acqEpochData(rinex, parser.getBoolOpt(MID8G), parser.getBoolOpt(MID8R))) {
+			rinex.printObsEpoch(epochFile);
+			epochCount++;
+		}
+		if (!gnssAcq.endSinglePass(rinex)) plog->warning("All, or some header data not acquired");
+	} catch (string error) {
+		plog->severe(error);
+	}
+	//generate the filename in standard format, create it, print header, copy epochs, and print the end of file when requested
+	//note that printing the end of file clears header data
+	outFileName = rinex.getObsFileName(parser.getStrOpt(RINEX));
+	if ((obsFile = fopen(outFileName.c_str(), "w")) == NULL) {
+		plog->severe(FILENOK + outFileName);
+		endPrinting(rinex, plog);
+		fclose(epochFile);
+		return -1;
+	}
+	try {
+		rinex.endPrintThread();
+		rinex.printObsHeader(obsFile);
+		rewind(epochFile);
+		while ((n = fread(buffer, 1, sizeof buffer, epochFile)) > 0) fwrite(buffer, 1, n, obsFile);
+		if (parser.getBoolOpt(APPEND)) rinex.printObsEOF(obsFile);
+		rinex.patchObsHeader(obsFile);
+	} catch (string error) {
+		plog->severe(error);
+	}
+	endPrinting(rinex, plog);
+	fclose(epochFile);
+	fclose(obsFile);
+	return epochCount;
+}
+
+/**endPrinting waits until the observation epochs handed to the printing thread, if any, have been printed, logging printing errors.
+ *It shall be called before closing the file where epochs are printed, also when epoch acquisition or printing has been
+ *interrupted by an error, to avoid the printing thread using the file after it is closed.
+ *
+ *@param rinex is the RinexData object printing epochs
+ *@param plog a pointer to the Logger object where logging messages will be printed
+ */
+void endPrinting(RinexData &rinex, Logger* plog) {
+	try {
+		rinex.endPrintThread();
+	} catch (string error) {
+		plog->severe(error);
+	}
+}
+
 /**prinfNavFile prints a RINEX navigation file from the navigation data stored stored in the given RinexData object.
  *File format will be according the given version, and for the given satellite system if version to be generated is 2.10.
  *
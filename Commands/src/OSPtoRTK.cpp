@@ -7,6 +7,8 @@
  *	- -h or --help : Show usage data. Default value HELP=FALSE
  *	- -l LOGLEVEL or --llevel=LOGLEVEL : Maximum level to log (SEVERE, WARNING, INFO, CONFIG, FINE, FINER, FINEST). Default value LOGLEVEL = INFO
  *	- -m MINSV or --minsv=MINSV : Minimum satellites in a fix to acquire solution data. Default value MINSV = 4
+ *	- -x or --index : Use a message index file (the input file name with .idx appended) to read only the messages needed in each pass.
+ *	  The index is built and saved if it does not exist or is outdated. Default value: index not used
  * Default values for operators are: DATA.OSP 
  *<p>
  *Copyright 2015 Francisco Cancillo
@@ -44,7 +46,7 @@ const string RECEIVER_NAME = "SiRF";
 ///The parser object to store options and operators passed in the comman line
 ArgParser parser;
 //Metavariables for options
-int HELP, LOGLEVEL, MINSV;
+int HELP, INDEX, LOGLEVEL, MINSV;
 //Metavariables for operators
 int OSPF;
 //@endcond 
@@ -69,6 +71,7 @@ int main(int argc, char** argv) {
 	/// 1- Defines and sets the error logger object
 	Logger log("LogFile.txt", string(), string(argv[0]) + MYVER + string(" START"));
 	/// 2- Setups the valid options in the command line. They will be used by the argument/option parser
+	INDEX = parser.addOption("-x", "--index", "INDEX", "Use a message index file (input file name + .idx) to read only the messages needed", false);
 	MINSV = parser.addOption("-m", "--minsv", "MINSV", "Minimun satellites in a fix to acquire observations", "4");
 	LOGLEVEL = parser.addOption("-l", "--llevel", "LOGLEVEL", "Maximum level to log (SEVERE, WARNING, INFO, CONFIG, FINE, FINER, FINEST)", "INFO");
 	HELP = parser.addOption("-h", "--help", "HELP", "Show usage data", false);
@@ -126,6 +129,7 @@ void generateRTKobs(FILE* inFile, FILE* rtkFile, string inFileName, string prgNa
 	int nEpochs = 0;		//to count the number of epochs processed
 	/// 1- Setups the GNSSdataFromOSP object used to extract data from the binary file
 	GNSSdataFromOSP gnssAcq(RECEIVER_NAME, stoi(parser.getStrOpt(MINSV)), true, inFile, plog);
+	if (parser.getBoolOpt(INDEX)) gnssAcq.setIndex(parser.getOperator(OSPF) + ".idx");
 	/// 2- Setups the RTKobservation object where extracted RTK data from the binary file will be placed 
 	RTKobservation rtko(prgName, inFileName);
 	/// 3- Acquire RTK header data located in the binary input file
@@ -134,7 +138,7 @@ void generateRTKobs(FILE* inFile, FILE* rtkFile, string inFileName, string prgNa
 	}
 	/// 4- Prints RTK file header
 	rtko.printHeader(rtkFile);
-	rewind(inFile);
+	gnssAcq.rewind();
 	/// 6- Iterates over the binary OSP file extracting epoch by epoch solution data and printing them
 	while (gnssAcq.acqEpochData(rtko)) {
 		rtko.printSolution(rtkFile);
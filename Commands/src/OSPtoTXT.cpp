@@ -4,8 +4,15 @@
  *Usage:
  *<p>OSPtoTXT.exe {options} [OSPfileName]
  *<p>Options are:
+ *	- -f FROMT or --fromtime=FROMT : Print messages from the given date and time (comma separated yyyy,mm,dd,hh,mm,sec). The message index is used to locate them.
+ *	  Default value: 1st message in the input file
  *	- -h or --help : Show usage data. Default value HELP=FALSE
  *	- -l LOGLEVEL or --llevel=LOGLEVEL : Maximum level to log (SEVERE, WARNING, INFO, CONFIG, FINE, FINER, FINEST). Default value LOGLEVEL = INFO
+ *	- -m MIDLST or --mids=MIDLST : Print only messages having MIDs in the given comma separated list. Default value: all messages
+ *	- -t TOT or --totime=TOT : Print messages before the given date and time (comma separated yyyy,mm,dd,hh,mm,sec). The message index is used to locate them.
+ *	  Default value: last message in the input file
+ *	- -x or --index : Use a message index file (the input file name with .idx appended) to read only the messages selected.
+ *	  The index is built and saved if it does not exist or is outdated. Default value: index not used, unless FROMT or TOT are given
  *Default values for operators are: DATA.OSP 
  *<p>
  *Copyright 2015 Francisco Cancillo
@@ -23,11 +30,16 @@
  *------+-------+------------------
  *V1.0	|2/2015	|First release
  *V1.1	|2/2016	|Minor changes to improve logging
+ *V1.2	|10/2026	|Added message selection by MID and time using message index files
+ *V1.3	|10/2026	|Message data printed using the message layouts in OSPDecoder
  */
 
+#include <string.h>
+
 //from CommonClasses
 #include "ArgParser.h"
 #include "Logger.h"
+#include "OSPDecoder.h"
 #include "OSPMessage.h"
 #include "Utilities.h"
 
@@ -37,16 +49,16 @@ using namespace std;
 ///The command line format
 const string CMDLINE = "OSPtoTXT.exe {options} [OSPfileName]";
 ///The current version of this program
-const string MYVER = " V1.1";
+const string MYVER = " V1.3";
 ///The parser object to store options and operators passed in the command line
 ArgParser parser;
 //Metavariables for options
-int HELP, LOGLEVEL;	//the metavariables for the command line options 
+int FROMT, HELP, INDEX, LOGLEVEL, MIDLST, TOT;	//the metavariables for the command line options 
 //Metavariables for operators
 int OSPF;		//metavariables for the command line operands
 //@endcond 
 //functions in this file
-int extractMsgs(FILE* , Logger*);
+int extractMsgs(FILE* , double, double, Logger*);
 
 /**main
  * gets the command line arguments, set parameters accordingly and performs the data acquisition for printing them.
@@ -54,7 +66,7 @@ int extractMsgs(FILE* , Logger*);
  * (see SiRF IV ICD for details).
  * The output contains printed descriptive relevant data from each OSP message:
  *  - Message identification (MID, in decimal) and payload length for all messages
- *  - Payload parameter values for relevant messages used to generate RINEX or RTK files (MIDs 2, 6, 7, 8, 11, 12, 15, 28, 50, 56, 64, 68, 75)
+ *  - Payload parameter values for relevant messages used to generate RINEX or RTK files, as per the layouts in OSPDecoder (MIDs 2, 6, 7, 8, 11, 12, 15, 28, 50, 56, 64, 67, 68, 70, 75)
  *  - Payload bytes in hexadecimal, for MID 255
  * Output data are sent to the standard output (stdout file), which could be redirected.
  *
@@ -70,8 +82,12 @@ int main(int argc, char* argv[]) {
 	/// 1- Defines and sets the error logger object
 	Logger log("LogFile.txt", string(), string(argv[0]) + MYVER + string(" START"));
 	/// 2- Setups the valid options in the command line. They will be used by the argument/option parser
+	INDEX = parser.addOption("-x", "--index", "INDEX", "Use a message index file (input file name + .idx) to read only the messages selected", false);
+	TOT = parser.addOption("-t", "--totime=TOT", "TOT", "Print messages before the given date and time (comma separated yyyy,mm,dd,hh,mm,sec", "");
+	MIDLST = parser.addOption("-m", "--mids", "MIDLST", "Print only messages having MIDs in the given comma separated list", "");
 	LOGLEVEL = parser.addOption("-l", "--llevel", "LOGLEVEL", "Maximum level to log (SEVERE, WARNING, INFO, CONFIG, FINE, FINER, FINEST)", "INFO");
 	HELP = parser.addOption("-h", "--help", "HELP", "Show usage data", false);
+	FROMT = parser.addOption("-f", "--fromtime=FROMT", "FROMT", "Print messages from the given date and time (comma separated yyyy,mm,dd,hh,mm,sec", "");
 	/// 3- Setups the default values for operators in the command line
 	OSPF = parser.addOperator("DATA.OSP");
 	/// 4- Parses arguments in the command line extracting options and operators
@@ -90,15 +106,37 @@ int main(int argc, char* argv[]) {
 	}
 	/// 5- Sets logging level stated in option
 	log.setLevel(parser.getStrOpt(LOGLEVEL));
-	/// 6- Opens the OSP binary file
+	/// 6- Sets time window limits (if selected from / to time)
+	double fromTimeTag = 0.0, toTimeTag = 0.0;
+	int week, year, month, day, hour, minute;
+	double tow, second;
+	string aStr = parser.getStrOpt(FROMT);
+	if (!aStr.empty()) {
+		if (sscanf(aStr.c_str(), "%d,%d,%d,%d,%d,%lf", &year, &month, &day, &hour, &minute, &second) != 6) {
+			log.severe("Cannot state 'from time' for the time interval");
+			return 1;
+		}
+		setWeekTow (year, month, day, hour, minute, second, week, tow);
+		fromTimeTag = getSecsGPSEphe(week, tow);
+	}
+	aStr = parser.getStrOpt(TOT);
+	if (!aStr.empty()) {
+		if (sscanf(aStr.c_str(), "%d,%d,%d,%d,%d,%lf", &year, &month, &day, &hour, &minute, &second) != 6) {
+			log.severe("Cannot state 'to time' for the time interval");
+			return 1;
+		}
+		setWeekTow (year, month, day, hour, minute, second, week, tow);
+		toTimeTag = getSecsGPSEphe(week, tow);
+	}
+	/// 7- Opens the OSP binary file
 	FILE* inFile;
 	string fileName = parser.getOperator (OSPF);
 	if ((inFile = fopen(fileName.c_str(), "rb")) == NULL) {
 		log.severe("Cannot open file " + fileName);
 		return 2;
 	}
-	/// 7- Call extractMsgs to extract messages from the binary OSP file and print contents
-	int n = extractMsgs(inFile, &log);
+	/// 8- Call extractMsgs to extract messages from the binary OSP file and print contents
+	int n = extractMsgs(inFile, fromTimeTag, toTimeTag, &log);
 	fclose(inFile);
 	log.info("End of data extraction. Messages read: " + to_string((long long) n));
 	return 0;
@@ -109,123 +147,48 @@ int main(int argc, char* argv[]) {
  * The OSP binary file contain OSP messages (see SiRF IV ICD for details) 
  *
  * @param inFile the pointer to the OSP binary FILE to read
+ * @param fromTime the GPS time (seconds from the GPS ephemeris) of the first message to print, or 0 if not stated
+ * @param toTime the GPS time (seconds from the GPS ephemeris) before which messages are printed, or 0 if not stated
  * @param plog the pointer to the Logger object
  * @return the number of messages read
  */
-int extractMsgs(FILE* inFile, Logger* plog) {
+int extractMsgs(FILE* inFile, double fromTime, double toTime, Logger* plog) {
 	OSPMessage message;
+	OSPReader reader(inFile);	//messages are got as views over the mapped file, when possible
 	int mid;
 	int nMessages = 0;
-	///For each input message, the following data are printed:
-	while (message.fill(inFile)) {
+	///Messages to print are selected by MID and, when the message index is used, by time
+	bool midSelected[256];
+	vector<int> mids;
+	vector<string> midTokens = getTokens(parser.getStrOpt(MIDLST), ',');
+	for (vector<string>::iterator it = midTokens.begin(); it != midTokens.end(); it++) {
+		if ((sscanf(it->c_str(), "%d", &mid) != 1) || (mid < 0) || (mid > 255)) {
+			plog->warning("Wrong MID in the list: " + *it);
+			continue;
+		}
+		mids.push_back(mid);
+	}
+	memset(midSelected, mids.empty(), sizeof midSelected);
+	for (vector<int>::iterator it = mids.begin(); it != mids.end(); it++) midSelected[*it] = true;
+	bool timeWindow = (fromTime > 0.0) || (toTime > 0.0);
+	if (parser.getBoolOpt(INDEX) || timeWindow) {
+		string idxFileName = parser.getOperator(OSPF) + ".idx";
+		if (reader.setIndex(idxFileName)) {
+			reader.selectMids(mids);
+			if (timeWindow) reader.setTimeWindow(fromTime, toTime);
+		} else {
+			plog->warning("Cannot use message index " + idxFileName + ". All messages will be read");
+		}
+	}
+	///For each input message selected, the following data are printed:
+	while (reader.next(message)) {
 		nMessages++;
-		mid = message.get();
+		mid = message.mid();
+		if ((mid < 0) || !midSelected[mid]) continue;
 		/// - for all messages, MID and payload length
 		printf("MID:%3d;Ln:%3d;", mid, message.payloadLen());
-		switch (mid) {
-		case 2:		/// - MID 2, solution data: X, Y, Z, vX, vY, vZ, week, TOW and satellites used
-			printf("X:%8d;",message.getInt());
-			printf("Y:%8d;",message.getInt());
-			printf("Z:%8d;",message.getInt());
-			printf("vX:%4hd;",message.getShort());
-			printf("vY:%4hd;",message.getShort());
-			printf("vZ:%4hd;",message.getShort());
-			message.get(); //skip Mode 1
-			message.get(); //skip HDOP2
-			message.get(); //skip Mode 2
-			printf("wk:%4hu;",message.getUShort());
-			printf("TOW:%6u;",message.getUInt());
-			printf("SVs:%2d",message.get());
-			break;
-		case 6:		/// - MID 6: SiRF and customer versions
-			unsigned int lsirf, lcust;
-			lsirf = message.get();
-			lcust = message.get();
-			printf("SiRF ver:");
-			while (lsirf-- > 0) printf("%c", message.get());
-			printf(";Cust ver:");
-			while (lcust-- > 0) printf("%c", message.get());
-			break;
-		case 7:		/// - MID 7, Clock Status Data: week, TOW, satellites used, drift, bias, and EsT
-			printf("ewk:%3hu;", message.getUShort());
-			printf("TOW:%6u;", message.getUInt());
-			printf("SVs:%2d;", message.get());
-			printf("drft:%8u;", message.getUInt());
-			printf("bias:%8u;", message.getUInt());
-			printf("EsT:%8u", message.getUInt());
-			break;
-		case 8:		/// - MID 8, 50 BPS Data: 10 words subframe in hexadecimal
-			printf("ch:%2d;", message.get());
-			printf("SV:%2d;", message.get());
-			unsigned int word[10];
-			for(int i=0; i<10; i++) word[i] = message.getUInt();
-			printf("TOW:%6u;sfr:%2u;pg:%2u;\n\t",
-					(word[1]>>13) & 0x1FFFF,
-					(word[1]>>8) & 0x07,
-					(word[2]>>24) & 0x3F );
-			for(int i=0; i<10; i++) printf("%08X;", word[i]);
-			break;
-		case 11:	/// - MID 11, Command Acknowledgment
-			printf("ack:%3d", message.get());
-			break;
-		case 12:	/// - MID 12, Command Negative Acknowledgment
-			printf("nack:%3d", message.get());
-			break;
-		case 15:	/// - MID 15, Ephemeris Data with compact subframes 1, 2 & 3, in response to poll
-			printf("SV:%2d\n", message.get());
-			for(int i=0; i<3; i++) {
-				printf("\t");
-				for (int j=0; j<15; j++) printf(" %04hX", message.getUShort());
-				printf("\n");
-			}
-			break;
-		case 28:	/// - MID 28, Navigation Library Measurement Data
-			printf("Ch:%2d;", message.get());
-			printf("Ttg:%8u;", message.getUInt());
-			printf("SV:%2d;", message.get());
-			printf("Tsw:%14.3f;", message.getDouble());
-			printf("Psr:%14.3f;", message.getDouble());
-			printf("Cfr:%14.3f;", message.getFloat());
-			printf("Cph:%14.3f;", message.getDouble());
-			printf("Trk:%3hu;", message.getUShort());
-			printf("Syn:%02X\n", message.get());
-			printf("\tCN0:");
-			for (int i=0; i<10; i++) printf("%3d;", message.get());
-			printf("\n\tDri:%5hu", message.getUShort());
-			break;
-		case 50:	/// - MID 50, SBAS Parameters
-			printf("SBASsv:%3d;", message.get());
-			printf("Md:%3d;", message.get());
-			printf("Tout:%3d;", message.get());
-			printf("Flg:%02X", message.get());
-			break;
-		case 56:	/// - MID 56: Extended Ephemeris Data-reserved use
-			printf("SID:%3d;", message.get());
-           	break;
-		case 64:	//Navigation Library Messages
-			printf("SID:%3d", message.get());
-			break;
-		case 67:	/// - MID 67, Multi-constellation Navigation Data (SiRFV)
-			printf("SID:%3d", message.get());
-			break;
-		case 68:	/// - MID 68, Measurement Engine. Wraps the content of another OSP message and outputs it to SiRFLive
-			printf("Wraps:%3d", message.get());
-			break;
-		case 70:	/// -MID 70 GLONASS almanac/ephemeris response to MID 212
-			printf("SID:%3d", message.get());
-			break;
-		case 75:	/// - MID 75, ACK/NACK/ERROR Notification 
-			printf("SID:%2d;", message.get());
-			printf(" echo to MID%2d ", message.get());
-			printf("SID%2d:", message.get());
-			printf("%02x", message.get());
-			break;
-		case 255:	/// - MID 255, ASCII Development Data Output
-			for(unsigned int i=0; i<message.payloadLen()-1; i++)  printf("%c", message.get());
-			break;
-		default:
-			break;
-		}
+		/// - for messages having a layout defined in OSPDecoder, the fields stated in it
+		if (!OSPDecoder::print(message, stdout)) plog->warning("MID" + to_string((long long) mid) + " payload too short to print all fields");
 		printf("\n");
 	}
 	return nMessages;
@@ -0,0 +1,428 @@
+/** @file ParseBenchmark.cpp
+ * Contains the command line program to measure the parsing throughput of RINEX observation and navigation files.
+ *<p>Usage:
+ *<p>ParseBenchmark.exe {options} [DIRLIST]
+ *<p>DIRLIST is a comma separated list of directories. The RINEX observation and navigation files found in them, or in their
+ *subdirectories, are parsed. Other files are ignored.
+ *<p>For each file two measurements are made, and printed to stdout:
+ *	- The epoch reading throughput: the file header and all its epochs are read using RinexData, as RINEXtoRINEX or RINEXtoCSV
+ *	  would do, without printing them. The best time of several rounds is used to compute MB/s and epochs/s.
+ *	- The field parsing throughput: the observable values (V3 observation files) and broadcast orbit values (navigation files)
+ *	  in the file are converted using the fixed width field parser (fieldToDouble) and, for comparison, the former ways:
+ *	  a temporary string converted with stod for observables, and sscanf with a field width for broadcast orbits.
+ *	  The number of fields where results differ is also given.
+ *<p>Options are:
+ *	- -h or --help : Show usage data and stops. Default value HELP=FALSE
+ *	- -l LOGLEVEL or --llevel=LOGLEVEL : Maximum level to log (SEVERE, WARNING, INFO, CONFIG, FINE, FINER, FINEST). Default value LOGLEVEL = WARNING
+ *	- -n ROUNDS or --rounds=ROUNDS : Number of times each measurement is repeated (the best one is given). Default value ROUNDS = 5
+ *Default value for operator is: Data/SiRFV,Data/GStarIV
+ *<p>
+ *Copyright 2015 Francisco Cancillo
+ *<p>
+ *This file is part of the RXtoRINEX tool.
+ *<p>
+ *RXtoRINEX is free software: you can redistribute it and/or modify it under the terms of the GNU General Public License
+ *as published by the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+ *RXtoRINEX is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ *warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *See the GNU General Public License for more details.
+ *A copy of the GNU General Public License can be found at <http://www.gnu.org/licenses/>.
+ *
+ *Ver.	|Date	|Reason for change
+ *------+-------+------------------
+ *V1.0	|10/2026	|First release
+ */
+#include <stdio.h>
+#include <string.h>
+#include <sys/stat.h>
+#ifdef _WIN32
+#include <windows.h>
+#ifndef S_ISDIR
+#define S_ISDIR(m) (((m) & _S_IFMT) == _S_IFDIR)
+#define S_ISREG(m) (((m) & _S_IFMT) == _S_IFREG)
+#endif
+#else
+#include <dirent.h>
+#endif
+#include <algorithm>
+#include <chrono>
+
+//from CommonClasses
+#include "ArgParser.h"
+#include "Logger.h"
+#include "Utilities.h"
+#include "RinexData.h"
+
+using namespace std;
+
+//@cond DUMMY
+///Program name
+const string THISPRG = "ParseBenchmark";
+///The command line format
+const string CMDLINE = THISPRG + ".exe {options} [DIRLIST]";
+///Current program version
+const string MYVER = " V1.0 ";
+//The parser object to store options and operators passed in the comman line
+ArgParser parser;
+//Metavariables for options
+int HELP, LOGLEVEL, ROUNDS;
+//Metavariables for operators
+int DIRLIST;
+//@endcond
+
+/**NumField defines a fixed width numeric field in the image of a RINEX file.
+ */
+struct NumField {
+	const char* start;	//the first char of the field
+	int width;			//the field width
+};
+
+//@cond DUMMY
+//functions in this file
+void findRinexFiles(const string &, vector<string> &);
+bool isRinexFile(const string &);
+bool readEpochs(const string &, int &, long long &, char &, Logger*);
+void findFields(string &, char, vector<NumField> &, vector<NumField> &);
+double timeFieldToDouble(const vector<NumField> &, double &);
+double timeStod(const vector<NumField> &, double &);
+double timeSscanf(const vector<NumField> &, double &);
+int countDifferences(const vector<NumField> &, bool);
+double secondsSince(chrono::steady_clock::time_point);
+//@endcond
+
+/**main
+ * gets the command line arguments, finds the RINEX files in the given directories and measures their parsing throughput.
+ *
+ *@param argc the number of arguments passed from the command line
+ *@param argv the array of arguments passed from the command line
+ *@return  the exit status according to the following values and meaning::
+ *		- (0) all RINEX files found have been measured
+ *		- (1) an error has been detected in arguments
+ *		- (2) no RINEX files have been found
+ *		- (3) some RINEX files cannot be read
+ */
+int main(int argc, char* argv[]) {
+	/**The main process sequence follows:*/
+	/// 1- Defines and sets the error logger object
+	Logger log("LogFile.txt", string(), string(argv[0]) + MYVER + string(" START"));
+	/// 2- Setups the valid options in the command line. They will be used by the argument/option parser
+	ROUNDS = parser.addOption("-n", "--rounds", "ROUNDS", "Number of times each measurement is repeated (the best one is given)", "5");
+	LOGLEVEL = parser.addOption("-l", "--llevel", "LOGLEVEL", "Maximum level to log (SEVERE, WARNING, INFO, CONFIG, FINE, FINER, FINEST)", "WARNING");
+	HELP = parser.addOption("-h", "--help", "HELP", "Show usage data and stops", false);
+	/// 3- Setups the default values for operators in the command line
+	DIRLIST = parser.addOperator("Data/SiRFV,Data/GStarIV");
+	/// 4- Parses arguments in the command line extracting options and operators
+	try {
+		parser.parseArgs(argc, argv);
+	}  catch (string error) {
+		parser.usage("Argument error: " + error, CMDLINE);
+		log.severe(error);
+		return 1;
+	}
+	log.info(parser.showOptValues());
+	log.info(parser.showOpeValues());
+	if (parser.getBoolOpt(HELP)) {
+		//help info has been requested
+		parser.usage("Measures the parsing throughput of the RINEX files in the given directories", CMDLINE);
+		return 0;
+	}
+	/// 5- Sets logging level stated in option
+	log.setLevel(parser.getStrOpt(LOGLEVEL));
+	int rounds = atoi(parser.getStrOpt(ROUNDS).c_str());
+	if (rounds < 1) rounds = 1;
+	/// 6- Finds the RINEX files in the given directories
+	vector<string> files;
+	vector<string> dirs = getTokens(parser.getOperator(DIRLIST), ',');
+	for (vector<string>::iterator it = dirs.begin(); it != dirs.end(); it++) findRinexFiles(*it, files);
+	if (files.empty()) {
+		log.severe("No RINEX files found in " + parser.getOperator(DIRLIST));
+		return 2;
+	}
+	/// 7- For each file measures the epoch reading throughput, and the field parsing throughput of each parser
+	int exitCode = 0;
+	printf("Epoch reading (best of %d rounds)\n", rounds);
+	printf("%-58s %5s %9s %8s %9s %10s\n", "File", "Type", "Size(KB)", "Epochs", "Time(ms)", "MB/s");
+	for (vector<string>::iterator it = files.begin(); it != files.end(); it++) {
+		int epochs;
+		long long size;
+		char fileType;
+		double best = 0.0;
+		bool ok = true;
+		for (int r = 0; ok && r < rounds; r++) {
+			chrono::steady_clock::time_point start = chrono::steady_clock::now();
+			ok = readEpochs(*it, epochs, size, fileType, &log);
+			double t = secondsSince(start);
+			if (r == 0 || t < best) best = t;
+		}
+		if (!ok) {
+			printf("%-58s cannot be read\n", it->c_str());
+			exitCode = 3;
+			continue;
+		}
+		printf("%-58s %5c %9.1f %8d %9.2f %10.1f\n", it->c_str(), fileType, size / 1024.0, epochs, best * 1000.0,
+			size / best / 1048576.0);
+	}
+	printf("\nField parsing (best of %d rounds, ns per field)\n", rounds);
+	printf("%-58s %-9s %8s %13s %12s %12s %6s\n", "File", "Fields", "Count", "fieldToDouble", "stod", "sscanf", "Diffs");
+	for (vector<string>::iterator it = files.begin(); it != files.end(); it++) {
+		//load the file image, and get its type from the header
+		FILE* inFile;
+		if ((inFile = fopen(it->c_str(), "rb")) == NULL) continue;
+		string image;
+		char buffer[65536];
+		size_t n;
+		while ((n = fread(buffer, 1, sizeof buffer, inFile)) > 0) image.append(buffer, n);
+		fclose(inFile);
+		char fileType = image.size() > 20? image[20] : ' ';
+		vector<NumField> obsFields, orbitFields;
+		findFields(image, fileType, obsFields, orbitFields);
+		const vector<NumField>* fieldSets[] = {&obsFields, &orbitFields};
+		const char* setNames[] = {"obs(14)", "orbit(19)"};
+		for (int s = 0; s < 2; s++) {
+			const vector<NumField> &fields = *fieldSets[s];
+			if (fields.empty()) continue;
+			double tFast = 0.0, tStod = 0.0, tScan = 0.0, t, sum;
+			for (int r = 0; r < rounds; r++) {
+				t = timeFieldToDouble(fields, sum);
+				if (r == 0 || t < tFast) tFast = t;
+				t = timeStod(fields, sum);
+				if (r == 0 || t < tStod) tStod = t;
+				t = timeSscanf(fields, sum);
+				if (r == 0 || t < tScan) tScan = t;
+			}
+			printf("%-58s %-9s %8u %13.1f %12.1f %12.1f %6d\n", it->c_str(), setNames[s], (unsigned int) fields.size(),
+				tFast * 1e9 / fields.size(), tStod * 1e9 / fields.size(), tScan * 1e9 / fields.size(), countDifferences(fields, s == 0));
+		}
+	}
+	return exitCode;
+}
+
+/**findRinexFiles appends to the list the names of the RINEX files in the given directory and its subdirectories, sorted by name.
+ *
+ *@param dirName the directory name
+ *@param files the list where file names are appended
+ */
+void findRinexFiles(const string &dirName, vector<string> &files) {
+	struct stat fileStat;
+	vector<string> names;
+#ifdef _WIN32
+	WIN32_FIND_DATAA entry;
+	HANDLE find;
+	if ((find = FindFirstFileA((dirName + "/*").c_str(), &entry)) == INVALID_HANDLE_VALUE) return;
+	do {
+		if (entry.cFileName[0] == '.') continue;
+		names.push_back(dirName + "/" + entry.cFileName);
+	} while (FindNextFileA(find, &entry));
+	FindClose(find);
+#else
+	DIR* dir;
+	struct dirent* entry;
+	if ((dir = opendir(dirName.c_str())) == NULL) return;
+	while ((entry = readdir(dir)) != NULL) {
+		if (entry->d_name[0] == '.') continue;
+		names.push_back(dirName + "/" + entry->d_name);
+	}
+	closedir(dir);
+#endif
+	sort(names.begin(), names.end());
+	for (vector<string>::iterator it = names.begin(); it != names.end(); it++) {
+		if (stat(it->c_str(), &fileStat) != 0) continue;
+		if (S_ISDIR(fileStat.st_mode)) findRinexFiles(*it, files);
+		else if (S_ISREG(fileStat.st_mode) && isRinexFile(*it)) files.push_back(*it);
+	}
+}
+
+/**isRinexFile checks if the given file is a RINEX observation or navigation file, that is, its first line is
+ * a RINEX VERSION / TYPE record of one of these file types.
+ *
+ *@param name the file name
+ *@return true if it is a RINEX observation or navigation file, false otherwise
+ */
+bool isRinexFile(const string &name) {
+	FILE* inFile;
+	char line[100];
+	bool isRinex = false;
+	if ((inFile = fopen(name.c_str(), "r")) == NULL) return false;
+	if ((fgets(line, sizeof line, inFile) != NULL) && (strncmp(line + 60, "RINEX VERSION / TYPE", 20) == 0))
+		isRinex = (line[20] == 'O') || (line[20] == 'N') || (line[20] == 'G');
+	fclose(inFile);
+	return isRinex;
+}
+
+/**readEpochs reads the header and all epochs of the given RINEX file, as a RINEX conversion would do, without printing them.
+ *
+ *@param name the file name
+ *@param epochs the number of epochs read (navigation records for navigation files)
+ *@param size the file size in bytes
+ *@param fileType the RINEX file type (O, N, G)
+ *@param plog the logger to use
+ *@return true if the file could be read, false otherwise
+ */
+bool readEpochs(const string &name, int &epochs, long long &size, char &fileType, Logger* plog) {
+	FILE* inFile;
+	double version;
+	char sysId;
+	int rdStat;
+	if ((inFile = fopen(name.c_str(), "rb")) == NULL) {
+		plog->severe("Cannot open file " + name);
+		return false;
+	}
+	fseek(inFile, 0, SEEK_END);
+	size = ftell(inFile);
+	rewind(inFile);
+	RinexData rinex(RinexData::VTBD, plog);
+	epochs = 0;
+	try {
+		rinex.readRinexHeader(inFile);
+		if (!rinex.getHdLnData(RinexData::INFILEVER, version, fileType, sysId)) {
+			plog->severe("This RINEX input file version cannot be processed: " + name);
+			fclose(inFile);
+			return false;
+		}
+		if (fileType == 'O') {
+			while ((rdStat = rinex.readObsEpoch(inFile)) != 0) epochs++;
+		} else {
+			while ((rdStat = rinex.readNavEpoch(inFile)) != 0) epochs++;
+		}
+	}  catch (string error) {
+		plog->severe(error + " in " + name);
+		fclose(inFile);
+		return false;
+	}
+	fclose(inFile);
+	return true;
+}
+
+/**findFields finds in the image of a RINEX file the numeric fields of observable values (in V3 observation files) and
+ * of broadcast orbit values (in navigation files), as placed in their epoch records.
+ * Line ends are replaced by null chars, as lines would be in the reading buffer, to allow sscanf conversions.
+ *
+ *@param image the file contents
+ *@param fileType the RINEX file type (O, N, G)
+ *@param obsFields the list where observable fields are appended
+ *@param orbitFields the list where broadcast orbit fields are appended
+ */
+void findFields(string &image, char fileType, vector<NumField> &obsFields, vector<NumField> &orbitFields) {
+	NumField field;
+	bool inHeader = true;
+	int version = image.size() > 5? image[5] - '0' : 0;	//the major version number is in the F9.2 field at col 0
+	for (size_t pos = 0, eol; pos < image.size(); pos = eol + 1) {
+		if ((eol = image.find('\n', pos)) == string::npos) eol = image.size();
+		else image[eol] = '\0';
+		const char* line = image.c_str() + pos;
+		int length = (int) (eol - pos);
+		if ((length > 0) && (line[length - 1] == '\r')) length--;
+		if (inHeader) {
+			inHeader = (length < 73) || (strncmp(line + 60, "END OF HEADER", 13) != 0);
+			continue;
+		}
+		if (fileType == 'O') {
+			//V3 observation records start with the system and PRN, followed by values in 16 chars (F14.3, LLI, SSI)
+			if ((version != 3) || (length < 17) || (line[0] == '>') || (line[1] == ' ')) continue;
+			for (int col = 3; col + 14 <= length; col += 16) {
+				field.start = line + col;
+				field.width = 14;
+				if (strspn(field.start, " ") < 14) obsFields.push_back(field);
+			}
+		} else {
+			//broadcast orbit records start with 3 (V2) or 4 (V3) blanks, followed by up to 4 values of 19 chars (D19.12)
+			int col = version == 2? 3 : 4;
+			if ((length < col + 19) || (strspn(line, " ") < (size_t) col)) continue;
+			for (; col + 19 <= length; col += 19) {
+				field.start = line + col;
+				field.width = 19;
+				orbitFields.push_back(field);
+			}
+		}
+	}
+}
+
+/**timeFieldToDouble converts all given fields using the fixed width field parser.
+ *
+ *@param fields the fields to convert
+ *@param sum the sum of the values converted, to avoid the conversion being optimized away
+ *@return the time taken, in seconds
+ */
+double timeFieldToDouble(const vector<NumField> &fields, double &sum) {
+	double value;
+	sum = 0.0;
+	chrono::steady_clock::time_point start = chrono::steady_clock::now();
+	for (vector<NumField>::const_iterator it = fields.begin(); it != fields.end(); it++)
+		if (fieldToDouble(it->start, it->width, value)) sum += value;
+	return secondsSince(start);
+}
+
+/**timeStod converts all given fields copying each one to a temporary string converted with stod,
+ * as the V2 observation reader did before the fixed width field parser was available.
+ *
+ *@param fields the fields to convert
+ *@param sum the sum of the values converted, to avoid the conversion being optimized away
+ *@return the time taken, in seconds
+ */
+double timeStod(const vector<NumField> &fields, double &sum) {
+	sum = 0.0;
+	chrono::steady_clock::time_point start = chrono::steady_clock::now();
+	for (vector<NumField>::const_iterator it = fields.begin(); it != fields.end(); it++) {
+		try {
+			sum += stod(string(it->start, it->width));
+		} catch (...) {
+		}
+	}
+	return secondsSince(start);
+}
+
+/**timeSscanf converts all given fields using sscanf with the field width,
+ * as the navigation reader did before the fixed width field parser was available.
+ *
+ *@param fields the fields to convert
+ *@param sum the sum of the values converted, to avoid the conversion being optimized away
+ *@return the time taken, in seconds
+ */
+double timeSscanf(const vector<NumField> &fields, double &sum) {
+	double value;
+	char format[8];
+	sum = 0.0;
+	chrono::steady_clock::time_point start = chrono::steady_clock::now();
+	for (vector<NumField>::const_iterator it = fields.begin(); it != fields.end(); it++) {
+		sprintf(format, "%%%dlf", it->width);
+		if (sscanf(it->start, format, &value) == 1) sum += value;
+	}
+	return secondsSince(start);
+}
+
+/**countDifferences counts the fields where the fixed width field parser gives a result different from the former parser.
+ *
+ *@param fields the fields to check
+ *@param useStod true to compare with stod, false to compare with sscanf
+ *@return the number of fields with different results
+ */
+int countDifferences(const vector<NumField> &fields, bool useStod) {
+	int diffs = 0;
+	double fast, former;
+	char format[8];
+	for (vector<NumField>::const_iterator it = fields.begin(); it != fields.end(); it++) {
+		bool okFast = fieldToDouble(it->start, it->width, fast);
+		bool okFormer = true;
+		if (useStod) {
+			try {
+				former = stod(string(it->start, it->width));
+			} catch (...) {
+				okFormer = false;
+			}
+		} else {
+			sprintf(format, "%%%dlf", it->width);
+			okFormer = sscanf(it->start, format, &former) == 1;
+		}
+		if ((okFast != okFormer) || (okFast && (fast != former))) diffs++;
+	}
+	return diffs;
+}
+
+/**secondsSince gives the time elapsed since the given time point.
+ *
+ *@param start the time point
+ *@return the seconds elapsed
+ */
+double secondsSince(chrono::steady_clock::time_point start) {
+	return chrono::duration<double>(chrono::steady_clock::now() - start).count();
+}
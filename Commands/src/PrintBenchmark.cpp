@@ -0,0 +1,237 @@
+/** @file PrintBenchmark.cpp
+ * Contains the command line program to measure how the time to print RINEX observation and navigation epochs scales with their size.
+ *<p>Usage:
+ *<p>PrintBenchmark.exe {options}
+ *<p>Synthetic epoch data of increasing size are generated and printed to the null device using RinexData, and the time taken
+ *per item printed is given for each size, to stdout. If printing time is linear in the epoch size, the time per item remains
+ *about the same for all sizes. Two measurements are made:
+ *	- Observation epochs: epochs with data for 32 GPS satellites and 4 x SCALE observable types for each one (C1x, L1x, D1x, S1x
+ *	  for each x tracking mode, and the same for bands 2 and 5), that is 128 x SCALE observables per epoch.
+ *	- Navigation epoch: a single epoch with 1000 x SCALE ephemeris for the 32 GPS satellites, as the one OSPtoRINEX prints
+ *	  at the end of a session with all ephemeris acquired.
+ *<p>Options are:
+ *	- -h or --help : Show usage data and stops. Default value HELP=FALSE
+ *	- -l LOGLEVEL or --llevel=LOGLEVEL : Maximum level to log (SEVERE, WARNING, INFO, CONFIG, FINE, FINER, FINEST). Default value LOGLEVEL = WARNING
+ *	- -n ROUNDS or --rounds=ROUNDS : Number of times each measurement is repeated (the best one is given). Default value ROUNDS = 5
+ *	- -s SCALES or --scales=SCALES : Comma separated list of size scale factors (1 to 20). Default value SCALES = 1,2,4,8,16
+ *	- -v VER or --ver=VER : Select version of RINEX file to print (V210, V302). Default value VER = V302
+ *<p>
+ *Copyright 2015 Francisco Cancillo
+ *<p>
+ *This file is part of the RXtoRINEX tool.
+ *<p>
+ *RXtoRINEX is free software: you can redistribute it and/or modify it under the terms of the GNU General Public License
+ *as published by the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+ *RXtoRINEX is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ *warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *See the GNU General Public License for more details.
+ *A copy of the GNU General Public License can be found at <http://www.gnu.org/licenses/>.
+ *
+ *Ver.	|Date	|Reason for change
+ *------+-------+------------------
+ *V1.0	|10/2026	|First release
+ */
+#include <stdio.h>
+#include <chrono>
+
+//from CommonClasses
+#include "ArgParser.h"
+#include "Logger.h"
+#include "Utilities.h"
+#include "RinexData.h"
+
+using namespace std;
+
+//@cond DUMMY
+///Program name
+const string THISPRG = "PrintBenchmark";
+///The command line format
+const string CMDLINE = THISPRG + ".exe {options}";
+///Current program version
+const string MYVER = " V1.0 ";
+//The parser object to store options and operators passed in the comman line
+ArgParser parser;
+//Metavariables for options
+int HELP, LOGLEVEL, ROUNDS, SCALES, VER;
+///The number of satellites in synthetic data
+const int NSATS = 32;
+///The number of epochs printed in each observation measurement
+const int NOBSEPOCHS = 100;
+///The tracking modes used to build observable types for each band
+const char* TRACKMODES[] = {"1CSLXPWYMN", "2CDSLXPWYMN", "5IQX"};
+//@endcond
+
+//@cond DUMMY
+//functions in this file
+vector<string> obsTypes(int);
+double timeObsEpochs(RinexData::RINEXversion, int, FILE*, Logger*);
+double timeNavEpoch(RinexData::RINEXversion, int, FILE*, Logger*);
+//@endcond
+
+/**main
+ * gets the command line arguments, and measures the time to print synthetic observation and navigation epochs for each scale given.
+ *
+ *@param argc the number of arguments passed from the command line
+ *@param argv the array of arguments passed from the command line
+ *@return  the exit status according to the following values and meaning::
+ *		- (0) no errors have been detected
+ *		- (1) an error has been detected in arguments
+ *		- (2) the null device cannot be opened
+ *		- (3) an error has been detected printing epochs
+ */
+int main(int argc, char* argv[]) {
+	/**The main process sequence follows:*/
+	/// 1- Defines and sets the error logger object
+	Logger log("LogFile.txt", string(), string(argv[0]) + MYVER + string(" START"));
+	/// 2- Setups the valid options in the command line. They will be used by the argument/option parser
+	VER = parser.addOption("-v", "--ver", "VER", "Select version of RINEX file to print (V210, V302)", "V302");
+	SCALES = parser.addOption("-s", "--scales", "SCALES", "Comma separated list of size scale factors (1 to 20)", "1,2,4,8,16");
+	ROUNDS = parser.addOption("-n", "--rounds", "ROUNDS", "Number of times each measurement is repeated (the best one is given)", "5");
+	LOGLEVEL = parser.addOption("-l", "--llevel", "LOGLEVEL", "Maximum level to log (SEVERE, WARNING, INFO, CONFIG, FINE, FINER, FINEST)", "WARNING");
+	HELP = parser.addOption("-h", "--help", "HELP", "Show usage data and stops", false);
+	/// 3- Parses arguments in the command line extracting options
+	try {
+		parser.parseArgs(argc, argv);
+	}  catch (string error) {
+		parser.usage("Argument error: " + error, CMDLINE);
+		log.severe(error);
+		return 1;
+	}
+	log.info(parser.showOptValues());
+	if (parser.getBoolOpt(HELP)) {
+		//help info has been requested
+		parser.usage("Measures how the time to print RINEX epochs scales with their size", CMDLINE);
+		return 0;
+	}
+	/// 4- Sets logging level stated in option
+	log.setLevel(parser.getStrOpt(LOGLEVEL));
+	/// 5- Checks the version and scales given
+	RinexData::RINEXversion version;
+	if (parser.getStrOpt(VER).compare("V210") == 0) version = RinexData::V210;
+	else if (parser.getStrOpt(VER).compare("V302") == 0) version = RinexData::V302;
+	else {
+		log.severe("Unknown RINEX version " + parser.getStrOpt(VER));
+		return 1;
+	}
+	vector<int> scales;
+	vector<string> tokens = getTokens(parser.getStrOpt(SCALES), ',');
+	for (vector<string>::iterator it = tokens.begin(); it != tokens.end(); it++) {
+		int scale = atoi(it->c_str());
+		if ((scale < 1) || (scale > 20)) {
+			log.severe("Wrong scale factor " + *it);
+			return 1;
+		}
+		scales.push_back(scale);
+	}
+	int rounds = atoi(parser.getStrOpt(ROUNDS).c_str());
+	if (rounds < 1) rounds = 1;
+	/// 6- Opens the null device to print epochs
+#ifdef _WIN32
+	FILE* nullFile = fopen("NUL", "w");
+#else
+	FILE* nullFile = fopen("/dev/null", "w");
+#endif
+	if (nullFile == NULL) {
+		log.severe("Cannot open the null device");
+		return 2;
+	}
+	/// 7- For each scale measures the time to print observation epochs and the navigation epoch, and prints it per item
+	int exitCode = 0;
+	printf("RINEX %s print time (best of %d rounds)\n", parser.getStrOpt(VER).c_str(), rounds);
+	printf("%5s %12s %12s %12s %12s %12s %12s\n", "Scale", "Obs/epoch", "Time(ms)", "ns/obs", "Ephemeris", "Time(ms)", "ns/eph");
+	try {
+		for (vector<int>::iterator it = scales.begin(); it != scales.end(); it++) {
+			double tObs = 0.0, tNav = 0.0, t;
+			for (int r = 0; r < rounds; r++) {
+				t = timeObsEpochs(version, *it, nullFile, &log);
+				if (r == 0 || t < tObs) tObs = t;
+				t = timeNavEpoch(version, *it, nullFile, &log);
+				if (r == 0 || t < tNav) tNav = t;
+			}
+			int nObs = NSATS * 4 * (*it);
+			int nEph = 1000 * (*it);
+			printf("%5d %12d %12.2f %12.1f %12d %12.2f %12.1f\n", *it, nObs, tObs * 1000.0, tObs * 1e9 / nObs / NOBSEPOCHS,
+				nEph, tNav * 1000.0, tNav * 1e9 / nEph);
+		}
+	}  catch (string error) {
+		log.severe(error);
+		exitCode = 3;
+	}
+	fclose(nullFile);
+	return exitCode;
+}
+
+/**obsTypes gives the list of observable types for the given scale: C, L, D and S observables for the first scale tracking modes
+ * in the bands 1, 2 and 5.
+ *
+ *@param scale the scale factor (1 to 20)
+ *@return the list of 4 x scale observable types
+ */
+vector<string> obsTypes(int scale) {
+	vector<string> types;
+	const char* measurements = "CLDS";
+	for (int b = 0; b < 3; b++)
+		for (const char* mode = TRACKMODES[b] + 1; *mode != 0; mode++)
+			for (int m = 0; m < 4; m++) {
+				if (types.size() == (size_t) (4 * scale)) return types;
+				types.push_back(string(1, measurements[m]) + TRACKMODES[b][0] + *mode);
+			}
+	return types;
+}
+
+/**timeObsEpochs prints NOBSEPOCHS synthetic observation epochs with data for NSATS GPS satellites and the observable types
+ * given by obsTypes for the given scale, and measures the time taken in printing them.
+ *
+ *@param version the RINEX version to print
+ *@param scale the scale factor (1 to 20)
+ *@param out the file where epochs are printed
+ *@param plog the logger to use
+ *@return the time taken in printing epochs, in seconds
+ */
+double timeObsEpochs(RinexData::RINEXversion version, int scale, FILE* out, Logger* plog) {
+	RinexData rinex(version, plog);
+	vector<string> types = obsTypes(scale);
+	rinex.setHdLnData(RinexData::TOBS, 'G', types);
+	chrono::steady_clock::duration elapsed = chrono::steady_clock::duration::zero();
+	for (int e = 0; e < NOBSEPOCHS; e++) {
+		double tTag = rinex.setEpochTime(1888, 345600.0 + e, 0.0, 0);
+		for (int sat = 1; sat <= NSATS; sat++)
+			for (size_t i = 0; i < types.size(); i++)
+				rinex.saveObsData('G', sat, types[i], 20000000.0 + sat * 1000.0 + i * 0.125, 0, 7, tTag);
+		chrono::steady_clock::time_point start = chrono::steady_clock::now();
+		rinex.printObsEpoch(out);
+		elapsed += chrono::steady_clock::now() - start;
+	}
+	return chrono::duration<double>(elapsed).count();
+}
+
+/**timeNavEpoch prints a synthetic navigation epoch with 1000 x scale ephemeris for NSATS GPS satellites,
+ * and measures the time taken in printing it. The header is printed before, to set the system to print in V210.
+ *
+ *@param version the RINEX version to print
+ *@param scale the scale factor (1 to 20)
+ *@param out the file where the epoch is printed
+ *@param plog the logger to use
+ *@return the time taken in printing the epoch, in seconds
+ */
+double timeNavEpoch(RinexData::RINEXversion version, int scale, FILE* out, Logger* plog) {
+	RinexData rinex(version, plog);
+	rinex.setHdLnData(RinexData::TOBS, 'G', obsTypes(1));
+	double bo[8][4];
+	for (int i = 0; i < 8; i++)
+		for (int j = 0; j < 4; j++) bo[i][j] = (i * 4 + j + 1) * 1.0e-3;
+	int nEph = 1000 * scale;
+	for (int n = 0; n < nEph; n++) {
+		int sat = n % NSATS + 1;
+		double tTag = rinex.setEpochTime(1888, (n / NSATS) * 7200.0, 0.0, 0);
+		bo[0][0] = (n / NSATS) * 7200.0;
+		rinex.saveNavData('G', sat, bo, tTag);
+	}
+	vector<string> selSat(1, string("G"));
+	vector<string> selObs;
+	rinex.setFilter(selSat, selObs);
+	rinex.printNavHeader(out);
+	chrono::steady_clock::time_point start = chrono::steady_clock::now();
+	rinex.printNavEpoch(out);
+	return chrono::duration<double>(chrono::steady_clock::now() - start).count();
+}
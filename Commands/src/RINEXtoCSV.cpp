@@ -5,6 +5,8 @@
  *<p>Options are:
  *	- -f FROMT or --fromtime=FROMT : Select epochs from the given date and time (comma separated yyyy,mm,dd,hh,mm,sec. Default value: 1st epoch in the input file
  *	- -h or --help : Show usage data and stops. Default value HELP=FALSE
+ *	- -i or --index : Use an epoch index file (input file name + .idx) to read only epochs in the time interval. The index is created if it does not exist. Default value false
+ *	- -j THREADS or --threads=THREADS : Number of threads used to read input observation epochs in parallel. Default value THREADS = 1 (sequential reading)
  *	- -l LOGLEVEL or --llevel=LOGLEVEL : Maximum level to log (SEVERE, WARNING, INFO, CONFIG, FINE, FINER, FINEST). Default value LOGLEVEL = INFO
  *	- -o OBSLST or --selobs=OBSLST : List of selected system-observables (ver.3.01 notation) from input (a comma separated list, like GC1C,GL1C). Default value is all selected.
  *	- -p OBS2LST or --selobs2=OBS2LST : List of selected system-observables (ver.2.10 notation) from input (comma separated list, like GC1,GL1,GL2). Default value is all selected.
@@ -25,12 +27,14 @@
  *Ver.	|Date	|Reason for change
  *------+-------+------------------
  *V1.0	|2/2016	|First release
+ *V1.1	|10/2026	|CSV generation functions moved to RinexCSV, to be shared with BatchToRINEX
  */
 //from CommonClasses
 #include "ArgParser.h"
 #include "Logger.h"
 #include "Utilities.h"
 #include "RinexData.h"
+#include "RinexCSV.h"
 
 using namespace std;
 
@@ -42,22 +46,10 @@ const string MYVER = " V1.0";
 ///The parser object to store options and operators passed in the command line
 ArgParser parser;
 //Metavariables for options
-int AEND, BIAS, FROMT, GPS, HELP, LOGLEVEL, MINSV, SELOBS3, SELOBS2, SELSAT, TOT;
+int AEND, BIAS, FROMT, GPS, HELP, INDEX, LOGLEVEL, MINSV, SELOBS3, SELOBS2, SELSAT, THREADS, TOT;
 //Metavariables for operators
 int INRINEX;
 //@endcond 
-///A data tipe to define a time interval
-struct TimeIntervalParams {
-	bool fromTime, toTime;
-	double fromTimeTag, toTimeTag;
-};
-//functions in this file
-int generateHeaderCSV(FILE*, RinexData &, Logger*);
-int generateObsCSV(FILE*, FILE*, RinexData &, TimeIntervalParams &, Logger*);
-int generateGPSNavCSV(FILE*, FILE*, RinexData &, TimeIntervalParams &, Logger*);
-int generateGalNavCSV(FILE*, FILE*, RinexData &, TimeIntervalParams &, Logger*);
-int generateGloNavCSV(FILE*, FILE*, RinexData &, TimeIntervalParams &, Logger*);
-int generateSBASNavCSV(FILE*, FILE*, RinexData &, TimeIntervalParams &, Logger*);
 
 /**main
  * gets the command line arguments, set parameters accordingly and triggers the data acquisition to generate CSV files.
@@ -95,6 +87,8 @@ int main(int argc, char* argv[]) {
 	SELOBS3 = parser.addOption("-o", "--selobs", "SELOBS3", "Select system-observable (ver.3.01 notation) from input (comma separated list, like GC1C,GL1C)", "");
 	LOGLEVEL = parser.addOption("-l", "--llevel", "LOGLEVEL", "Maximum level to log (SEVERE, WARNING, INFO, CONFIG, FINE, FINER, FINEST)", "INFO");
 	HELP = parser.addOption("-h", "--help", "HELP", "Show usage data and stops", false);
+	INDEX = parser.addOption("-i", "--index", "INDEX", "Use an epoch index file (input file name + .idx) to read only epochs in the time interval", false);
+	THREADS = parser.addOption("-j", "--threads", "THREADS", "Number of threads used to read input observation epochs in parallel", "1");
 	FROMT = parser.addOption("-f", "--fromtime=FROMT", "FROMT", "Select epochs from the given date and time (comma separated yyyy,mm,dd,hh,mm,sec", "");
 	/// 3- Setups the default values for operators in the command line
 	INRINEX = parser.addOperator("RINEX.DAT");
@@ -117,6 +111,7 @@ int main(int argc, char* argv[]) {
 	log.setLevel(parser.getStrOpt(LOGLEVEL));
 	/// 7 - Set 1st and last epoch time tags (if selected from / to epochs time) 
 	TimeIntervalParams timeInterval;
+	timeInterval.timeOrdered = false;
 	int week, year, month, day, hour, minute;
 	double tow, second;
 	aStr = parser.getStrOpt(FROMT);
@@ -148,6 +143,7 @@ int main(int argc, char* argv[]) {
 	}
 	/// 8- Create a RINEX object and extract header data from the RINEX input file
 	RinexData rinex(RinexData::VTBD, &log);
+	rinex.setReadThreads(stoi(parser.getStrOpt(THREADS)));
 	char fileType = ' ';
 	char sysId = ' ';
 	try {
@@ -204,6 +200,9 @@ int main(int argc, char* argv[]) {
 			log.severe("Cannot create file " + aStr);
 			return 6;
 		}
+		//if an epoch index is used, go to the first epoch in the interval. Epochs are in time order
+		timeInterval.timeOrdered = parser.getBoolOpt(INDEX) && rinex.setEpochIndex(inFile, parser.getOperator(INRINEX) + ".idx");
+		if (timeInterval.timeOrdered && timeInterval.fromTime) rinex.seekObsEpoch(inFile, timeInterval.fromTimeTag);
 		anInt = generateObsCSV(inFile, outFile, rinex, timeInterval, &log);
 		fclose(outFile);
 		break;
@@ -258,280 +257,3 @@ int main(int argc, char* argv[]) {
 	fclose(inFile);
 	return anInt>0? 0:5;
 }
-
-/**generateHeaderCSV prints header data for relevant records in CVS format
- *
- *@param out the already open print stream where header data will be printed in CVS format
- *@param rinex the RINEX data object, source of data to be printed
- *@param plog a pointer to a Logger to be used to record logging messages
- *@return  the exit status
- */
-int generateHeaderCSV(FILE* out, RinexData &rinex, Logger* plog) {
-	double db1, db2, db3;
-	char ch1, ch2;
-	vector <string> vs1;
-	unsigned int ui1;
-	string record, str1, str2, str3;
-	int nrec = 0;
-	plog->finer("Print CSV header records:");
-	fprintf(out, "RINEX header record,Values\n");
-	RinexData::RINEXlabel labelId = rinex.get1stLabelId();
-	if (labelId != RinexData::VERSION) plog->warning("VERSION record has not data");
-	while (labelId != RinexData::LASTONE) {
-		record = rinex.idTOlbl(labelId);
-		try {
-			switch(labelId) {
-			case RinexData::VERSION:
-				rinex.setHdLnData(RinexData::VERSION);	//set version as per input file
-				rinex.getHdLnData(labelId, db1, ch1, ch2);
-				fprintf(out,"%s,%f,%c,%c\n", record.c_str(), db1, ch1, ch2);
-				break;
-			case RinexData::RUNBY:
-				rinex.getHdLnData(labelId, str1, str2, str3);
-				fprintf(out,"%s,%s,%s,%s\n", record.c_str(), str1.c_str(), str2.c_str(), str3.c_str());
-				break;
-			case RinexData::APPXYZ:
-				rinex.getHdLnData(labelId, db1, db2, db3);
-				fprintf(out,"%s,%lf,%lf,%lf\n", record.c_str(),  db1, db2, db3);
-				break;
-			case RinexData::TOBS:
-			case RinexData::SYS:
-				for (ui1 = 0; rinex.getHdLnData(labelId, ch1, vs1, ui1); ui1++) {
-					fprintf(out,"%s,%c", record.c_str(), ch1);
-					for(vector<string>::iterator it = vs1.begin() ; it != vs1.end(); ++it) fprintf(out,",%s", (*it).c_str());
-					fprintf(out,"\n");
-				}
-				break;
-			case RinexData::INT:
-				rinex.getHdLnData(labelId, db1);
-				fprintf(out,"%s,%lf\n", record.c_str(), db1);
-				break;
-			default:
-				nrec--;
-				break;
-			}
-			nrec++;
-		} catch (string error) {
-			plog->severe(error + string("Incorrect params in getHdLnData call for " + record));
-		}
-		labelId = rinex.getNextLabelId();
-	}
-	plog->finer("Records printed:" + to_string((long long) nrec));
-	return nrec;
-}
-
-/*timeInInterval checks if the given time is in the given time interval.
- *
- *@param epochT the time in seconds to be checked
- *@param timeInterval the values defining the interval and the limits to be checked
- *@return true if the time interval is not defined or the given time is in the interval, false otherwise
-*/
-bool timeInInterval(double epochT, TimeIntervalParams &timeInterval) {
-	if (timeInterval.fromTime || timeInterval.toTime) {
-		if (timeInterval.fromTime && ( epochT < timeInterval.fromTimeTag)) return false;
-		if (timeInterval.toTime && (epochT > timeInterval.toTimeTag)) return false;
-	}
-	return true;
-}
-
-/**generateObsCSV prints observation data in CVS format
- *
- *@param inFile the already open input RINEX observation file, positioned just after the End of Header record, in the first epoch 
- *@param outFile the already open print stream where header data will be printed in CVS format
- *@param rinex the RINEX data object, source of data to be printed
- *@param timeInterval the values defining the interval and the limits to be checked
- *@param plog a pointer to a Logger to be used to record logging messages
- *@return  the number of epochs transferred to the CSV file
- */
-int generateObsCSV(FILE *inFile, FILE* outFile, RinexData &rinex, TimeIntervalParams &timeInterval, Logger* plog) {
-	int anInt;		//a general purpose int variable
-	string aStr;	//a general purpose string variable
-	double aDouble;	//a general purpose double variable
-	char sys;
-	int week, rdStat, sat, lol, strg;
-	double tow, value, tTag;
-	string obsType;
-	int nrec = 0;
-	plog->finer("Print CSV observation epochs:");
-	try {
-		fprintf(outFile, "Week,TOW,Sys,Sat,Obs,Value,LoL,Strg\n");
-		while ((rdStat = rinex.readObsEpoch(inFile)) != 0) {
-			if (rdStat == 1 && timeInInterval(rinex.getEpochTime(week, tow, aDouble, anInt), timeInterval) && rinex.filterObsData()) {	//Epoch observables and data are well formatted and it remains data after filtering
-				nrec++;
-				for (unsigned int index = 0; rinex.getObsData(sys, sat, obsType, value, lol, strg, tTag, index); index++) {
-					fprintf(outFile, "%d,%lf,%c,%d,%s,%lf,%d,%d\n", week, tow, sys, sat, obsType.c_str(), value, lol, strg);
-				}
-			}
-		}
-	} catch (string error) {
-		plog->severe(error);
-	}
-	plog->finer("Obs epochs to CSV:" + to_string((long long) nrec));
-	return nrec;
-}
-
-/**generateGPSNavCSV prints GPS navigation data in CVS format
- *
- *@param inFile the already open input RINEX navigation file, positioned just after the End of Header record, in the first epoch 
- *@param outFile the already open print stream where header data will be printed in CVS format
- *@param rinex the RINEX data object, source of data to be printed
- *@param timeInterval the values defining the interval and the limits to be checked
- *@param plog a pointer to a Logger to be used to record logging messages
- *@return  the exit status
- */
-int generateGPSNavCSV(FILE *inFile, FILE* outFile, RinexData &rinex, TimeIntervalParams &timeInterval, Logger* plog) {
-	int anInt;		//a general purpose int variable
-	string aStr;	//a general purpose string variable
-	double aDouble;	//a general purpose double variable
-	char sys;
-	int week, rdStat, sat;
-	double tow, tTag, bo[8][4];
-	int nrec = 0;
-	plog->finer("Print CSV GPS navigation epochs:");
-	try {
-		fprintf(outFile, "Sys,Sat,Week,TOW,Af0,Af1,Af2,IODE,Crs,Delta N,M0,Cuc,e,Cus,sqrt(A),Toe,Cic,OMEGA0,Cis,i0,Crc,W,WDOT,IDOT,Codes on L2,GPS Week,L2 P flag,SV accuracy,SV health,TGD,IODC,Transm. time,Fit interval\n");
-		while ((rdStat = rinex.readNavEpoch(inFile)) != 0) {
-			if ((rdStat == 1 || rdStat == 2) && timeInInterval(rinex.getEpochTime(week, tow, aDouble, anInt), timeInterval) && rinex.filterNavData()) {	//Epoch nav. data are well formatted
-				if (rinex.getNavData(sys, sat, bo, tTag, 0) && sys == 'G') {
-					nrec++;
-					fprintf(outFile, "%c,%d,%d,%lf", sys, sat, week, tow);
-					for (int j = 1; j != 4; j++) fprintf(outFile, ",%19.12E", bo[0][j]);
-					for (int i = 1; i != 7; i++)
-						for (int j = 0; j != 4; j++) fprintf(outFile, ",%19.12E", bo[i][j]);
-					for (int j = 0; j != 2; j++) fprintf(outFile, ",%19.12E", bo[7][j]);
-					fprintf(outFile, "\n");
-					rinex.clearNavData();
-				} else plog->warning("Expected GPS epoch, but selected an " + string(1, sys) + " sat.");
-			}
-		}
-
-	} catch (string error) {
-		plog->severe(error);
-	}
-	plog->finer("GPS nav. epochs to CSV:" + to_string((long long) nrec));
-	return nrec;
-}
-
-/**generateGalNavCSV prints Galileo navigation data in CVS format
- *
- *@param inFile the already open input RINEX navigation file, positioned just after the End of Header record, in the first epoch 
- *@param outFile the already open print stream where header data will be printed in CVS format
- *@param rinex the RINEX data object, source of data to be printed
- *@param timeInterval the values defining the interval and the limits to be checked
- *@param plog a pointer to a Logger to be used to record logging messages
- *@return  the exit status
- */
-int generateGalNavCSV(FILE *inFile, FILE* outFile, RinexData &rinex, TimeIntervalParams &timeInterval, Logger* plog) {
-	int anInt;		//a general purpose int variable
-	string aStr;	//a general purpose string variable
-	double aDouble;	//a general purpose double variable
-	char sys;
-	int week, rdStat, sat;
-	double tow, tTag, bo[8][4];
-	int nrec = 0;
-	plog->finer("Print CSV Galileo navigation epochs:");
-	try {
-		fprintf(outFile, "Sys,Sat,Week,TOW,Af0,Af1,Af2,IODE,Crs,Delta N,M0,Cuc,e,Cus,sqrt(A),Toe,Cic,OMEGA0,Cis,i0,Crc,W,WDOT,IDOT,Data sources,Gal Week,SISA,SV health,BGD E5a/E1,BGD E5b/E1,Transm. time\n");
-		while ((rdStat = rinex.readNavEpoch(inFile)) != 0) {
-			if ((rdStat == 1 || rdStat == 2) && timeInInterval(rinex.getEpochTime(week, tow, aDouble, anInt), timeInterval) && rinex.filterNavData()) {	//Epoch nav. data are well formatted
-				if (rinex.getNavData(sys, sat, bo, tTag, 0) && sys == 'E') {
-					nrec++;
-					fprintf(outFile, "%c,%d,%d,%lf", sys, sat, week, tow);
-					for (int j = 1; j != 4; j++) fprintf(outFile, ",%19.12E", bo[0][j]);
-					for (int i = 1; i != 5; i++)
-						for (int j = 0; j != 4; j++) fprintf(outFile, ",%19.12E", bo[i][j]);
-					for (int j = 0; j != 3; j++) fprintf(outFile, ",%19.12E", bo[5][j]);
-					for (int j = 0; j != 4; j++) fprintf(outFile, ",%19.12E", bo[6][j]);
-					fprintf(outFile, ",%19.12E\n", bo[7][0]);
-					rinex.clearNavData();
-				} else plog->warning("Expected GALILEO epoch, but selected an " + string(1, sys) + " sat.");
-			}
-		}
-
-	} catch (string error) {
-		plog->severe(error);
-	}
-	plog->finer("Galileo nav. epochs to CSV:" + to_string((long long) nrec));
-	return nrec;
-}
-
-/**generateGloNavCSV prints GLONASSo navigation data in CVS format
- *
- *@param inFile the already open input RINEX navigation file, positioned just after the End of Header record, in the first epoch 
- *@param outFile the already open print stream where header data will be printed in CVS format
- *@param rinex the RINEX data object, source of data to be printed
- *@param timeInterval the values defining the interval and the limits to be checked
- *@param plog a pointer to a Logger to be used to record logging messages
- *@return  the exit status
- */
-int generateGloNavCSV(FILE *inFile, FILE* outFile, RinexData &rinex, TimeIntervalParams &timeInterval, Logger* plog) {
-	int anInt;		//a general purpose int variable
-	string aStr;	//a general purpose string variable
-	double aDouble;	//a general purpose double variable
-	char sys;
-	int week, rdStat, sat;
-	double tow, tTag, bo[8][4];
-	int nrec = 0;
-	plog->finer("Print CSV GLONASS navigation epochs:");
-	try {
-		fprintf(outFile, "Sys,Sat,Week,TOW,-TauN,+GammaN,Msg.frm.t,Sat.X,Sat.vel.X,Sat.acc.X,Sat.health,Sat.Y,Sat.vel.Y,Sat.acc.Y,Sat.frq.,Sat.Z,Sat.vel.Z,Sat.acc.Z,Age\n");
-		while ((rdStat = rinex.readNavEpoch(inFile)) != 0) {
-			if ((rdStat == 1 || rdStat == 2) && timeInInterval(rinex.getEpochTime(week, tow, aDouble, anInt), timeInterval) && rinex.filterNavData()) {	//Epoch nav. data are well formatted
-				if (rinex.getNavData(sys, sat, bo, tTag, 0) && sys == 'R') {
-					nrec++;
-					fprintf(outFile, "%c,%d,%d,%lf", sys, sat, week, tow);
-					for (int j = 1; j != 4; j++) fprintf(outFile, ",%19.12E", bo[0][j]);
-					for (int i = 1; i != 4; i++)
-						for (int j = 0; j != 4; j++) fprintf(outFile, ",%19.12E", bo[i][j]);
-					fprintf(outFile, "\n");
-					rinex.clearNavData();
-				} else plog->warning("Expected GLONASS epoch, but selected an " + string(1, sys) + " sat.");
-			}
-		}
-
-	} catch (string error) {
-		plog->severe(error);
-	}
-	plog->finer("GLONASS nav. epochs to CSV:" + to_string((long long) nrec));
-	return nrec;
-}
-
-/**generateSBASNavCSV prints SBAS navigation data in CVS format
- *
- *@param inFile the already open input RINEX navigation file, positioned just after the End of Header record, in the first epoch 
- *@param outFile the already open print stream where header data will be printed in CVS format
- *@param rinex the RINEX data object, source of data to be printed
- *@param timeInterval the values defining the interval and the limits to be checked
- *@param plog a pointer to a Logger to be used to record logging messages
- *@return  the exit status
- */
-int generateSBASNavCSV(FILE *inFile, FILE* outFile, RinexData &rinex, TimeIntervalParams &timeInterval, Logger* plog) {
-	int anInt;		//a general purpose int variable
-	string aStr;	//a general purpose string variable
-	double aDouble;	//a general purpose double variable
-	char sys;
-	int week, rdStat, sat;
-	double tow, tTag, bo[8][4];
-	int nrec = 0;
-	plog->finer("Print CSV SBAS navigation epochs:");
-	try {
-		fprintf(outFile, "Sys,Sat,Week,TOW,aGf0,aGf1,Transm.time,Sat.X,Sat.vel.X,Sat.acc.X,Sat.health,Sat.Y,Sat.vel.Y,Sat.acc.Y,Sat.URA,Sat.Z,Sat.vel.Z,Sat.acc.Z,IODN\n");
-		while ((rdStat = rinex.readNavEpoch(inFile)) != 0) {
-			if ((rdStat == 1 || rdStat == 2) && timeInInterval(rinex.getEpochTime(week, tow, aDouble, anInt), timeInterval) && rinex.filterNavData()) {	//Epoch nav. data are well formatted
-				if (rinex.getNavData(sys, sat, bo, tTag, 0) && sys == 'S') {
-					nrec++;
-					fprintf(outFile, "%c,%d,%d,%lf", sys, sat, week, tow);
-					for (int j = 1; j != 4; j++) fprintf(outFile, ",%19.12E", bo[0][j]);
-					for (int i = 1; i != 4; i++)
-						for (int j = 0; j != 4; j++) fprintf(outFile, ",%19.12E", bo[i][j]);
-					fprintf(outFile, "\n");
-					rinex.clearNavData();
-				} else plog->warning("Expected SBAS epoch, but selected an " + string(1, sys) + " sat.");
-			}
-		}
-	} catch (string error) {
-		plog->severe(error);
-	}
-	plog->finer("GBAS nav. epochs to CSV:" + to_string((long long) nrec));
-	return nrec;
-}
@@ -3,10 +3,14 @@
  *<p>Usage:
  *<p>RINEXtoRINEX.exe {options} InputRINEXfilename
  *<p>Options are:
+ *	- -e MINELEV or --minelev=MINELEV : Minimum elevation in degrees of satellites whose observations are selected (requires -n). Default value: no elevation mask
  *	- -f FROMT or --fromtime=FROMT : Select epochs from the given date and time (comma separated yyyy,mm,dd,hh,mm,sec. Default value: 1st epoch in the input file
  *	- -k or --skipe : Skip epochs with erroneus data. Default value false
  *	- -h or --help : Show usage data and stops. Default value HELP=FALSE
+ *	- -i or --index : Use an epoch index file (input file name + .idx) to read only epochs in the time interval. The index is created if it does not exist. Default value false
+ *	- -j THREADS or --threads=THREADS : Number of threads used to read input observation epochs in parallel. Default value THREADS = 1 (sequential reading)
  *	- -l LOGLEVEL or --llevel=LOGLEVEL : Maximum level to log (SEVERE, WARNING, INFO, CONFIG, FINE, FINER, FINEST). Default value LOGLEVEL = INFO
+ *	- -n NAVFILE or --navfile=NAVFILE : RINEX navigation file with the ephemerides used to compute satellite elevations. Default value: none
  *	- -o OBSLST or --selobs=OBSLST : List of selected system-observables (ver.3.02 notation) from input (a comma separated list, like GC1C,GL1C). Default value is all selected.
  *	- -p OBS2LST or --selobs2=OBS2LST : List of selected system-observables (ver.2.10 notation) from input (comma separated list, like GC1,GL1,GL2). Default value is all selected.
  *	- -r RINEX or --rinex=RINEX : Output RINEX file name prefix. Default value RINEX = RTOR
@@ -14,6 +18,9 @@
  *	- -t TOT or --totime=TOT : Select epochs before the given date and time (comma separated yyyy,mm,dd,hh,mm,sec. Default value: last epoch in the input file
  *	- -u RUNBY or --runby=RUNBY : Who runs the RINEX file generation. Default value: Not specified
  *	- -v VER or --ver=VER : RINEX version to generate (V210, V302). Default value VER = TBD (same as input)
+ *	- -w HDSATS or --hdsats=HDSATS : Patch the header of the observation file with the INTERVAL, TIME OF LAST OBS, # OF SATELLITES and PRN / # OF OBS
+ *	  records computed from the epochs printed, reserving PRN / # OF OBS lines for up to HDSATS satellites. Default value HDSATS = 0 (no patching)
+ *	- -z MINSNR or --minsnr=MINSNR : Minimum signal to noise ratio (S1 observable, dB-Hz) of satellites whose observations are selected. Default value: no SNR mask
  *<p>
  *Copyright 2016 Francisco Cancillo
  *<p>
@@ -47,7 +54,7 @@ const string MYVER = " V1.1";
 ///The parser object to store options and operators passed in the comman line
 ArgParser parser;
 //Metavariables for options
-int AEND, BIAS, FROMT, GPS, HELP, LOGLEVEL, MINSV, OUTRINEX, RUNBY, SELOBS3, SELOBS2, SELSAT, SKIPE, TOT, VER;
+int AEND, BIAS, FROMT, GPS, HDSATS, HELP, INDEX, LOGLEVEL, MINELEV, MINSNR, MINSV, NAVFILE, OUTRINEX, RUNBY, SELOBS3, SELOBS2, SELSAT, SKIPE, THREADS, TOT, VER;
 //Metavariables for operators
 int INRINEX;
 //@endcond 
@@ -76,6 +83,8 @@ int main(int argc, char* argv[]) {
 	/// 1 - Defines and sets the error logger object
 	Logger log("LogFile.txt", string(), string(argv[0]) + MYVER + string(" START"));
 	/// 2 - Setups the valid options in the command line. They will be used by the argument/option parser
+	MINSNR = parser.addOption("-z", "--minsnr", "MINSNR", "Minimum signal to noise ratio (S1, dB-Hz) of satellites whose observations are selected", "");
+	HDSATS = parser.addOption("-w", "--hdsats", "HDSATS", "Patch observation header records computed from epochs, reserving PRN / # OF OBS lines for up to HDSATS satellites", "0");
 	VER = parser.addOption("-v", "--ver", "VER", "RINEX version to generate (V210, V302)", "TBD");
 	RUNBY = parser.addOption("-u", "--runby", "RUNBY", "Who runs the RINEX file generation", "Run by");
 	TOT = parser.addOption("-t", "--totime=TOT", "TOT", "Select epochs before the given date and time (comma separated yyyy,mm,dd,hh,mm,sec", "");
@@ -83,10 +92,14 @@ int main(int argc, char* argv[]) {
 	OUTRINEX = parser.addOption("-r", "--rinex", "RINEX", "RINEX file name prefix", "RTOR");
 	SELOBS2 = parser.addOption("-p", "--selobs2", "SELOBS2", "Select system-observable (ver.2.10 notation) from input (comma separated list, like C1,L1,L2)", "");
 	SELOBS3 = parser.addOption("-o", "--selobs", "SELOBS3", "Select system-observable (ver.3.02 notation) from input (comma separated list, like GC1C,GL1C)", "");
+	NAVFILE = parser.addOption("-n", "--navfile", "NAVFILE", "RINEX navigation file with ephemerides to compute satellite elevations", "");
 	LOGLEVEL = parser.addOption("-l", "--llevel", "LOGLEVEL", "Maximum level to log (SEVERE, WARNING, INFO, CONFIG, FINE, FINER, FINEST)", "INFO");
 	HELP = parser.addOption("-h", "--help", "HELP", "Show usage data and stops", false);
+	INDEX = parser.addOption("-i", "--index", "INDEX", "Use an epoch index file (input file name + .idx) to read only epochs in the time interval", false);
+	THREADS = parser.addOption("-j", "--threads", "THREADS", "Number of threads used to read input observation epochs in parallel", "1");
 	SKIPE = parser.addOption("-k", "--skipe", "SKIPE", "Skip epochs with erroneus data", false);
 	FROMT = parser.addOption("-f", "--fromtime=FROMT", "FROMT", "Select epochs from the given date and time (comma separated yyyy,mm,dd,hh,mm,sec", "");
+	MINELEV = parser.addOption("-e", "--minelev", "MINELEV", "Minimum elevation (degrees) of satellites whose observations are selected (requires -n)", "");
 	/// 3- Setups the default values for operators in the command line
 	INRINEX = parser.addOperator("RINEX.DAT");
 	/// 4 - Parses arguments in the command line extracting options and operators
@@ -143,7 +156,9 @@ int main(int argc, char* argv[]) {
 	if (aStr.compare("TBD") == 0) rinexVer = RinexData::VTBD;
 	else if (aStr.compare("V302") == 0) rinexVer = RinexData::V302;
 	RinexData rinex(rinexVer, &log);
+	rinex.setReadThreads(stoi(parser.getStrOpt(THREADS)));
 	double aDouble;
+	int anInt;
 	char fileType = ' ';
 	char sysId = ' ';
 	try {
@@ -169,13 +184,45 @@ int main(int argc, char* argv[]) {
 	}
 	if (!rinex.setFilter(getTokens(parser.getStrOpt(SELSAT), ','), obsTokens))
 		log.warning("Error in some data filtering parameters. Erroneous data ignored");
+	/// 9.1 - Set elevation and signal to noise ratio masks, if any. Ephemerides to compute elevations are read from the given navigation file
+	RinexData navRinex(RinexData::VTBD, &log);
+	aStr = parser.getStrOpt(MINELEV);
+	if (!aStr.empty()) {
+		if (sscanf(aStr.c_str(), "%lf", &aDouble) != 1) {
+			log.severe("Cannot state the elevation mask");
+			return 4;
+		}
+		FILE* navFile;
+		string navFileName = parser.getStrOpt(NAVFILE);
+		if (navFileName.empty()) log.warning("Elevation mask ignored: a navigation file is required");
+		else if ((navFile = fopen(navFileName.c_str(), "r")) == NULL) log.warning("Elevation mask ignored: cannot open file " + navFileName);
+		else {
+			try {
+				navRinex.readRinexHeader(navFile);
+				while (((anInt = navRinex.readNavEpoch(navFile)) != 0) && (anInt != 9));
+			}  catch (string error) {
+				log.warning(error);
+			}
+			fclose(navFile);
+			log.info("Ephemerides for elevation mask: " + to_string((long long) navRinex.getEphemerisStore()->size()));
+			rinex.setElevationMask(aDouble, navRinex.getEphemerisStore());
+		}
+	}
+	aStr = parser.getStrOpt(MINSNR);
+	if (!aStr.empty()) {
+		if (sscanf(aStr.c_str(), "%lf", &aDouble) != 1) {
+			log.severe("Cannot state the signal to noise ratio mask");
+			return 4;
+		}
+		rinex.setSnrMask(aDouble);
+	}
 	bool skipe;
+	bool timeOrdered;
 	string outFileName;
 	FILE* outFile;
 	int goodCount = 0;
 	int badCount = 0;
 	int skipCount = 0;
-	int anInt;
 	switch (fileType) {
 	case 'O':
 		try {
@@ -188,11 +235,15 @@ int main(int argc, char* argv[]) {
 				log.severe("Cannot create file " + outFileName);
 				return 6;
 			}
-		/// 10.1 -  prints new RINEX header ...
+		/// 10.1 -  prints new RINEX header, reserving lines for records to be patched if requested ...
+			rinex.setHeaderPatch(stoi(parser.getStrOpt(HDSATS)));
 			rinex.printObsHeader(outFile);
 		/// 10.2 - ... and iterate over input file extracting epoch by epoch data and printing them
 			rinex.clearHeaderData();
 			skipe = parser.getBoolOpt(SKIPE);
+			//if an epoch index is used, go to the first epoch in the interval. Epochs are in time order
+			timeOrdered = parser.getBoolOpt(INDEX) && rinex.setEpochIndex(inFile, fileName + ".idx");
+			if (timeOrdered && fromTime) rinex.seekObsEpoch(inFile, fromTimeTag);
 			while ((anInt = rinex.readObsEpoch(inFile)) != 0) {
 				if (fromTime) {
 					rinex.getEpochTime(week, tow, aDouble, minute);
@@ -205,6 +256,7 @@ int main(int argc, char* argv[]) {
 					rinex.getEpochTime(week, tow, aDouble, minute);
 					if (toTimeTag <= getSecsGPSEphe(week, tow)) {
 						log.finer("Epoch after interval");
+						if (timeOrdered) break;
 						continue;
 					}
 				}
@@ -242,6 +294,8 @@ int main(int argc, char* argv[]) {
 			fclose(outFile);
 			return 5;
 		}
+		/// 10.3 - patch the header records reserved with data from epochs printed
+		rinex.patchObsHeader(outFile);
 		fclose(outFile);
 		break;
 	case 'N':
@@ -0,0 +1,175 @@
+/** @file EphemerisStore.cpp
+ * Contains the implementation of the EphemerisStore class.
+ */
+
+#include "EphemerisStore.h"
+
+#include <math.h>
+
+//from CommonClasses
+#include "Utilities.h"
+
+/**Constructs an empty EphemerisStore object.
+ */
+EphemerisStore::EphemerisStore(void) {
+	nEphemeris = 0;
+}
+
+/**Destructs EphemerisStore objects.
+ */
+EphemerisStore::~EphemerisStore(void) {
+}
+
+/**add stores the given navigation data of a satellite, computing its reference time and fit interval.
+ *<p>For GPS, QZSS and Galileo the reference time is the Toe computed from the week and Toe in the broadcast orbit data.
+ *If they are not consistent with the given time tag (more than half a week apart), the time tag is used.
+ *
+ * @param sys the satellite system identifier (G,E,R, ...)
+ * @param sat the satellite PRN the navigation data belongs
+ * @param bo the broadcast orbit data with the eight lines of RINEX navigation data with four parameters each
+ * @param tTag the time tag (Toc) of the navigation data
+ * @return true if data have been stored, false if the store already has navigation data for this satellite and time tag
+ */
+bool EphemerisStore::add(char sys, int sat, double bo[8][4], double tTag) {
+	Ephemeris eph;
+	eph.systemId = sys;
+	eph.satellite = sat;
+	eph.navTimeTag = tTag;
+	for (int i=0; i<8; i++)
+		for (int j=0; j<4; j++)
+			eph.broadcastOrbit[i][j] = bo[i][j];
+	double halfFit;
+	eph.refTime = tTag;
+	switch (sys) {
+	case 'G':
+	case 'J':
+	case 'E':
+		if (bo[5][2] > 0.0) {
+			eph.refTime = getSecsGPSEphe((int) bo[5][2], bo[3][0]);	//week and Toe
+			if (fabs(eph.refTime - tTag) > 302400.0) eph.refTime = tTag;
+		}
+		if (sys == 'E') halfFit = GALHALFFIT;
+		else halfFit = bo[7][1] > 0.0? bo[7][1] * 1800.0 : GPSDEFFIT;	//fit interval in hours
+		break;
+	case 'C':
+		halfFit = BDSHALFFIT;
+		break;
+	case 'R':
+		halfFit = GLOHALFFIT;
+		break;
+	case 'S':
+		halfFit = SBSHALFFIT;
+		break;
+	default:
+		halfFit = DEFHALFFIT;
+		break;
+	}
+	eph.fitBegin = eph.refTime - halfFit;
+	eph.fitEnd = eph.refTime + halfFit;
+	SatEphemerides &satEph = satEphemerides[satKey(sys, sat)];
+	vector<Ephemeris> &ephs = satEph.ephemeris;
+	//binary search of the position where data shall be inserted: after the ones having lower or equal reference time and time tag
+	size_t low = 0;
+	size_t high = ephs.size();
+	//usually data are added in time order: check first if they shall be appended
+	if ((high > 0) && ((eph.refTime < ephs[high-1].refTime) || ((eph.refTime == ephs[high-1].refTime) && (tTag < ephs[high-1].navTimeTag)))) {
+		high--;
+		while (low < high) {
+			size_t mid = (low + high) / 2;
+			if ((eph.refTime < ephs[mid].refTime) || ((eph.refTime == ephs[mid].refTime) && (tTag < ephs[mid].navTimeTag))) high = mid;
+			else low = mid + 1;
+		}
+	}
+	if ((high > 0) && (ephs[high-1].refTime == eph.refTime) && (ephs[high-1].navTimeTag == tTag)) return false;
+	ephs.insert(ephs.begin() + high, eph);
+	if (halfFit > satEph.maxHalfFit) satEph.maxHalfFit = halfFit;
+	nEphemeris++;
+	return true;
+}
+
+/**find searches the best ephemeris of the given satellite to be used at the given instant:
+ * the one valid at this instant having the nearest reference time (the latest one in case of tie).
+ *<p>The last ephemeris found for the satellite is checked first. If it is not valid or not the nearest one, a binary search
+ * is made, followed by a search of valid ones in order of distance to the instant, up to the maximum fit interval.
+ *
+ * @param sys the satellite system identifier (G,E,R, ...)
+ * @param sat the satellite PRN
+ * @param t the instant in seconds from the GPS ephemeris
+ * @return a pointer to the ephemeris found, or NULL if no valid one exists. It may be invalidated when new data are added
+ */
+const EphemerisStore::Ephemeris* EphemerisStore::find(char sys, int sat, double t) {
+	unordered_map<int, SatEphemerides>::iterator itSat = satEphemerides.find(satKey(sys, sat));
+	if (itSat == satEphemerides.end()) return NULL;
+	SatEphemerides &satEph = itSat->second;
+	vector<Ephemeris> &ephs = satEph.ephemeris;
+	size_t n = ephs.size();
+	if ((satEph.lastHit < n)
+		&& (ephs[satEph.lastHit].fitBegin <= t) && (t <= ephs[satEph.lastHit].fitEnd)
+		&& isNearest(ephs, satEph.lastHit, t)) return &ephs[satEph.lastHit];
+	//binary search of the first ephemeris having reference time after t
+	size_t left = 0;
+	size_t right = n;
+	while (left < right) {
+		size_t mid = (left + right) / 2;
+		if (t < ephs[mid].refTime) right = mid;
+		else left = mid + 1;
+	}
+	//check candidates in order of distance to t, at both sides of the found position
+	double dLeft, dRight;
+	size_t pos;
+	while (true) {
+		dLeft = left > 0? t - ephs[left-1].refTime : HUGE_VAL;
+		dRight = right < n? ephs[right].refTime - t : HUGE_VAL;
+		if (dRight <= dLeft) {
+			if (dRight > satEph.maxHalfFit) return NULL;
+			pos = right++;
+		} else {
+			if (dLeft > satEph.maxHalfFit) return NULL;
+			pos = --left;
+		}
+		if ((ephs[pos].fitBegin <= t) && (t <= ephs[pos].fitEnd)) {
+			satEph.lastHit = pos;
+			return &ephs[pos];
+		}
+	}
+}
+
+/**size provides the number of ephemerides stored.
+ *
+ * @return the number of ephemerides stored
+ */
+unsigned int EphemerisStore::size() {
+	return nEphemeris;
+}
+
+/**clear removes all ephemerides stored.
+ */
+void EphemerisStore::clear() {
+	satEphemerides.clear();
+	nEphemeris = 0;
+}
+
+/**satKey computes the key used to identify the ephemerides of a satellite.
+ *
+ * @param sys the satellite system identifier (G,E,R, ...)
+ * @param sat the satellite PRN
+ * @return the satellite key
+ */
+int EphemerisStore::satKey(char sys, int sat) {
+	return ((int) (unsigned char) sys << 16) | (sat & 0xFFFF);
+}
+
+/**isNearest checks if the ephemeris in the given position has the reference time nearest to the given instant.
+ * In case of tie, the latest one is considered the nearest.
+ *
+ * @param eph the ephemerides of a satellite, sorted by reference time
+ * @param pos the position of the ephemeris to check
+ * @param t the instant in seconds from the GPS ephemeris
+ * @return true if it is the nearest one, false otherwise
+ */
+bool EphemerisStore::isNearest(const vector<Ephemeris> &eph, size_t pos, double t) {
+	double distance = fabs(eph[pos].refTime - t);
+	if ((pos > 0) && (fabs(eph[pos-1].refTime - t) < distance)) return false;
+	if ((pos + 1 < eph.size()) && (fabs(eph[pos+1].refTime - t) <= distance)) return false;
+	return true;
+}
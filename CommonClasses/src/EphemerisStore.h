@@ -0,0 +1,82 @@
+/** @file EphemerisStore.h
+ * Contains the EphemerisStore class definition used to find the navigation data (ephemeris) of a satellite valid at a given instant.
+ *
+ *Copyright 2015 Francisco Cancillo
+ *<p>
+ *This file is part of the RXtoRINEX tool.
+ *<p>
+ *RXtoRINEX is free software: you can redistribute it and/or modify it under the terms of the GNU General Public License
+ *as published by the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+ *RXtoRINEX is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ *warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *See the GNU General Public License for more details.
+ *<p>
+ *A copy of the GNU General Public License can be found at <http://www.gnu.org/licenses/>.
+ *<p>Ver.	|Date	|Reason for change
+ *<p>---------------------------------
+ *<p>V1.0	|10/2026	|First release
+ */
+#ifndef EPHEMERISSTORE_H
+#define EPHEMERISSTORE_H
+
+#include <vector>
+#include <unordered_map>
+
+using namespace std;
+
+//@cond DUMMY
+//Half of the interval around the reference time where an ephemeris is considered valid, in seconds
+const double GPSDEFFIT = 2.0 * 3600.0;	//GPS and QZSS when the RINEX fit interval is not known (4 hours)
+const double GALHALFFIT = 2.0 * 3600.0;	//Galileo (4 hours)
+const double BDSHALFFIT = 1.0 * 3600.0;	//BeiDou (2 hours)
+const double GLOHALFFIT = 15.0 * 60.0;	//GLONASS (30 minutes)
+const double SBSHALFFIT = 5.0 * 60.0;	//SBAS (10 minutes)
+const double DEFHALFFIT = 2.0 * 3600.0;	//any other system (4 hours)
+//@endcond
+
+/**EphemerisStore class keeps the navigation data (ephemerides) of satellites to find efficiently the one to be used at a given instant.
+ *<p>Ephemerides are arranged per satellite into arrays sorted by their reference time: the Toe for GPS, QZSS and Galileo, and
+ *the Toc (the time tag of the RINEX navigation record) for the rest of systems.
+ *Each ephemeris has a fit interval around its reference time where it is valid. For GPS and QZSS it is computed from the
+ *fit interval stated in the broadcast orbit data. For the rest of systems the nominal validity period of the system is used.
+ *<p>The best ephemeris for a satellite at a given instant is the valid one having the reference time nearest to the instant
+ *(the latest one in case of tie). It is found using binary search, and the last one found for each satellite is cached, because
+ *usually consecutive searches are made for close instants.
+ *<p>Broadcast orbit data are arranged as per RINEX navigation files: eight lines with four parameters each, where line 0 contains
+ *in the positions 1 to 3 the clock parameters. Time tags are stated in seconds from the GPS ephemeris (see getSecsGPSEphe).
+ *<p>Note that pointers to ephemerides provided by find may be invalidated when new ones are added.
+ */
+class EphemerisStore {
+public:
+	struct Ephemeris {	//the navigation data of a satellite and its validity period
+		char systemId;	//the system identification (G, E, R, ...)
+		int satellite;	//the PRN of the satellite navigation data belong
+		double navTimeTag;	//the time tag (Toc) of the navigation data
+		double refTime;	//the reference time used for searches (Toe or Toc)
+		double fitBegin;	//the first instant where the ephemeris is valid
+		double fitEnd;		//the last instant where the ephemeris is valid
+		double broadcastOrbit[8][4];	//the eigth lines of RINEX navigation data, with four parameters each
+	};
+	EphemerisStore(void);
+	~EphemerisStore(void);
+	bool add(char sys, int sat, double bo[8][4], double tTag);
+	const Ephemeris* find(char sys, int sat, double t);
+	unsigned int size();
+	void clear();
+
+private:
+	struct SatEphemerides {	//the ephemerides of a satellite
+		vector <Ephemeris> ephemeris;	//ephemerides sorted by reference time and time tag
+		double maxHalfFit;	//the maximum half fit interval of the stored ephemerides
+		size_t lastHit;		//the position of the last ephemeris found, for caching purposes
+		SatEphemerides() {
+			maxHalfFit = 0.0;
+			lastHit = 0;
+		};
+	};
+	unordered_map <int, SatEphemerides> satEphemerides;	//the ephemerides of each satellite, by satellite key
+	unsigned int nEphemeris;	//the total number of ephemerides stored
+	static int satKey(char sys, int sat);
+	static bool isNearest(const vector<Ephemeris> &eph, size_t pos, double t);
+};
+#endif
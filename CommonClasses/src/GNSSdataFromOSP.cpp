@@ -3,6 +3,10 @@
  *
  */
 #include <stdio.h>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
 
 #include "GNSSdataFromOSP.h"
 //from CommonClasses
@@ -13,6 +17,13 @@
 	if (message.payloadLen() != LENGTH) { \
 		plog->warning(ERROR_MSG); \
 	}
+///Macro to decode the message payload into the given data structure as per its layout (see OSPDecoder), and to log an error message if
+///the payload does not contain all data to be extracted
+#define CHECK_DECODE(DATA, MSG_NAME) \
+	if (!OSPDecoder::decode(message, DATA)) { \
+		plog->severe(string(MSG_NAME) + msgEOM + to_string((long long) message.payloadLen())); \
+		return false; \
+	}
 ///Macro to check if the number of satellites in the fix is lower than required and to log an error message if true 
 #define CHECK_SATSREQUIRED(NSV, ERROR_MSG) \
 	if (NSV < minSVSfix) { \
@@ -20,6 +31,315 @@
 		return false; \
 	}
 
+//The results of processing a message when acquiring epoch data (see acqEpochMessage)
+const int MSGOTHER = 0;		//a message without epoch time, or with a time not valid
+const int MSGEPOCHTIME = 1;	//a MID7 with a valid epoch time. No epoch data saved
+const int MSGEPOCH = 2;		//a MID7 with a valid epoch time, and epoch data have been saved
+
+//Compile time tables used to extract ephemeris from navigation messages and to convert them to values in actual units
+/**pow2 computes at compile time the power of 2 for the given exponent, used to define scale factors.
+ *
+ * @param n the exponent
+ * @return 2 raised to n
+ */
+static constexpr double pow2(int n) {
+	return n == 0? 1.0 : (n > 0? 2.0 * pow2(n-1) : 0.5 * pow2(n+1));
+}
+
+///The scale factors to apply to GPS broadcast orbit data to obtain ephemeris (see GPS ICD)
+static constexpr double GPS_SCALEFACTOR[8][4] = {
+	{pow2(4), pow2(-31), pow2(-43), pow2(-55)},					//T0c, Af0: SV clock bias, Af1: SV clock drift, Af2: SV clock drift rate
+	{1.0, pow2(-5), pow2(-43) * ThisPI, pow2(-31) * ThisPI},	//IODE, Crs, Delta N, M0
+	{pow2(-29), pow2(-33), pow2(-29), pow2(-19)},				//Cuc, e, Cus, sqrt(A)
+	{pow2(4), pow2(-29), pow2(-31) * ThisPI, pow2(-29)},		//TOE, Cic, Omega0, Cis
+	{pow2(-31) * ThisPI, pow2(-5), pow2(-31) * ThisPI, pow2(-43) * ThisPI},	//i0, Crc, w, w dot
+	{pow2(-43) * ThisPI, 1.0, 1.0, 1.0},						//Idot, codes on L2, GPS week + 1024, L2 P data flag
+	{1.0, 1.0, pow2(-31), 1.0},									//SV accuracy (index), SV health, TGD, IODC
+	{0.01, 1.0, 0.0, 0.0}										//Transmission time of message in sec x 100, Fit interval, Spare, Spare
+};
+///The User Range Accuracy values in meters corresponding to URA index in the GPS SV broadcast data (see GPS ICD 20.3.3.3.1.3)
+static constexpr double GPS_URA[16] = {
+	2.0, 2.8, 4.0, 5.7, 8.0, 11.3, pow2(4), pow2(5), pow2(6), pow2(7), pow2(8), pow2(9), pow2(10), pow2(11), pow2(12), 6144.00
+};
+///The scale factors to apply to GLONASS broadcast orbit data to obtain ephemeris (see GLONASS ICD)
+static constexpr double GLO_SCALEFACTOR[4][4] = {
+	{1.0, pow2(-30), pow2(-40), 1.0},			//T0c, -TauN, +GammaN, Message frame time
+	{pow2(-11), pow2(-20), pow2(-30), 1.0},		//X, Vel X, Accel X, SV Health
+	{pow2(-11), pow2(-20), pow2(-30), 1.0},		//Y, Vel Y, Accel Y, Frequency number
+	{pow2(-11), pow2(-20), pow2(-30), 1.0}		//Z, Vel Z, Accel Z, Age of oper.
+};
+
+///The coding of a field in navigation messages
+enum NavCoding {
+	NAV_UNSIGNED,	//unsigned integer
+	NAV_TWOSCOMPL,	//two's complement signed integer (GPS)
+	NAV_SIGNMAGN	//sign and magnitude signed integer (GLONASS)
+};
+///The layout of an ephemeris field in the navigation message, and the place of its mantissa in the broadcast orbit arrangement
+struct NavField {
+	unsigned char row, col;	//the line and parameter in the broadcast orbit arrangement
+	unsigned char word;		//GPS: the navigation word containing the field MSB. GLONASS: the string index (string number - 1)
+	unsigned char bit;		//GPS: the position of the field MSB in the word. GLONASS: the position in the string of the field LSB (bit 1 is position 0)
+	unsigned char len;		//the number of bits in the field
+	NavCoding coding;		//how the field value is coded
+};
+///The GPS ephemeris fields in navigation words arranged as per MID 15 (see SiRF ICD A.5). Fields not stated are computed in extractGPSEphemeris
+static constexpr NavField GPS_EPHFIELDS[] = {
+	{0, 0, 11, 15, 16, NAV_UNSIGNED},	//T0C
+	{0, 1, 13,  7, 22, NAV_TWOSCOMPL},	//Af0
+	{0, 2, 12,  7, 16, NAV_TWOSCOMPL},	//Af1
+	{0, 3, 12, 15,  8, NAV_TWOSCOMPL},	//Af2
+	{1, 0, 18, 15,  8, NAV_UNSIGNED},	//IODE
+	{1, 1, 18,  7, 16, NAV_TWOSCOMPL},	//Crs
+	{1, 2, 19,  7, 16, NAV_TWOSCOMPL},	//Delta n
+	{1, 3, 20,  7, 32, NAV_TWOSCOMPL},	//M0
+	{2, 0, 22,  7, 16, NAV_TWOSCOMPL},	//Cuc
+	{2, 1, 23,  7, 32, NAV_UNSIGNED},	//e
+	{2, 2, 25,  7, 16, NAV_TWOSCOMPL},	//Cus
+	{2, 3, 26,  7, 32, NAV_UNSIGNED},	//sqrt(A)
+	{3, 0, 28,  7, 16, NAV_UNSIGNED},	//Toe
+	{3, 1, 33, 15, 16, NAV_TWOSCOMPL},	//Cic
+	{3, 2, 34, 15, 32, NAV_TWOSCOMPL},	//OMEGA
+	{3, 3, 36, 15, 16, NAV_TWOSCOMPL},	//CIS
+	{4, 0, 37, 15, 32, NAV_TWOSCOMPL},	//i0
+	{4, 1, 39, 15, 16, NAV_TWOSCOMPL},	//Crc
+	{4, 2, 40, 15, 32, NAV_TWOSCOMPL},	//w (omega)
+	{4, 3, 42, 15, 24, NAV_TWOSCOMPL},	//w dot
+	{5, 0, 44, 15, 14, NAV_TWOSCOMPL},	//IDOT
+	{5, 1,  3,  5,  2, NAV_UNSIGNED},	//Codes on L2
+	{5, 2,  3, 15, 10, NAV_UNSIGNED},	//GPS week# (without rollover)
+	{5, 3,  4,  7,  1, NAV_UNSIGNED},	//L2P data flag
+	{6, 0,  3,  3,  4, NAV_UNSIGNED},	//SV accuracy
+	{6, 1,  4, 15,  6, NAV_UNSIGNED},	//SV health
+	{6, 2, 10, 15,  8, NAV_TWOSCOMPL},	//TGD
+	{7, 1, 29,  7,  1, NAV_UNSIGNED}	//Fit flag
+};
+///The GLONASS ephemeris fields in strings 1 to 4 (see GLONASS ICD). Fields not stated are computed in extractGLOEphemeris
+static constexpr NavField GLO_EPHFIELDS[] = {
+	{0, 1, 3, 58, 22, NAV_SIGNMAGN},	//Clock bias TauN: bits 80-59 string 4
+	{0, 2, 2, 68, 11, NAV_SIGNMAGN},	//Relative frequency bias GammaN: bits 79-69 string 3
+	{1, 0, 0,  8, 27, NAV_SIGNMAGN},	//Satellite position, X: bits 35-9 string 1
+	{1, 1, 0, 40, 24, NAV_SIGNMAGN},	//Satellite velocity, X: bits 64-41 string 1
+	{1, 2, 0, 35,  5, NAV_SIGNMAGN},	//Satellite acceleration, X: bits 40-36 string 1
+	{1, 3, 1, 77,  3, NAV_UNSIGNED},	//Satellite health Bn: bits 80-78 string 2
+	{2, 0, 1,  8, 27, NAV_SIGNMAGN},	//Satellite position, Y: bits 35-9 string 2
+	{2, 1, 1, 40, 24, NAV_SIGNMAGN},	//Satellite velocity, Y: bits 64-41 string 2
+	{2, 2, 1, 35,  5, NAV_SIGNMAGN},	//Satellite acceleration, Y: bits 40-36 string 2
+	{3, 0, 2,  8, 27, NAV_SIGNMAGN},	//Satellite position, Z: bits 35-9 string 3
+	{3, 1, 2, 40, 24, NAV_SIGNMAGN},	//Satellite velocity, Z: bits 64-41 string 3
+	{3, 2, 2, 35,  5, NAV_SIGNMAGN},	//Satellite acceleration, Z: bits 40-36 string 3
+	{3, 3, 1, 48,  5, NAV_UNSIGNED}		//Age of oper. information (days) (E): bits 53-49 string 2
+};
+
+/**navFieldValue gets the value of a navigation message field from its bits, as per the field coding.
+ *
+ * @param bits the bits of the field, in the LSB positions
+ * @param field the field layout
+ * @return the field value
+ */
+static inline int navFieldValue(unsigned int bits, const NavField &field) {
+	switch (field.coding) {
+	case NAV_TWOSCOMPL: return getTwosComplement(bits, field.len);
+	case NAV_SIGNMAGN: return getSigned(bits, field.len);
+	default: return (int) bits;
+	}
+}
+
+/**getNavWBits gets the bits of a GPS field from the navigation words arranged as per MID 15 (16 effective bits per word).
+ * The field starts at the bit and word stated in its layout, and extends to the following words, MSB first.
+ *
+ * @param navW the navigation words
+ * @param field the field layout
+ * @return the field bits, in the LSB positions
+ */
+static inline unsigned int getNavWBits(const unsigned int (&navW)[45], const NavField &field) {
+	int word = field.word;
+	int nBits = field.bit + 1;
+	unsigned long long bits = navW[word] & ((1U << nBits) - 1);
+	while (nBits < field.len) {
+		bits = (bits << 16) | (navW[++word] & 0xFFFF);
+		nBits += 16;
+	}
+	return (unsigned int) (bits >> (nBits - field.len));
+}
+
+/**DecodedChunk defines the results of decoding a chunk of messages by a decoding thread (see ParallelDecode).
+ * Data acquired are recorded in acquisition order, with the number of deferred logging messages generated before each one.
+ * At each MID7 with a valid time (a sync point), the decoding state which could depend on messages before the chunk
+ * (navigation message data stored by channel and GLONASS slots) is recorded, only when it has changed from the previous one.
+ * The partial epoch and the decoding state at the chunk end are also recorded.
+ */
+struct GNSSdataFromOSP::DecodedChunk {
+	enum ItemType {		//the kinds of data acquired
+		ITEM_TIME,		//an epoch time
+		ITEM_EPOCH,		//the observables of an epoch
+		ITEM_NAV		//the ephemeris of a satellite
+	};
+	struct DecodedItem {	//defines data acquired
+		ItemType type;		//the kind of data
+		unsigned int lastMsg;	//the index after the last deferred logging message generated before acquiring them
+		int week;			//the epoch week (epoch time)
+		double tow;			//the epoch TOW (epoch time)
+		double clkBias;		//the receiver clock bias (epoch time and observables)
+		double clkDrift;	//the receiver clock drift (epoch observables)
+		vector<ChannelObs> obs;	//the observables acquired in each channel (epoch observables)
+		char sys;			//the satellite system (ephemeris)
+		unsigned int sat;	//the satellite number (ephemeris)
+		double tTag;		//the time tag (ephemeris)
+		double bo[8][4];	//the broadcast orbit data (ephemeris)
+	};
+	struct DecodeState {	//defines the decoding state which could depend on messages before the chunk
+		SubframeData subfrm[MAXCHANNELS][MAXSUBFR];	//the navigation message data stored for each channel
+		GLONASSslot gloSlots[MAXGLOSATS];			//the GLONASS slot of each satellite
+		//get the state from the given decoder
+		void get (const GNSSdataFromOSP* decoder) {
+			memcpy(subfrm, decoder->subfrmCh, sizeof subfrm);
+			memcpy(gloSlots, decoder->satGLOslt, sizeof gloSlots);
+		};
+		//set this state into the given decoder
+		void set (GNSSdataFromOSP* decoder) const {
+			memcpy(decoder->subfrmCh, subfrm, sizeof subfrm);
+			memcpy(decoder->satGLOslt, gloSlots, sizeof gloSlots);
+		};
+		//compare with the state of the given decoder. Words of empty subframe storage are never used, and are not compared
+		bool matches (const GNSSdataFromOSP* decoder) const {
+			for (int i = 0; i < MAXCHANNELS; i++)
+				for (int j = 0; j < MAXSUBFR; j++) {
+					if (subfrm[i][j].sv != decoder->subfrmCh[i][j].sv) return false;
+					if ((subfrm[i][j].sv != 0) && (memcmp(subfrm[i][j].words, decoder->subfrmCh[i][j].words, sizeof subfrm[i][j].words) != 0)) return false;
+				}
+			for (int i = 0; i < MAXGLOSATS; i++)
+				if ((gloSlots[i].slot != decoder->satGLOslt[i].slot) || (gloSlots[i].rcvCh != decoder->satGLOslt[i].rcvCh)) return false;
+			return true;
+		};
+	};
+	struct SyncPoint {		//defines a MID7 with a valid time in the chunk
+		long long end;		//the position after the MID7 message
+		size_t items;		//the number of data items acquired up to it, included
+		unsigned int msgs;	//the number of deferred logging messages generated up to it, included
+		size_t state;		//the index in states of the decoding state after it
+	};
+	long long start;			//the position of the first message in the chunk
+	long long end;				//the position after the last message in the chunk
+	bool done;					//true when the chunk has been decoded
+	Logger* log;				//the logger deferring messages generated decoding the chunk
+	vector <DecodedItem> items;	//the data acquired
+	vector <SyncPoint> syncs;	//the sync points, in file order
+	vector <DecodeState> states;	//the decoding states at sync points
+	DecodeState endState;		//the decoding state at the chunk end
+	int endWeek;				//the epoch time at the chunk end
+	double endTow;
+	double endClkBias;
+	double endClkDrift;
+	vector <ChannelObs> endObs;	//the observables of the partial epoch at the chunk end
+	//constructor
+	DecodedChunk (long long s, long long e) {
+		start = s;
+		end = e;
+		done = false;
+		log = NULL;
+		endWeek = 0;
+		endTow = 0.0;
+		endClkBias = 0.0;
+		endClkDrift = 0.0;
+	};
+	//append a data item of the given type
+	DecodedItem &add (ItemType type) {
+		items.push_back(DecodedItem());
+		items.back().type = type;
+		items.back().lastMsg = log->deferredSize();
+		return items.back();
+	};
+	//append a sync point after the MID7 just processed by the given decoder
+	void addSync (const GNSSdataFromOSP* decoder) {
+		if (states.empty() || !states.back().matches(decoder)) {
+			states.push_back(DecodeState());
+			states.back().get(decoder);
+		}
+		SyncPoint sync = {decoder->reader.tell(), items.size(), log->deferredSize(), states.size() - 1};
+		syncs.push_back(sync);
+	};
+	//save the state of the given decoder at the chunk end
+	void saveEnd (GNSSdataFromOSP* decoder) {
+		endState.get(decoder);
+		endWeek = decoder->epochGPSweek;
+		endTow = decoder->epochGPStow;
+		endClkBias = decoder->epochClkBias;
+		endClkDrift = decoder->epochClkDrift;
+		endObs.swap(decoder->chSatObs);
+	};
+	//set the state at the chunk end into the given decoder
+	void restoreEnd (GNSSdataFromOSP* decoder) {
+		endState.set(decoder);
+		decoder->epochGPSweek = endWeek;
+		decoder->epochGPStow = endTow;
+		decoder->epochClkBias = endClkBias;
+		decoder->epochClkDrift = endClkDrift;
+		decoder->chSatObs.swap(endObs);
+	};
+	//release the memory used by data
+	void release () {
+		delete log;
+		log = NULL;
+		vector<DecodedItem>().swap(items);
+		vector<SyncPoint>().swap(syncs);
+		vector<DecodeState>().swap(states);
+		vector<ChannelObs>().swap(endObs);
+	};
+};
+
+/**ParallelDecode defines the state of a parallel decoding of messages when acquiring epoch data.
+ * The mapped OSP file is split in chunks at message boundaries. Chunks are decoded by the decoding threads, each one using its own
+ * GNSSdataFromOSP object starting from a decoding state without data from former chunks, and recording data acquired (see DecodedChunk).
+ * To acquire data of a chunk, its first messages are decoded sequentially from the actual state up to a sync point where this state
+ * matches the one recorded by the thread, that is, the partial epoch and the partial navigation data sets of former chunks have been
+ * completed or discarded. From there, data recorded are acquired. When there is no such sync point, the whole chunk is decoded sequentially.
+ */
+struct GNSSdataFromOSP::ParallelDecode {
+	vector <DecodedChunk> chunks;	//the chunks the mapped file has been split into
+	size_t toDecode;				//the index of the next chunk to be decoded
+	size_t current;					//the index of the chunk being acquired
+	size_t maxAhead;				//the maximum number of chunks that can be decoded in advance of the current one
+	bool sequential;				//true when messages shall be decoded sequentially
+	bool useMID8G;					//the sources of navigation data (see acqEpochData)
+	bool useMID8R;
+	GLONASSslot gloSlots[MAXGLOSATS];	//the GLONASS slots when decoding started, used as initial state to decode chunks
+	bool synced;					//true when data of the current chunk are acquired from the data recorded
+	size_t nextSync;				//the index in the current chunk of the next sync point to check
+	size_t nextItem;				//the index in the current chunk of the next data item to acquire
+	unsigned int nextMsg;			//the index in the current chunk log of the next deferred message to forward
+	atomic<bool> stop;				//true when decoding threads shall end
+	mutex lock;						//to access chunks state shared between threads
+	condition_variable changed;		//to signal changes in chunks decoded or acquired
+	vector <thread> threads;		//the decoding threads
+	vector <GNSSdataFromOSP*> decoders;	//the GNSSdataFromOSP object used by each decoding thread
+	//constructor & destructor
+	ParallelDecode () {
+		toDecode = current = maxAhead = 0;
+		sequential = useMID8G = useMID8R = synced = false;
+		nextSync = nextItem = 0;
+		nextMsg = 0;
+		stop = false;
+	};
+	~ParallelDecode () {
+		stopThreads();
+	};
+	//stop decoding threads, releasing their resources
+	void stopThreads () {
+		{
+			lock_guard<mutex> guard(lock);
+			stop = true;
+		}
+		changed.notify_all();
+		for (size_t i = 0; i < threads.size(); i++) threads[i].join();
+		threads.clear();
+		for (size_t i = 0; i < decoders.size(); i++) delete decoders[i];
+		decoders.clear();
+		for (size_t i = 0; i < chunks.size(); i++) chunks[i].release();
+		chunks.clear();
+	};
+};
+
 /**Constructs a GNSSdataFromOSP object using parameters passed.
  *
  *@param rcv the receiver name
@@ -33,12 +353,22 @@ GNSSdataFromOSP::GNSSdataFromOSP(string rcv, int minxfix, bool applBias, FILE* f
 	minSVSfix = minxfix;
 	applyBias = applBias;
 	ospFile = f;
+	reader.open(f);
 	plog = pl;
 	dynamicLog = false;
-	for (int i=0; i<MAXCHANNELS; i++)
-		for (int j=0; j<MAXSUBFR; j++)
-			subfrmCh[i][j].sv = 0;
-	setTblValues();
+	epochGPSweek = 0;
+	epochGPStow = epochClkBias = epochClkDrift = 0.0;
+	gpsTimeSet = false;
+	singlePass = false;
+	decodeThreads = 1;
+	parDecode = NULL;
+	recording = NULL;
+	//set tables to 0
+	memset(subfrmCh, 0, sizeof subfrmCh);
+	memset(satGLOslt, 0, sizeof satGLOslt);
+	memset(carrierFreq, 0, sizeof carrierFreq);
+	memset(carrierFreqSet, 0, sizeof carrierFreqSet);
+	memset(nAhnA, 0, sizeof nAhnA);
 }
 
 /**Constructs a GNSSdataFromOSP object using parameters passed, and logging data into the stderr.
@@ -53,20 +383,56 @@ GNSSdataFromOSP::GNSSdataFromOSP(string rcv, int minxfix, bool applBias, FILE* f
 	minSVSfix = minxfix;
 	applyBias = applBias;
 	ospFile = f;
-	for (int i=0; i<MAXCHANNELS; i++)
-		for (int j=0; j<MAXSUBFR; j++)
-			subfrmCh[i][j].sv = 0;
+	reader.open(f);
+	//set tables to 0
+	memset(subfrmCh, 0, sizeof subfrmCh);
+	memset(satGLOslt, 0, sizeof satGLOslt);
+	memset(carrierFreq, 0, sizeof carrierFreq);
+	memset(carrierFreqSet, 0, sizeof carrierFreqSet);
+	memset(nAhnA, 0, sizeof nAhnA);
 	plog = new Logger();
 	dynamicLog = true;
-	setTblValues();
+	epochGPSweek = 0;
+	epochGPStow = epochClkBias = epochClkDrift = 0.0;
+	gpsTimeSet = false;
+	singlePass = false;
+	decodeThreads = 1;
+	parDecode = NULL;
+	recording = NULL;
 }
 
 /**Destroys a GNSSdataFromOSP object
  */
 GNSSdataFromOSP::~GNSSdataFromOSP(void) {
+	endParallelDecode();
 	if (dynamicLog) delete plog;
 }
 
+/**rewind restarts data acquisition from the first message in the binary OSP file.
+ * It shall be used instead of rewinding the file stream, as messages are usually read from a mapped image of the file.
+ */
+void GNSSdataFromOSP::rewind() {
+	endParallelDecode();
+	reader.rewind();
+}
+
+/**setIndex states the message index file to be used for the binary OSP file (see OSPReader::setIndex).
+ * When an index is used, header data and GLONASS parameters acquisition only read the messages containing them.
+ * Acquisition restarts from the first message in the file.
+ *
+ * @param idxFileName the name of the message index file
+ * @return true if the index has been loaded or built, false otherwise (messages will be read sequentially)
+ */
+bool GNSSdataFromOSP::setIndex(string idxFileName) {
+	endParallelDecode();
+	if (reader.setIndex(idxFileName)) {
+		plog->info("Message index set from " + idxFileName + ": " + to_string((long long) reader.getIndex().size()) + " messages");
+		return true;
+	}
+	plog->warning("Message index cannot be set. Messages will be read sequentially");
+	return false;
+}
+
 /**acqHeaderData extracts data from the binary OSP file for RINEX file header.
  * The RINEX header data to be extracted from the binary file are:
  * - the receiver identification contained in the first MID6 message
@@ -88,7 +454,8 @@ bool GNSSdataFromOSP::acqHeaderData(RinexData &rinex) {
 	bool intrvSet = false;	//observations interval not set
 	int mid;
 	plog->info("RINEX header data acquisition:");
-	while (message.fill(ospFile) &&		//there are messages in the binary file
+	reader.selectMids(vector<int> {2, 6, 7});	//when a message index is used, only these messages are read
+	while (reader.next(message) &&		//there are messages in the binary file
 			!(apxSet && rxIdSet && frsEphSet && intrvSet)) {	//not all header data have been adquired
 		mid = message.get();		//get first byte (MID)
 		switch(mid) {
@@ -117,6 +484,8 @@ bool GNSSdataFromOSP::acqHeaderData(RinexData &rinex) {
 	logMessage += intrvSet? " Observation interval;" : ";";
 	logMessage += rxIdSet? " Receiver version" : "";
 	plog->info(logMessage);
+	reader.selectMids(vector<int>());
+	setObsHandles(rinex);
 	return (apxSet && frsEphSet && rxIdSet && intrvSet);
 }
 
@@ -140,7 +509,8 @@ bool GNSSdataFromOSP::acqHeaderData(RTKobservation &rtko) {
 	int mid;
 	//acquire mask data and first and last epoch time
 	plog->info("RTK header data acquisition:");
-	while (message.fill(ospFile)) {	//there are messages in the binary file
+	reader.selectMids(vector<int> {2, 19});	//when a message index is used, only these messages are read
+	while (reader.next(message)) {	//there are messages in the binary file
 		mid = message.get();		//get first byte (MID)
 		switch(mid) {
 		case 2:
@@ -164,6 +534,7 @@ bool GNSSdataFromOSP::acqHeaderData(RTKobservation &rtko) {
 	logMessage += fetSet? "1ts epoch time;" : ";";
 	logMessage += maskSet? "Mask data" : "";
 	plog->info(logMessage);
+	reader.selectMids(vector<int>());
 	return maskSet && fetSet;
 }
 
@@ -183,6 +554,10 @@ bool GNSSdataFromOSP::acqHeaderData(RTKobservation &rtko) {
  * Method returns when it is read the last message (MID2 or MID7) of the current epoch.
  *<p>Ephemeris data messages (MID15, MID8, MID70) can appear in any place of the input message sequence. Their data
  * would be stored for further generation of the RINEX navigation file.
+ *<p>In single pass mode (see setSinglePass) header data in MID2, MID6 and MID7 messages, and GLONASS parameters
+ * in MID8 messages, are also acquired.
+ *<p>When several decoding threads have been stated using setDecodeThreads, and single pass mode is not set, messages are
+ * decoded in advance by these threads, and their data are acquired here in the same order than when decoded sequentially.
  *<p>Other messages in the input binary file are ignored.
  *
  * @param rinex the RinexObsData object where data got from receiver will be placed
@@ -191,75 +566,94 @@ bool GNSSdataFromOSP::acqHeaderData(RTKobservation &rtko) {
  * @return true when observation data from an epoch messages have been acquired, false otherwise (End Of File reached)
  */
 bool GNSSdataFromOSP::acqEpochData(RinexData &rinex, bool useMID8G, bool useMID8R) {
-	int mid, ch, sv;
-	bool sameEpoch;
-	double anObservable;
-	while (message.fill(ospFile)) {	//one message has been read from the binary file
-		mid = message.get();		//get first byte (MID) from message
-		switch(mid) {
-		case 7:		//the Rx sends MID7 when position for current epoch is computed (after sending MID28 msgs)
-			if (getMID7TimeData(rinex)) {
-				plog->fine("Epoch " + to_string((long double) epochGPStow) + " sats=" + to_string((long long) chSatObs.size()));
-				if(!chSatObs.empty()) {
-					for (vector<ChannelObs>::iterator it = chSatObs.begin(); it != chSatObs.end(); it++) {
-						//convert observables from the OSP units to RINEX units when necessary
-						//and apply corrections due to clock bias, when requested
-						anObservable = it->psedrng;		//unit are m
-						if (applyBias && (anObservable != 0.0)) anObservable -= epochClkBias * C1CADJ;
-						rinex.saveObsData(it->system, it->satPrn, "C1C", anObservable, it->limitOl, it->strgIdx, it->timeT);
-						anObservable = it->carrPh * L1WLINV;	//convert from initial unit (m) to cycles
-						if (applyBias && (anObservable != 0.0)) anObservable -= epochClkBias * L1CADJ;
-						rinex.saveObsData(it->system, it->satPrn, "L1C", anObservable, it->limitOl, it->strgIdx, it->timeT);
-						anObservable = it->carrFq * L1WLINV;	//convert from initial unit (m/s) to Hz
-						if (applyBias && (anObservable != 0.0)) anObservable -=  epochClkDrift;
-						rinex.saveObsData(it->system, it->satPrn, "D1C", anObservable, it->limitOl, it->strgIdx, it->timeT);
-						rinex.saveObsData(it->system, it->satPrn, "S1C", it->signalStrg, it->limitOl, it->strgIdx, it->timeT);
-					}
-					chSatObs.clear();
-					return true;
-				}
-			}
-			break;
-		case 8:		//collect 50BPS ephemerides data in MID8
-			if (useMID8G || useMID8R) {
-				try {
-					//extract channel number an satellite number from the OSP message
-					ch = (int) message.get();
-					if (ch>=0 && ch<MAXCHANNELS) {	//channel in range, continue data extraction
-						sv = (int) message.get();	//the satellite number
-						if ((sv >= FIRSTGPSSAT) && (sv <= LASTGPSSAT)) {
-							if (useMID8G) getMID8GPSNavData(ch, sv, rinex);
-						} else if ((sv >= FIRSTGLOSAT) && (sv <= LASTGLOSAT)) {	//it is a GLONASS satellite SirfV
-							if (useMID8R) getMID8GLONavData(ch, sv, rinex);
-						} else {
-							plog->warning(msgMID8Ign + " satellite number out of GPS, GLONASS ranges:" + to_string((long long) sv));
-						}
-					} else plog->warning(msgMID8Ign + "channel not in range");
-				} catch (int error) {
-					plog->severe(msgMID8Ign + msgEOM + to_string((long long) error));
-				}
+	//in single pass mode, first save epochs already waiting and having known GLONASS slots
+	while (singlePass && isEpochReady())
+		if (savePendingEpoch(rinex)) return true;
+	if ((decodeThreads > 1) && !singlePass) {
+		if (parDecode == NULL) beginParallelDecode(useMID8G, useMID8R);
+		if (!parDecode->sequential) {
+			if (acqEpochParallel(rinex)) return true;
+			if (!gpsEphPending.empty()) saveGPSpending(rinex);
+			return false;
+		}
+	}
+	while (reader.next(message))	//one message has been read from the binary file
+		if (acqEpochMessage(rinex, useMID8G, useMID8R) == MSGEPOCH) return true;
+	//end of file reached: save epochs still waiting, if any
+	while (!pendingEpochs.empty())
+		if (savePendingEpoch(rinex)) return true;
+	if (!gpsEphPending.empty()) saveGPSpending(rinex);
+	return false;
+}
+
+/**acqEpochMessage processes the message just read when acquiring epoch data (see acqEpochData).
+ *
+ * @param rinex the RinexObsData object where data got from receiver will be placed
+ * @param useMID8G when true GPS navigation data will be acquired from MID8 messages, when false these data would be acquired from MID15
+ * @param useMID8R when true GLONASS navigation data will be acquired from MID8 messages , when false these data would be acquired from MID70
+ * @return MSGEPOCH when observation data from an epoch have been saved, MSGEPOCHTIME for other MID7 with a valid time, or MSGOTHER otherwise
+ */
+int GNSSdataFromOSP::acqEpochMessage(RinexData &rinex, bool useMID8G, bool useMID8R) {
+	int mid;
+	bool sameEpoch, validTime;
+	MID8data mid8;
+	mid = message.get();		//get first byte (MID) from message
+	switch(mid) {
+	case 2:		//in single pass mode, collect first MID2 data to obtain approximate position (X, Y, Z)
+		if (singlePass && !apxSet) apxSet = getMID2PosData(rinex);
+		break;
+	case 6:		//in single pass mode, extract the software version
+		if (singlePass && !rxIdSet) rxIdSet = getMID6RxData(rinex);
+		break;
+	case 7:		//the Rx sends MID7 when position for current epoch is computed (after sending MID28 msgs)
+		validTime = getMID7TimeData(rinex);
+		if (singlePass) setMID7HeaderData(rinex, validTime);
+		if (!validTime) break;
+		if (!gpsEphPending.empty()) saveGPSpending(rinex);
+		LOG_FINE(plog, "Epoch " + to_string((long double) epochGPStow) + " sats=" + to_string((long long) chSatObs.size()));
+		if (chSatObs.empty()) return MSGEPOCHTIME;
+		if (singlePass) {
+			//keep the epoch waiting until the GLONASS slots of its satellites are known
+			pendingEpochs.push_back(PendingEpoch(epochGPSweek, epochGPStow, epochClkBias, epochClkDrift, chSatObs));
+			chSatObs.clear();
+			while (isEpochReady())
+				if (savePendingEpoch(rinex)) return MSGEPOCH;
+			return MSGEPOCHTIME;
+		}
+		saveEpochObs(rinex, chSatObs, epochClkBias, epochClkDrift);
+		chSatObs.clear();
+		return MSGEPOCH;
+	case 8:		//collect 50BPS ephemerides data in MID8, and GLONASS parameters in single pass mode
+		if ((useMID8G || useMID8R || singlePass) && getMID8data(mid8)) {
+			if ((mid8.sv >= FIRSTGPSSAT) && (mid8.sv <= LASTGPSSAT)) {
+				if (useMID8G) getMID8GPSNavData(mid8, rinex);
+			} else if ((mid8.sv >= FIRSTGLOSAT) && (mid8.sv <= LASTGLOSAT)) {	//it is a GLONASS satellite SirfV
+				if (useMID8R) getMID8GLONavData(mid8, rinex);
+				else if (singlePass) getMID8GLOparams(mid8);
+			} else {
+				plog->warning(msgMID8Ign + " satellite number out of GPS, GLONASS ranges:" + to_string((long long) mid8.sv));
 			}
-			break;
-		case 15:	//collect complete GPS ephemerides data in MID15
-			if (!useMID8G) getMID15NavData(rinex);
-			break;
-		case 28:	//collect satellite measurements from a channel in MID28
-			if (getMID28ObsData(rinex, sameEpoch)) {	//message data are correct and have been stored
-				if (!sameEpoch) {	//last data stored belong to a new epoch, and no MID7 has arrived!
-					//as no MID7 has been received, the epoch time is not availble and current epoch observables shall be discarded 
-					plog->warning("Epoch " + to_string((long double)chSatObs[0].timeT) + " ignored: MID7 lost");
-					chSatObs.erase(chSatObs.begin(), chSatObs.end() - 1);
-				}
+		}
+		break;
+	case 15:	//collect complete GPS ephemerides data in MID15
+		if (!useMID8G) getMID15NavData(rinex);
+		break;
+	case 28:	//collect satellite measurements from a channel in MID28
+		if (getMID28ObsData(rinex, sameEpoch)) {	//message data are correct and have been stored
+			if (!sameEpoch) {	//last data stored belong to a new epoch, and no MID7 has arrived!
+				//as no MID7 has been received, the epoch time is not availble and current epoch observables shall be discarded 
+				plog->warning("Epoch " + to_string((long double)chSatObs[0].timeT) + " ignored: MID7 lost");
+				chSatObs.erase(chSatObs.begin(), chSatObs.end() - 1);
 			}
-			break;
-		case 70:	//collect complete GLONASS ephemerides data in MID70
-			if (!useMID8R) getMID70NavData(rinex);
-			break;
-		default:
-			break;
 		}
+		break;
+	case 70:	//collect complete GLONASS ephemerides data in MID70
+		if (!useMID8R) getMID70NavData(rinex);
+		break;
+	default:
+		break;
 	}
-	return false;
+	return MSGOTHER;
 }
 
 /**acqGLOparams acquires some relevant parameters from GLONASS navigation data in MID8 messages
@@ -268,91 +662,70 @@ bool GNSSdataFromOSP::acqEpochData(RinexData &rinex, bool useMID8G, bool useMID8
  * - the carrier frequency number for each slot
  *<p>Such parameters are needed to stablish correpondence between data provided by receiver
  * and used in the GNSS data processing.
+ *<p>The method rewinds the binary file and iterates over all its messages (only over MID8 ones when a message index is used). When single pass acquisition is used,
+ * these parameters are acquired while acquiring epoch data, and calling this method is not needed.
  *
- * @return true if data properly extracted, false otherwise  (End Of File reached)
+ * @return true when the end of file has been reached. MID8 messages with wrong data are logged and ignored
  */
 bool GNSSdataFromOSP::acqGLOparams() {
-	int mid, ch, sat, strNum, n, nA, hnA;
-	unsigned int gloStrg[3];		//a place to store the 84 bits of the GLONASS nav string
-	vector<GLONASSslot>::iterator itSlot;
-	char txtBuffer[80];
-	bool dataAcq = false;
+	MID8data mid8;
 
-	rewind(ospFile);
+	endParallelDecode();
+	reader.rewind();
+	reader.selectMids(vector<int> {8});	//when a message index is used, only these messages are read
 	plog->info("Acquisition of GLONASS parameters:");
-	try {
-		while (message.fill(ospFile)) {	//a message has been read from the binary file
-			mid = message.get();		//get first byte (MID) from message
-			if (mid == 8) {
-				CHECK_PAYLOADLEN(43,"MID8 msg len <> 43")
-				ch = (int) message.get();
-				if (ch>=0 && ch<MAXCHANNELS) {	//channel in range, continue data extraction
-					sat = (int) message.get();	//the satellite number
-					if ((sat >= FIRSTGLOSAT) && (sat <= LASTGLOSAT)) {	//it is a GLONASS satellite (in SirfV), extract nav data params needed
-						//get from message payload the GLONASS string and the string number
-						strNum = getGLOstring(gloStrg);
-						switch (strNum) {
-						case 4:
-							//get slot number (n) in string 4, bits 15-11
-							//and store its first occurrence in the table of GLONASS satellites
-							n = getBits(gloStrg, 10, 5);
-							sat -= FIRSTGLOSAT;
-							if (satGLOslt[sat].slot == 0) {	//if this table entry is empty 
-								satGLOslt[sat].rcvCh = ch;
-								satGLOslt[sat].slot = n;
-							}
-							break;
-						case 6:
-						case 8:
-						case 10:
-						case 12:
-						case 14:
-							//get from almanac data the slot number (nA) in bits 77-73 (see GLONASS ICD for details)
-							//and prepare slot - carrier frequency table to receive the value corresponding to this slot (if not already received)
-							nA = getBits(gloStrg, 72, 5);
-							if (nA > 0 && nA <= MAXGLOSLOTS) {
-								nAhnA[ch].nA = nA;
-								nAhnA[ch].strFhnA = strNum + 1;	//set the string number where continuation data should come
-							} else plog->warning("MID8 GLO almanac string " + to_string((long long) strNum) + " bad slot number = " + to_string((long long) nA));
-							break;
-						case 7:
-						case 9:
-						case 11:
-						case 13:
-						case 15:
-							//check in the slot - carrier frequency table the expected string number in this channel
-							//if current string is the expected one to provide the carrier frequency data, store it
-							if (nAhnA[ch].strFhnA == strNum) {
-								hnA = getBits(gloStrg, 9, 5);	//HnA in almanac: bits 14-10
-								if (hnA >= 25) hnA -= 32;	//set negative values as per table 4.11 of the GLONASS ICD
-								carrierFreq[nAhnA[ch].nA - 1] = hnA;
-							}
-							break;
-						default:
-							break;
-
-						}
-					}
-				} else plog->warning(msgMID8Ign + "channel not in range");
-			}
-		}
-		//log data acquired
-		plog->finer("GLONASS slot numbers used (from string 4 in MID8):");
-		for (int i=0; i<MAXGLOSATS; i++) {
-			sprintf(txtBuffer, "->sv=%2d slot=%2d rxChannel=%2d ", i+FIRSTGLOSAT, satGLOslt[i].slot, satGLOslt[i].rcvCh);
-			plog->finer(string(txtBuffer));
-			dataAcq = true;
-		}
-		plog->finer("GLONASS carrier frequency numbers (from almanac in MID8):");
-		for (int i = 0; i < MAXGLOSLOTS; i++) {
-			sprintf(txtBuffer, "->slot=%2d frequency=%2d", i+1, carrierFreq[i]);
-			plog->finer(string(txtBuffer));
-			dataAcq = true;
+	while (reader.next(message)) {	//a message has been read from the binary file
+		if ((message.mid() == 8) && getMID8data(mid8)) {
+			//if it is a GLONASS satellite (in SirfV), extract nav data params needed
+			if ((mid8.sv >= FIRSTGLOSAT) && (mid8.sv <= LASTGLOSAT)) getMID8GLOparams(mid8);
 		}
-	} catch (int error) {
-		plog->severe("MID8 GLO" + msgEOM + to_string((long long) error));
 	}
-	return  dataAcq;
+	reader.selectMids(vector<int>());
+	logGLOparams();
+	return  true;
+}
+
+/**setSinglePass sets the single pass acquisition mode, where header data and GLONASS parameters are acquired
+ * while epoch data are acquired, avoiding to read the binary file several times.
+ *<p>In this mode, each call to acqEpochData for RinexData objects also acquires:
+ * - the receiver identification contained in the first MID6 message
+ * - the initial X,Y,Z position contained in the first valid MID2 message
+ * - the time of first epoch contained in the first valid MID7 message
+ * - the measurement interval, computed as the time difference between two consecutive valid MID7
+ * - the GLONASS slot and carrier frequency numbers contained in MID8 messages (see acqGLOparams)
+ *<p>GLONASS slot numbers are resolved lazily: epochs having observations of GLONASS satellites whose slot number has not been received yet
+ * are kept waiting until it is received (up to MAXEPOCHWAIT epochs, after that such observations are ignored).
+ * GLONASS ephemeris acquired from MID8 are kept until the carrier frequency number of their slot is received, and
+ * GPS ephemeris acquired from MID15 before the first valid MID7 are kept until it is received, to set their transmission time.
+ *<p>As header data are not complete until all epochs have been acquired, they shall be printed after calling endSinglePass.
+ *
+ * @param rinex the RinexData object where data will be saved
+ */
+void GNSSdataFromOSP::setSinglePass(RinexData &rinex) {
+	singlePass = true;
+	rxIdSet = apxSet = frsEphSet = intrvBegin = intrvSet = false;
+	plog->info("RINEX header and epoch data acquisition in a single pass:");
+	setObsHandles(rinex);
+}
+
+/**endSinglePass completes data acquisition in single pass mode, once acqEpochData has reached the end of file.
+ * GLONASS ephemeris still waiting for their carrier frequency number are saved, and header and GLONASS data acquired are logged.
+ *
+ * @param rinex the RinexData object where data are saved
+ * @return	true if all header data have been acquired (see setSinglePass), false otherwise
+ */
+bool GNSSdataFromOSP::endSinglePass(RinexData &rinex) {
+	saveGLOpending(rinex, true);
+	//log data sources available or not
+	string logMessage = "Header data acquired:";
+	logMessage += apxSet? " Aprox. position;" : ";";
+	logMessage += frsEphSet? " 1st epoch time;" : ";";
+	logMessage += intrvSet? " Observation interval;" : ";";
+	logMessage += rxIdSet? " Receiver version" : "";
+	plog->info(logMessage);
+	logGLOparams();
+	singlePass = false;
+	return apxSet && rxIdSet && frsEphSet && intrvSet;
 }
 
 /**acqEpochData acquires epoch position data from binary OSP file messages for RTK observation files.
@@ -365,7 +738,7 @@ bool GNSSdataFromOSP::acqGLOparams() {
  */
 bool GNSSdataFromOSP::acqEpochData(RTKobservation &rtko) {
 	int mid;
-	while (message.fill(ospFile)) {	//one message has been read from the binary file
+	while (reader.next(message)) {	//one message has been read from the binary file
 		mid = message.get();		//get first byte (MID) from message
 		if ((mid == 2) && getMID2PosData(rtko)) return true;
 	}
@@ -374,94 +747,316 @@ bool GNSSdataFromOSP::acqEpochData(RTKobservation &rtko) {
 
 //PRIVATE METHODS
 //===============
-/**setTblValues set conversion parameter tables used to translate scaled normalized GPS message data to values in actual units.
- * Called by the construtors
+/**setObsHandles gets from the RinexData object the handles of the observables saved in each epoch for the systems
+ * the receiver could track (GPS, GLONASS and SBAS). They are used to save epoch observables avoiding the search of their codes.
+ * Called when header data are acquired, that is, after the systems and observable types have been defined in the RINEX header.
  *
+ * @param rinex the RinexData object where epoch data will be saved
  */
-void GNSSdataFromOSP::setTblValues() {
-	//SV clock data
-	GPS_SCALEFACTOR[0][0] = pow(2.0, 4.0);		//T0c
-	GPS_SCALEFACTOR[0][1] = pow(2.0, -31.0);	//Af0: SV clock bias
-	GPS_SCALEFACTOR[0][2] = pow(2.0, -43.0);	//Af1: SV clock drift
-	GPS_SCALEFACTOR[0][3] = pow(2.0, -55.0);	//Af2: SV clock drift rate
-	//broadcast orbit 1
-	GPS_SCALEFACTOR[1][0] = 1.0;				//IODE
-	GPS_SCALEFACTOR[1][1] = pow(2.0, -5.0);	//Crs
-	GPS_SCALEFACTOR[1][2] = pow(2.0, -43.0) * ThisPI;	//Delta N
-	GPS_SCALEFACTOR[1][3] = pow(2.0, -31.0) * ThisPI;	//M0
-	//broadcast orbit 2
-	GPS_SCALEFACTOR[2][0] = pow(2.0, -29.0);	//Cuc
-	GPS_SCALEFACTOR[2][1] = pow(2.0, -33.0);	//e
-	GPS_SCALEFACTOR[2][2] = pow(2.0, -29.0);	//Cus
-	GPS_SCALEFACTOR[2][3] = pow(2.0, -19.0);	//sqrt(A) ????
-	//broadcast orbit 3
-	GPS_SCALEFACTOR[3][0] = pow(2.0, 4.0);		//TOE
-	GPS_SCALEFACTOR[3][1] = pow(2.0, -29.0);	//Cic
-	GPS_SCALEFACTOR[3][2] = pow(2.0, -31.0) * ThisPI;	//Omega0
-	GPS_SCALEFACTOR[3][3] = pow(2.0, -29.0);	//Cis
-	//broadcast orbit 4
-	GPS_SCALEFACTOR[4][0] = pow(2.0, -31.0) * ThisPI;	//i0
-	GPS_SCALEFACTOR[4][1] = pow(2.0, -5.0);	//Crc
-	GPS_SCALEFACTOR[4][2] = pow(2.0, -31.0) * ThisPI;	//w
-	GPS_SCALEFACTOR[4][3] = pow(2.0, -43.0) * ThisPI;	//w dot
-	//broadcast orbit 5
-	GPS_SCALEFACTOR[5][0] = pow(2.0, -43.0) * ThisPI;	//Idot ??
-	GPS_SCALEFACTOR[5][1] = 1.0;				//codes on L2
-	GPS_SCALEFACTOR[5][2] = 1.0;				//GPS week + 1024
-	GPS_SCALEFACTOR[5][3] = 1.0;				//L2 P data flag
-	//broadcast orbit 6
-	GPS_SCALEFACTOR[6][0] = 1.0;				//SV accuracy (index)
-	GPS_SCALEFACTOR[6][1] = 1.0;				//SV health
-	GPS_SCALEFACTOR[6][2] = pow(2.0, -31.0);	//TGD
-	GPS_SCALEFACTOR[6][3] = 1.0;				//IODC
-	//broadcast orbit 7
-	GPS_SCALEFACTOR[7][0] = 0.01;	//Transmission time of message in sec x 100
-	GPS_SCALEFACTOR[7][1] = 1.0;	//Fit interval
-	GPS_SCALEFACTOR[7][2] = 0.0;	//Spare
-	GPS_SCALEFACTOR[7][3] = 0.0;	//Spare
-	//GPS_URA table to obtain in meters the value associated to the satellite accuracy index
-	//fill GPS_URA table as per GPS ICD 20.3.3.3.1.3
-	GPS_URA[0] = 2.0;		//0
-	GPS_URA[1] = 2.8;		//1
-	GPS_URA[2] = 4.0;		//2
-	GPS_URA[3] = 5.7;		//3
-	GPS_URA[4] = 8.0;		//4
-	GPS_URA[5] = 11.3;		//5
-	GPS_URA[6] = pow(2.0, 4.0);		//<=6
-	GPS_URA[7] = pow(2.0, 5.0);
-	GPS_URA[8] = pow(2.0, 6.0);
-	GPS_URA[9] = pow(2.0, 7.0);
-	GPS_URA[10] = pow(2.0, 8.0);
-	GPS_URA[11] = pow(2.0, 9.0);
-	GPS_URA[12] = pow(2.0, 10.0);
-	GPS_URA[13] = pow(2.0, 11.0);
-	GPS_URA[14] = pow(2.0, 12.0);
-	GPS_URA[15] = 6144.00;
-	//SV clock data
-	GLO_SCALEFACTOR[0][0] = 1;		//T0c
-	GLO_SCALEFACTOR[0][1] = pow(2.0, -30.0);		//-TauN
-	GLO_SCALEFACTOR[0][2] = pow(2.0, -40.0);		//+GammaN
-	GLO_SCALEFACTOR[0][3] = 1;					//Message frame time
-	//broadcast orbit 1
-	GLO_SCALEFACTOR[1][0] = pow(2.0, -11.0);	//X
-	GLO_SCALEFACTOR[1][1] = pow(2.0, -20.0);	//Vel X
-	GLO_SCALEFACTOR[1][2] = pow(2.0, -30.0);	//Accel X
-	GLO_SCALEFACTOR[1][3] = 1;					//SV Health
-	//broadcast orbit 2
-	GLO_SCALEFACTOR[2][0] = pow(2.0, -11.0);	//Y
-	GLO_SCALEFACTOR[2][1] = pow(2.0, -20.0);	//Vel Y
-	GLO_SCALEFACTOR[2][2] = pow(2.0, -30.0);	//Accel Y
-	GLO_SCALEFACTOR[2][3] = 1;					//Frequency number
-	//broadcast orbit 3
-	GLO_SCALEFACTOR[3][0] = pow(2.0, -11.0);	//Z
-	GLO_SCALEFACTOR[3][1] = pow(2.0, -20.0);	//Vel Z
-	GLO_SCALEFACTOR[3][2] = pow(2.0, -30.0);	//Accel Z
-	GLO_SCALEFACTOR[3][3] = 1;					//Age of oper.
-	//set tables to 0
-	memset(subfrmCh, 0, sizeof subfrmCh);
-	memset(satGLOslt, 0, sizeof satGLOslt);
-	memset(carrierFreq, 0, sizeof carrierFreq);
-	memset(nAhnA, 0, sizeof nAhnA);
+void GNSSdataFromOSP::setObsHandles(RinexData &rinex) {
+	const char SYSTEMS[] = "GRS";
+	SysObsHandles sysHandles;
+	obsHandles.clear();
+	for (int i = 0; SYSTEMS[i] != 0; i++) {
+		sysHandles.system = SYSTEMS[i];
+		for (int j = 0; j < 4; j++) sysHandles.handle[j] = rinex.getObsHandle(SYSTEMS[i], OBSCODES[j]);
+		obsHandles.push_back(sysHandles);
+	}
+}
+
+/**saveEpochObs saves into the RinexData object the observables acquired for an epoch.
+ * Observables are converted from the OSP units to RINEX units when necessary, and corrections due to clock bias are applied when requested.
+ * When a decoding thread is acquiring data, observables are recorded as acquired to be saved later, and epochObs is left empty.
+ *
+ * @param rinex the RinexData object where epoch data will be saved
+ * @param epochObs the observables acquired in each channel for the epoch
+ * @param clkBias the receiver clock bias for the epoch, in seconds
+ * @param clkDrift the receiver clock drift for the epoch, in Hz
+ */
+void GNSSdataFromOSP::saveEpochObs(RinexData &rinex, vector<ChannelObs> &epochObs, double clkBias, double clkDrift) {
+	double observables[4];
+	vector<SysObsHandles>::iterator itHandles;
+	if (recording != NULL) {
+		//a decoding thread is acquiring data: record them, leaving epochObs empty
+		DecodedChunk::DecodedItem &item = recording->add(DecodedChunk::ITEM_EPOCH);
+		item.clkBias = clkBias;
+		item.clkDrift = clkDrift;
+		item.obs.swap(epochObs);
+		return;
+	}
+	for (vector<ChannelObs>::iterator it = epochObs.begin(); it != epochObs.end(); it++) {
+		//convert observables from the OSP units to RINEX units when necessary
+		//and apply corrections due to clock bias, when requested
+		observables[0] = it->psedrng;		//unit are m
+		if (applyBias && (observables[0] != 0.0)) observables[0] -= clkBias * C1CADJ;
+		observables[1] = it->carrPh * L1WLINV;	//convert from initial unit (m) to cycles
+		if (applyBias && (observables[1] != 0.0)) observables[1] -= clkBias * L1CADJ;
+		observables[2] = it->carrFq * L1WLINV;	//convert from initial unit (m/s) to Hz
+		if (applyBias && (observables[2] != 0.0)) observables[2] -=  clkDrift;
+		observables[3] = it->signalStrg;
+		//save them using the handles of the system observables, or their codes when handles are not available
+		for (itHandles = obsHandles.begin(); (itHandles != obsHandles.end()) && (itHandles->system != it->system); itHandles++);
+		for (int i = 0; i < 4; i++) {
+			if ((itHandles != obsHandles.end()) && (itHandles->handle[i] >= 0))
+				rinex.saveObsData(itHandles->handle[i], it->satPrn, observables[i], it->limitOl, it->strgIdx, it->timeT);
+			else rinex.saveObsData(it->system, it->satPrn, OBSCODES[i], observables[i], it->limitOl, it->strgIdx, it->timeT);
+		}
+	}
+}
+
+/**isEpochReady checks, in single pass mode, if the first epoch waiting can be saved: when the slot numbers of all its GLONASS satellites
+ * are already known, or when the maximum number of epochs waiting has been exceeded.
+ *
+ * @return true if the first epoch waiting can be saved, false otherwise or if there are not epochs waiting
+ */
+bool GNSSdataFromOSP::isEpochReady() {
+	if (pendingEpochs.empty()) return false;
+	if (pendingEpochs.size() > MAXEPOCHWAIT) return true;
+	vector<ChannelObs> &epochObs = pendingEpochs.front().obs;
+	for (vector<ChannelObs>::iterator it = epochObs.begin(); it != epochObs.end(); it++)
+		if ((it->system == 'R') && (it->satPrn >= FIRSTGLOSAT) && (getGLOslot(0, it->satPrn) == it->satPrn)) return false;
+	return true;
+}
+
+/**savePendingEpoch saves into the RinexData object the first epoch waiting in single pass mode, and removes it from the waiting ones.
+ * The slot numbers of GLONASS satellites are resolved, and observables of GLONASS satellites whose slot is still unknown are ignored.
+ *
+ * @param rinex the RinexData object where epoch data will be saved
+ * @return true if epoch data have been saved, false if no observables remain in the epoch
+ */
+bool GNSSdataFromOSP::savePendingEpoch(RinexData &rinex) {
+	PendingEpoch &epoch = pendingEpochs.front();
+	vector<ChannelObs>::iterator it = epoch.obs.begin();
+	while (it != epoch.obs.end()) {
+		if ((it->system == 'R') && (it->satPrn >= FIRSTGLOSAT)) {
+			it->satPrn = getGLOslot(0, it->satPrn);
+			if (it->satPrn >= FIRSTGLOSAT) {
+				LOG_FINE(plog, "Epoch " + to_string((long double) epoch.tow) + " GLONASS sv=" + to_string((long long) it->satPrn) + " ignored: slot unknown");
+				it = epoch.obs.erase(it);
+				continue;
+			}
+		}
+		it++;
+	}
+	bool saved = !epoch.obs.empty();
+	if (saved) {
+		rinex.setEpochTime(epoch.week, epoch.tow, epoch.clkBias, 0);
+		saveEpochObs(rinex, epoch.obs, epoch.clkBias, epoch.clkDrift);
+	}
+	pendingEpochs.pop_front();
+	return saved;
+}
+
+/**setDecodeThreads states the number of threads to be used for decoding messages when acquiring epoch data with acqEpochData.
+ * When more than one thread is stated, the OSP file is split in chunks of messages which are decoded in parallel
+ * by the given number of threads, and acqEpochData acquires in order their results.
+ * Parallel decoding is only possible when the OSP file can be mapped into memory, and it is not used in single pass mode.
+ * <p>Results, including logging messages, are the same as when decoding sequentially. The sources of navigation data
+ * stated when acqEpochData is called the first time are used for the whole file.
+ *
+ * @param nThreads the number of threads to use
+ */
+void GNSSdataFromOSP::setDecodeThreads(int nThreads) {
+	endParallelDecode();
+	decodeThreads = nThreads;
+}
+
+/**saveEpochTime saves the current epoch time into the RinexData object, or records it when a decoding thread is acquiring data.
+ *
+ * @param rinex the RinexData object where epoch data are saved
+ */
+void GNSSdataFromOSP::saveEpochTime(RinexData &rinex) {
+	if (recording == NULL) {
+		rinex.setEpochTime(epochGPSweek, epochGPStow, epochClkBias, 0);
+		return;
+	}
+	DecodedChunk::DecodedItem &item = recording->add(DecodedChunk::ITEM_TIME);
+	item.week = epochGPSweek;
+	item.tow = epochGPStow;
+	item.clkBias = epochClkBias;
+}
+
+/**saveNavData saves the ephemeris of a satellite into the RinexData object, or records them when a decoding thread is acquiring data.
+ *
+ * @param rinex the RinexData object where navigation data are saved
+ * @param sys the satellite system identifier (G, R)
+ * @param sat the satellite number
+ * @param bo the broadcast orbit data
+ * @param tTag the time tag of the navigation data
+ */
+void GNSSdataFromOSP::saveNavData(RinexData &rinex, char sys, unsigned int sat, double (&bo)[8][4], double tTag) {
+	if (recording == NULL) {
+		rinex.saveNavData(sys, sat, bo, tTag);
+		return;
+	}
+	DecodedChunk::DecodedItem &item = recording->add(DecodedChunk::ITEM_NAV);
+	item.sys = sys;
+	item.sat = sat;
+	item.tTag = tTag;
+	memcpy(item.bo, bo, sizeof bo);
+}
+
+/**acqEpochParallel acquires the data of the next epoch from the chunks decoded by the decoding threads (see ParallelDecode).
+ *
+ * @param rinex the RinexData object where data will be placed
+ * @return true when observation data from an epoch have been acquired, false otherwise (End Of File reached)
+ */
+bool GNSSdataFromOSP::acqEpochParallel(RinexData &rinex) {
+	ParallelDecode* par = parDecode;
+	int msgType;
+	for (;;) {
+		{
+			unique_lock<mutex> guard(par->lock);
+			if (par->current >= par->chunks.size()) return false;
+			while (!par->chunks[par->current].done) par->changed.wait(guard);
+		}
+		DecodedChunk &chunk = par->chunks[par->current];
+		if (!par->synced) {
+			//decode sequentially messages from the chunk begin, until the decoding state matches the one recorded at a sync point
+			while (reader.next(message)) {
+				msgType = acqEpochMessage(rinex, par->useMID8G, par->useMID8R);
+				if (msgType != MSGOTHER) {
+					while ((par->nextSync < chunk.syncs.size()) && (chunk.syncs[par->nextSync].end < reader.tell())) par->nextSync++;
+					if ((par->nextSync < chunk.syncs.size()) && (chunk.syncs[par->nextSync].end == reader.tell())
+							&& chunk.states[chunk.syncs[par->nextSync].state].matches(this)) {
+						par->synced = true;
+						par->nextItem = chunk.syncs[par->nextSync].items;
+						par->nextMsg = chunk.syncs[par->nextSync].msgs;
+					}
+				}
+				if (msgType == MSGEPOCH) return true;
+				if (par->synced) break;
+			}
+		}
+		if (par->synced) {
+			//acquire data recorded after the sync point, forwarding the messages logged before each one
+			while (par->nextItem < chunk.items.size()) {
+				DecodedChunk::DecodedItem &item = chunk.items[par->nextItem++];
+				chunk.log->forward(par->nextMsg, item.lastMsg);
+				par->nextMsg = item.lastMsg;
+				switch (item.type) {
+				case DecodedChunk::ITEM_TIME:
+					rinex.setEpochTime(item.week, item.tow, item.clkBias, 0);
+					break;
+				case DecodedChunk::ITEM_NAV:
+					rinex.saveNavData(item.sys, item.sat, item.bo, item.tTag);
+					break;
+				case DecodedChunk::ITEM_EPOCH:
+					saveEpochObs(rinex, item.obs, item.clkBias, item.clkDrift);
+					vector<ChannelObs>().swap(item.obs);
+					return true;
+				}
+			}
+			chunk.log->forward(par->nextMsg, chunk.log->deferredSize());
+			chunk.restoreEnd(this);
+		}
+		//all chunk data have been acquired: release it, allow threads to decode further chunks, and read messages from the next one
+		{
+			lock_guard<mutex> guard(par->lock);
+			chunk.release();
+			par->current++;
+			par->synced = false;
+			par->nextSync = par->nextItem = 0;
+			par->nextMsg = 0;
+		}
+		par->changed.notify_all();
+		if (par->current < par->chunks.size()) reader.setRange(par->chunks[par->current].start, par->chunks[par->current].end);
+	}
+}
+
+/**beginParallelDecode splits the mapped OSP file in chunks, from the next message to read, and starts the decoding threads,
+ * each one with its own GNSSdataFromOSP object.
+ *
+ * @param useMID8G when true GPS navigation data will be acquired from MID8 messages, when false these data would be acquired from MID15
+ * @param useMID8R when true GLONASS navigation data will be acquired from MID8 messages , when false these data would be acquired from MID70
+ */
+void GNSSdataFromOSP::beginParallelDecode(bool useMID8G, bool useMID8R) {
+	long long first, start;
+	parDecode = new ParallelDecode();
+	parDecode->useMID8G = useMID8G;
+	parDecode->useMID8R = useMID8R;
+	memcpy(parDecode->gloSlots, satGLOslt, sizeof satGLOslt);
+	if (!reader.isMapped()) {
+		LOG_FINE(plog, "Parallel decoding not possible. Messages are decoded sequentially");
+		parDecode->sequential = true;
+		return;
+	}
+	//split the mapped file in chunks at message boundaries, up to the last message that can be read
+	first = start = reader.tell();
+	while (reader.next(message))
+		if (reader.tell() - start >= DECODECHUNKSIZE) {
+			parDecode->chunks.push_back(DecodedChunk(start, reader.tell()));
+			start = reader.tell();
+		}
+	if (reader.tell() > start) parDecode->chunks.push_back(DecodedChunk(start, reader.tell()));
+	if (parDecode->chunks.size() < 2) {
+		LOG_FINE(plog, "Parallel decoding not possible. Messages are decoded sequentially");
+		parDecode->chunks.clear();
+		parDecode->sequential = true;
+		reader.setRange(first, reader.tell());
+		return;
+	}
+	//start decoding threads, each one with its own GNSSdataFromOSP object having the GLONASS data needed to decode messages
+	parDecode->maxAhead = DECODECHUNKSAHEAD * decodeThreads;
+	for (int i = 0; i < decodeThreads; i++) {
+		GNSSdataFromOSP* decoder = new GNSSdataFromOSP(receiver, minSVSfix, applyBias, ospFile, plog);
+		memcpy(decoder->carrierFreq, carrierFreq, sizeof carrierFreq);
+		memcpy(decoder->carrierFreqSet, carrierFreqSet, sizeof carrierFreqSet);
+		parDecode->decoders.push_back(decoder);
+		parDecode->threads.push_back(thread(decodeChunks, parDecode, decoder));
+	}
+	reader.setRange(parDecode->chunks[0].start, parDecode->chunks[0].end);
+	LOG_FINE(plog, "Messages are decoded by " + to_string((long long) decodeThreads) + " threads in " + to_string((long long) parDecode->chunks.size()) + " chunks");
+}
+
+/**endParallelDecode ends the parallel decoding in progress, if any, stopping decoding threads and releasing resources.
+ */
+void GNSSdataFromOSP::endParallelDecode() {
+	if (parDecode == NULL) return;
+	delete parDecode;
+	parDecode = NULL;
+}
+
+/**decodeChunks is the body of each decoding thread: it decodes chunks not yet decoded, recording data acquired, until all chunks
+ * have been decoded or threads are stopped. Each chunk is decoded starting from a state without data from former chunks.
+ *
+ * @param par the parallel decoding state
+ * @param decoder the GNSSdataFromOSP object used by this thread to decode messages
+ */
+void GNSSdataFromOSP::decodeChunks(ParallelDecode* par, GNSSdataFromOSP* decoder) {
+	Logger* targetLog = decoder->plog;
+	RinexData rinex(RinexData::VTBD, targetLog);	//not used: data acquired are recorded in chunks
+	size_t index;
+	unique_lock<mutex> guard(par->lock);
+	for (;;) {
+		while (!par->stop && (par->toDecode < par->chunks.size()) && (par->toDecode >= par->current + par->maxAhead)) par->changed.wait(guard);
+		if (par->stop || (par->toDecode >= par->chunks.size())) return;
+		index = par->toDecode++;
+		guard.unlock();
+		DecodedChunk &chunk = par->chunks[index];
+		chunk.log = new Logger(targetLog);
+		decoder->plog = chunk.log;
+		decoder->recording = &chunk;
+		//set the initial decoding state
+		for (int i = 0; i < MAXCHANNELS; i++)
+			for (int j = 0; j < MAXSUBFR; j++)
+				decoder->subfrmCh[i][j].sv = 0;
+		memcpy(decoder->satGLOslt, par->gloSlots, sizeof par->gloSlots);
+		decoder->chSatObs.clear();
+		decoder->epochGPSweek = 0;
+		decoder->epochGPStow = decoder->epochClkBias = decoder->epochClkDrift = 0.0;
+		decoder->gpsTimeSet = false;
+		decoder->gpsEphPending.clear();
+		if (decoder->reader.setRange(chunk.start, chunk.end))
+			while (!par->stop && decoder->reader.next(decoder->message))
+				if (decoder->acqEpochMessage(rinex, par->useMID8G, par->useMID8R) != MSGOTHER) chunk.addSync(decoder);
+		chunk.saveEnd(decoder);
+		decoder->recording = NULL;
+		decoder->plog = targetLog;
+		guard.lock();
+		chunk.done = true;
+		par->changed.notify_all();
+	}
 }
 
 /**getMID2PosData gets position solution data from a MID2 message and store them into "APPROX POSITION XYZ" record of a RinexData object.
@@ -507,23 +1102,21 @@ bool GNSSdataFromOSP::getMID2PosData(RTKobservation &rtko) {
  */
 bool GNSSdataFromOSP::getMID2xyz(float &x, float &y, float &z, int &nsv) {
 	char msgBuf[100];
+	MID2data mid2;
 	CHECK_PAYLOADLEN(41,"MID2 msg len <> 41")
-	//extract X, Y, Z for the rinex header
-	try {
-		x = (float) message.getInt();	//get X
-		y = (float) message.getInt();	//get Y
-		z = (float) message.getInt();	//get Z
-		message.skipBytes(9);	//skip from vX to Mode2: 3*2S 3*1U
-		epochGPSweek = (int) message.getUShort() + 1024;
-		epochGPStow = (double) message.getInt() / 100.0;	//get GPS TOW (scaled by 100)
-		//check if fix has the minimum SVs required
-		nsv = message.get();
-		CHECK_SATSREQUIRED(nsv, "MID2" + msgFew)
+	CHECK_DECODE(mid2, "MID2 ")
+	//X, Y, Z for the rinex header
+	x = (float) mid2.x;
+	y = (float) mid2.y;
+	z = (float) mid2.z;
+	epochGPSweek = (int) mid2.week + 1024;
+	epochGPStow = (double) (int) mid2.tow / 100.0;	//GPS TOW is scaled by 100
+	//check if fix has the minimum SVs required
+	nsv = mid2.svs;
+	CHECK_SATSREQUIRED(nsv, "MID2" + msgFew)
+	if (plog->isLevel(Logger::FINER)) {
 		sprintf(msgBuf, "MID2 tow=%g x=%g y=%g z=%g", epochGPStow, x, y, z);
 		plog->finer(string(msgBuf));
-	} catch (int error) {
-		plog->severe("MID2 " + msgEOM + to_string((long long) error));
-		return false;
 	}
 	return true;
 }
@@ -566,7 +1159,7 @@ bool GNSSdataFromOSP::getMID6RxData(RinexData &rinex) {
 		plog->severe(error + " in getMID6");
 		return false;
 	}
-	plog->finer("MID6 swV=" + swVersion + " swC=" + swCustomer);
+	LOG_FINER(plog, "MID6 swV=" + swVersion + " swC=" + swCustomer);
 	return true;
 }
 
@@ -576,28 +1169,26 @@ bool GNSSdataFromOSP::getMID6RxData(RinexData &rinex) {
  * @return true if data properly extracted (correct message length and satellites in solution greather than minimum), false otherwise
  */
 bool GNSSdataFromOSP::getMID7TimeData(RinexData &rinex) {
-	int sats;
 	char msgBuf[100];
+	MID7data mid7;
 	CHECK_PAYLOADLEN(20,"MID7 msg len <> 20")
-	try {
-		epochGPSweek = (int) message.getUShort();		//get GPS Week (includes rollover)
-		epochGPStow = (double) message.getUInt() / 100.0;	//get GPS TOW (scaled by 100)
-		sats = (int) message.get();			//get number of satellites in the solution
-		CHECK_SATSREQUIRED(sats, "MID7" + msgFew)
-		epochClkDrift = (double) message.getUInt();	//get receiver clock drift (change rate of bias in Hz)
-		//get receiver clock bias in nanoseconds (unsigned 32 bits int) and convert to seconds
-		epochClkBias = (double) message.getUInt() * 1.0e-9;
+	CHECK_DECODE(mid7, "MID7TimeData")
+	epochGPSweek = (int) mid7.week;		//GPS Week (includes rollover)
+	epochGPStow = (double) mid7.tow / 100.0;	//GPS TOW is scaled by 100
+	CHECK_SATSREQUIRED((int) mid7.svs, "MID7" + msgFew)
+	epochClkDrift = (double) mid7.drift;	//receiver clock drift (change rate of bias in Hz)
+	//receiver clock bias in nanoseconds (unsigned 32 bits int) converted to seconds
+	epochClkBias = (double) mid7.bias * 1.0e-9;
+	if (plog->isLevel(Logger::FINER)) {
 		sprintf(msgBuf, "MID7 week=%d tow=%g bias=%g", epochGPSweek, epochGPStow, epochClkBias);
 		plog->finer(string(msgBuf));
-		if (!applyBias) {
-			epochGPStow += epochClkBias;
-			epochClkBias = 0.0;
-		}
-	} catch (int error) {
-		plog->severe("MID7TimeData" + msgEOM + to_string((long long) error));
-		return false;
 	}
-	rinex.setEpochTime(epochGPSweek, epochGPStow, epochClkBias, 0);
+	if (!applyBias) {
+		epochGPStow += epochClkBias;
+		epochClkBias = 0.0;
+	}
+	gpsTimeSet = true;
+	saveEpochTime(rinex);
 	return true;
 }
 
@@ -607,36 +1198,79 @@ bool GNSSdataFromOSP::getMID7TimeData(RinexData &rinex) {
  * @return true if data properly extracted (correct message length and satellites in solution greather than minimum), false otherwise
  */
 bool GNSSdataFromOSP::getMID7Interval(RinexData &rinex) {
-	int week, sats;
+	int week;
 	double tow, interval;
+	MID7data mid7;
 	CHECK_PAYLOADLEN(20,"MID7 msg len <> 20")
+	CHECK_DECODE(mid7, "MID7interval")
+	week = (int) mid7.week;		//GPS Week (includes rollover)
+	tow = (double) mid7.tow / 100.0;	//GPS TOW is scaled by 100
+	CHECK_SATSREQUIRED((int) mid7.svs, "MID7" + msgFew)
+	interval = tow - epochGPStow + (double) ((week - epochGPSweek) * 604800.0);
 	try {
-		week = (int) message.getUShort();		//get GPS Week (includes rollover)
-		tow = (double) message.getUInt() / 100.0;	//get GPS TOW (scaled by 100)
-		sats = (int) message.get();			//get number of satellites in the solution
-		CHECK_SATSREQUIRED(sats, "MID7" + msgFew)
-		interval = tow - epochGPStow + (double) ((week - epochGPSweek) * 604800.0);
 		rinex.setHdLnData(rinex.INT, interval);
-	} catch (int error) {
-		plog->severe("MID7interval" + msgEOM + to_string((long long) error));
-		return false;
 	} catch (string error) {
 		plog->severe(error + " in getMID7interval");
 		return false;
 	}
-	plog->finer("MID7 interval=" + to_string((long double) interval));
+	LOG_FINER(plog, "MID7 interval=" + to_string((long double) interval));
+	return true;
+}
+
+/**setMID7HeaderData acquires, in single pass mode, header data from the time data of the MID7 message already processed:
+ * the time of first epoch and the observation interval, computed as the time difference between two consecutive valid MID7.
+ * 
+ * @param rinex	the class instance where data will be stored
+ * @param valid true if the MID7 data have been properly extracted, false otherwise
+ */
+void GNSSdataFromOSP::setMID7HeaderData(RinexData &rinex, bool valid) {
+	double interval;
+	if (!valid) {
+		intrvBegin = false;
+		return;
+	}
+	if (!frsEphSet) {
+		rinex.setHdLnData(rinex.TOFO);
+		frsEphSet = true;
+	} else if (intrvBegin && !intrvSet) {
+		interval = epochGPStow - intrvTow + (double) ((epochGPSweek - intrvWeek) * 604800.0);
+		try {
+			rinex.setHdLnData(rinex.INT, interval);
+			intrvSet = true;
+			LOG_FINER(plog, "MID7 interval=" + to_string((long double) interval));
+		} catch (string error) {
+			plog->severe(error + " in getMID7interval");
+		}
+	}
+	intrvBegin = true;
+	intrvWeek = epochGPSweek;
+	intrvTow = epochGPStow;
+}
+
+/**getMID8data decodes the data of a MID 8 message (channel, satellite and navigation words), checking the channel is in range.
+ * 
+ * @param mid8	the data structure where message data are decoded
+ * @return true if data properly extracted (message length and channel number in range), false otherwise
+ */
+bool GNSSdataFromOSP::getMID8data(MID8data &mid8) {
+	CHECK_DECODE(mid8, msgMID8Ign)
+	if (mid8.channel >= MAXCHANNELS) {
+		plog->warning(msgMID8Ign + "channel not in range");
+		return false;
+	}
 	return true;
 }
 
 /**getMID8GPSNavData gets GPS navigation data from a MID 8 message and store them into satellite ephemeris (bradcast orbit data) of the RinexData object.
  * 
- * @param ch	the receiver channel number providing data
- * @param sv	the satellite number given by the receiver
+ * @param mid8	the MID 8 message data (see getMID8data)
  * @param rinex	the class instance where data are stored
- * @return true if data properly extracted (correct message length, channel number in range, and correct parity in navigation data), false otherwise
+ * @return true if data properly extracted (correct parity in navigation data), false otherwise
  */
-bool GNSSdataFromOSP::getMID8GPSNavData(int ch, int sv, RinexData &rinex) {
+bool GNSSdataFromOSP::getMID8GPSNavData(const MID8data &mid8, RinexData &rinex) {
 	CHECK_PAYLOADLEN(43,"MID8 msg len <> 43")
+	int ch = mid8.channel;	//the receiver channel number providing data
+	int sv = mid8.sv;		//the satellite number given by the receiver
 	unsigned int wd[10];	//a place to store the ten words of OSP message
 	unsigned int navW[45];	//a place to pack message data as per MID 15 (see SiRF ICD)
 	unsigned int sat;		//the satellite number in the satellite navigation message
@@ -646,73 +1280,71 @@ bool GNSSdataFromOSP::getMID8GPSNavData(int ch, int sv, RinexData &rinex) {
 	bool parityOK;
 	unsigned int subfrmID, pgID;
 	char msgBuf[100];
-	try {
-		//read ten words with navigation data from the OSP message. Bits in each 32 bits word are: D29 D30 d1 d2 ... d30
-		//that is: two last parity bits from previous word followed by the 30 bits of the current word
-		for (int i=0; i<10; i++) wd[i] = message.getUInt();
-		//check parity of each subframe word
-		parityOK = checkGPSparity(wd[0]);
-		for (int i=1; parityOK && i<10; i++) parityOK &= checkGPSparity(wd[i]);
-		//if parity not OK, ignore all subframe data and return
-		if (!parityOK) {
-			plog->warning(msgMID8Ign + "GPS wrong parity");
-			return false;
-		}
-		//remove parity from each GPS word getting the useful 24 bits
-		//Note that when D30 is set, data bits are complemented (a non documented SiRF OSP feature)
-		for (int i=0; i<10; i++)
-			if ((wd[i] & 0x40000000) == 0) wd[i] = (wd[i]>>6) & 0xFFFFFF;
-			else wd[i] = ~(wd[i]>>6) & 0xFFFFFF;
-		//get subframe and page identification (page identification valid only for subframes 4 & 5)
-		subfrmID = (wd[1]>>2) & 0x07;
-		pgID = (wd[2]>>16) & 0x3F;
+	//ten words with navigation data from the OSP message. Bits in each 32 bits word are: D29 D30 d1 d2 ... d30
+	//that is: two last parity bits from previous word followed by the 30 bits of the current word
+	for (int i=0; i<10; i++) wd[i] = mid8.words[i];
+	//check parity of each subframe word
+	parityOK = checkGPSparity(wd[0]);
+	for (int i=1; parityOK && i<10; i++) parityOK &= checkGPSparity(wd[i]);
+	//if parity not OK, ignore all subframe data and return
+	if (!parityOK) {
+		plog->warning(msgMID8Ign + "GPS wrong parity");
+		return false;
+	}
+	//remove parity from each GPS word getting the useful 24 bits
+	//Note that when D30 is set, data bits are complemented (a non documented SiRF OSP feature)
+	for (int i=0; i<10; i++)
+		if ((wd[i] & 0x40000000) == 0) wd[i] = (wd[i]>>6) & 0xFFFFFF;
+		else wd[i] = ~(wd[i]>>6) & 0xFFFFFF;
+	//get subframe and page identification (page identification valid only for subframes 4 & 5)
+	subfrmID = (wd[1]>>2) & 0x07;
+	pgID = (wd[2]>>16) & 0x3F;
+	if (plog->isLevel(Logger::FINER)) {
 		sprintf(msgBuf, "MID8 GPS ch=%d sv=%d subfrm=%d page=%d", ch, sv, subfrmID, pgID);
 		plog->finer(string(msgBuf));
-		//only have interest subframes: 1,2,3 & page 18 of subframe 4 (pgID = 56 in GPS ICD Table 20-V)
-		if ((subfrmID>0 && subfrmID<4) || (subfrmID==4 && pgID==56)) {
-			subfrmID--;		//convert it to its index
-			//store satellite number and message words
-			subfrmCh[ch][subfrmID].sv = sv;
-			for (int i=0; i<10; i++) subfrmCh[ch][subfrmID].words[i] = wd[i];
-			//check if all ephemerides have been already received
-			if (allGPSEphemReceived(ch)) {
-				//if all 3 frames received , pack their data as per MID 15 (see SiRF ICD)
-				for (int i=0; i<3; i++) {	//for each subframe index 0, 1, 2
-					for (int j=0; j<5; j++) { //for each 2 WORDs group
-						navW[i*15+j*3] = (subfrmCh[ch][i].words[j*2]>>8) & 0xFFFF;
-						navW[i*15+j*3+1] = ((subfrmCh[ch][i].words[j*2] & 0xFF)<<8) | ((subfrmCh[ch][i].words[j*2+1]>>16) & 0xFF);
-						navW[i*15+j*3+2] = subfrmCh[ch][i].words[j*2+1] & 0xFFFF;
-					}
-					//the exception is WORD1 (TLM word) of each subframe, whose data are not needed
-					navW[i*15] = sv;
-					navW[i*15+1] &= 0xFF;
-				}
-				//extract ephemeris data and store them into the RINEX instance
-				if (extractGPSEphemeris(navW, sat, bom)) {
-					scaleGPSEphemeris(bom, tTag, bo);
-					rinex.saveNavData('G', sat, bo, tTag);
+	}
+	//only have interest subframes: 1,2,3 & page 18 of subframe 4 (pgID = 56 in GPS ICD Table 20-V)
+	if ((subfrmID>0 && subfrmID<4) || (subfrmID==4 && pgID==56)) {
+		subfrmID--;		//convert it to its index
+		//store satellite number and message words
+		subfrmCh[ch][subfrmID].sv = sv;
+		for (int i=0; i<10; i++) subfrmCh[ch][subfrmID].words[i] = wd[i];
+		//check if all ephemerides have been already received
+		if (allGPSEphemReceived(ch)) {
+			//if all 3 frames received , pack their data as per MID 15 (see SiRF ICD)
+			for (int i=0; i<3; i++) {	//for each subframe index 0, 1, 2
+				for (int j=0; j<5; j++) { //for each 2 WORDs group
+					navW[i*15+j*3] = (subfrmCh[ch][i].words[j*2]>>8) & 0xFFFF;
+					navW[i*15+j*3+1] = ((subfrmCh[ch][i].words[j*2] & 0xFF)<<8) | ((subfrmCh[ch][i].words[j*2+1]>>16) & 0xFF);
+					navW[i*15+j*3+2] = subfrmCh[ch][i].words[j*2+1] & 0xFFFF;
 				}
-				//TBW check if iono data exist & extract and store iono data in subfrmCh[ch][3]
-				//clear storage
-				for (int i=0; i<MAXSUBFR; i++) subfrmCh[ch][i].sv = 0;
+				//the exception is WORD1 (TLM word) of each subframe, whose data are not needed
+				navW[i*15] = sv;
+				navW[i*15+1] &= 0xFF;
+			}
+			//extract ephemeris data and store them into the RINEX instance
+			if (extractGPSEphemeris(navW, sat, bom)) {
+				scaleGPSEphemeris(bom, tTag, bo);
+				saveNavData(rinex, 'G', sat, bo, tTag);
 			}
+			//TBW check if iono data exist & extract and store iono data in subfrmCh[ch][3]
+			//clear storage
+			for (int i=0; i<MAXSUBFR; i++) subfrmCh[ch][i].sv = 0;
 		}
-	} catch (int error) {
-		plog->severe("MID8" + msgEOM + to_string((long long) error));
-		return false;
 	}
 	return true;
 }
 
 /**getMID8GLONavData gets GLONASS navigation data from a MID 8 message and store them into satellite ephemeris (bradcast orbit data) of the RinexData object.
  * 
- * @param ch	the receiver channel number providing data
- * @param sv	the satellite number given by the receiver
+ * @param mid8	the MID 8 message data (see getMID8data)
  * @param rinex	the class instance where data are stored
- * @return true if data properly extracted (correct message length, channel number in range, and correct parity in navigation data), false otherwise
+ * @return true if data properly extracted (correct Hamming code in navigation data), false otherwise
  */
-bool GNSSdataFromOSP::getMID8GLONavData(int ch, int sv, RinexData &rinex) {
+bool GNSSdataFromOSP::getMID8GLONavData(const MID8data &mid8, RinexData &rinex) {
 	CHECK_PAYLOADLEN(43,"MID8 msg len <> 43")
+	int ch = mid8.channel;	//the receiver channel number providing data
+	int sv = mid8.sv;		//the satellite number given by the receiver
 	int sltNum, svx;				//the slot number (n) extracted from from string 4
 	double tTag;			//the time tag for ephemeris data
 	unsigned int gloStrg[3];//a place to store the 84 bits of a GLONASS string
@@ -721,55 +1353,79 @@ bool GNSSdataFromOSP::getMID8GLONavData(int ch, int sv, RinexData &rinex) {
 	unsigned int strNum;	//the GLONASS string number
 	string msgTxt;			//a place to build log messages
 	unsigned int sat = sv;	//the satellite number in the satellite navigation message (slot number for GLONASS). Initially the one given by the receiver
-	try {
-		//get from message payload the GLONASS string and the string number
-		strNum = getGLOstring(gloStrg);
-		if (!checkGLOhamming (gloStrg)) {
-			plog->warning(msgMID8Ign + "GLONASS wrong Hamming code");
-			return false;
-		}
-		msgTxt = "MID8 GLONASS ch=" + to_string((long long) ch) + " sv=" + to_string((long long) sv) + " str=" + to_string((long long) strNum);
-		//store satellite number and message words with inmediate data (strings # 1 to 5)
-		if ((strNum > 0) && (strNum <= MAXSUBFR)) {
-			//if string received is 4, it could be necessary to update inmediately the slot number
-			if (strNum == 4) {
-				//get slot number (n) in string 4, bits 15-11 and update the table of GLONASS satellites
-				sltNum = getBits(gloStrg, 10, 5);
-				if ((sltNum >= 0) && (sltNum <= MAXGLOSATS)) {
-					svx = sv - FIRSTGLOSAT;
-					if (satGLOslt[svx].slot != sltNum) {
-						plog->finer(msgTxt
-							+ " slot=" + to_string((long long) satGLOslt[svx].slot)
-							+ " updated to slot=" + to_string((long long) sltNum));
-						satGLOslt[svx].rcvCh = ch;
-						satGLOslt[svx].slot = sltNum;
-					}
-				} else {
-					msgTxt += " wrong slot=" + to_string((long long) sltNum); 
+	//get from message words the GLONASS string and the string number
+	strNum = getGLOstring(mid8.words, gloStrg);
+	if (!checkGLOhamming (gloStrg)) {
+		plog->warning(msgMID8Ign + "GLONASS wrong Hamming code");
+		return false;
+	}
+	if (plog->isLevel(Logger::FINER)) msgTxt = "MID8 GLONASS ch=" + to_string((long long) ch) + " sv=" + to_string((long long) sv) + " str=" + to_string((long long) strNum);
+	if (singlePass) {
+		setGLOparams(ch, sv, strNum, gloStrg);
+		if (!gloEphPending.empty()) saveGLOpending(rinex, false);
+	}
+	//store satellite number and message words with inmediate data (strings # 1 to 5)
+	if ((strNum > 0) && (strNum <= MAXSUBFR)) {
+		//if string received is 4, it could be necessary to update inmediately the slot number
+		if (strNum == 4) {
+			//get slot number (n) in string 4, bits 15-11 and update the table of GLONASS satellites
+			sltNum = getBits(gloStrg, 10, 5);
+			if ((sltNum >= 0) && (sltNum <= MAXGLOSATS)) {
+				svx = sv - FIRSTGLOSAT;
+				if (satGLOslt[svx].slot != sltNum) {
+					LOG_FINER(plog, msgTxt
+						+ " slot=" + to_string((long long) satGLOslt[svx].slot)
+						+ " updated to slot=" + to_string((long long) sltNum));
+					satGLOslt[svx].rcvCh = ch;
+					satGLOslt[svx].slot = sltNum;
 				}
+			} else {
+				msgTxt += " wrong slot=" + to_string((long long) sltNum); 
 			}
-			strNum--;		//convert string number to its index
-			//store satellite number and message words
-			subfrmCh[ch][strNum].sv = sv;
-			for (int i=0; i<3; i++) subfrmCh[ch][strNum].words[i] = gloStrg[i];
-			for (int i=3; i<10; i++) subfrmCh[ch][strNum].words[i] = 0;
-			//check if all ephemerides have been already received
-			msgTxt += " saved";
-			if (allGLOEphemReceived(ch)) {
-				//extract ephemeris data and store them into the RINEX instance
-				if (extractGLOEphemeris(ch, sat, tTag, bom)) {
+		}
+		strNum--;		//convert string number to its index
+		//store satellite number and message words
+		subfrmCh[ch][strNum].sv = sv;
+		for (int i=0; i<3; i++) subfrmCh[ch][strNum].words[i] = gloStrg[i];
+		for (int i=3; i<10; i++) subfrmCh[ch][strNum].words[i] = 0;
+		//check if all ephemerides have been already received
+		msgTxt += " saved";
+		if (allGLOEphemReceived(ch)) {
+			//extract ephemeris data and store them into the RINEX instance
+			if (extractGLOEphemeris(ch, sat, tTag, bom)) {
+				if (singlePass && !carrierFreqSet[sat-1]) {
+					//the carrier frequency number of this slot is not known yet: keep ephemeris until it is received
+					GLOephemeris pending;
+					pending.sat = sat;
+					pending.tTag = tTag;
+					memcpy(pending.bom, bom, sizeof bom);
+					gloEphPending.push_back(pending);
+					msgTxt += " pending frequency";
+				} else {
 					scaleGLOEphemeris(bom, bo);
-					rinex.saveNavData('R', sat, bo, tTag);
+					saveNavData(rinex, 'R', sat, bo, tTag);
 				}
-				//clear storage
-				for (int i=0; i<MAXSUBFR; i++) subfrmCh[ch][i].sv = 0;
 			}
-		} else msgTxt += " ignored";
-		plog->finer(msgTxt);
-	} catch (int error) {
-		plog->severe("MID8 GLO" + msgEOM + to_string((long long) error));
-		return false;
-	}
+			//clear storage
+			for (int i=0; i<MAXSUBFR; i++) subfrmCh[ch][i].sv = 0;
+		}
+	} else msgTxt += " ignored";
+	LOG_FINER(plog, msgTxt);
+	return true;
+}
+
+/**getMID8GLOparams gets GLONASS parameters (slot and carrier frequency numbers) from the navigation string in a MID8 message.
+ * 
+ * @param mid8	the MID 8 message data (see getMID8data)
+ * @return true if the navigation string has been extracted, false otherwise
+ */
+bool GNSSdataFromOSP::getMID8GLOparams(const MID8data &mid8) {
+	unsigned int gloStrg[3];		//a place to store the 84 bits of the GLONASS nav string
+	CHECK_PAYLOADLEN(43,"MID8 msg len <> 43")
+	//get from message words the GLONASS string and the string number
+	int strNum = getGLOstring(mid8.words, gloStrg);
+	if (strNum == 0) return false;
+	setGLOparams(mid8.channel, mid8.sv, strNum, gloStrg);
 	return true;
 }
 
@@ -785,29 +1441,33 @@ bool GNSSdataFromOSP::getMID15NavData(RinexData &rinex) {
 	int bom[8][4];		//the RINEX broadcats orbit like arrangement for satellite ephemeris mantissa
 	double tTag;		//the time tag for ephemeris data
 	double bo[8][4];	//the RINEX broadcats orbit arrangement for satellite ephemeris
-	int svID;
+	MID15data mid15;
 	string msgMID ("MID15 GPS ephemeris sv="); 
-	try {
-		svID = (int) message.get();
-		msgMID += to_string((long long) svID);
-		for (int i=0; i<45; i++) navW[i] = (unsigned int) message.getUShort();
-		//set HOW bits in navW[1] and navW[2] to 0 (MID15 does not provide data from HOW)
-		navW[1] &= 0xFF00;
-		navW[2] &= 0x0003;
-		//extract ephemerides data and store them into the RINEX instance
-		if (!extractGPSEphemeris(navW, sat, bom)) {
-			plog->warning(msgMID + " Wrong data");
-			return false;
-		}
-		plog->finer(msgMID + " Ephemeris OK");
-		//set bom[7][0] (MID15 has no HOW data) with current GPS seconds scaled by 100 as transmission time
-		bom[7][0] = (int) (epochGPStow * 100.0);
-		scaleGPSEphemeris(bom, tTag, bo);
-		rinex.saveNavData('G', sat, bo, tTag);
-	} catch (int error) {
-		plog->severe("MID15" + msgEOM + to_string((long long) error));
+	CHECK_DECODE(mid15, "MID15")
+	msgMID += to_string((long long) mid15.sv);
+	for (int i=0; i<45; i++) navW[i] = (unsigned int) mid15.words[i];
+	//set HOW bits in navW[1] and navW[2] to 0 (MID15 does not provide data from HOW)
+	navW[1] &= 0xFF00;
+	navW[2] &= 0x0003;
+	//extract ephemerides data and store them into the RINEX instance
+	if (!extractGPSEphemeris(navW, sat, bom)) {
+		plog->warning(msgMID + " Wrong data");
 		return false;
 	}
+	if (!gpsTimeSet) {
+		//no valid GPS time acquired yet: keep ephemeris until it is received to set their transmission time
+		GPSephemeris pending;
+		pending.sat = sat;
+		memcpy(pending.bom, bom, sizeof bom);
+		gpsEphPending.push_back(pending);
+		LOG_FINER(plog, msgMID + " Ephemeris OK, pending GPS time");
+		return true;
+	}
+	LOG_FINER(plog, msgMID + " Ephemeris OK");
+	//set bom[7][0] (MID15 has no HOW data) with current GPS seconds scaled by 100 as transmission time
+	bom[7][0] = (int) (epochGPStow * 100.0);
+	scaleGPSEphemeris(bom, tTag, bo);
+	saveNavData(rinex, 'G', sat, bo, tTag);
 	return true;
 }
 
@@ -820,16 +1480,12 @@ bool GNSSdataFromOSP::getMID19Masks(RTKobservation &rtko) {
 	CHECK_PAYLOADLEN(65,"MID19 msg len <> 65")
 	double elevationMask;
 	double snrMask;
-	try {
-		message.skipBytes(19);	//skip from SubID to DOPmask: 1U 2U 3*1U 2S 6*1U 4U 1U
-		elevationMask = (double) message.getShort();
-		snrMask = (double) message.get();
-		rtko.setMasks(elevationMask/10.0, snrMask);
-	} catch (int error) {
-		plog->severe("MID19" + msgEOM + to_string((long long) error));
-		return false;
-	}
-	plog->finer("MID19 elevation=" + to_string((long double) elevationMask) + " s/n=" + to_string((long double) snrMask));
+	MID19data mid19;
+	CHECK_DECODE(mid19, "MID19")
+	elevationMask = (double) mid19.elevationMask;
+	snrMask = (double) mid19.snrMask;
+	rtko.setMasks(elevationMask/10.0, snrMask);
+	LOG_FINER(plog, "MID19 elevation=" + to_string((long double) elevationMask) + " s/n=" + to_string((long double) snrMask));
 	return true;
 }
 
@@ -845,43 +1501,38 @@ bool GNSSdataFromOSP::getMID28ObsData(RinexData &rinex, bool &sameEpoch) {
 	unsigned short int deltaRangeInterval;
 	double gpsSWtime, pseudorange, carrierFrequency, carrierPhase;
 	char msgBuf[100];
+	MID28data mid28;
 	CHECK_PAYLOADLEN(56,"MID28 msg len <> 20")
+	CHECK_DECODE(mid28, "MID28 ")
 	sameEpoch = false;
-	try {
-		//get data from message MID28
-		channel = message.get();	
-		message.getInt();			//a time tag not used
-		sv = message.get();			//the satellite number assigned by the receiver
-		if ((sv >= FIRSTGPSSAT) && (sv <= LASTGPSSAT)) {
-			sys = 'G';
-			satID = sv;
-		} else if ((sv >= FIRSTGLOSAT) && (sv <= LASTGLOSAT)) {	//it is a GLONASS satellite SirfV
-			sys = 'R';
-			satID = getGLOslot(channel, sv);
-		} else if ((sv >= FIRSTSBASSAT) && (sv <= LASTSBASSAT)) {			//it is a SBAS satellite
-			sys = 'S';
-			satID = sv - 100;
-		} else {
-			plog->warning("MID28 satellite number out of GPS, SBAS, GLONASS ranges:" + to_string((long long) sv));
-			return false;
-		}
-		gpsSWtime = message.getDouble();
-		pseudorange = message.getDouble();
-		carrierFrequency = (double) message.getFloat(); //sign - ?
-		carrierPhase = message.getDouble();
-		message.getUShort();		//the timeIntrack is not used
-		syncFlags = message.get();
-		//get the signal strength as the worst of the C/N0 given
-		carrier2noise = 0;
-		strength = message.get();
-		for (int i=1; i<10; i++)
-			if ((carrier2noise = message.get()) < strength) strength = carrier2noise;
-		deltaRangeInterval = message.getUShort();
-	} catch (int error) {
-		plog->severe("MID28 " + msgEOM + to_string((long long) error));
+	//data from message MID28 (the time tag is not used)
+	channel = mid28.channel;
+	sv = mid28.sv;			//the satellite number assigned by the receiver
+	if ((sv >= FIRSTGPSSAT) && (sv <= LASTGPSSAT)) {
+		sys = 'G';
+		satID = sv;
+	} else if ((sv >= FIRSTGLOSAT) && (sv <= LASTGLOSAT)) {	//it is a GLONASS satellite SirfV
+		sys = 'R';
+		satID = getGLOslot(channel, sv);
+	} else if ((sv >= FIRSTSBASSAT) && (sv <= LASTSBASSAT)) {			//it is a SBAS satellite
+		sys = 'S';
+		satID = sv - 100;
+	} else {
+		plog->warning("MID28 satellite number out of GPS, SBAS, GLONASS ranges:" + to_string((long long) sv));
 		return false;
 	}
-	sprintf(msgBuf,"MID28 tTag=%g ch=%2d sv=%2d sat=%c%02d psr=%g SynFlg=%02X ", gpsSWtime, channel, sv, sys, satID, pseudorange, syncFlags);
+	gpsSWtime = mid28.gpsSWtime;
+	pseudorange = mid28.pseudorange;
+	carrierFrequency = (double) mid28.carrierFrequency; //sign - ?
+	carrierPhase = mid28.carrierPhase;
+	syncFlags = mid28.syncFlags;	//the timeIntrack is not used
+	//get the signal strength as the worst of the C/N0 given
+	carrier2noise = 0;
+	strength = mid28.cn0[0];
+	for (int i=1; i<10; i++)
+		if ((carrier2noise = mid28.cn0[i]) < strength) strength = carrier2noise;
+	deltaRangeInterval = mid28.deltaRangeInterval;
+	if (plog->isLevel(Logger::FINER)) sprintf(msgBuf,"MID28 tTag=%g ch=%2d sv=%2d sat=%c%02d psr=%g SynFlg=%02X ", gpsSWtime, channel, sv, sys, satID, pseudorange, syncFlags);
 	//compute strengthIndex as per RINEX spec (5.7): min(max(strength / 6, 1), 9)
 	strengthIndex = strength / 6;
 	if (strengthIndex < 1) strengthIndex = 1;
@@ -892,10 +1543,10 @@ bool GNSSdataFromOSP::getMID28ObsData(RinexData &rinex, bool &sameEpoch) {
 		if ((syncFlags & 0x10) == 0) carrierFrequency = 0.0;
 		chSatObs.push_back(ChannelObs(sys, satID, pseudorange, carrierPhase, carrierFrequency, (double) strength, 0, strengthIndex, gpsSWtime));
 		sameEpoch = gpsSWtime == chSatObs[0].timeT;
-		plog->finer(string(msgBuf) + "SAVED");
+		LOG_FINER(plog, string(msgBuf) + "SAVED");
 		return true;
 	}
-	plog->finer(string(msgBuf) + "IGNORED");
+	LOG_FINER(plog, string(msgBuf) + "IGNORED");
 	return false;
 }
 
@@ -925,7 +1576,7 @@ bool GNSSdataFromOSP::getMID70NavData(RinexData &rinex) {
 		n4 = message.get();
 		kp = message.get();
 		nSvs = message.get();
-		plog->finer("MID70 SID12 GLONASS ephem. for nSVs=" + to_string((long long) nSvs));
+		LOG_FINER(plog, "MID70 SID12 GLONASS ephem. for nSVs=" + to_string((long long) nSvs));
 		while (nSvs > 0) {
 			validEphem = message.get() == 1;	//Validity flag
 			sat = message.get();	//Slot number
@@ -953,7 +1604,7 @@ bool GNSSdataFromOSP::getMID70NavData(RinexData &rinex) {
 				bom[0][3] =  (int) tTag;	//Message frame time (tk+nd*86400) in seconds of the UTC week?
 				bom[3][3] = 0;			//Age of oper. information (days) (E)
 				scaleGLOEphemeris(bom, bo);
-				rinex.saveNavData('R', sat, bo, tTag);
+				saveNavData(rinex, 'R', sat, bo, tTag);
 			} else plog->warning("GLONASS ephem. not valid for " + to_string((long long) sat));
 			nSvs--;
 		}
@@ -976,30 +1627,28 @@ bool GNSSdataFromOSP::checkGPSparity (unsigned int d) {
 	if ((d & 0x40000000) != 0) toCheck = (d & 0xC0000000) | (~d & 0x3FFFFFFF);
 	//compute the parity of the bit stream
 	unsigned int parity = 0;
-	for (int i=0; i<6; i++) parity |= (bitsSet(parityBitMask[i] & toCheck) % 2) << (5-i);
+	for (int i=0; i<6; i++) parity = (parity << 1) | bitParity(parityBitMask[i] & toCheck);
 	return parity == (d & 0x3F);
 }
 
-/**checkGLOhamming checks the GLONASS string for correct hamming code.
+/**checkGLOhamming checks the GLONASS string for correct hamming code using procedure in GLONASS ICD.
+ * Checksums C1 to C7 are computed for the check bits 1-7 and the data bits participating in each one, and the checksum
+ * of all string bits is computed for the check bit 8 (see gloHammingMask). Bit 85 of the string (the idle bit) is always 0.
+ * The string data are correct when all checksums are 0, or when only one check bit is wrong (only one of C1-C7 and the
+ * checksum of all bits are 1, or only the later is 1). Strings with errors in data bits are not corrected.
  *  
- * @param ps a pointer to the string to be checked contained in the 3 words pointed by pw   
- * @return true if code computed is equal to the current one in bits 1-8 of the string
- */
-bool GNSSdataFromOSP::checkGLOhamming (unsigned int* ps) {
-	//To be implemented
-	return true;
-};
-
-/**bitsSet counts the number of bits set in a given 32 bits stream.
- * Used to compute the XOR of a bit stream for computing parity
- * 
- * @param lw The 32 bit stream to be processed (32 LSB in the long)
- * @return the number of bits set to 1 in lw 
+ * @param gloStrg the 84 bits of the GLONASS string to be checked
+ * @return true if code computed is equal to the current one in bits 1-8 of the string, or only a check bit is wrong
  */
-unsigned int GNSSdataFromOSP::bitsSet(unsigned int lw) {
-	int count = 0;
-	for (int i=0; i<32; i++) count += (int)((lw>>i) & 0x01);
-	return count;
+bool GNSSdataFromOSP::checkGLOhamming (const unsigned int (&gloStrg)[3]) {
+	unsigned int checksums = 0;
+	for (int i=0; i<8; i++)
+		checksums |= bitParity((gloHammingMask[i][0] & gloStrg[0])
+			^ (gloHammingMask[i][1] & gloStrg[1])
+			^ (gloHammingMask[i][2] & gloStrg[2])) << i;
+	unsigned int syndrome = checksums & 0x7F;
+	if ((checksums & 0x80) == 0) return syndrome == 0;
+	return (syndrome & (syndrome - 1)) == 0;
 }
 
 /**allGPSEphemReceived checks if all GPS ephemerides in a given channel have been received
@@ -1069,45 +1718,11 @@ bool GNSSdataFromOSP::extractGPSEphemeris(const unsigned int (&navW)[45], unsign
 		return false;
 	}
 */
-	//fill bom extracting data according SiRF ICD (see A.5 Message # 15: Ephemeris Data) 
-	//broadcast line 0
-	bom[0][0] = navW[11];	//T0C
-	bom[0][1] = getTwosComplement(((navW[13] & 0x00FF)<<14) | ((navW[14]>>2) & 0x3FFF), 22);	//Af0
-	bom[0][2] = getTwosComplement(((navW[12] & 0x00FF)<<8) | ((navW[13]>>8) & 0x00FF), 16);	//Af1
-	bom[0][3] = getTwosComplement((navW[12]>>8) & 0x00FF, 8);								//Af2
-	//broadcast line 1
-	bom[1][0] = iode1;	//IODE
-	bom[1][1] = getTwosComplement(((navW[15+3] & 0x00FF)<<8) | ((navW[15+4]>>8) & 0x00FF), 16);	//Crs
-	bom[1][2] = getTwosComplement(((navW[15+4] & 0x00FF)<<8) | ((navW[15+5]>>8) & 0x00FF), 16);	//Delta n
-	bom[1][3] = getTwosComplement(((navW[15+5] & 0x00FF)<<24) | ((navW[15+6] & 0xFFFF)<<8) | ((navW[15+7]>>8) & 0x00FF),32);//M0
-	//broadcast line 2
-	bom[2][0] = getTwosComplement(((navW[15+7] & 0x00FF)<<8) | ((navW[15+8]>>8) & 0x00FF), 16);			//Cuc
-	bom[2][1] = (((navW[15+8] & 0x00FF)<<24) | ((navW[15+9] & 0xFFFF)<<8) | ((navW[15+10]>>8) & 0x00FF));	//e
-	bom[2][2] = getTwosComplement(((navW[15+10] & 0x00FF)<<8) | ((navW[15+11]>>8) & 0x00FF), 16);		//Cus
-	bom[2][3] = ((navW[15+11] & 0x00FF)<<24) | ((navW[15+12] & 0xFFFF)<<8) | ((navW[15+13]>>8) & 0x00FF);	//sqrt(A)
-	//broadcast line 3
-	bom[3][0] = ((navW[15+13] & 0x00FF)<<8) | ((navW[15+14]>>8) & 0x00FF);	//Toe
-	bom[3][1] = getTwosComplement(navW[30+3], 16);						//Cic
-	bom[3][2] = getTwosComplement(((navW[30+4] & 0xFFFF)<<16) | (navW[30+5] & 0xFFFF), 32);	//OMEGA
-	bom[3][3] = getTwosComplement(navW[30+6], 16);						//CIS
-	//broadcast line 4
-	bom[4][0] = getTwosComplement(((navW[30+7] & 0xFFFF)<<16) | (navW[30+8] & 0xFFFF), 32);	//i0
-	bom[4][1] = getTwosComplement(navW[30+9], 16);											//Crc
-	bom[4][2] = getTwosComplement(((navW[30+10] & 0xFFFF)<<16) | (navW[30+11] & 0xFFFF), 32);	//w (omega)
-	bom[4][3] = getTwosComplement(((navW[30+12] & 0xFFFF)<<8) | ((navW[30+13]>>8) & 0x00FF), 24);//w dot
-	//broadcast line 5
-	bom[5][0] = getTwosComplement((navW[30+14]>>2) & 0x03FFF, 14);	//IDOT
-	bom[5][1] = (navW[3]>>4) & 0x0003;				//Codes on L2
-	bom[5][2] = ((navW[3]>>6) & 0x03FF) + 1024L;	//GPS week#
-	bom[5][3] = (navW[4]>>7) & 0x0001;				//L2P data flag
-	//broadcast line 6
-	bom[6][0] = navW[3] & 0x000F;			//SV accuracy
-	bom[6][1] = (navW[4]>>10) & 0x003F;	//SV health
-	bom[6][2] = getTwosComplement((navW[10]>>8) & 0x00FF, 8);//TGD
+	//fill bom extracting data according SiRF ICD (see A.5 Message # 15: Ephemeris Data) and the GPS_EPHFIELDS layout table
+	for (const NavField &field : GPS_EPHFIELDS) bom[field.row][field.col] = navFieldValue(getNavWBits(navW, field), field);
+	bom[5][2] += 1024;	//GPS week#
 	bom[6][3] = iodcLSB | (navW[4] & 0x0300);		//IODC
-	//broadcast line 7
 	bom[7][0] = (((navW[1] & 0x00FF)<<9) | ((navW[2]>>7) & 0x01FF)) * 600;	//the 17 MSB of the Zcount in HOW (W2) converted to sec and scaled by 100
-	bom[7][1] = (navW[15+14]>>7) & 0x0001;			//Fit flag
 	bom[7][2] = 0;		//Spare. Not used
 	bom[7][3] = iode2;	//Spare. Used for temporary store of IODE in subframe 3
 	return true;
@@ -1139,22 +1754,13 @@ bool GNSSdataFromOSP::extractGLOEphemeris(int ch, unsigned int &sv, double &tTag
 	tkSec += (tk & 0x01) == 0? 0: 30;	//add sec. interval to secs.
 	//convert frame time (in GLONASS time) to an UTC instant (use GPS ephemeris for convenience)
 	tTag = getSecsGPSEphe(1996 + (n4-1)*4, 1, nt, 0, 0, (float) tb) - 3*60*60;
-	bom[0][0] = (int) tTag;													//Toc
-	bom[0][1] = - getSigned(getBits(subfrmCh[ch][3].words, 58, 22), 22);	//Clock bias TauN: bits 80-59 string 4
-	bom[0][2] = getSigned(getBits(subfrmCh[ch][2].words, 68, 11), 11);	//Relative frequency bias GammaN: bits 79-69 string 3
+	//fill bom extracting data according the GLO_EPHFIELDS layout table
+	for (const NavField &field : GLO_EPHFIELDS)
+		bom[field.row][field.col] = navFieldValue(getBits(subfrmCh[ch][field.word].words, field.bit, field.len), field);
+	bom[0][0] = (int) tTag;					//Toc
+	bom[0][1] = - bom[0][1];				//-TauN
 	bom[0][3] = ((int) getGPStow(tTag) + 518400) % 604800;		//seconds from UTC week start (mon 00:00). Note that GPS week starts sun 00:00. 
-	bom[1][0] = getSigned(getBits(subfrmCh[ch][0].words, 8, 27), 27);	//Satellite position, X: bits 35-9 string 1
-	bom[1][1] = getSigned(getBits(subfrmCh[ch][0].words, 40, 24), 24);	//Satellite velocity, X: bits 64-41 string 1
-	bom[1][2] = getSigned(getBits(subfrmCh[ch][0].words, 35, 5), 5);	//Satellite acceleration, X: bits 40-36 string 1
-	bom[1][3] = getBits(subfrmCh[ch][1].words, 77, 3);					//Satellite health Bn: bits 80-78 string 2
-	bom[2][0] = getSigned(getBits(subfrmCh[ch][1].words, 8, 27), 27);	//Satellite position, Y: bits 35-9 string 2
-	bom[2][1] = getSigned(getBits(subfrmCh[ch][1].words, 40, 24), 24);	//Satellite velocity, Y: bits 64-41 string 2
-	bom[2][2] = getSigned(getBits(subfrmCh[ch][1].words, 35, 5), 5);	//Satellite acceleration, Y: bits 40-36 string 2
-	bom[2][3] = carrierFreq[sv-1];										//Frequency number (-7 ... +13)
-	bom[3][0] = getSigned(getBits(subfrmCh[ch][2].words, 8, 27), 27);	//Satellite position, Z: bits 35-9 string 3
-	bom[3][1] = getSigned(getBits(subfrmCh[ch][2].words, 40, 24), 24);	//Satellite velocity, Z: bits 64-41 string 3
-	bom[3][2] = getSigned(getBits(subfrmCh[ch][2].words, 35, 5), 5);	//Satellite acceleration, Z: bits 40-36 string 3
-	bom[3][3] = getBits(subfrmCh[ch][1].words, 48, 5);			//Age of oper. information (days) (E): bits 53-49 string 2
+	bom[2][3] = carrierFreq[sv-1];			//Frequency number (-7 ... +13)
 	return true;
 }
 
@@ -1174,24 +1780,23 @@ void GNSSdataFromOSP::scaleGPSEphemeris(int (&bom)[8][4], double &tTag, double (
 				bom[0][0] * GPS_SCALEFACTOR[0][0] ); //T0C
 	double aDouble;
 	int iodc = bom[6][3];
-	for(int i=0; i<8; i++) {
-		for(int j=0; j<4; j++) {
-			if (i==7 && j==1) {		//compute the Fit Interval from fit flag
-				if (bom[7][1] == 0) aDouble = 4.0;
-				else if (iodc>=240 && iodc<=247) aDouble = 8.0;
-				else if (iodc>=248 && iodc<=255) aDouble = 14.0;
-				else if (iodc==496) aDouble = 14.0;
-				else if (iodc>=497 && iodc<=503) aDouble = 26.0;
-				else if (iodc>=1021 && iodc<=1023) aDouble = 26.0;
-				else aDouble = 6.0;
-				bo[7][1] = aDouble;
-			} else if (i==6 && j==0) {	//compute User Range Accuracy value
-				bo[6][0] = bom[6][0] < 16? GPS_URA[bom[6][0]] : GPS_URA[15];
-			} else if (i==2 && (j==1 || j==3)) {	//e and sqrt(A) are 32 bits unsigned
-				bo[2][j] = ((unsigned int) bom[2][j]) * GPS_SCALEFACTOR[2][j];
-			} else bo[i][j] = bom[i][j] * GPS_SCALEFACTOR[i][j]; //the rest signed
-		}
-	}
+	for(int i=0; i<8; i++)
+		for(int j=0; j<4; j++)
+			bo[i][j] = bom[i][j] * GPS_SCALEFACTOR[i][j];
+	//e and sqrt(A) are 32 bits unsigned
+	bo[2][1] = ((unsigned int) bom[2][1]) * GPS_SCALEFACTOR[2][1];
+	bo[2][3] = ((unsigned int) bom[2][3]) * GPS_SCALEFACTOR[2][3];
+	//compute User Range Accuracy value
+	bo[6][0] = bom[6][0] < 16? GPS_URA[bom[6][0]] : GPS_URA[15];
+	//compute the Fit Interval from fit flag
+	if (bom[7][1] == 0) aDouble = 4.0;
+	else if (iodc>=240 && iodc<=247) aDouble = 8.0;
+	else if (iodc>=248 && iodc<=255) aDouble = 14.0;
+	else if (iodc==496) aDouble = 14.0;
+	else if (iodc>=497 && iodc<=503) aDouble = 26.0;
+	else if (iodc>=1021 && iodc<=1023) aDouble = 26.0;
+	else aDouble = 6.0;
+	bo[7][1] = aDouble;
 	return;
 }
 
@@ -1213,7 +1818,7 @@ void GNSSdataFromOSP::scaleGLOEphemeris(int (&bom)[8][4], double (&bo)[8][4]) {
 	return;
 }
 
-/**getGLOstring gets ten words from a MID8 OSP message payload and packs the 84 bits of a GLONASS string they contain into three words.
+/**getGLOstring gets the ten words of a MID8 OSP message payload and packs the 84 bits of a GLONASS string they contain into three words.
  *It is assumed that:
  *a-the OSP word 0, bits 23 to  0 contain GLONASS string bits 84 to 61	(24 b)
  *b-the OSP word 1, bits 24 to  0 contain GLONASS string bits 60 to 36	(25 b)
@@ -1224,23 +1829,126 @@ void GNSSdataFromOSP::scaleGLOEphemeris(int (&bom)[8][4], double (&bo)[8][4]) {
  *	- bit 1 is moved to bit 0 of compact string word 0, 2 to bit 1 of compact string word 0, and so on
  * 	- string bit 84 becomes bit 19 of compact string word 2
  *
+ * @param ospW the ten words of the OSP message payload
  * @param stringW the three words array where the 84 bits of the GLONASS string are packed 
- * @return string number extracted from the bit stream passed, or 0 in case of error occurred
+ * @return string number extracted from the bit stream passed
  */
-int GNSSdataFromOSP::getGLOstring(unsigned int (&stringW)[3]) {
-	unsigned int ospW[10];	//a place to store the ten words of OSP message payload
-	try {
-		for (int i=0; i<10; i++) ospW[i] = message.getUInt();
-	} catch (int error) {
-		plog->severe("MID8 " + msgEOM + to_string((long long) error));
-		return 0;
-	}
+int GNSSdataFromOSP::getGLOstring(const unsigned int (&ospW)[10], unsigned int (&stringW)[3]) {
 	stringW[0] = ((ospW[2] & 0x003FFFFF) << 10) | ((ospW[3] & 0x01FF8000) >> 15);
 	stringW[1] = ((ospW[0] & 0x0000000F) << 28) | ((ospW[1] & 0x01FFFFFF) <<  3) | ((ospW[2] & 0x01C00000) >> 22);
 	stringW[2] = ((ospW[0] & 0x00FFFFF0) >>  4);
 	return getBits(stringW, 80, 4);
 }
 
+/**setGLOparams updates the GLONASS slot and carrier frequency tables with data in the given GLONASS navigation string:
+ * - the slot number (n) in string 4 is stored in the table of GLONASS satellites, if not already stated for this satellite
+ * - the slot number (nA) in almanac strings 6, 8, 10, 12 and 14 is saved to identify the slot the carrier frequency number
+ *   contained in the following almanac string in this channel belongs.
+ * - the carrier frequency number (HnA) in almanac strings 7, 9, 11, 13 and 15 is stored in the slot - carrier frequency table
+ *
+ * @param ch the channel receiver where this satellite is being tracked
+ * @param sat the satellite number that receiver has assigned to this satellite
+ * @param strNum the string number
+ * @param gloStrg the 84 bits of the GLONASS navigation string
+ */
+void GNSSdataFromOSP::setGLOparams(int ch, int sat, int strNum, unsigned int (&gloStrg)[3]) {
+	int n, nA, hnA;
+	switch (strNum) {
+	case 4:
+		//get slot number (n) in string 4, bits 15-11
+		//and store its first occurrence in the table of GLONASS satellites
+		n = getBits(gloStrg, 10, 5);
+		sat -= FIRSTGLOSAT;
+		if (satGLOslt[sat].slot == 0) {	//if this table entry is empty 
+			satGLOslt[sat].rcvCh = ch;
+			satGLOslt[sat].slot = n;
+		}
+		break;
+	case 6:
+	case 8:
+	case 10:
+	case 12:
+	case 14:
+		//get from almanac data the slot number (nA) in bits 77-73 (see GLONASS ICD for details)
+		//and prepare slot - carrier frequency table to receive the value corresponding to this slot (if not already received)
+		nA = getBits(gloStrg, 72, 5);
+		if (nA > 0 && nA <= MAXGLOSLOTS) {
+			nAhnA[ch].nA = nA;
+			nAhnA[ch].strFhnA = strNum + 1;	//set the string number where continuation data should come
+		} else plog->warning("MID8 GLO almanac string " + to_string((long long) strNum) + " bad slot number = " + to_string((long long) nA));
+		break;
+	case 7:
+	case 9:
+	case 11:
+	case 13:
+	case 15:
+		//check in the slot - carrier frequency table the expected string number in this channel
+		//if current string is the expected one to provide the carrier frequency data, store it
+		if (nAhnA[ch].strFhnA == strNum) {
+			hnA = getBits(gloStrg, 9, 5);	//HnA in almanac: bits 14-10
+			if (hnA >= 25) hnA -= 32;	//set negative values as per table 4.11 of the GLONASS ICD
+			carrierFreq[nAhnA[ch].nA - 1] = hnA;
+			carrierFreqSet[nAhnA[ch].nA - 1] = true;
+		}
+		break;
+	default:
+		break;
+	}
+}
+
+/**saveGLOpending saves into the RinexData object the GLONASS ephemeris kept waiting for the carrier frequency number of their slot.
+ *
+ * @param rinex the RinexData object where data are saved
+ * @param all when true all ephemeris are saved, when false only the ones whose carrier frequency number is already known
+ */
+void GNSSdataFromOSP::saveGLOpending(RinexData &rinex, bool all) {
+	double bo[8][4];	//the RINEX broadcats orbit arrangement for satellite ephemeris (after applying scale factors)
+	vector<GLOephemeris>::iterator it = gloEphPending.begin();
+	while (it != gloEphPending.end()) {
+		if (all || carrierFreqSet[it->sat - 1]) {
+			if (!carrierFreqSet[it->sat - 1]) plog->warning("GLONASS carrier frequency number not acquired for slot " + to_string((long long) it->sat));
+			it->bom[2][3] = carrierFreq[it->sat - 1];	//Frequency number (-7 ... +13)
+			scaleGLOEphemeris(it->bom, bo);
+			saveNavData(rinex, 'R', it->sat, bo, it->tTag);
+			it = gloEphPending.erase(it);
+		} else it++;
+	}
+}
+
+/**saveGPSpending saves into the RinexData object the GPS ephemeris from MID15 kept waiting for a valid GPS time,
+ * using the current GPS seconds as their transmission time (MID15 has no HOW data).
+ *
+ * @param rinex the RinexData object where data are saved
+ */
+void GNSSdataFromOSP::saveGPSpending(RinexData &rinex) {
+	double tTag;		//the time tag for ephemeris data
+	double bo[8][4];	//the RINEX broadcats orbit arrangement for satellite ephemeris (after applying scale factors)
+	if (!gpsTimeSet) plog->warning("GPS time not acquired for MID15 ephemeris transmission time");
+	for (vector<GPSephemeris>::iterator it = gpsEphPending.begin(); it != gpsEphPending.end(); it++) {
+		it->bom[7][0] = (int) (epochGPStow * 100.0);
+		scaleGPSEphemeris(it->bom, tTag, bo);
+		saveNavData(rinex, 'G', it->sat, bo, tTag);
+	}
+	gpsEphPending.clear();
+}
+
+/**logGLOparams logs at FINER level the GLONASS slot and carrier frequency numbers acquired.
+ */
+void GNSSdataFromOSP::logGLOparams() {
+	char txtBuffer[80];
+	if (!plog->isLevel(Logger::FINER)) return;
+	plog->finer("GLONASS slot numbers used (from string 4 in MID8):");
+	for (int i=0; i<MAXGLOSATS; i++) {
+		sprintf(txtBuffer, "->sv=%2d slot=%2d rxChannel=%2d ", i+FIRSTGLOSAT, satGLOslt[i].slot, satGLOslt[i].rcvCh);
+		plog->finer(string(txtBuffer));
+	}
+	plog->finer("GLONASS carrier frequency numbers (from almanac in MID8):");
+	for (int i = 0; i < MAXGLOSLOTS; i++) {
+		sprintf(txtBuffer, "->slot=%2d frequency=%2d", i+1, carrierFreq[i]);
+		plog->finer(string(txtBuffer));
+	}
+}
+
 /**getGLOslot gets the GLONASS slot for a satellite number and channel given by the receiver
  *
  * @param ch the channel receiver where this satellite is being tracked
@@ -25,8 +25,11 @@
 #ifndef GNSSDATAFROMOSP_H
 #define GNSSDATAFROMOSP_H
 
+#include <deque>
+
 //from CommonClasses
 #include "Logger.h"
+#include "OSPDecoder.h"
 #include "OSPMessage.h"
 #include "RinexData.h"
 #include "RTKobservation.h"
@@ -51,23 +54,44 @@
 #define FIRSTSBASSAT 101
 #define LASTSBASSAT 200
 #define MAXSBASSATS 100
+///In single pass acquisition, the maximum number of epochs waiting for the slot numbers of their GLONASS satellites
+#define MAXEPOCHWAIT 600
+///In parallel decoding, the approximate size in bytes of each chunk of messages decoded by a thread
+#define DECODECHUNKSIZE 1048576
+///In parallel decoding, the number of chunks each thread can decode in advance of the chunk being acquired
+#define DECODECHUNKSAHEAD 4
 
 //Constants usefull for computations
 const double LSPEED = 299792458.0;	//the speed of light
 const double C1CADJ = 299792458.0;	//to adjust C1C (pseudorrange L1 in meters) = C1CADJ (the speed of light) * clkOff
 const double L1CADJ = 1575420000.0;	//to adjust L1C (carrier phase in cycles) =  L1CADJ (L1 carrier frequency) * clkOff
 const double L1WLINV = 1575420000.0 / 299792458.0; //the inverse of L1 wave length to convert m/s to Hz.
-const double ThisPI = 3.1415926535898;
+constexpr double ThisPI = 3.1415926535898;
 
 //a bit mask definition for the bits participating in the computation of parity (see GPS ICD)
 //bit mask order: D29 D30 d1 d2 d3 ... d24 ... d29 d30
 //parityBitMask[i] identifies bits participating (set to 1) or not (set to 0) in the computation of parity bit i.
 const unsigned int parityBitMask[] = {0xBB1F3480, 0x5D8F9A40, 0xAEC7CD00, 0x5763E680, 0x6BB1F340, 0x8B7A89C0};
+//a bit mask definition for the bits participating in the Hamming code checksums of a GLONASS string (see GLONASS ICD)
+//the 84 bits of the string are packed in 3 words, being string bit 1 the bit 0 of word 0, and string bit 84 the bit 19 of word 2
+//gloHammingMask[i] identifies the bits (the check bit i+1 and the data bits 9-84) participating in checksum Ci+1.
+//The last one is the checksum of all string bits.
+const unsigned int gloHammingMask[8][3] = {
+	{0xAAAD5B01, 0x55555556, 0x000AAAAB},
+	{0x33366D02, 0x9999999B, 0x000CCCCD},
+	{0xC3C78E04, 0xE1E1E1E3, 0x0000F0F1},
+	{0xFC07F008, 0xFE01FE03, 0x0000FF01},
+	{0xFFF80010, 0xFFFE0003, 0x000F0001},
+	{0x00000020, 0xFFFFFFFC, 0x00000001},
+	{0x00000040, 0x00000000, 0x000FFFFE},
+	{0xFFFFFFFF, 0xFFFFFFFF, 0x000FFFFF}
+};
 //Default value for unknown data
 const string unknown ("UNKNOWN");
 const string msgEOM (" error getting data after end of message: ");
 const string msgMID8Ign ("MID8 ignored: ");
 const string msgFew (" ignored: few SVs in solution");
+const string OBSCODES[] = {"C1C", "L1C", "D1C", "S1C"};	//the observable codes saved in each epoch for each satellite tracked
 //@endcond
 
 /**GNSSdataFromOSP class defines data and methods used to acquire RINEX or RTK header and epoch data from a binary OSP file containing receiver messages.
@@ -78,13 +102,21 @@ const string msgFew (" ignored: few SVs in solution");
  *		to be acquired, and optionally the logger to be used
  *	-# Acquire header data and save them into an object of RinexData or RTKobservation class using acqHeaderData methods
  *	-# Header data acquired can be used to generate / print RINEX or RTK files (see available methods in RinexData and RTKobservation classes for that)
- *	-# As header data may be sparse among the binary file, rewind it before performing any other data acquisition
+ *	-# As header data may be sparse among the binary file, rewind it (using the rewind method) before performing any other data acquisition
  *	-# Acquire an epoch data and save them into an object of RinexData or RTKobservation class using acqEpochData methods
  *	-# Epoch data acquired can be used to generate / print RINEX or RTK file epoch (see available methods in RinexData and RTKobservation classes)
  *	-# Repeat above steps 5 and 6 while epoch data are available in the input file.
  *<p>
+ * Alternatively, header and epoch data can be acquired in a single pass over the binary file: after calling setSinglePass,
+ * the acqEpochData method for RinexData objects also acquires the header data and the GLONASS parameters as they appear in the file.
+ * When all epochs have been acquired, endSinglePass shall be called to complete the acquisition, and header data can be printed.
+ *<p>
+ * Messages can be decoded in parallel by several threads when acquiring epoch data, stating before the number of threads
+ * to use with setDecodeThreads. The results are the same as when decoding sequentially.
+ *<p>
  * This version implements acquisition from binary files containing OSP messages collected from SiRFIV receivers.
  * Each OSP message starts with the payload length (2 bytes) and follows the n bytes of the message payload.
+ * Messages having a fixed layout are decoded in one shot into the data structures defined in OSPDecoder.
  *<p>
  *A detailed definition of OSP messages can be found in the document "SiRFstarIV (TM) One Socket Protocol 
  * Interface Control Document Issue 9".
@@ -102,6 +134,11 @@ public:
 	bool acqEpochData(RinexData &, bool, bool);
 	bool acqEpochData(RTKobservation &);
 	bool acqGLOparams();
+	void rewind();
+	bool setIndex(string idxFileName);
+	void setSinglePass(RinexData &);
+	bool endSinglePass(RinexData &);
+	void setDecodeThreads(int nThreads);
 
 private:
 	string receiver;
@@ -111,7 +148,9 @@ private:
 	double epochGPStow;
 	double epochClkBias;
 	double epochClkDrift;
+	bool gpsTimeSet;		//true when a valid GPS time has been acquired from a MID7 message
 	FILE* ospFile;
+	OSPReader reader;		//to read messages from the binary file, usually as views over its mapped image
 	OSPMessage message;
 	struct SubframeData {		//A type to store 50bps message data
 		int sv;					//the satelite number
@@ -138,6 +177,27 @@ private:
 	};
 	GLONASSfreq nAhnA[MAXCHANNELS];	//for each channel, the nA and frequency data
 	int carrierFreq[MAXGLOSLOTS];
+	bool carrierFreqSet[MAXGLOSLOTS];	//for each slot, true when its carrier frequency number has been acquired
+	struct GLOephemeris {	//A type to store GLONASS ephemeris waiting for the carrier frequency number of their slot
+		unsigned int sat;	//the slot number
+		double tTag;		//the time tag for ephemeris data
+		int bom[8][4];		//the ephemeris mantissas, as extracted from nav message
+	};
+	vector<GLOephemeris> gloEphPending;
+	struct GPSephemeris {	//A type to store GPS ephemeris from MID15 waiting for a valid GPS time to set their transmission time
+		unsigned int sat;	//the satellite number
+		int bom[8][4];		//the ephemeris mantissas, as extracted from nav message
+	};
+	vector<GPSephemeris> gpsEphPending;
+	//single pass acquisition state
+	bool singlePass;	//true when header data and GLONASS parameters are acquired while acquiring epoch data
+	bool rxIdSet;		//identification of receiver set
+	bool apxSet;		//approximate position set
+	bool frsEphSet;		//first epoch time set
+	bool intrvBegin;	//interval begin time has been stated
+	bool intrvSet;		//observations interval set
+	int intrvWeek;		//the GPS week of the interval begin time
+	double intrvTow;	//the GPS TOW of the interval begin time
 	struct ChannelObs {		//storage for channel/satellite observables during one epoch
 		char system;		//system identification
 		int satPrn;			//satellite number
@@ -162,26 +222,63 @@ private:
 		}
 	};
 	vector<ChannelObs> chSatObs;
-	//Constant data used to convert GPS broadcast navigation data to "true" values
-	double GPS_SCALEFACTOR[8][4];	//the scale factors to apply to GPS broadcast orbit data to obtain ephemeris (see GPS ICD)
-	double GPS_URA[16];			//the User Range Accuracy values corresponding to URA index in the GPS SV broadcast data (see GPS ICD)
-	double GLO_SCALEFACTOR[4][4];	//the scale factors to apply to GLONASS broadcast orbit data to obtain ephemeris (see GLONASS ICD)
+	struct PendingEpoch {	//storage for an epoch waiting for the slot numbers of its GLONASS satellites (single pass mode)
+		int week;			//GPS week of the epoch time
+		double tow;			//GPS TOW of the epoch time
+		double clkBias;		//receiver clock bias
+		double clkDrift;	//receiver clock drift
+		vector<ChannelObs> obs;	//the observables acquired in each channel
+		//constructor
+		PendingEpoch(int we, double to, double cb, double cd, vector<ChannelObs> &ob) {
+			week = we;
+			tow = to;
+			clkBias = cb;
+			clkDrift = cd;
+			obs = ob;
+		}
+	};
+	deque<PendingEpoch> pendingEpochs;
+	struct SysObsHandles {	//the RinexData handles of the observables saved for a system
+		char system;		//system identification
+		int handle[4];		//the handles for C1C, L1C, D1C and S1C observables, or -1 if not defined in the RINEX header for this system
+	};
+	vector<SysObsHandles> obsHandles;
+	//Parallel decoding of messages
+	int decodeThreads;			//the number of threads used to decode messages when acquiring epochs (1 means sequential decoding)
+	struct ParallelDecode;		//the state of a parallel decoding (defined in the implementation file)
+	ParallelDecode* parDecode;	//the parallel decoding in progress, or NULL if not started
+	struct DecodedChunk;		//the results of decoding a chunk of messages (defined in the implementation file)
+	DecodedChunk* recording;	//the chunk where a decoding thread records acquired data, or NULL if they are saved directly
 	//Logger
 	Logger* plog;		//the place to send logging messages
 	bool dynamicLog;	//true when created dynamically here, false when provided externally
 
-	void setTblValues();
+	void setObsHandles(RinexData &);
+	int acqEpochMessage(RinexData &, bool, bool);
+	void saveEpochTime(RinexData &);
+	void saveNavData(RinexData &, char, unsigned int, double (&)[8][4], double);
+	bool acqEpochParallel(RinexData &);
+	void beginParallelDecode(bool, bool);
+	void endParallelDecode();
+	static void decodeChunks(ParallelDecode *, GNSSdataFromOSP *);
+	void saveEpochObs(RinexData &, vector<ChannelObs> &, double, double);
+	bool isEpochReady();
+	bool savePendingEpoch(RinexData &);
 	bool checkGPSparity (unsigned int );
-	bool checkGLOhamming (unsigned int* );
-	unsigned int bitsSet(unsigned int );
+	bool checkGLOhamming (const unsigned int (&gloStrg)[3]);
 	bool allGPSEphemReceived(int );
 	bool extractGPSEphemeris(const unsigned int (&navW)[45], unsigned int &sat, int (&bom)[8][4]);
 	bool extractGLOEphemeris(int ch, unsigned int &sat, double &tTag, int (&bom)[8][4]);
 	void scaleGPSEphemeris(int (&bom)[8][4], double &tTag, double (&bo)[8][4]);
 	void scaleGLOEphemeris(int (&bom)[8][4], double (&bo)[8][4]);
 	bool allGLOEphemReceived(int );
-	int getGLOstring(unsigned int (&stringW)[3]);
+	int getGLOstring(const unsigned int (&ospW)[10], unsigned int (&stringW)[3]);
 	int getGLOslot(int ch, int sat);
+	void setGLOparams(int ch, int sat, int strNum, unsigned int (&gloStrg)[3]);
+	void saveGLOpending(RinexData &, bool);
+	void saveGPSpending(RinexData &);
+	void logGLOparams();
+	void setMID7HeaderData(RinexData &, bool);
 
 	bool getMID2PosData(RinexData &);
 	bool getMID2PosData(RTKobservation &);
@@ -189,8 +286,10 @@ private:
 	bool getMID6RxData(RinexData &);
 	bool getMID7TimeData(RinexData &);
 	bool getMID7Interval(RinexData &);
-	bool getMID8GPSNavData(int, int, RinexData &);
-	bool getMID8GLONavData(int, int, RinexData &);
+	bool getMID8data(MID8data &);
+	bool getMID8GPSNavData(const MID8data &, RinexData &);
+	bool getMID8GLONavData(const MID8data &, RinexData &);
+	bool getMID8GLOparams(const MID8data &);
 	bool getMID15NavData(RinexData &);
 	bool getMID19Masks(RTKobservation &);
 	bool getMID28ObsData(RinexData &, bool &);
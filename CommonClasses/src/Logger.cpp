@@ -12,6 +12,7 @@
 Logger::Logger(void) {
 	levelSet = INFO;
 	fileLog = stderr;
+	target = NULL;
 }
 
 /**Constructs a Logger using the given file name for recording messages.
@@ -24,6 +25,19 @@ Logger::Logger(string fileName) {
 	levelSet = INFO;
 	fileLog = fopen(fileName.c_str(), "a");
 	if (fileLog == NULL) fileLog = stderr;
+	target = NULL;
+}
+
+/**Constructs a Logger deferring messages, to be forwarded later to the given target Logger.
+ *<p>The log level is set to the current level of the target Logger. Only messages at this level are kept.
+ *No log file is used: messages are kept in memory until they are forwarded using the forward method.
+ *
+ *@param targetLog the Logger where messages will be forwarded
+ */
+Logger::Logger(Logger* targetLog) {
+	levelSet = targetLog->levelSet;
+	fileLog = NULL;
+	target = targetLog;
 }
 
 /**Constructs a Logger using the given file name for recording messages, sets the logging message prefix, and prints the given initial message.
@@ -38,6 +52,7 @@ Logger::Logger(string fileName, string prefix, string initMsg) {
 	levelSet = INFO;
 	fileLog = fopen(fileName.c_str(), "a");
 	if (fileLog == NULL) fileLog = stderr;
+	target = NULL;
 	program = prefix;
 	logMsg(SEVERE, initMsg);
 }
@@ -45,6 +60,7 @@ Logger::Logger(string fileName, string prefix, string initMsg) {
 /**Destructs the Logger object after closing its log file. 
  */
 Logger::~Logger(void) {
+	if (target != NULL) return;
 	logMsg (SEVERE, "logging END");
 	if (fileLog != stderr) fclose(fileLog);
 }
@@ -90,7 +106,7 @@ void Logger::setLevel(string levelDescription) {
  *@return true when messages at the given level would be logged, false otherwise.
  */
 bool Logger::isLevel(logLevel level) {
-	if (levelSet <= level) return true;
+	if (level <= levelSet) return true;
 	return false;
 }
 
@@ -106,7 +122,7 @@ bool Logger::isLevel(logLevel level) {
  *@param levelDescription the word describing the log level to set
  */
 bool Logger::isLevel(string levelDescription) {
-	if (levelSet <= identifyLevel(levelDescription)) return true;
+	if (identifyLevel(levelDescription) <= levelSet) return true;
 	return false;
 }
 
@@ -179,6 +195,24 @@ void Logger::finest(string toLog) {
 	logMsg(FINEST, toLog);
 }
 
+/**deferredSize gives the number of messages deferred up to now.
+ *
+ *@return the number of messages deferred, or 0 if the Logger does not defer messages
+ */
+unsigned int Logger::deferredSize() {
+	return deferredMsgs.size();
+}
+
+/**forward records through the target Logger the deferred messages in the given range, in the order they were generated.
+ *<p>Messages are identified by their order, starting at 0. Messages not forwarded are just ignored.
+ *
+ *@param first the index of the first message to forward
+ *@param last the index after the last message to forward
+ */
+void Logger::forward(unsigned int first, unsigned int last) {
+	for (; (first < last) && (first < deferredMsgs.size()); first++) target->logMsg(deferredLevels[first], deferredMsgs[first]);
+}
+
 //*Private methods
 
 /**logMsg is an internal method to tag, format, and log messages data passed by log level methods.
@@ -187,14 +221,15 @@ void Logger::finest(string toLog) {
  *@param message contains its description
  */
 void Logger::logMsg(logLevel msgLevel, string msg) {
-	time_t rawtime;
-	struct tm * timeinfo;
 	char txtBuf[80];
 
-	time (&rawtime);
-	timeinfo = localtime (&rawtime);
-	if (msgLevel == SEVERE) strftime(txtBuf, sizeof txtBuf, " %Y-%m-%d %H:%M:%S ", timeinfo);
-	else strftime(txtBuf, sizeof txtBuf, " %H:%M:%S ", timeinfo);
+	if (target != NULL) {
+		deferredLevels.push_back(msgLevel);
+		deferredMsgs.push_back(msg);
+		return;
+	}
+	if (msgLevel == SEVERE) formatLocalTime(txtBuf, sizeof txtBuf, (char*) " %Y-%m-%d %H:%M:%S ");
+	else formatLocalTime(txtBuf, sizeof txtBuf, (char*) " %H:%M:%S ");
 	fprintf(fileLog, "%s%s", program.c_str(), txtBuf);
 	switch (msgLevel) {
 	case SEVERE: fprintf(fileLog, "(SVR) "); break;
@@ -21,6 +21,7 @@
 #define LOGGER_H
 
 #include <string>
+#include <vector>
 #include <time.h>
 #include <stdio.h>
 
@@ -33,6 +34,13 @@ using namespace std;
 		If the log level is not explicitly stated, the default level is INFO.
  *	-# Log any message that would be necessary using the method corresponding to the desired log level of the message.
  *		Only those messages having level from SEVERE to the current level stated are recorded in the log file.
+ *<p>Messages at CONFIG, FINE, FINER or FINEST levels usually need some formatting work to compose their text. To avoid this work when
+ *the message would not be recorded, they can be logged using the LOG_CONFIG, LOG_FINE, LOG_FINER or LOG_FINEST macros, which compose
+ *the message text only when the level check passes. For example:
+ *<p>	LOG_FINE(plog, "Epoch " + to_string(tow) + " sats=" + to_string(nSats));
+ *<p>When the message is composed in several statements, the same effect is obtained using isLevel before composing it.
+ *<p>A Logger can also be defined to defer messages instead of recording them, for example when they are generated in a worker thread.
+ *Deferred messages are kept in memory and forwarded later, in the order they were generated, to the target Logger stated when it was defined.
  */
 class Logger {
 public:
@@ -42,6 +50,7 @@ public:
 	Logger(string, string, string);
 	Logger(string);
 	Logger(void);
+	Logger(Logger*);
 	~Logger(void);
 	void setPrgName(string);
 	void setLevel(logLevel);
@@ -55,12 +64,23 @@ public:
 	void fine(string);
 	void finer(string);
 	void finest(string);
+	unsigned int deferredSize();
+	void forward(unsigned int, unsigned int);
 private:
 	string program;		//program name to tag logs
 	logLevel levelSet;	//maximum level to log
 	FILE * fileLog;
+	Logger* target;		//the Logger where deferred messages are forwarded, or NULL when messages are recorded directly
+	vector<logLevel> deferredLevels;	//the level of each deferred message
+	vector<string> deferredMsgs;		//the text of each deferred message
 
 	void logMsg(logLevel msgLevel, string msg);
 	logLevel identifyLevel(string level);
 };
+
+///Macros to log the message MSG through the Logger pointed by PLOG, evaluating MSG only when it would be actually recorded
+#define LOG_CONFIG(PLOG, MSG) do { if ((PLOG)->isLevel(Logger::CONFIG)) (PLOG)->config(MSG); } while (0)
+#define LOG_FINE(PLOG, MSG) do { if ((PLOG)->isLevel(Logger::FINE)) (PLOG)->fine(MSG); } while (0)
+#define LOG_FINER(PLOG, MSG) do { if ((PLOG)->isLevel(Logger::FINER)) (PLOG)->finer(MSG); } while (0)
+#define LOG_FINEST(PLOG, MSG) do { if ((PLOG)->isLevel(Logger::FINEST)) (PLOG)->finest(MSG); } while (0)
 #endif
\ No newline at end of file
@@ -0,0 +1,153 @@
+/** @file MappedFile.cpp
+ * Contains the implementation of the MappedFile class.
+ */
+
+#include "MappedFile.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#include <io.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#else
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#endif
+
+/**Constructs a MappedFile object without any file mapped.
+ */
+MappedFile::MappedFile(void) {
+	base = NULL;
+	length = 0;
+#ifdef _WIN32
+	mapHandle = NULL;
+#endif
+}
+
+/**Destructs MappedFile objects, releasing the current mapping.
+ */
+MappedFile::~MappedFile(void) {
+	unmap();
+}
+
+/**map maps into memory the whole file already open in the given stream.
+ * Any former mapping is released before.
+ *
+ * @param file the stream where the file to be mapped is open
+ * @return true if the file has been mapped, false otherwise (empty file, not a regular file, or system error)
+ */
+bool MappedFile::map(FILE* file) {
+	unmap();
+	if (file == NULL) return false;
+#ifdef _WIN32
+	HANDLE fileHandle = (HANDLE) _get_osfhandle(_fileno(file));
+	LARGE_INTEGER fileSize;
+	if ((fileHandle == INVALID_HANDLE_VALUE) || (GetFileType(fileHandle) != FILE_TYPE_DISK)) return false;
+	if (!GetFileSizeEx(fileHandle, &fileSize) || (fileSize.QuadPart <= 0)) return false;
+	if ((mapHandle = CreateFileMapping(fileHandle, NULL, PAGE_READONLY, 0, 0, NULL)) == NULL) return false;
+	if ((base = (const char*) MapViewOfFile(mapHandle, FILE_MAP_READ, 0, 0, 0)) == NULL) {
+		CloseHandle(mapHandle);
+		mapHandle = NULL;
+		return false;
+	}
+	length = fileSize.QuadPart;
+#else
+	struct stat fileStat;
+	if ((fstat(fileno(file), &fileStat) != 0) || !S_ISREG(fileStat.st_mode) || (fileStat.st_size <= 0)) return false;
+	void* addr = mmap(NULL, (size_t) fileStat.st_size, PROT_READ, MAP_PRIVATE, fileno(file), 0);
+	if (addr == MAP_FAILED) return false;
+	madvise(addr, (size_t) fileStat.st_size, MADV_SEQUENTIAL);
+	base = (const char*) addr;
+	length = fileStat.st_size;
+#endif
+	return true;
+}
+
+/**unmap releases the current mapping, if any.
+ */
+void MappedFile::unmap() {
+	if (base == NULL) return;
+#ifdef _WIN32
+	UnmapViewOfFile(base);
+	CloseHandle(mapHandle);
+	mapHandle = NULL;
+#else
+	munmap((void*) base, (size_t) length);
+#endif
+	base = NULL;
+	length = 0;
+}
+
+/**isMapped checks if a file is currently mapped.
+ *
+ * @return true if a file is mapped, false otherwise
+ */
+bool MappedFile::isMapped() {
+	return base != NULL;
+}
+
+/**data provides the address of the first byte of the mapped image.
+ * Note that the mapped image is not null terminated.
+ *
+ * @return the address of the first byte of the mapped file, or NULL if nothing is mapped
+ */
+const char* MappedFile::data() {
+	return base;
+}
+
+/**size provides the size in bytes of the mapped image.
+ *
+ * @return the size of the mapped file, or 0 if nothing is mapped
+ */
+long long MappedFile::size() {
+	return length;
+}
+
+/**tell gets the current position in the given stream as a 64 bits offset from the beginning of the file.
+ *
+ * @param file the stream
+ * @return the current stream position, or -1 if an error happened
+ */
+long long MappedFile::tell(FILE* file) {
+#ifdef _WIN32
+	return _ftelli64(file);
+#else
+	return (long long) ftello(file);
+#endif
+}
+
+/**seek sets the position in the given stream to a 64 bits offset from the beginning of the file.
+ *
+ * @param file the stream
+ * @param pos the offset from the beginning of the file to set
+ * @return true if the position has been set, false otherwise
+ */
+bool MappedFile::seek(FILE* file, long long pos) {
+#ifdef _WIN32
+	return _fseeki64(file, pos, SEEK_SET) == 0;
+#else
+	return fseeko(file, (off_t) pos, SEEK_SET) == 0;
+#endif
+}
+
+/**fileStamp gets the size and the last modification time of the regular file open in the given stream.
+ * They allow to check if data derived from the file contents (f.e. an index) are still valid.
+ *
+ * @param file the stream
+ * @param size the size in bytes of the file
+ * @param modTime the last modification time of the file, in seconds
+ * @return true if data have been obtained, false otherwise (not a regular file, or system error)
+ */
+bool MappedFile::fileStamp(FILE* file, long long &size, long long &modTime) {
+#ifdef _WIN32
+	struct _stat64 fileStat;
+	if ((_fstat64(_fileno(file), &fileStat) != 0) || ((fileStat.st_mode & _S_IFREG) == 0)) return false;
+#else
+	struct stat fileStat;
+	if ((fstat(fileno(file), &fileStat) != 0) || !S_ISREG(fileStat.st_mode)) return false;
+#endif
+	size = (long long) fileStat.st_size;
+	modTime = (long long) fileStat.st_mtime;
+	return true;
+}
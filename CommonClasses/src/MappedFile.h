@@ -0,0 +1,51 @@
+/** @file MappedFile.h
+ * Contains the MappedFile class definition used to access the whole content of an input file through a memory mapped image.
+ *
+ *Copyright 2015 Francisco Cancillo
+ *<p>
+ *This file is part of the RXtoRINEX tool.
+ *<p>
+ *RXtoRINEX is free software: you can redistribute it and/or modify it under the terms of the GNU General Public License
+ *as published by the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+ *RXtoRINEX is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ *warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *See the GNU General Public License for more details.
+ *<p>
+ *A copy of the GNU General Public License can be found at <http://www.gnu.org/licenses/>.
+ *<p>Ver.	|Date	|Reason for change
+ *<p>---------------------------------
+ *<p>V1.0	|10/2026	|First release
+ */
+#ifndef MAPPEDFILE_H
+#define MAPPEDFILE_H
+
+#include <stdio.h>
+
+/**MappedFile class provides read only access to the bytes of a file already open as a stream, mapping the whole file into memory.
+ *<p>The mapping is stated from the FILE stream given, and it is independent of the stream position, which is not modified.
+ *Static methods are provided to get and set the stream position as 64 bits offsets, allowing to synchronize the stream
+ *with the position of data accessed through the mapped image.
+ *<p>Mapping is not possible for empty files or for streams not related to a regular file (pipes, consoles, ...).
+ *In this case the caller shall use the stream to access data.
+ */
+class MappedFile {
+	const char* base;			//the address of the first byte of the mapped image, or NULL if nothing is mapped
+	long long length;			//the size in bytes of the mapped image
+#ifdef _WIN32
+	void* mapHandle;			//the handle of the file mapping object
+#endif
+	MappedFile(const MappedFile &);				//copies are not allowed
+	MappedFile &operator=(const MappedFile &);	//copies are not allowed
+public:
+	MappedFile(void);
+	~MappedFile(void);
+	bool map(FILE* file);		//map the whole file open in the given stream
+	void unmap();				//release the current mapping, if any
+	bool isMapped();			//checks if a file is currently mapped
+	const char* data();			//provides the address of the first byte of the mapped image
+	long long size();			//provides the size in bytes of the mapped image
+	static long long tell(FILE* file);				//get the current position in the stream as a 64 bits offset
+	static bool seek(FILE* file, long long pos);	//set the stream position to the given 64 bits offset
+	static bool fileStamp(FILE* file, long long &size, long long &modTime);	//get size and modification time of the file open in the stream
+};
+#endif
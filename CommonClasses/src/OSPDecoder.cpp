@@ -0,0 +1,341 @@
+/** @file OSPDecoder.cpp
+ * Contains the OSP message layout tables and the implementation of the OSPDecoder class.
+ */
+
+#include "OSPDecoder.h"
+
+#include <string.h>
+
+//@cond DUMMY
+///Macros to define layout fields: stored in the data structure (and printed if label is not NULL), only printed, bit fields, and variable length fields
+#define FIELD(NAME, TYPE, OFFSET, COUNT, DATA, MEMBER, LABEL, FORMAT, SUFFIX) {NAME, TYPE, OFFSET, COUNT, -1, 0, 0, offsetof(DATA, MEMBER), LABEL, FORMAT, SUFFIX}
+#define PFIELD(NAME, TYPE, OFFSET, COUNT, LABEL, FORMAT, SUFFIX) {NAME, TYPE, OFFSET, COUNT, -1, 0, 0, OSPNOMEMBER, LABEL, FORMAT, SUFFIX}
+#define BITFIELD(NAME, OFFSET, SHIFT, MASK, LABEL, FORMAT, SUFFIX) {NAME, OSP_U4, OFFSET, 1, -1, SHIFT, MASK, OSPNOMEMBER, LABEL, FORMAT, SUFFIX}
+#define VARFIELD(NAME, TYPE, OFFSET, COUNTFROM, LABEL, FORMAT, SUFFIX) {NAME, TYPE, OFFSET, OSPTOEND, COUNTFROM, 0, 0, OSPNOMEMBER, LABEL, FORMAT, SUFFIX}
+#define NFIELDS(TABLE) ((int) (sizeof TABLE / sizeof TABLE[0]))
+
+//Layouts of OSP messages (see SiRF ICD). Offsets include the MID byte
+const OSPField MID2FIELDS[] = {
+	FIELD("X-position", OSP_S4, 1, 1, MID2data, x, "X:", "%8d;", ""),
+	FIELD("Y-position", OSP_S4, 5, 1, MID2data, y, "Y:", "%8d;", ""),
+	FIELD("Z-position", OSP_S4, 9, 1, MID2data, z, "Z:", "%8d;", ""),
+	FIELD("X-velocity", OSP_S2, 13, 1, MID2data, vx, "vX:", "%4hd;", ""),
+	FIELD("Y-velocity", OSP_S2, 15, 1, MID2data, vy, "vY:", "%4hd;", ""),
+	FIELD("Z-velocity", OSP_S2, 17, 1, MID2data, vz, "vZ:", "%4hd;", ""),
+	FIELD("GPS Week", OSP_U2, 22, 1, MID2data, week, "wk:", "%4hu;", ""),
+	FIELD("GPS TOW", OSP_U4, 24, 1, MID2data, tow, "TOW:", "%6u;", ""),
+	FIELD("SVs in Fix", OSP_U1, 28, 1, MID2data, svs, "SVs:", "%2d", "")
+};
+const OSPField MID6FIELDS[] = {
+	PFIELD("SiRF Version Length", OSP_U1, 1, 1, NULL, "", ""),
+	PFIELD("Customer Version Length", OSP_U1, 2, 1, NULL, "", ""),
+	VARFIELD("SiRF Version", OSP_CHAR, 3, 0, "SiRF ver:", "%c", ""),
+	VARFIELD("Customer Version", OSP_CHAR, OSPFOLLOWS, 1, ";Cust ver:", "%c", "")
+};
+const OSPField MID7FIELDS[] = {
+	FIELD("Extended GPS Week", OSP_U2, 1, 1, MID7data, week, "ewk:", "%3hu;", ""),
+	FIELD("GPS TOW", OSP_U4, 3, 1, MID7data, tow, "TOW:", "%6u;", ""),
+	FIELD("SVs", OSP_U1, 7, 1, MID7data, svs, "SVs:", "%2d;", ""),
+	FIELD("Clock Drift", OSP_U4, 8, 1, MID7data, drift, "drft:", "%8u;", ""),
+	FIELD("Clock Bias", OSP_U4, 12, 1, MID7data, bias, "bias:", "%8u;", ""),
+	PFIELD("Estimated GPS Time", OSP_U4, 16, 1, "EsT:", "%8u", "")
+};
+const OSPField MID8FIELDS[] = {
+	FIELD("Channel", OSP_U1, 1, 1, MID8data, channel, "ch:", "%2d;", ""),
+	FIELD("SV ID", OSP_U1, 2, 1, MID8data, sv, "SV:", "%2d;", ""),
+	BITFIELD("TOW (HOW word)", 7, 13, 0x1FFFF, "TOW:", "%6u;", ""),
+	BITFIELD("Subframe ID (HOW word)", 7, 8, 0x07, "sfr:", "%2u;", ""),
+	BITFIELD("Page ID (word 3)", 11, 24, 0x3F, "pg:", "%2u;", "\n\t"),
+	FIELD("Words", OSP_U4, 3, 10, MID8data, words, "", "%08X;", "")
+};
+const OSPField MID11FIELDS[] = {
+	PFIELD("ACK ID", OSP_U1, 1, 1, "ack:", "%3d", "")
+};
+const OSPField MID12FIELDS[] = {
+	PFIELD("NACK ID", OSP_U1, 1, 1, "nack:", "%3d", "")
+};
+const OSPField MID15FIELDS[] = {
+	FIELD("SV ID", OSP_U1, 1, 1, MID15data, sv, "SV:", "%2d\n", ""),
+	FIELD("Subframe 1", OSP_U2, 2, 15, MID15data, words, "\t", " %04hX", "\n"),
+	{"Subframe 2", OSP_U2, 32, 15, -1, 0, 0, offsetof(MID15data, words) + 15 * sizeof(unsigned short), "\t", " %04hX", "\n"},
+	{"Subframe 3", OSP_U2, 62, 15, -1, 0, 0, offsetof(MID15data, words) + 30 * sizeof(unsigned short), "\t", " %04hX", "\n"}
+};
+const OSPField MID19FIELDS[] = {
+	FIELD("Elevation Nav. Mask", OSP_S2, 20, 1, MID19data, elevationMask, NULL, "", ""),
+	FIELD("Power Nav. Mask", OSP_U1, 22, 1, MID19data, snrMask, NULL, "", "")
+};
+const OSPField MID28FIELDS[] = {
+	FIELD("Channel", OSP_U1, 1, 1, MID28data, channel, "Ch:", "%2d;", ""),
+	FIELD("Time Tag", OSP_U4, 2, 1, MID28data, timeTag, "Ttg:", "%8u;", ""),
+	FIELD("Satellite ID", OSP_U1, 6, 1, MID28data, sv, "SV:", "%2d;", ""),
+	FIELD("GPS Software Time", OSP_R8, 7, 1, MID28data, gpsSWtime, "Tsw:", "%14.3f;", ""),
+	FIELD("Pseudorange", OSP_R8, 15, 1, MID28data, pseudorange, "Psr:", "%14.3f;", ""),
+	FIELD("Carrier Frequency", OSP_R4, 23, 1, MID28data, carrierFrequency, "Cfr:", "%14.3f;", ""),
+	FIELD("Carrier Phase", OSP_R8, 27, 1, MID28data, carrierPhase, "Cph:", "%14.3f;", ""),
+	FIELD("Time in Track", OSP_U2, 35, 1, MID28data, timeInTrack, "Trk:", "%3hu;", ""),
+	FIELD("Sync Flags", OSP_U1, 37, 1, MID28data, syncFlags, "Syn:", "%02X", "\n"),
+	FIELD("C/N0", OSP_U1, 38, 10, MID28data, cn0, "\tCN0:", "%3d;", ""),
+	FIELD("Delta Range Interval", OSP_U2, 48, 1, MID28data, deltaRangeInterval, "\n\tDri:", "%5hu", "")
+};
+const OSPField MID50FIELDS[] = {
+	PFIELD("SBAS PRN", OSP_U1, 1, 1, "SBASsv:", "%3d;", ""),
+	PFIELD("SBAS Mode", OSP_U1, 2, 1, "Md:", "%3d;", ""),
+	PFIELD("DGPS Timeout", OSP_U1, 3, 1, "Tout:", "%3d;", ""),
+	PFIELD("Flag bits", OSP_U1, 4, 1, "Flg:", "%02X", "")
+};
+const OSPField MID56FIELDS[] = {
+	PFIELD("Message Sub ID", OSP_U1, 1, 1, "SID:", "%3d;", "")
+};
+const OSPField SIDFIELDS[] = {	//for messages where only the sub ID is printed: MID64, MID67 and MID70
+	PFIELD("Message Sub ID", OSP_U1, 1, 1, "SID:", "%3d", "")
+};
+const OSPField MID68FIELDS[] = {
+	PFIELD("Wrapped MID", OSP_U1, 1, 1, "Wraps:", "%3d", "")
+};
+const OSPField MID75FIELDS[] = {
+	PFIELD("Message Sub ID", OSP_U1, 1, 1, "SID:", "%2d;", ""),
+	PFIELD("Echo Message ID", OSP_U1, 2, 1, " echo to MID", "%2d ", ""),
+	PFIELD("Echo Message Sub ID", OSP_U1, 3, 1, "SID", "%2d:", ""),
+	PFIELD("ACK/NACK/ERROR", OSP_U1, 4, 1, "", "%02x", "")
+};
+const OSPField MID255FIELDS[] = {
+	PFIELD("ASCII String", OSP_CHAR, 1, OSPTOEND, "", "%c", "")
+};
+
+const OSPLayout LAYOUTS[] = {
+	{2, "Measure Navigation Data Out", sizeof(MID2data), MID2FIELDS, NFIELDS(MID2FIELDS)},
+	{6, "Software Version String", 0, MID6FIELDS, NFIELDS(MID6FIELDS)},
+	{7, "Clock Status Data", sizeof(MID7data), MID7FIELDS, NFIELDS(MID7FIELDS)},
+	{8, "50 BPS Data", sizeof(MID8data), MID8FIELDS, NFIELDS(MID8FIELDS)},
+	{11, "Command Acknowledgment", 0, MID11FIELDS, NFIELDS(MID11FIELDS)},
+	{12, "Command Negative Acknowledgment", 0, MID12FIELDS, NFIELDS(MID12FIELDS)},
+	{15, "Ephemeris Data (Response to Poll)", sizeof(MID15data), MID15FIELDS, NFIELDS(MID15FIELDS)},
+	{19, "Navigation Parameters", sizeof(MID19data), MID19FIELDS, NFIELDS(MID19FIELDS)},
+	{28, "Navigation Library Measurement Data", sizeof(MID28data), MID28FIELDS, NFIELDS(MID28FIELDS)},
+	{50, "SBAS Parameters", 0, MID50FIELDS, NFIELDS(MID50FIELDS)},
+	{56, "Extended Ephemeris Data", 0, MID56FIELDS, NFIELDS(MID56FIELDS)},
+	{64, "Navigation Library Messages", 0, SIDFIELDS, NFIELDS(SIDFIELDS)},
+	{67, "Multi-constellation Navigation Data", 0, SIDFIELDS, NFIELDS(SIDFIELDS)},
+	{68, "Measurement Engine", 0, MID68FIELDS, NFIELDS(MID68FIELDS)},
+	{70, "GLONASS Almanac/Ephemeris Response", 0, SIDFIELDS, NFIELDS(SIDFIELDS)},
+	{75, "ACK/NACK/ERROR Notification", 0, MID75FIELDS, NFIELDS(MID75FIELDS)},
+	{255, "ASCII Development Data Output", 0, MID255FIELDS, NFIELDS(MID255FIELDS)}
+};
+//@endcond
+
+/**Registry constructs the registry of layouts, indexing them by MID and computing the payload length needed to decode each one.
+ */
+OSPDecoder::Registry::Registry() {
+	unsigned int end;
+	memset(layouts, 0, sizeof layouts);
+	memset(length, 0, sizeof length);
+	for (int i = 0; i < NFIELDS(LAYOUTS); i++) {
+		const OSPLayout &lay = LAYOUTS[i];
+		layouts[lay.mid] = &lay;
+		for (int j = 0; j < lay.nFields; j++) {
+			const OSPField &field = lay.fields[j];
+			if (field.member == OSPNOMEMBER) continue;
+			end = field.offset + field.count * typeSize(field.type);
+			if (end > length[lay.mid]) length[lay.mid] = end;
+		}
+	}
+}
+
+/**registry provides the registry of layouts, built the first time it is used.
+ *
+ * @return the registry of layouts
+ */
+const OSPDecoder::Registry &OSPDecoder::registry() {
+	static const Registry reg;
+	return reg;
+}
+
+/**layout provides the layout of messages having the given MID.
+ *
+ * @param mid the message identification
+ * @return a pointer to the layout, or NULL if there is no layout defined for this MID
+ */
+const OSPLayout* OSPDecoder::layout(int mid) {
+	if ((mid < 0) || (mid > 255)) return NULL;
+	return registry().layouts[mid];
+}
+
+/**typeSize provides the size in the payload of a value of the given type.
+ *
+ * @param type the type of the value
+ * @return its size in bytes
+ */
+unsigned int OSPDecoder::typeSize(OSPType type) {
+	switch (type) {
+	case OSP_U2:
+	case OSP_S2:
+		return 2;
+	case OSP_S3:
+		return 3;
+	case OSP_U4:
+	case OSP_S4:
+	case OSP_R4:
+		return 4;
+	case OSP_R8:
+		return 8;
+	default:
+		return 1;
+	}
+}
+
+//@cond DUMMY
+//functions to extract values from the payload bytes
+inline unsigned int getU2(const unsigned char* p) {
+	return p[0] << 8 | p[1];
+}
+inline unsigned int getU4(const unsigned char* p) {
+	return (unsigned int) p[0] << 24 | p[1] << 16 | p[2] << 8 | p[3];
+}
+inline int getS3(const unsigned char* p) {
+	unsigned int uvalue = p[0] << 16 | p[1] << 8 | p[2];
+	return (uvalue & 0x800000)? (int) uvalue - 0x1000000 : (int) uvalue;
+}
+inline float getR4(const unsigned char* p) {	//bytes in reverse order
+	union {
+		unsigned char bytes[4];
+		float value;
+	} data;
+	for (int i = 0; i < 4; i++) data.bytes[i] = p[3 - i];
+	return data.value;
+}
+inline double getR8(const unsigned char* p) {	//bytes in order 3, 2, 1, 0, 7, 6, 5, 4
+	union {
+		unsigned char bytes[8];
+		double value;
+	} data;
+	for (int i = 0; i < 4; i++) {
+		data.bytes[i] = p[3 - i];
+		data.bytes[i + 4] = p[7 - i];
+	}
+	return data.value;
+}
+inline unsigned int getBitField(const OSPField &field, unsigned int value) {
+	return field.mask == 0? value : (value >> field.shift) & field.mask;
+}
+//@endcond
+
+/**decode decodes the given message payload into a data structure, using the layout of its MID.
+ * It is checked once that the payload contains all fields to be stored, and then values are extracted and stored without further checks.
+ *
+ * @param message the message to decode
+ * @param data the address of the data structure where message fields are stored
+ * @param size the size of the data structure, which shall be the one stated in the layout
+ * @return true if data have been decoded, false otherwise (no layout or different size for this MID, or the payload is too short)
+ */
+bool OSPDecoder::decode(OSPMessage &message, void* data, size_t size) {
+	const Registry &reg = registry();
+	int mid = message.mid();
+	if (mid < 0) return false;
+	const OSPLayout* lay = reg.layouts[mid];
+	if ((lay == NULL) || (lay->size == 0) || (lay->size != size) || (message.payloadLen() < reg.length[mid])) return false;
+	const unsigned char* payload = message.bytes();
+	for (int i = 0; i < lay->nFields; i++) {
+		const OSPField &field = lay->fields[i];
+		if (field.member == OSPNOMEMBER) continue;
+		const unsigned char* p = payload + field.offset;
+		unsigned char* d = (unsigned char*) data + field.member;
+		for (int n = 0; n < field.count; n++) {
+			switch (field.type) {
+			case OSP_U1:
+			case OSP_S1:
+			case OSP_CHAR:
+				*d = *p;
+				break;
+			case OSP_U2:
+			case OSP_S2:
+				*(unsigned short*) d = (unsigned short) getU2(p);
+				break;
+			case OSP_S3:
+				*(int*) d = getS3(p);
+				break;
+			case OSP_U4:
+			case OSP_S4:
+				*(unsigned int*) d = getBitField(field, getU4(p));
+				break;
+			case OSP_R4:
+				*(float*) d = getR4(p);
+				break;
+			case OSP_R8:
+				*(double*) d = getR8(p);
+				break;
+			}
+			p += typeSize(field.type);
+			d += field.type == OSP_S3? sizeof(int) : typeSize(field.type);
+		}
+	}
+	return true;
+}
+
+/**print prints to the given stream the fields of the message having a label in its layout, using their format.
+ * For each field, its label, the values formatted and its suffix are printed.
+ *<p>When the payload is too short, values are printed up to the last complete one.
+ *
+ * @param message the message to print
+ * @param out the stream where fields are printed
+ * @return true if all fields have been printed (or there is no layout for the message MID), false if the payload is too short
+ */
+bool OSPDecoder::print(OSPMessage &message, FILE* out) {
+	const OSPLayout* lay = layout(message.mid());
+	if (lay == NULL) return true;
+	const unsigned char* payload = message.bytes();
+	unsigned int length = message.payloadLen();
+	unsigned int pos = 0;	//the payload position after the previous field
+	unsigned int start, size, count;
+	for (int i = 0; i < lay->nFields; i++) {
+		const OSPField &field = lay->fields[i];
+		start = field.offset == OSPFOLLOWS? pos : field.offset;
+		size = typeSize(field.type);
+		if (field.countFrom >= 0) {		//the number of values is in other field with fixed offset
+			const OSPField &countField = lay->fields[field.countFrom];
+			if (countField.offset + typeSize(countField.type) > length) return false;
+			count = countField.type == OSP_U2? getU2(payload + countField.offset) : payload[countField.offset];
+		} else if (field.count == OSPTOEND) count = start < length? (length - start) / size : 0;
+		else count = field.count;
+		pos = start + count * size;
+		if (field.label == NULL) continue;
+		fputs(field.label, out);
+		for (unsigned int n = 0; n < count; n++) {
+			const unsigned char* p = payload + start + n * size;
+			if (start + (n + 1) * size > length) return false;
+			switch (field.type) {
+			case OSP_U1:
+				fprintf(out, field.format, (unsigned int) *p);
+				break;
+			case OSP_S1:
+				fprintf(out, field.format, (int) (signed char) *p);
+				break;
+			case OSP_CHAR:
+				fprintf(out, field.format, (char) *p);
+				break;
+			case OSP_U2:
+				fprintf(out, field.format, getU2(p));
+				break;
+			case OSP_S2:
+				fprintf(out, field.format, (int) (short) getU2(p));
+				break;
+			case OSP_S3:
+				fprintf(out, field.format, getS3(p));
+				break;
+			case OSP_U4:
+				fprintf(out, field.format, getBitField(field, getU4(p)));
+				break;
+			case OSP_S4:
+				fprintf(out, field.format, (int) getU4(p));
+				break;
+			case OSP_R4:
+				fprintf(out, field.format, (double) getR4(p));
+				break;
+			case OSP_R8:
+				fprintf(out, field.format, getR8(p));
+				break;
+			}
+		}
+		fputs(field.suffix, out);
+	}
+	return true;
+}
@@ -0,0 +1,166 @@
+/** @file OSPDecoder.h
+ * Contains the OSPDecoder class definition and the message layout tables used to decode and print OSP messages.
+ *
+ *Copyright 2015 Francisco Cancillo
+ *<p>
+ *This file is part of the RXtoRINEX tool.
+ *<p>
+ *RXtoRINEX is free software: you can redistribute it and/or modify it under the terms of the GNU General Public License
+ *as published by the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+ *RXtoRINEX is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ *warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *See the GNU General Public License for more details.
+ *<p>
+ *A copy of the GNU General Public License can be found at <http://www.gnu.org/licenses/>.
+ *<p>Ver.	|Date	|Reason for change
+ *<p>---------------------------------
+ *<p>V1.0	|10/2026	|First release
+ */
+#ifndef OSPDECODER_H
+#define OSPDECODER_H
+
+#include <stdio.h>
+#include <stddef.h>
+
+#include "OSPMessage.h"	//from CommonClasses
+
+using namespace std;
+
+//@cond DUMMY
+///The types of values in OSP message payloads (see SiRF ICD). Multibyte integers have the most significant byte first
+enum OSPType {
+	OSP_U1, OSP_S1,		//8 bits unsigned and signed integers
+	OSP_U2, OSP_S2,		//16 bits unsigned and signed integers
+	OSP_S3,				//24 bits signed integer
+	OSP_U4, OSP_S4,		//32 bits unsigned and signed integers
+	OSP_R4,				//32 bits floating point, bytes in reverse order
+	OSP_R8,				//64 bits floating point, bytes in order 3, 2, 1, 0, 7, 6, 5, 4
+	OSP_CHAR			//a character
+};
+///Field offset value stating that the field follows the previous one in the layout
+const short OSPFOLLOWS = -1;
+///Field count value stating that the field values extend up to the payload end
+const short OSPTOEND = 0;
+///Field member value stating that the field is not stored in the decoded data structure
+const size_t OSPNOMEMBER = (size_t) -1;
+//@endcond
+
+/**OSPField defines the layout of a field in an OSP message payload and how it is decoded and printed.
+ *<p>The field has count values of the given type, placed in the payload at the given offset (the MID is at offset 0).
+ *When the offset is OSPFOLLOWS, the field starts after the previous one in the layout, and when countFrom is not negative,
+ *the number of values is the one in the field having this position in the layout. These variable layouts are only printed.
+ *<p>For OSP_U4 fields, a non zero mask states that the value is the bit field (value >> shift) & mask.
+ */
+struct OSPField {
+	const char* name;	//the field name, as in the SiRF ICD
+	OSPType type;		//the type of its values
+	short offset;		//the offset in the payload of the first value, or OSPFOLLOWS
+	short count;		//the number of values, or OSPTOEND
+	short countFrom;	//the position in the layout of the field giving the number of values, or -1
+	unsigned char shift;	//for bit fields, the right shift to apply to the value
+	unsigned int mask;	//for bit fields, the mask to apply to the shifted value, or 0 if it is not a bit field
+	size_t member;		//the offset in the decoded data structure where values are stored, or OSPNOMEMBER
+	const char* label;	//the text printed before the values, or NULL if the field is not printed
+	const char* format;	//the printf format for each value
+	const char* suffix;	//the text printed after the values
+};
+
+/**OSPLayout defines the layout of the payload of messages having a given MID as a table of fields.
+ *The payload length needed to decode the message is the one containing all fields stored in its data structure.
+ */
+struct OSPLayout {
+	int mid;				//the message identification
+	const char* name;		//the message name, as in the SiRF ICD
+	size_t size;			//the size of the data structure where message data are decoded, or 0 if they are only printed
+	const OSPField* fields;	//the table of fields
+	int nFields;			//the number of fields in the table
+};
+
+//Data structures where message payloads are decoded. Each one contains its MID, used to find its layout.
+///MID2, Measure Navigation Data Out
+struct MID2data {
+	static const int MID = 2;
+	int x, y, z;				//ECEF position, in meters
+	short vx, vy, vz;			//ECEF velocity, in meters/second scaled by 8
+	unsigned short week;		//GPS week, without rollover
+	unsigned int tow;			//GPS TOW, in seconds scaled by 100
+	unsigned char svs;			//satellites in the solution
+};
+///MID7, Clock Status Data
+struct MID7data {
+	static const int MID = 7;
+	unsigned short week;		//GPS week, including rollover
+	unsigned int tow;			//GPS TOW, in seconds scaled by 100
+	unsigned char svs;			//satellites in the solution
+	unsigned int drift;			//clock drift, in Hz
+	unsigned int bias;			//clock bias, in nanoseconds
+};
+///MID8, 50 BPS Data
+struct MID8data {
+	static const int MID = 8;
+	unsigned char channel;		//the receiver channel
+	unsigned char sv;			//the satellite number given by the receiver
+	unsigned int words[10];		//the subframe (GPS) or string (GLONASS) words
+};
+///MID15, Ephemeris Data with compact subframes 1, 2 and 3
+struct MID15data {
+	static const int MID = 15;
+	unsigned char sv;			//the satellite number
+	unsigned short words[45];	//the 3 x 15 words of subframe data
+};
+///MID19, Navigation Parameters (only the masks are decoded)
+struct MID19data {
+	static const int MID = 19;
+	short elevationMask;		//the elevation mask, in degrees scaled by 10
+	unsigned char snrMask;		//the signal to noise ratio mask, in dB-Hz
+};
+///MID28, Navigation Library Measurement Data
+struct MID28data {
+	static const int MID = 28;
+	unsigned char channel;		//the receiver channel
+	unsigned int timeTag;		//the measurement time tag, in milliseconds
+	unsigned char sv;			//the satellite number given by the receiver
+	double gpsSWtime;			//the GPS software time, in seconds
+	double pseudorange;			//the pseudorange, in meters
+	float carrierFrequency;		//the carrier frequency, in meters/second
+	double carrierPhase;		//the carrier phase, in meters
+	unsigned short timeInTrack;	//time in track, in milliseconds
+	unsigned char syncFlags;	//synchronization flags
+	unsigned char cn0[10];		//C/N0 values, in dB-Hz
+	unsigned short deltaRangeInterval;	//delta range interval, in milliseconds
+};
+
+/**OSPDecoder class provides a registry of OSP message layouts, and methods to decode or print messages using them.
+ *<p>Layouts are defined as compile time tables of fields stating offset, type, number of values, and where each value is stored
+ *in the data structure of the message (see OSPField). Data structures have the MID of the message they decode, which allows
+ *decoding a message in one shot using the decode template method:
+ *<p>	MID7data data;
+ *<p>	if (OSPDecoder::decode(message, data)) ...
+ *<p>Decoding checks once that the payload contains all fields to be stored, and extracts their values without further checks.
+ *<p>The same tables state how the message data are printed, allowing to dump message contents (see print).
+ */
+class OSPDecoder {
+public:
+	static const OSPLayout* layout(int mid);		//provides the layout of messages with the given MID, if any
+	static bool decode(OSPMessage &message, void* data, size_t size);	//decode the message payload into the given data structure
+	static bool print(OSPMessage &message, FILE* out);	//print the message fields having a label in its layout
+	/**decode decodes the given message payload into the data structure of its type, using the layout of its MID.
+	 *
+	 * @param message the message to decode
+	 * @param data the data structure where message fields are stored
+	 * @return true if data have been decoded, false otherwise (the MID is not the one of the data, or the payload is too short)
+	 */
+	template<class T> static bool decode(OSPMessage &message, T &data) {
+		if (message.mid() != T::MID) return false;
+		return decode(message, &data, sizeof data);
+	};
+private:
+	struct Registry {		//the layouts by MID and the payload length needed to decode each one
+		const OSPLayout* layouts[256];
+		unsigned int length[256];	//the payload length containing all fields having member
+		Registry();
+	};
+	static const Registry &registry();
+	static unsigned int typeSize(OSPType type);
+};
+#endif
@@ -3,12 +3,17 @@
  */
 
 #include "OSPMessage.h"
+
+#include <string.h>
 //from CommonClasses
 #include "Utilities.h"
 
+const string OSPINDEXID = "OSP MESSAGE INDEX";	//the identifier in the first line of message index files
+
 /**Constructs and empty OSPMessage object.
  */
 OSPMessage::OSPMessage(void) {
+	payload = buffer;
 	cursor = 0;
 	payloadLength = 0;
 }
@@ -29,18 +34,54 @@ OSPMessage::~OSPMessage(void) {
  * @return true when a message was correctly read, false otherwise (read error or end of file found)
  */
 bool OSPMessage::fill(FILE* file) {
-	unsigned char buffer[2];
+	unsigned char lengthBytes[2];
 
 	cursor = 0;
+	payload = buffer;
 	//read message length from the input stream
-	if (fread(buffer, 1, 2, file) < 2) return false;
-	payloadLength = (buffer[0] << 8) | buffer[1];	//numbers in msg are big endians
+	if (fread(lengthBytes, 1, 2, file) < 2) return false;
+	payloadLength = (lengthBytes[0] << 8) | lengthBytes[1];	//numbers in msg are big endians
 	//read payload bytes
 	if (payloadLength > MAXPAYLOADSIZE) return false;
-	if (fread(payload, 1, payloadLength, file) < payloadLength) return false;
+	if (fread(buffer, 1, payloadLength, file) < payloadLength) return false;
 	return true;
 }
 
+/**view sets the OSPMessage object as a view over a message payload stored elsewhere (usually in a mapped OSP file), without copying it.
+ * The buffer cursor for further extractions is set to 0.
+ * Payload data shall remain available while the message is being used.
+ *
+ * @param data the address of the first payload byte
+ * @param length the payload length in bytes
+ * @return true when the view has been set, false if the length is greater than the maximum payload size
+ */
+bool OSPMessage::view(const unsigned char* data, unsigned int length) {
+	cursor = 0;
+	if (length > MAXPAYLOADSIZE) return false;
+	payload = data;
+	payloadLength = length;
+	return true;
+}
+
+/**mid provides the message identification, that is the first byte of the payload. The cursor is not modified.
+ *
+ * @return the message identification, or -1 if the payload is empty
+ */
+int OSPMessage::mid() {
+	if (payloadLength == 0) return -1;
+	return payload[0];
+}
+
+/**fits checks if the given number of bytes can be extracted from the payload starting at the current cursor position.
+ * When the layout of data to extract is known, it allows checking bounds once and using fetch methods to extract them.
+ *
+ * @param n the number of bytes to extract
+ * @return true if the n bytes starting at cursor are inside the payload, false otherwise
+ */
+bool OSPMessage::fits(unsigned int n) {
+	return cursor + n <= payloadLength;
+}
+
 /**skipBytes skips the number of bytes stated in the argument from the payload buffer.
  * It increments the payload cursor to allow next data extraction of values after bytes skipped. 
  *
@@ -61,6 +102,15 @@ unsigned int OSPMessage::payloadLen() {
 	return payloadLength;
 }
 
+/**bytes provides the payload bytes of the current message, allowing to extract data at known offsets (see OSPDecoder).
+ * They remain valid until the next message is set.
+ *
+ * @return the address of the first payload byte (the MID)
+ */
+const unsigned char* OSPMessage::bytes() {
+	return payload;
+}
+
 /**get gets the byte value in the payload at current cursor position.
  * The cursor is incremented by one after getting the byte.
  *
@@ -69,9 +119,7 @@ unsigned int OSPMessage::payloadLen() {
  */
 int OSPMessage::get() {
 	if (cursor >= payloadLength) throw 1;
-	unsigned int value = payload[cursor];
-	cursor += 1;
-	return value;
+	return fetch();
 }
 
 /**getInt gets four bytes starting at cursor which are interpreted as a 32 bits integer.
@@ -83,13 +131,7 @@ int OSPMessage::get() {
  */
 int OSPMessage::getInt() {
 	if (cursor+3 >= payloadLength) throw 2;
-	unsigned int value = 
-		payload[cursor] << 24 |
-		payload[cursor+1] << 16 |
-		payload[cursor+2] << 8 |
-		payload[cursor+3];
-	cursor += 4;
-	return value;
+	return fetchInt();
 }
 
 /**getUInt method gets four bytes starting at cursor which are interpreted as a 32 bits unsigned integer.
@@ -101,13 +143,7 @@ int OSPMessage::getInt() {
  */
 unsigned int OSPMessage::getUInt() {
 	if (cursor+3 >= payloadLength) throw 3;
-	unsigned int value = 
-		payload[cursor] << 24 |
-		payload[cursor+1] << 16 |
-		payload[cursor+2] << 8 |
-		payload[cursor+3];
-	cursor += 4;
-	return value;
+	return fetchUInt();
 }
 
 /**getShort gets two bytes starting at cursor which are interpreted as a 16 bits integer.
@@ -119,9 +155,7 @@ unsigned int OSPMessage::getUInt() {
  */
 short OSPMessage::getShort() {
 	if (cursor+1 >= payloadLength) throw 4;
-	unsigned short value = payload[cursor] << 8 | payload[cursor+1];
-	cursor += 2;
-	return value;
+	return fetchShort();
 }
 
 /**getUShort gets from payload two bytes starting at cursor which are interpreted as a 16 bits unsigned integer.
@@ -133,9 +167,7 @@ short OSPMessage::getShort() {
  */
 unsigned short OSPMessage::getUShort() {
 	if (cursor+1 >= payloadLength) throw 5;
-	unsigned short value = payload[cursor] << 8 | payload[cursor+1];
-	cursor += 2;
-	return value;
+	return fetchUShort();
 }
 
 /**getFloat gets four bytes starting at cursor which are interpreted as a 32 bits floating number.
@@ -146,15 +178,8 @@ unsigned short OSPMessage::getUShort() {
  * @throws the integer value 6 when it is intended to get data after the end of payload 
  */
 float OSPMessage::getFloat() {
-	unsigned char buffer[4];
-	float* p2value = (float*) buffer;
 	if (cursor+3 >= payloadLength) throw 6;
-	buffer[0] = payload[cursor + 3];
-	buffer[1] = payload[cursor + 2];
-	buffer[2] = payload[cursor + 1];
-	buffer[3] = payload[cursor + 0];
-	cursor += 4;
-	return *p2value;
+	return fetchFloat();
 }
 
 /**getDouble gets eight bytes starting at cursor which are interpreted as a 64 bits floating number.
@@ -165,19 +190,8 @@ float OSPMessage::getFloat() {
  * @throws the integer value 7 when it is intended to get data after the end of payload 
  */
 double OSPMessage::getDouble() {
-	unsigned char buffer[8];
-	double* p2value = (double*) buffer;
 	if (cursor+7 >= payloadLength) throw 7;
-	buffer[0] = payload[cursor + 3];
-	buffer[1] = payload[cursor + 2];
-	buffer[2] = payload[cursor + 1];
-	buffer[3] = payload[cursor + 0];
-	buffer[4] = payload[cursor + 7];
-	buffer[5] = payload[cursor + 6];
-	buffer[6] = payload[cursor + 5];
-	buffer[7] = payload[cursor + 4];
-	cursor += 8;
-	return *p2value;
+	return fetchDouble();
 }
 
 /**getInt3 gets three bytes starting at cursor which are interpreted as a 24 bits signed integer.
@@ -189,10 +203,327 @@ double OSPMessage::getDouble() {
  */
 int OSPMessage::getInt3() {
 	if (cursor+2 >= payloadLength) throw 8;
-	unsigned int uvalue = 
-		payload[cursor] << 16 |
-		payload[cursor+1] << 8 |
-		payload[cursor+2];
-	cursor += 3;
-	return getTwosComplement(uvalue, 24);
+	return fetchInt3();
+}
+
+/**Constructs an OSPReader object to read messages from the given stream (see open).
+ *
+ * @param f the stream where the OSP binary file is open, or NULL to state it later using open
+ */
+OSPReader::OSPReader(FILE* f) {
+	file = NULL;
+	data = NULL;
+	size = position = limit = 0;
+	indexed = false;
+	indexPos = indexEnd = 0;
+	memset(midSelected, true, sizeof midSelected);
+	if (f != NULL) open(f);
+}
+
+/**Destructs OSPReader objects, releasing the mapped image, if any.
+ */
+OSPReader::~OSPReader(void) {
+}
+
+/**open sets the stream where the OSP binary file to read is open, and tries to map the whole file into memory.
+ * Messages will be read starting at the first one in the file.
+ *
+ * @param f the stream where the OSP binary file is open
+ * @return true if the file has been mapped, false otherwise (messages will be read from the stream)
+ */
+bool OSPReader::open(FILE* f) {
+	file = f;
+	position = 0;
+	index.clear();
+	indexed = false;
+	indexPos = indexEnd = 0;
+	if (image.map(f)) {
+		data = (const unsigned char*) image.data();
+		limit = size = image.size();
+		return true;
+	}
+	data = NULL;
+	limit = size = 0;
+	return false;
+}
+
+/**isMapped checks if messages are read from the mapped image of the file.
+ *
+ * @return true if the file is mapped, false if messages are read from the stream
+ */
+bool OSPReader::isMapped() {
+	return data != NULL;
+}
+
+/**next gets the next message in the OSP file.
+ * When the file is mapped, the message is set as a view over the mapped payload, without copying it. Otherwise it is read from the stream.
+ *<p>When a message index is used, the next message is the next one in the index having a selected MID (see selectMids).
+ *
+ * @param message the OSPMessage object where the message will be set
+ * @return true when a message was correctly got, false otherwise (wrong length, truncated message or end of file found)
+ */
+bool OSPReader::next(OSPMessage &message) {
+	if (!indexed) return readNext(message);
+	while ((indexPos < indexEnd) && !midSelected[index[indexPos].mid]) indexPos++;
+	if (indexPos >= indexEnd) return false;
+	if (index[indexPos].offset != position) {
+		//some messages are skipped: set the position of the next one to read
+		if ((data == NULL) && !MappedFile::seek(file, index[indexPos].offset)) return false;
+		position = index[indexPos].offset;
+	}
+	indexPos++;
+	return readNext(message);
+}
+
+/**rewind restarts reading messages from the first one in the file, removing any time window stated.
+ * The stream is also rewound.
+ */
+void OSPReader::rewind() {
+	position = 0;
+	limit = size;
+	indexPos = 0;
+	indexEnd = index.size();
+	if (file != NULL) ::rewind(file);
+}
+
+/**tell provides the position in the OSP file of the next message to read, that is, the position after the last message read.
+ *
+ * @return the position of the next message to read
+ */
+long long OSPReader::tell() const {
+	return position;
+}
+
+/**setRange states the range of messages to read in a mapped file: the next message to read will be the one at the given
+ * start position, and reading ends before the given end position. Both positions shall be at message boundaries.
+ * When a message index is used, the range is stated in the index. The range is removed by rewind.
+ *
+ * @param from the position of the first message to read
+ * @param to the position after the last message to read
+ * @return true if the range has been set, false otherwise (the file is not mapped)
+ */
+bool OSPReader::setRange(long long from, long long to) {
+	if (data == NULL) return false;
+	position = from;
+	limit = to < size? to : size;
+	if (indexed) {
+		indexPos = findOffset(from);
+		indexEnd = findOffset(to);
+	}
+	return true;
+}
+
+/**setIndex states the message index file to be used for the OSP file being read, and restarts reading from the first message.
+ *<p>If the index file exists and it matches the OSP file (same size and modification time), it is loaded.
+ *Otherwise, the index is built reading all messages in the OSP file, and it is saved into the index file.
+ *<p>The GPS time of each message in the index is the one of the last MID7 (week and TOW) or MID28 (receiver GPS software time)
+ *message before it, including itself. Times are kept non decreasing along the index, and messages before the first one
+ *with time data are given the time of this one.
+ *
+ * @param idxFileName the name of the message index file
+ * @return true if the index has been loaded or built, false otherwise (messages will be read sequentially without index)
+ */
+bool OSPReader::setIndex(string idxFileName) {
+	long long fileSize, fileTime;
+	index.clear();
+	indexed = false;
+	rewind();
+	if ((file == NULL) || !MappedFile::fileStamp(file, fileSize, fileTime)) return false;
+	if (!loadIndex(idxFileName, fileSize, fileTime)) {
+		index.clear();
+		if (!buildIndex()) return false;
+		saveIndex(idxFileName, fileSize, fileTime);
+	}
+	indexed = true;
+	rewind();
+	return true;
+}
+
+/**isIndexed checks if a message index is used to read messages.
+ *
+ * @return true if a message index is used, false otherwise
+ */
+bool OSPReader::isIndexed() {
+	return indexed;
+}
+
+/**selectMids states the MIDs of messages to be read when a message index is used. Messages having other MIDs are skipped.
+ *
+ * @param mids the MIDs of messages to be read. If empty, all messages will be read
+ */
+void OSPReader::selectMids(const vector<int> &mids) {
+	memset(midSelected, mids.empty(), sizeof midSelected);
+	for (vector<int>::const_iterator it = mids.begin(); it != mids.end(); it++)
+		if ((*it >= 0) && (*it < 256)) midSelected[*it] = true;
+}
+
+/**setTimeWindow states the messages to read as the ones in the index having GPS time in the given window.
+ * The next message to read will be the first one at or after the given start time, and reading ends before the first one
+ * at or after the given end time. It needs a message index (see setIndex). The window is removed by rewind.
+ *
+ * @param from the GPS time of the window start, in seconds from the GPS ephemeris (see getSecsGPSEphe)
+ * @param to the GPS time of the window end, in seconds from the GPS ephemeris. If it is not greater than from, there is no end limit
+ * @return true if the window has been set, false otherwise (no index used)
+ */
+bool OSPReader::setTimeWindow(double from, double to) {
+	if (!indexed) return false;
+	indexPos = findTime(from);
+	indexEnd = to > from? findTime(to) : index.size();
+	return true;
+}
+
+/**getIndex provides the entries of the message index.
+ *
+ * @return the message index entries, in file order (empty if no index is used)
+ */
+const vector<OSPReader::IndexEntry> &OSPReader::getIndex() {
+	return index;
+}
+
+/**findTime finds, using a binary search, the first message in the index having a GPS time at or after the given one.
+ *
+ * @param t the GPS time, in seconds from the GPS ephemeris
+ * @return the position in the index of the message found, or the index size if there is none
+ */
+size_t OSPReader::findTime(double t) {
+	size_t low = 0, high = index.size();
+	while (low < high) {
+		size_t mid = (low + high) / 2;
+		if (index[mid].gpsTime < t) low = mid + 1;
+		else high = mid;
+	}
+	return low;
+}
+
+/**findOffset finds, using a binary search, the first message in the index at or after the given position in the OSP file.
+ *
+ * @param pos the position in the OSP file
+ * @return the position in the index of the message found, or the index size if there is none
+ */
+size_t OSPReader::findOffset(long long pos) {
+	size_t low = 0, high = index.size();
+	while (low < high) {
+		size_t mid = (low + high) / 2;
+		if (index[mid].offset < pos) low = mid + 1;
+		else high = mid;
+	}
+	return low;
+}
+
+/**readNext gets the message at the current position, from the mapped image or from the stream.
+ *
+ * @param message the OSPMessage object where the message will be set
+ * @return true when a message was correctly got, false otherwise (wrong length, truncated message or end of file found)
+ */
+bool OSPReader::readNext(OSPMessage &message) {
+	if (data == NULL) {
+		if (!message.fill(file)) return false;
+		position += 2 + message.payloadLen();
+		return true;
+	}
+	if (position + 2 > limit) return false;
+	unsigned int length = (data[position] << 8) | data[position + 1];	//numbers in msg are big endians
+	if (position + 2 + length > size) return false;
+	if (!message.view(data + position + 2, length)) return false;
+	position += 2 + length;
+	return true;
+}
+
+/**buildIndex builds the message index reading all messages from the first one in the OSP file.
+ *
+ * @return true if the index has been built, false if there are no messages in the file
+ */
+bool OSPReader::buildIndex() {
+	OSPMessage message;
+	IndexEntry entry;
+	int week = -1;			//the GPS week of the last MID7, or -1 if not known
+	double tow;
+	double lastTime = -1.0;	//the time of the last message with time data, or -1 if not known
+	size_t firstTimed = 0;	//the position in the index of the first message with time data
+	rewind();
+	entry.offset = 0;
+	while (readNext(message)) {
+		entry.length = (unsigned short) message.payloadLen();
+		entry.mid = (unsigned char) message.mid();
+		message.skipBytes(1);
+		switch (entry.mid) {
+		case 7:		//GPS week and TOW (scaled by 100)
+			if (message.fits(6)) {
+				week = message.fetchUShort();
+				tow = (double) message.fetchUInt() / 100.0;
+				if (lastTime < 0.0) firstTimed = index.size();
+				if (getSecsGPSEphe(week, tow) > lastTime) lastTime = getSecsGPSEphe(week, tow);
+			}
+			break;
+		case 28:	//receiver GPS software time, with the week of the last MID7
+			if ((week >= 0) && message.fits(14)) {
+				message.skipBytes(6);	//skip channel, time tag and satellite number
+				tow = message.fetchDouble();
+				if (getSecsGPSEphe(week, tow) > lastTime) lastTime = getSecsGPSEphe(week, tow);
+			}
+			break;
+		default:
+			break;
+		}
+		entry.gpsTime = lastTime;
+		index.push_back(entry);
+		entry.offset += 2 + entry.length;
+	}
+	if (index.empty()) return false;
+	//messages before the first one with time data are given its time
+	for (size_t i = 0; i < firstTimed; i++) index[i].gpsTime = index[firstTimed].gpsTime;
+	return true;
+}
+
+/**loadIndex loads the message index from the index file, checking it matches the OSP file.
+ *
+ * @param idxFileName the name of the message index file
+ * @param fileSize the size of the OSP file
+ * @param fileTime the modification time of the OSP file
+ * @return true if the index has been loaded, false otherwise (file does not exist, wrong format, or data do not match the OSP file)
+ */
+bool OSPReader::loadIndex(string idxFileName, long long fileSize, long long fileTime) {
+	char line[80];
+	long long idxSize, idxTime;
+	unsigned int nEntries;
+	IndexEntry entry;
+	FILE* idxFile = fopen(idxFileName.c_str(), "rb");
+	if (idxFile == NULL) return false;
+	bool isOk = (fgets(line, sizeof line, idxFile) != NULL) && (OSPINDEXID.compare(0, string::npos, line, strcspn(line, "\r\n")) == 0)
+		&& (fgets(line, sizeof line, idxFile) != NULL) && (sscanf(line, "%lld %lld %u", &idxSize, &idxTime, &nEntries) == 3)
+		&& (idxSize == fileSize) && (idxTime == fileTime) && (nEntries <= fileSize / 2);
+	if (isOk) index.reserve(nEntries);
+	for (unsigned int i = 0; isOk && (i < nEntries); i++) {
+		if ((fread(&entry.offset, sizeof entry.offset, 1, idxFile) != 1)
+				|| (fread(&entry.gpsTime, sizeof entry.gpsTime, 1, idxFile) != 1)
+				|| (fread(&entry.length, sizeof entry.length, 1, idxFile) != 1)
+				|| (fread(&entry.mid, sizeof entry.mid, 1, idxFile) != 1)
+				|| (entry.offset < 0) || (entry.offset + 2 + entry.length > fileSize)) isOk = false;
+		else index.push_back(entry);
+	}
+	fclose(idxFile);
+	return isOk;
+}
+
+/**saveIndex saves the message index built into the index file.
+ * The index file contains a text line with the OSPINDEXID identifier, a text line with the OSP file size, modification time
+ * and number of entries, and the binary data of each entry: offset (8 bytes), GPS time (8 bytes), payload length (2 bytes)
+ * and MID (1 byte), in the byte order of the computer.
+ *
+ * @param idxFileName the name of the message index file
+ * @param fileSize the size of the OSP file
+ * @param fileTime the modification time of the OSP file
+ * @return true if the index has been saved, false otherwise
+ */
+bool OSPReader::saveIndex(string idxFileName, long long fileSize, long long fileTime) {
+	FILE* idxFile = fopen(idxFileName.c_str(), "wb");
+	if (idxFile == NULL) return false;
+	fprintf(idxFile, "%s\n%lld %lld %u\n", OSPINDEXID.c_str(), fileSize, fileTime, (unsigned int) index.size());
+	for (vector<IndexEntry>::iterator it = index.begin(); it != index.end(); it++) {
+		fwrite(&it->offset, sizeof it->offset, 1, idxFile);
+		fwrite(&it->gpsTime, sizeof it->gpsTime, 1, idxFile);
+		fwrite(&it->length, sizeof it->length, 1, idxFile);
+		fwrite(&it->mid, sizeof it->mid, 1, idxFile);
+	}
+	return fclose(idxFile) == 0;
 }
@@ -15,11 +15,19 @@
  *<p>Ver.	|Date	|Reason for change
  *<p>---------------------------------
  *<p>V1.0	|2/2015	|First release
+ *<p>V1.1	|10/2026	|Added message views over mapped OSP files (OSPReader class)
+ *<p>V1.2	|10/2026	|Added message index files to OSPReader
  */
 #ifndef OSPMESSAGE_H
 #define OSPMESSAGE_H
 
 #include <stdio.h>
+#include <string>
+#include <vector>
+
+#include "MappedFile.h"	//from CommonClasses
+
+using namespace std;
 
 ///The maximum size in bytes of any message payload
 #define MAXPAYLOADSIZE 2048
@@ -33,9 +41,15 @@
  * - get the value of the specific types a message could contain (byte, integer (short or not,
  *		unsigned or not), float or double). Bit and byte ordering in the source are taken into account to perform the translation.
  * - skip unused data from the buffer advancing the cursor
+ *<p>Alternatively, the message can be a view over a payload stored elsewhere (usually a mapped OSP file, see OSPReader),
+ *avoiding to copy it into the buffer.
+ *<p>Get methods check payload bounds for each value extracted, throwing an integer value when data are beyond the payload end.
+ *When the layout of the message data to extract is known, bounds can be checked once for all data using fits, and then the
+ *fetch methods can be used to extract values without further checks.
  */
 class OSPMessage {
-	unsigned char payload[MAXPAYLOADSIZE];	//buffer for the OSP message payload
+	unsigned char buffer[MAXPAYLOADSIZE];	//buffer for the OSP message payload read from a stream
+	const unsigned char* payload;	//the payload of current message: in the buffer, or in the place given to view
 	unsigned int payloadLength;		//the payload length in bytes of current message
 	unsigned int cursor;	//payload index to the first byte to be extracted by any method defined below
 							//it is incremented after any extraction
@@ -43,6 +57,9 @@ public:
 	OSPMessage(void);
 	~OSPMessage(void);
 	bool fill(FILE*);	//fill the buffer whith a OSP message read from OSP binary file
+	bool view(const unsigned char* data, unsigned int length);	//set the message as a view over the given payload, without copying it
+	int mid();			//provides the message identification (the first payload byte), without moving the cursor
+	bool fits(unsigned int n);	//checks if n bytes can be extracted starting at cursor
 	int get();			//get from payload the byte value at cursor. Increment it by one
 	int getInt();		//get from payload the 32 bits integer at cursor. Increment it by four
 	unsigned int getUInt(); //get from payload the 32 bits unsigned integer at cursor. Increment it by four
@@ -53,5 +70,108 @@ public:
 	int getInt3();		//get from payload the 24 bits integer at cursor. Increment it by three
 	bool skipBytes(int n);	//skip n bytes advancing cursor by n
 	unsigned int payloadLen(); //provides the payload length
+	const unsigned char* bytes();	//provides the payload bytes, to extract data at given offsets (see OSPDecoder)
+	//methods to extract values without checking bounds. They shall be checked before using fits
+	int fetch() {		//get from payload the byte value at cursor. Increment it by one
+		return payload[cursor++];
+	};
+	unsigned int fetchUInt() {	//get from payload the 32 bits unsigned integer at cursor. Increment it by four
+		unsigned int value = payload[cursor] << 24 | payload[cursor+1] << 16 | payload[cursor+2] << 8 | payload[cursor+3];
+		cursor += 4;
+		return value;
+	};
+	int fetchInt() {	//get from payload the 32 bits integer at cursor. Increment it by four
+		return (int) fetchUInt();
+	};
+	unsigned short fetchUShort() {	//get from payload the 16 bits unsigned integer at cursor. Increment it by two
+		unsigned short value = payload[cursor] << 8 | payload[cursor+1];
+		cursor += 2;
+		return value;
+	};
+	short fetchShort() {	//get from payload the 16 bits integer at cursor. Increment it by two
+		return (short) fetchUShort();
+	};
+	float fetchFloat() {	//get from payload the 32 bits floating point at cursor (bytes in reverse order). Increment it by four
+		union {
+			unsigned char bytes[4];
+			float value;
+		} data;
+		for (int i = 0; i < 4; i++) data.bytes[i] = payload[cursor + 3 - i];
+		cursor += 4;
+		return data.value;
+	};
+	double fetchDouble() {	//get from payload the 64 bits floating point at cursor (bytes in order 3, 2, 1, 0, 7, 6, 5, 4). Increment it by eight
+		union {
+			unsigned char bytes[8];
+			double value;
+		} data;
+		for (int i = 0; i < 4; i++) {
+			data.bytes[i] = payload[cursor + 3 - i];
+			data.bytes[i + 4] = payload[cursor + 7 - i];
+		}
+		cursor += 8;
+		return data.value;
+	};
+	int fetchInt3() {	//get from payload the 24 bits integer at cursor. Increment it by three
+		unsigned int uvalue = payload[cursor] << 16 | payload[cursor+1] << 8 | payload[cursor+2];
+		cursor += 3;
+		return (uvalue & 0x800000)? (int) uvalue - 0x1000000 : (int) uvalue;
+	};
+};
+
+/**OSPReader class provides sequential access to the messages in an OSP binary file already open.
+ *<p>When possible, the whole file is mapped into memory, and messages are given as views over the mapped payloads
+ *(see OSPMessage::view), avoiding to read and copy them. Otherwise, messages are read from the stream (see OSPMessage::fill).
+ *<p>Note that, when the file is mapped, the stream position is not modified when reading messages, and the rewind method
+ *of this class shall be used to restart reading from the first message.
+ *<p>A message index file can be stated using setIndex. The index contains for each message in the OSP file its offset, MID,
+ *payload length and GPS time, and it allows:
+ * - to iterate only over messages having the MIDs selected with selectMids, skipping the others without reading them
+ * - to read only messages in a given time window, using setTimeWindow
+ *<p>Offsets in the index are 64 bits integers, allowing indexing of files greater than 2 GB.
+ *<p>When the file is mapped, reading can be limited to the messages in a range of offsets using setRange, allowing several
+ *readers over the same file to read different parts of it.
+ */
+class OSPReader {
+public:
+	struct IndexEntry {		//defines an entry of the message index
+		long long offset;	//the offset in the OSP file of the message (of its payload length bytes)
+		double gpsTime;		//the GPS time of the message, in seconds from the GPS ephemeris (see getSecsGPSEphe)
+		unsigned short length;	//the payload length
+		unsigned char mid;	//the message identification
+	};
+	OSPReader(FILE* f = NULL);
+	~OSPReader(void);
+	bool open(FILE* f);		//set the stream to read messages from, mapping it if possible
+	bool isMapped();		//checks if messages are read from a mapped image
+	bool next(OSPMessage &message);	//get the next message in the file
+	void rewind();			//restart reading from the first message
+	long long tell() const;	//provides the position in the OSP file of the next message to read
+	bool setRange(long long from, long long to);	//state the range of positions of messages to read in a mapped file
+	bool setIndex(string idxFileName);	//load, or build and save, the message index
+	bool isIndexed();		//checks if a message index is used
+	void selectMids(const vector<int> &mids);	//state the MIDs of messages to iterate when an index is used
+	bool setTimeWindow(double from, double to);	//state the GPS time window of messages to read when an index is used
+	const vector<IndexEntry> &getIndex();	//provides the message index entries
+private:
+	FILE* file;					//the stream where the OSP file is open
+	MappedFile image;			//the mapped image of the OSP file
+	const unsigned char* data;	//the first byte of the mapped image, or NULL if the file is not mapped
+	long long size;				//the size in bytes of the mapped image
+	long long position;			//the position in the OSP file of the next message to read
+	long long limit;			//the position where reading ends in the mapped image
+	vector<IndexEntry> index;	//the message index, in file order
+	bool indexed;				//true when the message index is used to read messages
+	size_t indexPos;			//the position in the index of the next message to read
+	size_t indexEnd;			//the position in the index after the last message to read
+	bool midSelected[256];		//for each MID, true if its messages are iterated when the index is used
+	OSPReader(const OSPReader &);				//copies are not allowed
+	OSPReader &operator=(const OSPReader &);	//copies are not allowed
+	bool readNext(OSPMessage &message);
+	size_t findTime(double t);
+	size_t findOffset(long long pos);
+	bool buildIndex();
+	bool loadIndex(string idxFileName, long long fileSize, long long fileTime);
+	bool saveIndex(string idxFileName, long long fileSize, long long fileTime);
 };
 #endif
\ No newline at end of file
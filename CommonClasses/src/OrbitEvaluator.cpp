@@ -0,0 +1,326 @@
+/** @file OrbitEvaluator.cpp
+ * Contains the implementation of the OrbitEvaluator class.
+ */
+
+#include "OrbitEvaluator.h"
+
+#include <math.h>
+
+//Physical and system constants
+const double OEPI = 3.1415926535898;		//pi as defined in the GPS ICD
+const double RAD2DEG = 180.0 / OEPI;
+const double SECSWEEK = 604800.0;			//seconds in a week
+const double BDTOFFSET = 14.0;				//GPS time - BeiDou time, in seconds
+const double CLIGHT = 299792458.0;			//speed of light, in m/s
+const double MUGPS = 3.9860050e14;			//GPS (and QZSS) Earth gravitational constant, in m3/s2
+const double MUGAL = 3.986004418e14;		//Galileo and BeiDou Earth gravitational constant, in m3/s2
+const double OMGGPS = 7.2921151467e-5;		//GPS, Galileo and QZSS Earth rotation rate, in rad/s
+const double OMGBDS = 7.292115e-5;			//BeiDou Earth rotation rate, in rad/s
+const double SIN5 = -0.0871557427476582;	//sin(-5 deg) used for BeiDou GEO satellites
+const double COS5 = 0.9961946980917456;		//cos(-5 deg) used for BeiDou GEO satellites
+const double MUGLO = 398600.44e9;			//GLONASS (PZ-90) Earth gravitational constant, in m3/s2
+const double AEGLO = 6378136.0;				//GLONASS (PZ-90) Earth equatorial radius, in m
+const double J2GLO = 1082625.75e-9;			//GLONASS (PZ-90) second zonal harmonic
+const double OMGGLO = 7.292115e-5;			//GLONASS (PZ-90) Earth rotation rate, in rad/s
+const double WGS84A = 6378137.0;			//WGS84 semi-major axis, in m
+const double WGS84E2 = 6.69437999014e-3;	//WGS84 first eccentricity squared
+
+/**Constructs an OrbitEvaluator object which will use ephemerides from the given store.
+ *
+ * @param ephStore the store where ephemerides are searched
+ */
+OrbitEvaluator::OrbitEvaluator(EphemerisStore* ephStore) {
+	store = ephStore;
+	stationSet = false;
+	for (int i = 0; i < 3; i++) {
+		station[i] = 0.0;
+		for (int j = 0; j < 3; j++) enu[i][j] = 0.0;
+	}
+	leapSeconds = DEFLEAPSECS;
+}
+
+/**Destructs OrbitEvaluator objects.
+ */
+OrbitEvaluator::~OrbitEvaluator(void) {
+}
+
+/**setEphemerisStore sets the store where ephemerides will be searched.
+ * Cached GLONASS states are discarded.
+ *
+ * @param ephStore the store where ephemerides are searched
+ */
+void OrbitEvaluator::setEphemerisStore(EphemerisStore* ephStore) {
+	store = ephStore;
+	gloCache.clear();
+}
+
+/**setStation sets the station position used to compute elevation and azimuth of satellites,
+ * computing the rotation from ECEF to local coordinates at the station.
+ *
+ * @param x the ECEF X coordinate of the station, in meters (as per APPROX POSITION XYZ)
+ * @param y the ECEF Y coordinate of the station, in meters
+ * @param z the ECEF Z coordinate of the station, in meters
+ * @return true if the position has been set, false if it is not a valid position (f.e. 0,0,0). In this case elevations will not be computed
+ */
+bool OrbitEvaluator::setStation(double x, double y, double z) {
+	if (stationSet && (x == station[0]) && (y == station[1]) && (z == station[2])) return true;	//already computed
+	double p = sqrt(x * x + y * y);
+	stationSet = sqrt(p * p + z * z) > 6.0e6;
+	if (!stationSet) return false;
+	station[0] = x;
+	station[1] = y;
+	station[2] = z;
+	//compute geodetic latitude iterating over the height
+	double lat = atan2(z, p * (1.0 - WGS84E2));
+	double sinLat, n, h;
+	for (int i = 0; i < 5; i++) {
+		sinLat = sin(lat);
+		n = WGS84A / sqrt(1.0 - WGS84E2 * sinLat * sinLat);
+		h = p / cos(lat) - n;
+		lat = atan2(z, p * (1.0 - WGS84E2 * n / (n + h)));
+	}
+	double lon = atan2(y, x);
+	sinLat = sin(lat);
+	double cosLat = cos(lat);
+	double sinLon = sin(lon);
+	double cosLon = cos(lon);
+	enu[0][0] = -sinLon;			enu[0][1] = cosLon;				enu[0][2] = 0.0;
+	enu[1][0] = -sinLat * cosLon;	enu[1][1] = -sinLat * sinLon;	enu[1][2] = cosLat;
+	enu[2][0] = cosLat * cosLon;	enu[2][1] = cosLat * sinLon;	enu[2][2] = sinLat;
+	return true;
+}
+
+/**isStationSet checks if a valid station position has been set.
+ *
+ * @return true if elevation and azimuth will be computed, false otherwise
+ */
+bool OrbitEvaluator::isStationSet() {
+	return stationSet;
+}
+
+/**setLeapSeconds sets the GPS - UTC leap seconds used to convert GPS time to GLONASS ephemeris time.
+ *
+ * @param secs the leap seconds (as per LEAP SECONDS RINEX header record)
+ */
+void OrbitEvaluator::setLeapSeconds(int secs) {
+	leapSeconds = secs;
+}
+
+/**compute computes at the given instant the position, clock correction, elevation and azimuth of the satellites given.
+ *<p>For each satellite, the best ephemeris at the given instant is searched in the store. Satellites of the same orbit type
+ * are computed in batch.
+ *
+ * @param t the instant in seconds from the GPS ephemeris, in GPS time
+ * @param satPos the satellites to compute, stated by system and PRN. Computed data are set in each element
+ * @return the number of satellites computed (having a valid ephemeris)
+ */
+int OrbitEvaluator::compute(double t, vector<SatPosition> &satPos) {
+	const EphemerisStore::Ephemeris* eph;
+	int nValid = 0;
+	kepler.clear();
+	for (size_t i = 0; i < satPos.size(); i++) {
+		satPos[i].valid = false;
+		if ((store == NULL) || ((eph = store->find(satPos[i].systemId, satPos[i].satellite, t)) == NULL)) continue;
+		switch (satPos[i].systemId) {
+		case 'G':
+		case 'E':
+		case 'C':
+		case 'J':
+			kepler.inx.push_back(i);
+			kepler.eph.push_back(eph);
+			break;
+		case 'R':
+			computeGLONASS(t, eph, satPos[i]);
+			break;
+		case 'S':
+			computeSBAS(t, eph, satPos[i]);
+			break;
+		default:
+			break;
+		}
+	}
+	if (!kepler.inx.empty()) computeKepler(t, satPos);
+	for (vector<SatPosition>::iterator it = satPos.begin(); it != satPos.end(); it++) {
+		if (!it->valid) continue;
+		nValid++;
+		computeElevation(*it);
+	}
+	return nValid;
+}
+
+/**computeKepler computes position and clock correction of satellites with Keplerian orbits gathered in the kepler working storage.
+ * Data are computed in three steps: mean anomaly, eccentric anomaly solving the Kepler equation for all satellites at once,
+ * and position and clock correction.
+ *
+ * @param t the instant in seconds from the GPS ephemeris, in GPS time
+ * @param satPos the results vector where computed data are set
+ */
+void OrbitEvaluator::computeKepler(double t, vector<SatPosition> &satPos) {
+	size_t n = kepler.inx.size();
+	kepler.tk.resize(n);
+	kepler.ecc.resize(n);
+	kepler.meanAnomaly.resize(n);
+	kepler.eccAnomaly.resize(n);
+	double* tk = &kepler.tk[0];
+	double* ecc = &kepler.ecc[0];
+	double* meanAnomaly = &kepler.meanAnomaly[0];
+	double* eccAnomaly = &kepler.eccAnomaly[0];
+	double tSys, a;
+	//compute time from Toe and mean anomaly
+	for (size_t k = 0; k < n; k++) {
+		const double (*bo)[4] = kepler.eph[k]->broadcastOrbit;
+		tSys = kepler.eph[k]->systemId == 'C'? t - BDTOFFSET : t;
+		tk[k] = fmod(tSys, SECSWEEK) - bo[3][0];
+		if (tk[k] > SECSWEEK / 2) tk[k] -= SECSWEEK;
+		else if (tk[k] < -SECSWEEK / 2) tk[k] += SECSWEEK;
+		a = bo[2][3] * bo[2][3];
+		ecc[k] = bo[2][1];
+		meanAnomaly[k] = bo[1][3] + (sqrt((kepler.eph[k]->systemId == 'G' || kepler.eph[k]->systemId == 'J'? MUGPS : MUGAL) / (a * a * a)) + bo[1][2]) * tk[k];
+	}
+	//solve the Kepler equation for all satellites with a fixed number of Newton iterations
+	for (size_t k = 0; k < n; k++) eccAnomaly[k] = meanAnomaly[k];
+	for (int iter = 0; iter < KEPLERITER; iter++)
+		for (size_t k = 0; k < n; k++)
+			eccAnomaly[k] -= (eccAnomaly[k] - ecc[k] * sin(eccAnomaly[k]) - meanAnomaly[k]) / (1.0 - ecc[k] * cos(eccAnomaly[k]));
+	//compute position and clock correction
+	double sinE, cosE, v, phi, sin2phi, cos2phi, u, r, incl, omega, omgE, mu, xp, yp, xg, yg, zg, tc;
+	for (size_t k = 0; k < n; k++) {
+		const EphemerisStore::Ephemeris* eph = kepler.eph[k];
+		const double (*bo)[4] = eph->broadcastOrbit;
+		SatPosition &sp = satPos[kepler.inx[k]];
+		mu = (eph->systemId == 'G' || eph->systemId == 'J')? MUGPS : MUGAL;
+		omgE = eph->systemId == 'C'? OMGBDS : OMGGPS;
+		sinE = sin(eccAnomaly[k]);
+		cosE = cos(eccAnomaly[k]);
+		a = bo[2][3] * bo[2][3];
+		v = atan2(sqrt(1.0 - ecc[k] * ecc[k]) * sinE, cosE - ecc[k]);
+		phi = v + bo[4][2];
+		sin2phi = sin(2.0 * phi);
+		cos2phi = cos(2.0 * phi);
+		u = phi + bo[2][2] * sin2phi + bo[2][0] * cos2phi;
+		r = a * (1.0 - ecc[k] * cosE) + bo[1][1] * sin2phi + bo[4][1] * cos2phi;
+		incl = bo[4][0] + bo[5][0] * tk[k] + bo[3][3] * sin2phi + bo[3][1] * cos2phi;
+		xp = r * cos(u);
+		yp = r * sin(u);
+		if ((eph->systemId == 'C') && ((eph->satellite <= 5) || (eph->satellite >= 59))) {
+			//BeiDou GEO: compute in inertial frame and rotate
+			omega = bo[3][2] + bo[4][3] * tk[k] - omgE * bo[3][0];
+			xg = xp * cos(omega) - yp * cos(incl) * sin(omega);
+			yg = xp * sin(omega) + yp * cos(incl) * cos(omega);
+			zg = yp * sin(incl);
+			double sinO = sin(omgE * tk[k]);
+			double cosO = cos(omgE * tk[k]);
+			sp.x = xg * cosO + yg * sinO * COS5 + zg * sinO * SIN5;
+			sp.y = -xg * sinO + yg * cosO * COS5 + zg * cosO * SIN5;
+			sp.z = -yg * SIN5 + zg * COS5;
+		} else {
+			omega = bo[3][2] + (bo[4][3] - omgE) * tk[k] - omgE * bo[3][0];
+			sp.x = xp * cos(omega) - yp * cos(incl) * sin(omega);
+			sp.y = xp * sin(omega) + yp * cos(incl) * cos(omega);
+			sp.z = yp * sin(incl);
+		}
+		tc = (eph->systemId == 'C'? t - BDTOFFSET : t) - eph->navTimeTag;
+		sp.clockBias = bo[0][1] + bo[0][2] * tc + bo[0][3] * tc * tc
+			- 2.0 * sqrt(mu) * ecc[k] * bo[2][3] * sinE / (CLIGHT * CLIGHT);
+		sp.valid = true;
+	}
+}
+
+/**computeGLONASS computes position and clock correction of a GLONASS satellite integrating its state vector
+ * with a fourth order Runge-Kutta method, in steps not greater than GLOSTEP.
+ * Integration starts from the last state computed for the satellite when it was computed with the same ephemeris
+ * and it is closer to the requested instant than the ephemeris reference time.
+ *
+ * @param t the instant in seconds from the GPS ephemeris, in GPS time
+ * @param eph the ephemeris of the satellite
+ * @param satPos where computed data are set
+ */
+void OrbitEvaluator::computeGLONASS(double t, const EphemerisStore::Ephemeris* eph, SatPosition &satPos) {
+	const double (*bo)[4] = eph->broadcastOrbit;
+	double tGlo = t - leapSeconds;	//ephemeris time tags are stated in UTC
+	double acc[3] = {bo[1][2] * 1000.0, bo[2][2] * 1000.0, bo[3][2] * 1000.0};
+	GLOstate &cached = gloCache[satPos.satellite];
+	if ((cached.navTimeTag != eph->navTimeTag) || (fabs(tGlo - cached.time) > fabs(tGlo - eph->navTimeTag))) {
+		cached.navTimeTag = eph->navTimeTag;
+		cached.time = eph->navTimeTag;
+		for (int i = 0; i < 3; i++) {
+			cached.state[i] = bo[i+1][0] * 1000.0;
+			cached.state[i+3] = bo[i+1][1] * 1000.0;
+		}
+	}
+	double k1[6], k2[6], k3[6], k4[6], tmp[6], h;
+	int i;
+	while (cached.time != tGlo) {
+		h = tGlo - cached.time;
+		if (h > GLOSTEP) h = GLOSTEP;
+		else if (h < -GLOSTEP) h = -GLOSTEP;
+		gloDerivatives(cached.state, acc, k1);
+		for (i = 0; i < 6; i++) tmp[i] = cached.state[i] + k1[i] * h / 2.0;
+		gloDerivatives(tmp, acc, k2);
+		for (i = 0; i < 6; i++) tmp[i] = cached.state[i] + k2[i] * h / 2.0;
+		gloDerivatives(tmp, acc, k3);
+		for (i = 0; i < 6; i++) tmp[i] = cached.state[i] + k3[i] * h;
+		gloDerivatives(tmp, acc, k4);
+		for (i = 0; i < 6; i++) cached.state[i] += (k1[i] + 2.0 * k2[i] + 2.0 * k3[i] + k4[i]) * h / 6.0;
+		if (fabs(tGlo - cached.time) <= GLOSTEP) cached.time = tGlo;
+		else cached.time += h;
+	}
+	satPos.x = cached.state[0];
+	satPos.y = cached.state[1];
+	satPos.z = cached.state[2];
+	satPos.clockBias = bo[0][1] + bo[0][2] * (tGlo - eph->navTimeTag);	//-TauN + GammaN * (t - tb)
+	satPos.valid = true;
+}
+
+/**computeSBAS computes position and clock correction of a SBAS satellite extrapolating its state vector.
+ *
+ * @param t the instant in seconds from the GPS ephemeris, in GPS time
+ * @param eph the ephemeris of the satellite
+ * @param satPos where computed data are set
+ */
+void OrbitEvaluator::computeSBAS(double t, const EphemerisStore::Ephemeris* eph, SatPosition &satPos) {
+	const double (*bo)[4] = eph->broadcastOrbit;
+	double dt = t - eph->navTimeTag;
+	satPos.x = (bo[1][0] + bo[1][1] * dt + bo[1][2] * dt * dt / 2.0) * 1000.0;
+	satPos.y = (bo[2][0] + bo[2][1] * dt + bo[2][2] * dt * dt / 2.0) * 1000.0;
+	satPos.z = (bo[3][0] + bo[3][1] * dt + bo[3][2] * dt * dt / 2.0) * 1000.0;
+	satPos.clockBias = bo[0][1] + bo[0][2] * dt;
+	satPos.valid = true;
+}
+
+/**computeElevation computes elevation and azimuth of the given satellite from the station, if its position has been set.
+ *
+ * @param satPos the satellite data, with its position already computed
+ */
+void OrbitEvaluator::computeElevation(SatPosition &satPos) {
+	if (!stationSet) return;
+	double d[3] = {satPos.x - station[0], satPos.y - station[1], satPos.z - station[2]};
+	double e = enu[0][0] * d[0] + enu[0][1] * d[1] + enu[0][2] * d[2];
+	double n = enu[1][0] * d[0] + enu[1][1] * d[1] + enu[1][2] * d[2];
+	double u = enu[2][0] * d[0] + enu[2][1] * d[1] + enu[2][2] * d[2];
+	satPos.elevation = atan2(u, sqrt(e * e + n * n)) * RAD2DEG;
+	satPos.azimuth = atan2(e, n) * RAD2DEG;
+	if (satPos.azimuth < 0.0) satPos.azimuth += 360.0;
+}
+
+/**gloDerivatives computes the derivatives of a GLONASS state vector as per the GLONASS ICD equations of motion
+ * in the PZ-90 rotating frame, including the J2 term and the given luni-solar accelerations.
+ *
+ * @param state the position and velocity, in meters and meters/second
+ * @param acc the luni-solar accelerations, in meters/second2
+ * @param deriv the computed velocity and acceleration
+ */
+void OrbitEvaluator::gloDerivatives(const double (&state)[6], const double (&acc)[3], double (&deriv)[6]) {
+	double r2 = state[0] * state[0] + state[1] * state[1] + state[2] * state[2];
+	double r3 = r2 * sqrt(r2);
+	double muR3 = MUGLO / r3;
+	double j2Term = 1.5 * J2GLO * MUGLO * AEGLO * AEGLO / (r3 * r2);
+	double z2R2 = 5.0 * state[2] * state[2] / r2;
+	double omg2 = OMGGLO * OMGGLO;
+	deriv[0] = state[3];
+	deriv[1] = state[4];
+	deriv[2] = state[5];
+	deriv[3] = -muR3 * state[0] - j2Term * state[0] * (1.0 - z2R2) + omg2 * state[0] + 2.0 * OMGGLO * state[4] + acc[0];
+	deriv[4] = -muR3 * state[1] - j2Term * state[1] * (1.0 - z2R2) + omg2 * state[1] - 2.0 * OMGGLO * state[3] + acc[1];
+	deriv[5] = -muR3 * state[2] - j2Term * state[2] * (3.0 - z2R2) + acc[2];
+}
@@ -0,0 +1,109 @@
+/** @file OrbitEvaluator.h
+ * Contains the OrbitEvaluator class definition used to compute satellite positions, clock corrections and elevations from broadcast orbits.
+ *
+ *Copyright 2015 Francisco Cancillo
+ *<p>
+ *This file is part of the RXtoRINEX tool.
+ *<p>
+ *RXtoRINEX is free software: you can redistribute it and/or modify it under the terms of the GNU General Public License
+ *as published by the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+ *RXtoRINEX is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ *warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *See the GNU General Public License for more details.
+ *<p>
+ *A copy of the GNU General Public License can be found at <http://www.gnu.org/licenses/>.
+ *<p>Ver.	|Date	|Reason for change
+ *<p>---------------------------------
+ *<p>V1.0	|10/2026	|First release
+ */
+#ifndef ORBITEVALUATOR_H
+#define ORBITEVALUATOR_H
+
+#include <vector>
+#include <unordered_map>
+#include <stddef.h>
+
+#include "EphemerisStore.h"	//from CommonClasses
+
+using namespace std;
+
+//@cond DUMMY
+const int KEPLERITER = 8;			//the fixed number of iterations to solve the Kepler equation
+const double GLOSTEP = 60.0;		//the maximum step in seconds to integrate GLONASS orbits
+const int DEFLEAPSECS = 18;			//the default GPS - UTC leap seconds, used to get GLONASS time
+//@endcond
+
+/**OrbitEvaluator class computes ECEF positions, clock corrections, elevation and azimuth of satellites from their broadcast orbits.
+ *<p>Ephemerides are taken from an EphemerisStore, where the best one for each satellite is searched at the instant of computation.
+ *Computations are made in batch for all satellites of an epoch:
+ * - For GPS, Galileo, BeiDou and QZSS, Keplerian elements are gathered into arrays, and the Kepler equation is solved for all
+ *   satellites at once using a fixed number of Newton iterations without branches, allowing the compiler to vectorise the loop.
+ * - For GLONASS, state vectors are integrated using a fourth order Runge-Kutta method. The last state computed for each satellite
+ *   is cached and used as starting point when it is closer to the requested instant than the ephemeris reference time.
+ * - For SBAS, state vectors are extrapolated using the given velocity and acceleration.
+ *<p>Elevation and azimuth are computed with respect to a station position, usually the one in the RINEX APPROX POSITION XYZ
+ *header record. They are not computed if the station position is not set.
+ *<p>Instants are stated in seconds from the GPS ephemeris, in GPS time (see getSecsGPSEphe). Positions are computed at the given
+ *instant, without light time or Earth rotation corrections, and clock corrections include the relativistic term but not group delays.
+ */
+class OrbitEvaluator {
+public:
+	struct SatPosition {	//the results computed for a satellite
+		char systemId;		//the system identification (G, E, R, ...)
+		int satellite;		//the PRN of the satellite
+		bool valid;			//true when a valid ephemeris exists and data below have been computed
+		double x, y, z;		//the ECEF position of the satellite, in meters
+		double clockBias;	//the satellite clock correction, in seconds
+		double elevation;	//the elevation over the station horizon, in degrees (0 if the station is not set)
+		double azimuth;		//the azimuth from the station, in degrees from north (0 if the station is not set)
+		SatPosition(char sys, int sat) {
+			systemId = sys;
+			satellite = sat;
+			valid = false;
+			x = y = z = clockBias = elevation = azimuth = 0.0;
+		};
+	};
+	OrbitEvaluator(EphemerisStore* ephStore = NULL);
+	~OrbitEvaluator(void);
+	void setEphemerisStore(EphemerisStore* ephStore);
+	bool setStation(double x, double y, double z);
+	bool isStationSet();
+	void setLeapSeconds(int secs);
+	int compute(double t, vector<SatPosition> &satPos);
+
+private:
+	EphemerisStore* store;	//where ephemerides are searched
+	bool stationSet;		//true when a valid station position has been set
+	double station[3];		//the ECEF station position, in meters
+	double enu[3][3];		//the rotation matrix from ECEF to local east, north, up coordinates at the station
+	int leapSeconds;		//GPS - UTC leap seconds
+	//working storage for Keplerian orbits, arranged as arrays
+	struct KeplerData {
+		vector <size_t> inx;			//the position of the satellite in the results vector
+		vector <const EphemerisStore::Ephemeris*> eph;	//the ephemeris used
+		vector <double> tk;				//time from ephemeris reference time
+		vector <double> ecc;			//eccentricity
+		vector <double> meanAnomaly;	//mean anomaly
+		vector <double> eccAnomaly;		//eccentric anomaly
+		void clear() {
+			inx.clear();
+			eph.clear();
+			tk.clear();
+			ecc.clear();
+			meanAnomaly.clear();
+			eccAnomaly.clear();
+		};
+	} kepler;
+	struct GLOstate {	//the last state computed for a GLONASS satellite
+		double navTimeTag;	//the time tag of the ephemeris used
+		double time;		//the instant of the state (GLONASS time)
+		double state[6];	//position and velocity, in meters and meters/second
+	};
+	unordered_map <int, GLOstate> gloCache;	//the last state computed for each GLONASS satellite, by PRN
+	void computeKepler(double t, vector<SatPosition> &satPos);
+	void computeGLONASS(double t, const EphemerisStore::Ephemeris* eph, SatPosition &satPos);
+	void computeSBAS(double t, const EphemerisStore::Ephemeris* eph, SatPosition &satPos);
+	void computeElevation(SatPosition &satPos);
+	static void gloDerivatives(const double (&state)[6], const double (&acc)[3], double (&deriv)[6]);
+};
+#endif
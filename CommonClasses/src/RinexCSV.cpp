@@ -0,0 +1,283 @@
+/** @file RinexCSV.cpp
+ * Contains the implementation of routines to generate CSV files from data contained in RINEX observation or navigation files.
+ */
+#include "RinexCSV.h"
+
+/**generateHeaderCSV prints header data for relevant records in CVS format
+ *
+ *@param out the already open print stream where header data will be printed in CVS format
+ *@param rinex the RINEX data object, source of data to be printed
+ *@param plog a pointer to a Logger to be used to record logging messages
+ *@return  the exit status
+ */
+int generateHeaderCSV(FILE* out, RinexData &rinex, Logger* plog) {
+	double db1, db2, db3;
+	char ch1, ch2;
+	vector <string> vs1;
+	unsigned int ui1;
+	string record, str1, str2, str3;
+	int nrec = 0;
+	plog->finer("Print CSV header records:");
+	fprintf(out, "RINEX header record,Values\n");
+	RinexData::RINEXlabel labelId = rinex.get1stLabelId();
+	if (labelId != RinexData::VERSION) plog->warning("VERSION record has not data");
+	while (labelId != RinexData::LASTONE) {
+		record = rinex.idTOlbl(labelId);
+		try {
+			switch(labelId) {
+			case RinexData::VERSION:
+				rinex.setHdLnData(RinexData::VERSION);	//set version as per input file
+				rinex.getHdLnData(labelId, db1, ch1, ch2);
+				fprintf(out,"%s,%f,%c,%c\n", record.c_str(), db1, ch1, ch2);
+				break;
+			case RinexData::RUNBY:
+				rinex.getHdLnData(labelId, str1, str2, str3);
+				fprintf(out,"%s,%s,%s,%s\n", record.c_str(), str1.c_str(), str2.c_str(), str3.c_str());
+				break;
+			case RinexData::APPXYZ:
+				rinex.getHdLnData(labelId, db1, db2, db3);
+				fprintf(out,"%s,%lf,%lf,%lf\n", record.c_str(),  db1, db2, db3);
+				break;
+			case RinexData::TOBS:
+			case RinexData::SYS:
+				for (ui1 = 0; rinex.getHdLnData(labelId, ch1, vs1, ui1); ui1++) {
+					fprintf(out,"%s,%c", record.c_str(), ch1);
+					for(vector<string>::iterator it = vs1.begin() ; it != vs1.end(); ++it) fprintf(out,",%s", (*it).c_str());
+					fprintf(out,"\n");
+				}
+				break;
+			case RinexData::INT:
+				rinex.getHdLnData(labelId, db1);
+				fprintf(out,"%s,%lf\n", record.c_str(), db1);
+				break;
+			default:
+				nrec--;
+				break;
+			}
+			nrec++;
+		} catch (string error) {
+			plog->severe(error + string("Incorrect params in getHdLnData call for " + record));
+		}
+		labelId = rinex.getNextLabelId();
+	}
+	plog->finer("Records printed:" + to_string((long long) nrec));
+	return nrec;
+}
+
+/*timeInInterval checks if the given time is in the given time interval.
+ *
+ *@param epochT the time in seconds to be checked
+ *@param timeInterval the values defining the interval and the limits to be checked
+ *@return true if the time interval is not defined or the given time is in the interval, false otherwise
+*/
+bool timeInInterval(double epochT, TimeIntervalParams &timeInterval) {
+	if (timeInterval.fromTime || timeInterval.toTime) {
+		if (timeInterval.fromTime && ( epochT < timeInterval.fromTimeTag)) return false;
+		if (timeInterval.toTime && (epochT > timeInterval.toTimeTag)) return false;
+	}
+	return true;
+}
+
+/**generateObsCSV prints observation data in CVS format
+ *
+ *@param inFile the already open input RINEX observation file, positioned just after the End of Header record, in the first epoch 
+ *@param outFile the already open print stream where header data will be printed in CVS format
+ *@param rinex the RINEX data object, source of data to be printed
+ *@param timeInterval the values defining the interval and the limits to be checked
+ *@param plog a pointer to a Logger to be used to record logging messages
+ *@return  the number of epochs transferred to the CSV file
+ */
+int generateObsCSV(FILE *inFile, FILE* outFile, RinexData &rinex, TimeIntervalParams &timeInterval, Logger* plog) {
+	int anInt;		//a general purpose int variable
+	string aStr;	//a general purpose string variable
+	double aDouble;	//a general purpose double variable
+	char sys;
+	int week, rdStat, sat, lol, strg, obsHandle;
+	double tow, value, tTag;
+	string obsType;
+	int nrec = 0;
+	plog->finer("Print CSV observation epochs:");
+	try {
+		fprintf(outFile, "Week,TOW,Sys,Sat,Obs,Value,LoL,Strg\n");
+		while ((rdStat = rinex.readObsEpoch(inFile)) != 0) {
+			if (timeInterval.timeOrdered && timeInterval.toTime && (rinex.getEpochTime(week, tow, aDouble, anInt) > timeInterval.toTimeTag)) break;
+			if (rdStat == 1 && timeInInterval(rinex.getEpochTime(week, tow, aDouble, anInt), timeInterval) && rinex.filterObsData()) {	//Epoch observables and data are well formatted and it remains data after filtering
+				nrec++;
+				for (unsigned int index = 0; rinex.getObsData(obsHandle, sat, value, lol, strg, tTag, index); index++) {
+					rinex.getObsHandleData(obsHandle, sys, obsType);
+					fprintf(outFile, "%d,%lf,%c,%d,%s,%lf,%d,%d\n", week, tow, sys, sat, obsType.c_str(), value, lol, strg);
+				}
+			}
+		}
+	} catch (string error) {
+		plog->severe(error);
+	}
+	plog->finer("Obs epochs to CSV:" + to_string((long long) nrec));
+	return nrec;
+}
+
+/**generateGPSNavCSV prints GPS navigation data in CVS format
+ *
+ *@param inFile the already open input RINEX navigation file, positioned just after the End of Header record, in the first epoch 
+ *@param outFile the already open print stream where header data will be printed in CVS format
+ *@param rinex the RINEX data object, source of data to be printed
+ *@param timeInterval the values defining the interval and the limits to be checked
+ *@param plog a pointer to a Logger to be used to record logging messages
+ *@return  the exit status
+ */
+int generateGPSNavCSV(FILE *inFile, FILE* outFile, RinexData &rinex, TimeIntervalParams &timeInterval, Logger* plog) {
+	int anInt;		//a general purpose int variable
+	string aStr;	//a general purpose string variable
+	double aDouble;	//a general purpose double variable
+	char sys;
+	int week, rdStat, sat;
+	double tow, tTag, bo[8][4];
+	int nrec = 0;
+	plog->finer("Print CSV GPS navigation epochs:");
+	try {
+		fprintf(outFile, "Sys,Sat,Week,TOW,Af0,Af1,Af2,IODE,Crs,Delta N,M0,Cuc,e,Cus,sqrt(A),Toe,Cic,OMEGA0,Cis,i0,Crc,W,WDOT,IDOT,Codes on L2,GPS Week,L2 P flag,SV accuracy,SV health,TGD,IODC,Transm. time,Fit interval\n");
+		while ((rdStat = rinex.readNavEpoch(inFile)) != 0) {
+			if ((rdStat == 1 || rdStat == 2) && timeInInterval(rinex.getEpochTime(week, tow, aDouble, anInt), timeInterval) && rinex.filterNavData()) {	//Epoch nav. data are well formatted
+				if (rinex.getNavData(sys, sat, bo, tTag, 0) && sys == 'G') {
+					nrec++;
+					fprintf(outFile, "%c,%d,%d,%lf", sys, sat, week, tow);
+					for (int j = 1; j != 4; j++) fprintf(outFile, ",%19.12E", bo[0][j]);
+					for (int i = 1; i != 7; i++)
+						for (int j = 0; j != 4; j++) fprintf(outFile, ",%19.12E", bo[i][j]);
+					for (int j = 0; j != 2; j++) fprintf(outFile, ",%19.12E", bo[7][j]);
+					fprintf(outFile, "\n");
+					rinex.clearNavData();
+				} else plog->warning("Expected GPS epoch, but selected an " + string(1, sys) + " sat.");
+			}
+		}
+
+	} catch (string error) {
+		plog->severe(error);
+	}
+	plog->finer("GPS nav. epochs to CSV:" + to_string((long long) nrec));
+	return nrec;
+}
+
+/**generateGalNavCSV prints Galileo navigation data in CVS format
+ *
+ *@param inFile the already open input RINEX navigation file, positioned just after the End of Header record, in the first epoch 
+ *@param outFile the already open print stream where header data will be printed in CVS format
+ *@param rinex the RINEX data object, source of data to be printed
+ *@param timeInterval the values defining the interval and the limits to be checked
+ *@param plog a pointer to a Logger to be used to record logging messages
+ *@return  the exit status
+ */
+int generateGalNavCSV(FILE *inFile, FILE* outFile, RinexData &rinex, TimeIntervalParams &timeInterval, Logger* plog) {
+	int anInt;		//a general purpose int variable
+	string aStr;	//a general purpose string variable
+	double aDouble;	//a general purpose double variable
+	char sys;
+	int week, rdStat, sat;
+	double tow, tTag, bo[8][4];
+	int nrec = 0;
+	plog->finer("Print CSV Galileo navigation epochs:");
+	try {
+		fprintf(outFile, "Sys,Sat,Week,TOW,Af0,Af1,Af2,IODE,Crs,Delta N,M0,Cuc,e,Cus,sqrt(A),Toe,Cic,OMEGA0,Cis,i0,Crc,W,WDOT,IDOT,Data sources,Gal Week,SISA,SV health,BGD E5a/E1,BGD E5b/E1,Transm. time\n");
+		while ((rdStat = rinex.readNavEpoch(inFile)) != 0) {
+			if ((rdStat == 1 || rdStat == 2) && timeInInterval(rinex.getEpochTime(week, tow, aDouble, anInt), timeInterval) && rinex.filterNavData()) {	//Epoch nav. data are well formatted
+				if (rinex.getNavData(sys, sat, bo, tTag, 0) && sys == 'E') {
+					nrec++;
+					fprintf(outFile, "%c,%d,%d,%lf", sys, sat, week, tow);
+					for (int j = 1; j != 4; j++) fprintf(outFile, ",%19.12E", bo[0][j]);
+					for (int i = 1; i != 5; i++)
+						for (int j = 0; j != 4; j++) fprintf(outFile, ",%19.12E", bo[i][j]);
+					for (int j = 0; j != 3; j++) fprintf(outFile, ",%19.12E", bo[5][j]);
+					for (int j = 0; j != 4; j++) fprintf(outFile, ",%19.12E", bo[6][j]);
+					fprintf(outFile, ",%19.12E\n", bo[7][0]);
+					rinex.clearNavData();
+				} else plog->warning("Expected GALILEO epoch, but selected an " + string(1, sys) + " sat.");
+			}
+		}
+
+	} catch (string error) {
+		plog->severe(error);
+	}
+	plog->finer("Galileo nav. epochs to CSV:" + to_string((long long) nrec));
+	return nrec;
+}
+
+/**generateGloNavCSV prints GLONASSo navigation data in CVS format
+ *
+ *@param inFile the already open input RINEX navigation file, positioned just after the End of Header record, in the first epoch 
+ *@param outFile the already open print stream where header data will be printed in CVS format
+ *@param rinex the RINEX data object, source of data to be printed
+ *@param timeInterval the values defining the interval and the limits to be checked
+ *@param plog a pointer to a Logger to be used to record logging messages
+ *@return  the exit status
+ */
+int generateGloNavCSV(FILE *inFile, FILE* outFile, RinexData &rinex, TimeIntervalParams &timeInterval, Logger* plog) {
+	int anInt;		//a general purpose int variable
+	string aStr;	//a general purpose string variable
+	double aDouble;	//a general purpose double variable
+	char sys;
+	int week, rdStat, sat;
+	double tow, tTag, bo[8][4];
+	int nrec = 0;
+	plog->finer("Print CSV GLONASS navigation epochs:");
+	try {
+		fprintf(outFile, "Sys,Sat,Week,TOW,-TauN,+GammaN,Msg.frm.t,Sat.X,Sat.vel.X,Sat.acc.X,Sat.health,Sat.Y,Sat.vel.Y,Sat.acc.Y,Sat.frq.,Sat.Z,Sat.vel.Z,Sat.acc.Z,Age\n");
+		while ((rdStat = rinex.readNavEpoch(inFile)) != 0) {
+			if ((rdStat == 1 || rdStat == 2) && timeInInterval(rinex.getEpochTime(week, tow, aDouble, anInt), timeInterval) && rinex.filterNavData()) {	//Epoch nav. data are well formatted
+				if (rinex.getNavData(sys, sat, bo, tTag, 0) && sys == 'R') {
+					nrec++;
+					fprintf(outFile, "%c,%d,%d,%lf", sys, sat, week, tow);
+					for (int j = 1; j != 4; j++) fprintf(outFile, ",%19.12E", bo[0][j]);
+					for (int i = 1; i != 4; i++)
+						for (int j = 0; j != 4; j++) fprintf(outFile, ",%19.12E", bo[i][j]);
+					fprintf(outFile, "\n");
+					rinex.clearNavData();
+				} else plog->warning("Expected GLONASS epoch, but selected an " + string(1, sys) + " sat.");
+			}
+		}
+
+	} catch (string error) {
+		plog->severe(error);
+	}
+	plog->finer("GLONASS nav. epochs to CSV:" + to_string((long long) nrec));
+	return nrec;
+}
+
+/**generateSBASNavCSV prints SBAS navigation data in CVS format
+ *
+ *@param inFile the already open input RINEX navigation file, positioned just after the End of Header record, in the first epoch 
+ *@param outFile the already open print stream where header data will be printed in CVS format
+ *@param rinex the RINEX data object, source of data to be printed
+ *@param timeInterval the values defining the interval and the limits to be checked
+ *@param plog a pointer to a Logger to be used to record logging messages
+ *@return  the exit status
+ */
+int generateSBASNavCSV(FILE *inFile, FILE* outFile, RinexData &rinex, TimeIntervalParams &timeInterval, Logger* plog) {
+	int anInt;		//a general purpose int variable
+	string aStr;	//a general purpose string variable
+	double aDouble;	//a general purpose double variable
+	char sys;
+	int week, rdStat, sat;
+	double tow, tTag, bo[8][4];
+	int nrec = 0;
+	plog->finer("Print CSV SBAS navigation epochs:");
+	try {
+		fprintf(outFile, "Sys,Sat,Week,TOW,aGf0,aGf1,Transm.time,Sat.X,Sat.vel.X,Sat.acc.X,Sat.health,Sat.Y,Sat.vel.Y,Sat.acc.Y,Sat.URA,Sat.Z,Sat.vel.Z,Sat.acc.Z,IODN\n");
+		while ((rdStat = rinex.readNavEpoch(inFile)) != 0) {
+			if ((rdStat == 1 || rdStat == 2) && timeInInterval(rinex.getEpochTime(week, tow, aDouble, anInt), timeInterval) && rinex.filterNavData()) {	//Epoch nav. data are well formatted
+				if (rinex.getNavData(sys, sat, bo, tTag, 0) && sys == 'S') {
+					nrec++;
+					fprintf(outFile, "%c,%d,%d,%lf", sys, sat, week, tow);
+					for (int j = 1; j != 4; j++) fprintf(outFile, ",%19.12E", bo[0][j]);
+					for (int i = 1; i != 4; i++)
+						for (int j = 0; j != 4; j++) fprintf(outFile, ",%19.12E", bo[i][j]);
+					fprintf(outFile, "\n");
+					rinex.clearNavData();
+				} else plog->warning("Expected SBAS epoch, but selected an " + string(1, sys) + " sat.");
+			}
+		}
+	} catch (string error) {
+		plog->severe(error);
+	}
+	plog->finer("GBAS nav. epochs to CSV:" + to_string((long long) nrec));
+	return nrec;
+}
@@ -0,0 +1,40 @@
+/** @file RinexCSV.h
+ * Contains definition of routines to generate CSV files from data contained in RINEX observation or navigation files,
+ * used by RINEXtoCSV and BatchToRINEX.
+ *
+ *Copyright 2016 Francisco Cancillo
+ *<p>
+ *This file is part of the RXtoRINEX tool.
+ *<p>
+ *RXtoRINEX is free software: you can redistribute it and/or modify it under the terms of the GNU General Public License
+ *as published by the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+ *RXtoRINEX is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ *warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *See the GNU General Public License for more details.
+ *<p>
+ *A copy of the GNU General Public License can be found at <http://www.gnu.org/licenses/>.
+ *<p>Ver.	|Date	|Reason for change
+ *<p>---------------------------------
+ *<p>V1.0	|10/2026	|First release, with the functions formerly in RINEXtoCSV
+ */
+#ifndef RINEXCSV_H
+#define RINEXCSV_H
+
+#include <stdio.h>
+#include "Logger.h"
+#include "RinexData.h"
+
+///A data tipe to define a time interval
+struct TimeIntervalParams {
+	bool fromTime, toTime;
+	double fromTimeTag, toTimeTag;
+	bool timeOrdered;	//epochs are known to be in time order: reading can stop after the interval
+};
+
+int generateHeaderCSV(FILE*, RinexData &, Logger*);		//prints header data
+int generateObsCSV(FILE*, FILE*, RinexData &, TimeIntervalParams &, Logger*);		//prints observation epochs
+int generateGPSNavCSV(FILE*, FILE*, RinexData &, TimeIntervalParams &, Logger*);	//prints GPS navigation epochs
+int generateGalNavCSV(FILE*, FILE*, RinexData &, TimeIntervalParams &, Logger*);	//prints Galileo navigation epochs
+int generateGloNavCSV(FILE*, FILE*, RinexData &, TimeIntervalParams &, Logger*);	//prints GLONASS navigation epochs
+int generateSBASNavCSV(FILE*, FILE*, RinexData &, TimeIntervalParams &, Logger*);	//prints SBAS navigation epochs
+#endif
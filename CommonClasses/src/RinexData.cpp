@@ -6,9 +6,24 @@
 #include <algorithm>
 #include <stdio.h>
 #include <math.h>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <chrono>
 //from CommonClasses
 #include "Utilities.h"
 
+const long long READCHUNKSIZE = 1048576;	//the approximate size in bytes of each chunk of input epochs read by a parallel reading thread
+const size_t READCHUNKSAHEAD = 4;			//the number of chunks each thread can read in advance of the chunk being delivered
+const double INDEXSTEP = 60.0;				//the minimum time in seconds between epochs in the epoch index
+const string INDEXID = "RINEX EPOCH INDEX";	//the identifier in the first line of epoch index files
+const size_t PRINTBUFFERS = 64;				//the number of epoch buffers handed to the printing thread
+const int PRINTSPINS = 64;					//the times a thread waiting for epoch buffers yields before sleeping
+const int PRINTSLEEP = 100;					//the time in microseconds a thread waiting for epoch buffers sleeps
+///a macro to compose the log message of an epoch from the start of its line (kept in epochTxt) and the given remarks
+#define EPOCH_MSG(REMARKS) (string("Epoch [") + string(epochTxt, sizeof epochTxt) + "]" + REMARKS)
+
 /**RinexData constructor providing only the minimum data required: the RINEX file version to be generated.
  *
  * Version parameter is needed in the header record RINEX VERSION / TYPE, which is mandatory in RINEX. Note that version
@@ -84,6 +99,12 @@ RinexData::RinexData(RINEXversion ver, string prg, string rby, Logger* plogger)
 /**Destructor.
  */
 RinexData::~RinexData(void) {
+	endParallelRead();
+	try {
+		endPrintThread();
+	} catch (string error) {
+		plog->severe(error);
+	}
 	if (dynamicLog) delete plog;
 }
 
@@ -1196,21 +1217,64 @@ double RinexData::getEpochTime(int &weeks, double &secs, double &bias, int &eFla
  * @return true if data belong to the current epoch, false otherwise
  */
 bool RinexData::saveObsData(char sys, int sat, string obsType, double value, int lol, int strg, double tTag) {
-	int sx = sysInx(sys);	//system index
+	int obsHandle = getObsHandle(sys, obsType);
+	if (obsHandle >= 0) return saveObsData(obsHandle, sat, value, lol, strg, tTag);
 	if (epochObs.empty()) epochTimeTag = tTag;
-	bool sameEpoch = epochTimeTag == tTag;
-	//check if this observable type for this system shall be stored
-	if (sameEpoch) {
-		if (sx >= 0) {
-			for (unsigned int ox = 0; ox != systems[sx].obsType.size(); ox++)
-				if (obsType.compare(systems[sx].obsType[ox]) == 0) {
-					epochObs.push_back(SatObsData(tTag, sx, sat, ox, value, lol, strg));
-					return true;
-				}
-		}
-		plog->warning("Observation data not saved. Unknown system " + string(1,sys) + " or observation " + obsType); 
+	if (epochTimeTag != tTag) return false;
+	plog->warning("Observation data not saved. Unknown system " + string(1,sys) + " or observation " + obsType); 
+	return true;
+}
+
+/**saveObsData stores measurement data for the observable identified by the given handle into the epoch data storage.
+ * It performs as the above method, but the system and observable type are given by a handle obtained using getObsHandle.
+ *
+ * @param obsHandle the handle of the system and observable type the measurement belongs
+ * @param sat the satellite PRN the measurement belongs
+ * @param value the value of the measurement
+ * @param lol the loss o lock indicator. See RINEX V2.10
+ * @param strg the signal strength. See RINEX V3.01
+ * @param tTag the time tag for the epoch this measurement belongs
+ * @return true if data belong to the current epoch, false otherwise
+ */
+bool RinexData::saveObsData(int obsHandle, int sat, double value, int lol, int strg, double tTag) {
+	if (epochObs.empty()) epochTimeTag = tTag;
+	if (epochTimeTag != tTag) return false;
+	if (!isObsHandle(obsHandle)) {
+		plog->warning("Observation data not saved. Wrong observable handle " + to_string((long long) obsHandle));
+		return true;
 	}
-	return sameEpoch;
+	epochObs.push_back(tTag, obsHandle >> 16, sat, obsHandle & 0xFFFF, value, lol, strg);
+	return true;
+}
+
+/**getObsHandle gets a handle identifying the given system and observable type, to be used to save or get observation data.
+ * The handle remains valid while the systems and observable types defined in the header records do not change.
+ *
+ * @param sys the system identification (G, S, ...)
+ * @param obsType the type of observable (C1C, L1C, D1C, ...) as per RINEX V3.01
+ * @return the handle, or -1 if the system or the observable type are not defined in the header records
+ */
+int RinexData::getObsHandle(char sys, const string &obsType) {
+	int sx = sysInx(sys);	//system index
+	if (sx >= 0) {
+		for (unsigned int ox = 0; ox != systems[sx].obsType.size(); ox++)
+			if (obsType.compare(systems[sx].obsType[ox]) == 0) return (sx << 16) | (int) ox;
+	}
+	return -1;
+}
+
+/**getObsHandleData gets the system and observable type identified by the given handle.
+ *
+ * @param obsHandle the handle of the system and observable type, as provided by getObsHandle or getObsData
+ * @param sys the system identification (G, S, ...)
+ * @param obsType the type of observable (C1C, L1C, D1C, ...) as per RINEX V3.01
+ * @return true if the handle identifies an observable type of a system defined in header records, false otherwise
+ */
+bool RinexData::getObsHandleData(int obsHandle, char &sys, string &obsType) {
+	if (!isObsHandle(obsHandle)) return false;
+	sys = systems[obsHandle >> 16].system;
+	obsType = systems[obsHandle >> 16].obsType[obsHandle & 0xFFFF];
+	return true;
 }
 
 /**getObsData extract from current epoch storage observable data in the given index position.
@@ -1226,15 +1290,31 @@ bool RinexData::saveObsData(char sys, int sat, string obsType, double value, int
  * @return true if data for the given index exist, false otherwise
  */
 bool RinexData::getObsData(char &sys, int &sat, string &obsType, double &value, int &lol, int &strg, double &tTag, unsigned int index) {
+	int obsHandle;
+	if (!getObsData(obsHandle, sat, value, lol, strg, tTag, index)) return false;
+	return getObsHandleData(obsHandle, sys, obsType);
+}
+
+/**getObsData extract from current epoch storage observable data in the given index position.
+ * It performs as the above method, but the system and observable type are given by a handle (see getObsHandleData).
+ *
+ * @param obsHandle the handle of the system and observable type the measurement belongs
+ * @param sat the satellite PRN the measurement belongs
+ * @param value the value of the measurement
+ * @param lol the loss o lock indicator. See RINEX V2.10
+ * @param strg the signal strength. See RINEX V3.01
+ * @param tTag the time tag for the epoch this measurement belongs
+ * @param index the position in the sequence of opoch observables to extract
+ * @return true if data for the given index exist, false otherwise
+ */
+bool RinexData::getObsData(int &obsHandle, int &sat, double &value, int &lol, int &strg, double &tTag, unsigned int index) {
 	if (epochObs.size() <= index) return false;
-	vector<SatObsData>::iterator it = epochObs.begin() + index;
-	sys = systems[it->sysIndex].system;
-	sat = it->satellite;
-	obsType = systems[it->sysIndex].obsType[it->obsTypeIndex];
-	value = it->obsValue;
-	lol = it->lossOfLock;
-	strg = it->strength;
-	tTag = it->obsTimeTag;
+	obsHandle = (EpochObsData::sysIndexOf(epochObs.satKey[index]) << 16) | (int) epochObs.obsTypeIndex[index];
+	sat = EpochObsData::satelliteOf(epochObs.satKey[index]);
+	value = epochObs.obsValue[index];
+	lol = epochObs.lossOfLock[index];
+	strg = epochObs.strength[index];
+	tTag = epochObs.obsTimeTag;
 	return true;
 }
 
@@ -1273,6 +1353,7 @@ bool RinexData::setFilter(vector<string> &selSat, vector<string> &selObs) {
 			(*itObs) = true;
 	}
 	if (selSat.empty() && selObs.empty()) {
+		compileFilter();
 		plog->info("Filtering data cleared"); 
 		return true;
 	}
@@ -1360,29 +1441,109 @@ bool RinexData::setFilter(vector<string> &selSat, vector<string> &selObs) {
 			plog->info(aStr);
 		} else plog->info(string("Excluded sys=") + string(1, itSystems->system));
 	}
+	compileFilter();
 	return areCoherent;
 }
 
+/**sort sorts the epoch observables by system, satellite PRN and observable type.
+ * Observables with the same system, satellite and type keep their relative order.
+ * Sorting is made on keys packing the satellite key, the observable type and the current position of each observable.
+ * After sorting keys, data are moved to their new positions following the cycles of the permutation, without auxiliary arrays.
+ */
+void RinexData::EpochObsData::sort() {
+	const unsigned long long POSMASK = 0xFFFFFF;	//the bits in the sort keys with the position of the observable
+	size_t n = obsValue.size();
+	size_t i, from, to;
+	bool sorted = true;
+	unsigned int aSatKey;
+	unsigned short anObsType;
+	double aValue;
+	short aLol, aStrength;
+	sortKey.resize(n);
+	for (i = 0; i < n; i++) {
+		sortKey[i] = ((unsigned long long) satKey[i] << 40) | ((unsigned long long) obsTypeIndex[i] << 24) | (unsigned long long) i;
+		if ((i > 0) && (sortKey[i] < sortKey[i-1])) sorted = false;
+	}
+	if (sorted) return;
+	std::sort(sortKey.begin(), sortKey.end());
+	//data for position i are in the position given by the low bits of sortKey[i]
+	for (i = 0; i < n; i++) {
+		if ((size_t) (sortKey[i] & POSMASK) == i) continue;
+		aSatKey = satKey[i];
+		anObsType = obsTypeIndex[i];
+		aValue = obsValue[i];
+		aLol = lossOfLock[i];
+		aStrength = strength[i];
+		to = i;
+		while ((from = (size_t) (sortKey[to] & POSMASK)) != i) {
+			copy(to, from);
+			sortKey[to] = to;
+			to = from;
+		}
+		satKey[to] = aSatKey;
+		obsTypeIndex[to] = anObsType;
+		obsValue[to] = aValue;
+		lossOfLock[to] = aLol;
+		strength[to] = aStrength;
+		sortKey[to] = to;
+	}
+}
+
 /**filterObsData if filtering data have been stated using setFilter method, removes from current epoch observation data on systems, satellites or observables not selected.
+ *
+ * Filtering uses the bitmaps compiled by setFilter: each observable is copied to the next kept position, which advances only
+ * when its system, observable type and satellite are selected.
+ * After that, if elevation or signal to noise ratio masks have been stated, data of satellites below them are removed.
  *
  * @return true when it remains any epoch data after filtering, false when no data remain
  */
 bool RinexData::filterObsData() {
-	vector<SatObsData>::iterator it;
-	if (applyObsFilter) {	//remove from epochObs the observables not selected
-		it = epochObs.begin();
-		while (it != epochObs.end()) {
-			if (!systems[it->sysIndex].selSystem ||
-					!systems[it->sysIndex].selObsType[it->obsTypeIndex] ||
-					!isSatSelected(it->sysIndex, it->satellite)) {	//system, observable or satellite not selected
-				it = epochObs.erase(it);
-			} else it++;
-		}
-	}
-	sort(epochObs.begin(), epochObs.end());
+	size_t i, kept;
+	int sysIndex, sat;
+	unsigned int obs, selected;
+	if (applyObsFilter) {	//remove from epochObs the observables not selected, moving the selected ones to the front
+		for (i = kept = 0; i < epochObs.size(); i++) {
+			sysIndex = EpochObsData::sysIndexOf(epochObs.satKey[i]);
+			sat = EpochObsData::satelliteOf(epochObs.satKey[i]);
+			obs = epochObs.obsTypeIndex[i];
+			selected = (systems[sysIndex].selObsMask[obs >> 5] >> (obs & 31)) & 1;	//system and observable selected
+			if ((unsigned int) sat < (unsigned int) FILTERPRNS) selected &= (unsigned int) systems[sysIndex].selPrn[sat];
+			else selected &= (unsigned int) isSatSelected(sysIndex, sat);	//out of the bitmap range
+			epochObs.copy(kept, i);
+			kept += selected;
+		}
+		epochObs.truncate(kept);
+	}
+	if (applyElevMask || applySnrMask) maskObsData();
+	epochObs.sort();
 	return !epochObs.empty();
 }
 
+/**setElevationMask states the minimum elevation of satellites whose observation data will pass filterObsData.
+ * Elevations are computed at the epoch time from the APPROX POSITION XYZ header data, using the ephemerides in the given store.
+ * Satellites without valid ephemeris are not removed.
+ *
+ * @param minElevation the minimum elevation, in degrees
+ * @param ephStore the store of ephemerides used to compute satellite positions, or NULL to use the ones saved or read in this object
+ */
+void RinexData::setElevationMask(double minElevation, EphemerisStore* ephStore) {
+	applyElevMask = true;
+	minElevMask = minElevation;
+	orbits.setEphemerisStore(ephStore == NULL? &ephemerides : ephStore);
+}
+
+/**setSnrMask states the minimum signal to noise ratio of satellites whose observation data will pass filterObsData.
+ * The greatest value of the S1 observables of a satellite is compared with the minimum. If the satellite has not S1 observables,
+ * the upper limit of the range for its signal strength (see RINEX V3.02 5.7) is used.
+ * Satellites without signal to noise data are not removed.
+ *
+ * @param minSnr the minimum signal to noise ratio, in dB-Hz
+ */
+void RinexData::setSnrMask(double minSnr) {
+	applySnrMask = true;
+	minSnrMask = minSnr;
+}
+
 /**clearObsData clears all epoch observation data on satellites and observables previously saved.
  *
  */
@@ -1402,15 +1563,13 @@ void RinexData::clearObsData() {
 bool RinexData::saveNavData(char sys, int sat, double bo[8][4], double tTag) {
 	//check if this sat epoch data already exists: same satellite and time tag
 	char msgBuf[100];
-	sprintf(msgBuf,"Ephemeris for sat=%c%02d at=%g ", sys, sat, tTag);
-	for (vector<SatNavData>::iterator it = epochNav.begin(); it != epochNav.end(); it++) {
-		if((sys == it->systemId) && (sat == it->satellite) && (tTag == it->navTimeTag)) {
-			plog->fine(string(msgBuf) + " already exist");
-			return false;
-		}
+	if (plog->isLevel(Logger::FINE)) sprintf(msgBuf,"Ephemeris for sat=%c%02d at=%g ", sys, sat, tTag);
+	if (navKeys.find(NAVkey(sys, sat, tTag)) != navKeys.end()) {
+		LOG_FINE(plog, string(msgBuf) + " already exist");
+		return false;
 	}
-	epochNav.push_back(SatNavData(tTag, sys, sat, bo));
-	plog->fine(string(msgBuf) + " saved");
+	pushNavData(tTag, sys, sat, bo);
+	LOG_FINE(plog, string(msgBuf) + " saved");
 	return true;
 }
 
@@ -1436,33 +1595,95 @@ bool RinexData::getNavData(char& sys, int &sat, double (&bo)[8][4], double &tTag
 }
 
 /**filterNavData if filtering data have been stated using setFilter method, removes from current epoch data on system or satellites not selected.
+ *
+ * Filtering uses the bitmaps compiled from the selected system-satellites list.
  *
  * @return true when it remains any epoch data after filtering, false when no data remain
  */
 bool RinexData::filterNavData() {
-	char buffer[5];
-	vector<SatNavData>::iterator it;
-	vector<string>::iterator itsel;
-	if (applyNavFilter) {	//remove from epochNav the system-satellites not selected
-		it = epochNav.begin();
-		while (it != epochNav.end()) {
-			sprintf(buffer, "%1c%02.2d", it->systemId, it->satellite);	//obtain a string with system-satellite identification
-			for (itsel = selectedSats.begin();	//look for it in the selected system-satellites list
-				(itsel != selectedSats.end()) && (string(buffer).compare(0,(*itsel).size(), *itsel) != 0);
-				++itsel);
-			if (itsel == selectedSats.end()) it = epochNav.erase(it);
-			else it++;
-		}
-	}
-	sort(epochNav.begin(), epochNav.end());
+	vector<SatNavData>::iterator it, itKept;
+	vector<NAVfilter>::iterator itFilter;
+	bool selected;
+	sortNavData();
+	if (applyNavFilter) {	//remove from epochNav the system-satellites not selected, moving the selected ones to the front
+		itKept = epochNav.begin();
+		for (it = epochNav.begin(); it != epochNav.end(); it++) {
+			if ((unsigned int) it->satellite < (unsigned int) FILTERPRNS) {
+				for (itFilter = navFilter.begin(); (itFilter != navFilter.end()) && (itFilter->system != it->systemId); itFilter++);
+				selected = (itFilter != navFilter.end()) && itFilter->selPrn[it->satellite];
+			} else selected = isNavSatSelected(it->systemId, it->satellite);	//out of the bitmap range
+			if (selected) {
+				if (itKept != it) *itKept = *it;
+				itKept++;
+			} else dropNavKey(*it);
+		}
+		epochNav.erase(itKept, epochNav.end());
+		navSorted = epochNav.size();
+	}
 	return !epochNav.empty();
 }
 
 /**clearNavData clears all epoch navigation data on satellites and ephemeris previously saved.
- *
+ * Note that data already kept in the ephemeris store are not removed.
  */
 void RinexData::clearNavData() {
 	epochNav.clear();
+	navKeys.clear();
+	navSorted = 0;
+}
+
+/**getBestNavData gets from the ephemeris store the navigation data of the given satellite to be used at the given instant:
+ * the valid one having the reference time (Toe or Toc) nearest to the instant.
+ * The ephemeris store keeps all navigation data saved or read, even after they have been printed or cleared.
+ *
+ * @param sys the satellite system identifier (G,E,R, ...)
+ * @param sat the satellite PRN
+ * @param t the instant in seconds from the GPS ephemeris (see getSecsGPSEphe)
+ * @param bo the broadcast orbit data with the eight lines of RINEX navigation data with four parameters each
+ * @param tTag the time tag for the navigation data
+ * @return true if valid navigation data exist for the satellite at the given instant, false otherwise
+ */
+bool RinexData::getBestNavData(char sys, int sat, double t, double (&bo)[8][4], double &tTag) {
+	const EphemerisStore::Ephemeris* eph = ephemerides.find(sys, sat, t);
+	if (eph == NULL) return false;
+	for (int i = 0; i < 8; i++)
+		for (int j = 0; j< 4; j++)
+			bo[i][j] = eph->broadcastOrbit[i][j];
+	tTag = eph->navTimeTag;
+	return true;
+}
+
+/**getEphemerisStore provides the ephemeris store where all navigation data saved or read are kept.
+ *
+ * @return a pointer to the ephemeris store of this object
+ */
+EphemerisStore* RinexData::getEphemerisStore() {
+	return &ephemerides;
+}
+
+/**getSatPositions computes position, clock correction, elevation and azimuth of the satellites in the current observation epoch
+ * at the epoch time, using the best ephemerides kept in the ephemeris store.
+ * Elevation and azimuth are computed from the APPROX POSITION XYZ header data, if they have been set.
+ *
+ * @param satPos the satellites in the epoch with their computed data (see OrbitEvaluator::SatPosition)
+ * @return the number of satellites having valid ephemeris
+ */
+int RinexData::getSatPositions(vector<OrbitEvaluator::SatPosition> &satPos) {
+	unsigned int lastKey = 0xFFFFFFFF;
+	char sys;
+	int sat;
+	vector<OrbitEvaluator::SatPosition>::iterator itSat;
+	satPos.clear();
+	for (size_t i = 0; i < epochObs.size(); i++) {
+		if (epochObs.satKey[i] == lastKey) continue;
+		lastKey = epochObs.satKey[i];
+		sys = systems[EpochObsData::sysIndexOf(lastKey)].system;
+		sat = EpochObsData::satelliteOf(lastKey);
+		for (itSat = satPos.begin(); (itSat != satPos.end()) && !((itSat->systemId == sys) && (itSat->satellite == sat)); itSat++);
+		if (itSat == satPos.end()) satPos.push_back(OrbitEvaluator::SatPosition(sys, sat));
+	}
+	setOrbitParams();
+	return orbits.compute(getSecsGPSEphe(epochWeek, epochTOW), satPos);
 }
 
 /**getObsFileName constructs a standard RINEX observation file name from the given prefix and current header data.
@@ -1501,7 +1722,7 @@ string RinexData::getNavFileName(string prefix, char suffix, string country) {
 		tow = firstObsTOW;
 	}
 	if (!epochNav.empty()) {
-		sort(epochNav.begin(), epochNav.end());
+		sortNavData();
 		week = getGPSweek(epochNav[0].navTimeTag);
 		tow = getGPStow(epochNav[0].navTimeTag);
 	}
@@ -1513,18 +1734,22 @@ string RinexData::getNavFileName(string prefix, char suffix, string country) {
 	}
 }
 
-/**printObsHeader prints the RINEX observation file header using data stored for header records.
+/**prepareObsHeader sets and verifies the header data needed to print an observation file: the version, file type and system records,
+ * and the observable types to be printed, depending on the version.
+ *<p>It is called by printObsHeader. When epochs are printed before the header (for example, when header data are still being acquired
+ * while printing epochs into a temporary file), it shall be called before printing the first epoch.
  *
- * @param out the already open print stream where RINEX header will be printed
- * @throws error message string when header cannot be printed
+ * @throws error message string when header data to print are not consistent
  */
-void RinexData::printObsHeader(FILE* out) {
+void RinexData::prepareObsHeader() {
 	string aStr;
-	///Before printing, set and verify VERSION data record:
+	///Set and verify VERSION data record:
 	int anInt = nSysSel();
 	if (anInt == 0) throw string("Satellite systems not defined or none selected");
 	if (version == VTBD) version = inFileVer;
 	if (version == VTBD) throw msgVerTBD;
+	///Keep station position for satellite elevations, as header data could be cleared after printing
+	setOrbitParams();
 	/// - Set file type for Observation.
 	fileType = 'O';
 	fileTypeSfx = "BSERVATION DATA";
@@ -1549,10 +1774,24 @@ void RinexData::printObsHeader(FILE* out) {
 		setLabelFlag(SYS);
 		setLabelFlag(TOBS, false);
 	}
+}
+
+/**printObsHeader prints the RINEX observation file header using data stored for header records.
+ *
+ * @param out the already open print stream where RINEX header will be printed
+ * @throws error message string when header cannot be printed
+ */
+void RinexData::printObsHeader(FILE* out) {
+	///Before printing, set and verify header data (see prepareObsHeader)
+	prepareObsHeader();
 	///Finally, for each observation header record belonging to the current version and having data defined, print it.
+	///When header patching is active, lines are reserved for records with statistics of the epochs (see setHeaderPatch).
+	hdPatches.clear();
 	for (vector<LABELdata>::iterator it = labelDef.begin(); it != labelDef.end(); it++) {
 		if (((it->type & OBSMSK) != OBSNAP) && (it->ver == VALL || it->ver == version)) {
-			if (it->hasData)
+			if (patchHeader && (it->labelID == INT || it->labelID == TOLO || it->labelID == SATS || it->labelID == PRNOBS))
+				reserveHdLines(out, it);
+			else if (it->hasData)
 				printHdLineData(out, it);
 			else if ((it->type & OBSMSK) == OBSOBL)
 				///Log a warning message when the record to be printed is obligatory, but has not data.
@@ -1570,20 +1809,31 @@ void RinexData::printObsHeader(FILE* out) {
  *<p>Data filtering is performed before printing (when data filters have been set).
  *<p>Observation data are removed from storage after printing them, but for special event epochs their special
  *records (header lines) are not cleared after printing them.
+ *<p>The text of epochs with observation data is built in a buffer, and it is printed with a single write.
+ *<p>When a printing thread has been stated using setPrintThread, epochs with observation data are handed to it, and current epoch
+ *observation data are cleared. Event epochs are printed after the thread has printed all epochs handed before.
+ *Epochs are printed sequentially when an elevation mask is applied, as it uses the ephemerides being acquired.
  * 
  * @param out the already open print stream where RINEX epoch data will be printed
  * @throws error message string when epoch data cannot be printed due to undefined version to be printed
  */
 void RinexData::printObsEpoch(FILE* out) {
-///a macro to compute comparison expression of satellite in two consecutive observables, in iterator POSITION and (POSITION-1)
+///a macro to compute comparison expression of satellite in two consecutive observables, in position POSITION and (POSITION-1)
 	#define DIFFERENT_SAT(POSITION) \
-		((POSITION-1)->sysIndex != POSITION->sysIndex) ||	\
-		((POSITION-1)->satellite != POSITION->satellite)
+		(epochObs.satKey[POSITION-1] != epochObs.satKey[POSITION])
 
 	char timeBuffer[80];
-	vector<SatObsData>::iterator it;
+	char numBuffer[80];
+	size_t i, kept;
 	int anInt;
 	bool clkPrinted = false;	//a flag to know if clock bias has been printed or not
+	if (printThreadSet && !applyElevMask) {
+		if ((epochFlag < 2) || (epochFlag > 5)) {
+			queueObsEpoch(out);
+			return;
+		}
+		endPrintThread();
+	}
 	//set the printable epoch time using format of the version to be printed.
 	switch (version) {
 	case V210:	//RINEX version 2.10
@@ -1605,59 +1855,82 @@ void RinexData::printObsEpoch(FILE* out) {
 		if (!filterObsData()) return;
 		switch (version) {
 		case V210:	//RINEX version 2.10
-			//change the observable type index as per V210 and remove observations not allowed in V210
-			it = epochObs.begin();
-			while (it != epochObs.end()) {
-				anInt = v2ObsInx(obsV3toV2(it->sysIndex, it->obsTypeIndex));
+			//change the observable type index as per V210 and remove observations not allowed in V210, moving the allowed ones to the front
+			for (i = kept = 0; i < epochObs.size(); i++) {
+				anInt = v2ObsInx(obsV3toV2(EpochObsData::sysIndexOf(epochObs.satKey[i]), epochObs.obsTypeIndex[i]));
 				if (anInt >= 0) {
-					it->obsTypeIndex = anInt;
-					it++;
-				} else it = epochObs.erase(it);
+					if (kept != i) epochObs.copy(kept, i);
+					epochObs.obsTypeIndex[kept] = (unsigned short) anInt;
+					kept++;
+				}
 			}
+			epochObs.truncate(kept);
 			//check if it remains anything to print
 		 	if (epochObs.empty()) return;
 			//sort observable data items available by system, satellite and new measurement type
-			sort(epochObs.begin(), epochObs.end());
+			epochObs.sort();
 			//count the number of different satellites with data in this epoch (at least one)
 			nSatsEpoch = 1;
-			for (it = epochObs.begin()+1; it != epochObs.end(); it++) if (DIFFERENT_SAT(it)) nSatsEpoch++;
-	 		//print epoch 1st line
-	 		fprintf(out, "%s  %1d%3d", timeBuffer, epochFlag, nSatsEpoch);
-			//append the different systems and satellites existing in this epoch.
+			for (i = 1; i < epochObs.size(); i++) if (DIFFERENT_SAT(i)) nSatsEpoch++;
+	 		//format epoch 1st line as per "%s  %1d%3d"
+			epochText.assign(timeBuffer);
+			epochText.append(2, ' ');
+			epochText.append(numBuffer, formatInt(numBuffer, 1, epochFlag));
+			epochText.append(numBuffer, formatInt(numBuffer, 3, nSatsEpoch));
+			//append the different systems and satellites existing in this epoch ("%1c%02d").
 			//if number of satellites is greather than 12, use continuation lines. Clock bias is printed only in the 1st one
-			fprintf(out, "%1c%02d", systems[epochObs[0].sysIndex].system, epochObs[0].satellite);
+			epochText += systems[EpochObsData::sysIndexOf(epochObs.satKey[0])].system;
+			epochText.append(numBuffer, formatInt(numBuffer, 2, EpochObsData::satelliteOf(epochObs.satKey[0]), '0'));
 			anInt = 1;		//currently, the number of satellites already printed
-			for (it = epochObs.begin()+1; it != epochObs.end(); it++)
-				if (DIFFERENT_SAT(it)) {
-					if ((anInt % 12) == 0) fprintf(out, "\n%32c", ' '); //to print the 1st sat in a continuation line
-					fprintf(out, "%1c%02d", systems[it->sysIndex].system, it->satellite);
+			for (i = 1; i < epochObs.size(); i++)
+				if (DIFFERENT_SAT(i)) {
+					if ((anInt % 12) == 0) {	//to print the 1st sat in a continuation line
+						epochText += '\n';
+						epochText.append(32, ' ');
+					}
+					epochText += systems[EpochObsData::sysIndexOf(epochObs.satKey[i])].system;
+					epochText.append(numBuffer, formatInt(numBuffer, 2, EpochObsData::satelliteOf(epochObs.satKey[i]), '0'));
 					anInt++;
 					if (anInt == 12) {		//printed last sat in the 1st line
-						fprintf(out, "%12.9f", epochClkOffset);
+						epochText.append(numBuffer, formatFixed(numBuffer, sizeof numBuffer, 12, 9, epochClkOffset));
 						clkPrinted = true;
 					}
 				}
 			while ((anInt % 12) != 0) {	//fill the line
-				fprintf(out, "%3c", ' ');
+				epochText.append(3, ' ');
 				anInt++;
 			}
-			if (clkPrinted) fprintf(out, "\n");
-			else fprintf(out, "%12.9f\n", epochClkOffset);
-			//print epoch measurement lines. For each satellite in this epoch, print a line with their measurements, and remove them
-			while (printSatObsValues(out, 5));
+			if (!clkPrinted) epochText.append(numBuffer, formatFixed(numBuffer, sizeof numBuffer, 12, 9, epochClkOffset));
+			epochText += '\n';
+			//format epoch measurement lines. For each satellite in this epoch, format a line with their measurements
+			for (i = 0; i < epochObs.size(); ) i = formatSatObsValues(i, 5);
+			if (patchHeader && (epochFlag != 6)) addObsStats();
+			epochObs.clear();
+			fwrite(epochText.data(), 1, epochText.size(), out);
 	 		break;
 		case V302:	//RINEX version 3.00
-			//sort observable data items available by system, satellite and measurement type
-			sort(epochObs.begin(), epochObs.end());
+			//observable data items are already sorted by system, satellite and measurement type
 			//count the number of different satellites with data in this epoch (at least one)
 			nSatsEpoch = 1;
-			for (it = epochObs.begin()+1; it != epochObs.end(); it++) if (DIFFERENT_SAT(it)) nSatsEpoch++;
-			//print epoch 1st line
- 			fprintf(out, "%s  %1d%3d%5c%15.12f%3c\n", timeBuffer, epochFlag, nSatsEpoch, ' ', epochClkOffset, ' ');
-			//for each satellite belonging to this epoch,  print a line with their measurements (they are removed just after printed)
-			do {
-				fprintf(out, "%1c%02d", systems[epochObs[0].sysIndex].system, epochObs[0].satellite);
- 			} while (printSatObsValues(out, 999));
+			for (i = 1; i < epochObs.size(); i++) if (DIFFERENT_SAT(i)) nSatsEpoch++;
+			//format epoch 1st line as per "%s  %1d%3d%5c%15.12f%3c\n"
+			epochText.assign(timeBuffer);
+			epochText.append(2, ' ');
+			epochText.append(numBuffer, formatInt(numBuffer, 1, epochFlag));
+			epochText.append(numBuffer, formatInt(numBuffer, 3, nSatsEpoch));
+			epochText.append(5, ' ');
+			epochText.append(numBuffer, formatFixed(numBuffer, sizeof numBuffer, 15, 12, epochClkOffset));
+			epochText.append(3, ' ');
+			epochText += '\n';
+			//for each satellite belonging to this epoch, format a line with their measurements
+			for (i = 0; i < epochObs.size(); ) {
+				epochText += systems[EpochObsData::sysIndexOf(epochObs.satKey[i])].system;
+				epochText.append(numBuffer, formatInt(numBuffer, 2, EpochObsData::satelliteOf(epochObs.satKey[i]), '0'));
+				i = formatSatObsValues(i, 999);
+			}
+			if (patchHeader && (epochFlag != 6)) addObsStats();
+			epochObs.clear();
+			fwrite(epochText.data(), 1, epochText.size(), out);
  			break;
  		}
 		break;
@@ -1696,6 +1969,103 @@ void RinexData::printObsEpoch(FILE* out) {
 	 setHdLnData(COMM, LASTONE, string("END OF FILE"));
 	 printObsEpoch(out);
 }
+
+/**setHeaderPatch sets header patching for the observation file to be printed.
+ *<p>When it is active, printObsHeader reserves lines for the INTERVAL, TIME OF LAST OBS, # OF SATELLITES and PRN / # OF OBS records,
+ *printObsEpoch accumulates statistics of the epochs printed, and patchObsHeader overwrites the reserved lines with the records
+ *computed from these statistics. This allows printing a complete header in a single pass, without a temporary file.
+ *<p>The output file shall allow positioning (a regular file, not a pipe or the standard output).
+ *
+ * @param maxSats the maximum number of satellites with PRN / # OF OBS records. A value of 0 or less disables header patching
+ */
+void RinexData::setHeaderPatch(int maxSats) {
+	patchHeader = maxSats > 0;
+	patchMaxSats = patchHeader? maxSats : 0;
+	hdPatches.clear();
+	obsStats.epochs = 0;
+	obsStats.lastWeek = 0;
+	obsStats.lastTOW = 0.0;
+	obsStats.intervals.clear();
+	obsStats.obsCount.clear();
+}
+
+/**patchObsHeader overwrites the header lines reserved by printObsHeader with the INTERVAL, TIME OF LAST OBS, # OF SATELLITES and
+ * PRN / # OF OBS records computed from the epochs printed. It shall be called after printing the last epoch, before closing the file.
+ *<p>The interval is the most frequent time difference between consecutive epochs, as receivers may give some epochs out of their nominal time.
+ *The PRN / # OF OBS records are not patched when the satellites observed do not fit into the lines reserved, and the INTERVAL
+ * record is not patched when it cannot be computed (less than two epochs). Lines reserved and not patched remain as empty comments.
+ *<p>On return the output file is positioned at its end.
+ *
+ * @param out the already open print stream where the RINEX header and epochs were printed
+ * @return true if all reserved records have been patched, false otherwise
+ */
+bool RinexData::patchObsHeader(FILE* out) {
+	bool patched = true;
+	unsigned int i, j;
+	long endPos;
+	vector<int> obsNum;
+	endPrintThread();
+	if (!patchHeader || hdPatches.empty()) return false;
+	if (obsStats.epochs == 0) {
+		plog->warning("Header records not patched: no epochs printed");
+		return false;
+	}
+	if ((endPos = ftell(out)) < 0) {
+		plog->warning("Header records not patched: output file cannot be positioned");
+		return false;
+	}
+	///Set header data from the statistics of epochs printed
+	j = 0;
+	obsInterval = 0.0;
+	for (map<long long, int>::iterator it = obsStats.intervals.begin(); it != obsStats.intervals.end(); it++)
+		if (it->second > (int) j) {
+			j = it->second;
+			obsInterval = it->first / 1000.0;
+		}
+	lastObsWeek = obsStats.lastWeek;
+	lastObsTOW = obsStats.lastTOW;
+	numOfSat = (int) obsStats.obsCount.size();
+	prnObsNum.clear();
+	for (map<unsigned int, vector<int> >::iterator it = obsStats.obsCount.begin(); it != obsStats.obsCount.end(); it++) {
+		i = EpochObsData::sysIndexOf(it->first);
+		if ((version == V302) && applyObsFilter) {
+			//count only observable types selected, as printed in the SYS / # / OBS TYPES records
+			obsNum.clear();
+			for (j = 0; j < it->second.size(); j++) if (systems[i].selObsType[j]) obsNum.push_back(it->second[j]);
+			prnObsNum.push_back(PRNobsnum(systems[i].system, EpochObsData::satelliteOf(it->first), obsNum));
+		} else prnObsNum.push_back(PRNobsnum(systems[i].system, EpochObsData::satelliteOf(it->first), it->second));
+	}
+	///For each record reserved, print its data over the reserved lines, filling with comments the ones remaining
+	for (vector<HDpatch>::iterator itp = hdPatches.begin(); itp != hdPatches.end(); itp++) {
+		if (itp->labelID == INT && obsInterval <= 0.0) {
+			plog->warning(valueLabel(INT, "not patched, cannot be computed"));
+			patched = false;
+			continue;
+		}
+		if (itp->labelID == PRNOBS) {
+			j = 0;
+			for (i = 0; i < prnObsNum.size(); i++) j += (prnObsNum[i].obsNum.size() + 8) / 9;
+			if (j > (unsigned int) itp->lines) {
+				plog->warning(valueLabel(PRNOBS, "not patched, lines reserved are not enough for " + to_string((long long) numOfSat) + " satellites"));
+				patched = false;
+				continue;
+			}
+		} else j = 1;
+		if (fseek(out, itp->position, SEEK_SET) != 0) {
+			plog->warning(valueLabel(itp->labelID, "not patched, output file cannot be positioned"));
+			patched = false;
+			continue;
+		}
+		for (vector<LABELdata>::iterator it = labelDef.begin(); it != labelDef.end(); it++)
+			if (it->labelID == itp->labelID) {
+				printHdLineData(out, it);
+				break;
+			}
+		printHdComments(out, itp->lines - (int) j);
+	}
+	fseek(out, endPos, SEEK_SET);
+	return patched;
+}
  
  /**printNavHeader prints RINEX navigation file header using the current RINEX data.
  * 
@@ -1725,6 +2095,7 @@ void RinexData::printNavHeader(FILE* out) {
 				if (systems.size() == 1) {	//it is assumed the selected one is the sys having obs data
 					selectedSats.push_back(string(1,systems[0].system));
 					applyNavFilter = true;
+					compileFilter();
 				} else throw msgNotNav + "UNSELECTED";
 			}
 			systemId = selectedSats[0].at(0);
@@ -1770,9 +2141,10 @@ void RinexData::printNavHeader(FILE* out) {
 void RinexData::printNavEpoch(FILE* out) {
 	char timeBuffer[80];
 	int nBroadcastOrbits, nEphemeris;
-	char* timeFormat;
+	const char* timeFormat;
+	const char* secFormat;
 	char* lineStart;
-	vector<SatNavData>::iterator it;
+	vector<SatNavData>::iterator it, itKept;
 
 #ifdef _WIN32
 	//MS VS specific!!
@@ -1783,10 +2155,12 @@ void RinexData::printNavEpoch(FILE* out) {
 	switch (version) {
 	case V210:
 		timeFormat = "%y %m %d %H %M";
+		secFormat = " %4.1f";	//F5.1 seconds
 		lineStart = "   "; //3 spaces
 		break;
 	case V302:
 		timeFormat = "%Y %m %d %H %M";
+		secFormat = " %02.0f";	//I2.2 seconds, as stated in RINEX 3
 		lineStart = "    "; //4 spaces
 		break;
 	default:
@@ -1795,17 +2169,19 @@ void RinexData::printNavEpoch(FILE* out) {
 	//filter and sort epochs available by time tag, system, and satellite
 	//filterNavData();
 	//sort epochs available by time tag, system, and satellite
-	sort(epochNav.begin(), epochNav.end());
-	plog->finest("Nav epoch for sys=" + string(1, systemId));
-	it = epochNav.begin();
-	while (it != epochNav.end()) {
+	sortNavData();
+	LOG_FINEST(plog, "Nav epoch for sys=" + string(1, systemId));
+	//data printed are removed from epochNav. Data not printed are moved to its front and kept
+	itKept = epochNav.begin();
+	for (it = epochNav.begin(); it != epochNav.end(); it++) {
 		if ((version == V210) && (it->systemId != systemId)) {	//in V210 only sats belonging to one system are printed
-			plog->finest("Nav epoch ignored: sys=" + string(1,it->systemId) + "; sat=" + to_string((long long) it->satellite));
-			it++;
+			LOG_FINEST(plog, "Nav epoch ignored: sys=" + string(1,it->systemId) + "; sat=" + to_string((long long) it->satellite));
+			if (itKept != it) *itKept = *it;
+			itKept++;
 		} else {
-			plog->finest("Nav epoch printed: sys=" + string(1, it->systemId) + "; sat=" + to_string((long long) it->satellite));
+			LOG_FINEST(plog, "Nav epoch printed: sys=" + string(1, it->systemId) + "; sat=" + to_string((long long) it->satellite));
 			//print epoch first line
-			formatGPStime (timeBuffer, sizeof timeBuffer, timeFormat, " %4.1f", getGPSweek(it->navTimeTag), getGPStow(it->navTimeTag));
+			formatGPStime (timeBuffer, sizeof timeBuffer, timeFormat, secFormat, getGPSweek(it->navTimeTag), getGPStow(it->navTimeTag));
 			switch (version) {	//print satellite and epoch time
 			case V210:
 				fprintf(out, "%02d %s", it->satellite, timeBuffer);
@@ -1838,9 +2214,11 @@ void RinexData::printNavEpoch(FILE* out) {
 				}
 				fprintf(out, "\n");
 			}
-			epochNav.erase(it);
+			dropNavKey(*it);
 		}
 	}
+	epochNav.erase(itKept, epochNav.end());
+	navSorted = epochNav.size();
 }
 
 /**readRinexHeader read the RINEX file header extracting its data and storing them into to the class members.
@@ -1855,7 +2233,7 @@ void RinexData::printNavEpoch(FILE* out) {
 RinexData::RINEXlabel RinexData::readRinexHeader(FILE* input) {
 	RINEXlabel labelId;
 	int maxErrors = 10;
-	plog->fine("Data from RINEX file header:");
+	LOG_FINE(plog, "Data from RINEX file header:");
 	//state variable to check correct order of header lines. Values are:
 	// 0 : No lines read. VERSION shall follow
 	// 1 : VERSION line read. No lines labeled DCBS, SCALE, or PRN can follow
@@ -1863,6 +2241,14 @@ RinexData::RINEXlabel RinexData::readRinexHeader(FILE* input) {
 	// 3 : SATS read. PRN can follow
 	// 4 : EOH read
 	int lineOrder = 0;
+	//a new input file: any former parallel reading or mapped image is released
+	endParallelRead();
+	inFile = NULL;
+	inMap.unmap();
+	inData = NULL;
+	inSize = 0;
+	epochIndex.clear();
+	indexLoaded = indexBuilding = false;
 	//read lines from input file
 	do {
 		labelId = readHdLineData(input);
@@ -1924,6 +2310,10 @@ RinexData::RINEXlabel RinexData::readRinexHeader(FILE* input) {
 /**readObsEpoch reads from a RINEX observation file one epoch (data and observables) and store them into the RinexData object.
  * Observable storage in the RinexData object is cleared before storing new data.
  * Stored epoch time and time tags (the same for epoch and observables) are set from epoch time read.
+ * <p>When several read threads have been stated using setReadThreads, epochs are parsed in advance by these threads,
+ * and they are delivered here in the same order, and with the same data, status and logging messages, than when read sequentially.
+ * <p>When an epoch index file has been stated using setEpochIndex, and it did not exist, the index is built while epochs are read,
+ * and it is saved when the EOF is found.
  *
  * @param input the already open print stream where RINEX epoch will be read
  * @return the status of the RINEX data read, which can can be:
@@ -1939,15 +2329,25 @@ RinexData::RINEXlabel RinexData::readRinexHeader(FILE* input) {
  *		- (9)	Unknown input file version
  */
 int RinexData::readObsEpoch(FILE* input) {
-	epochObs.clear();
-	switch(inFileVer) {
-	case V210:
-		return readV2ObsEpoch(input);
-	case V302:
-		return readV3ObsEpoch(input);
-	default:
-		return 9;
+	int retCode;
+	long long pos = indexBuilding? MappedFile::tell(input) : 0;
+	if ((readThreads <= 1) || ((retCode = readObsEpochParallel(input)) < 0)) {
+		epochObs.clear();
+		beginEpochRead(input);
+		switch(inFileVer) {
+		case V210:
+			retCode = readV2ObsEpoch(input);
+			break;
+		case V302:
+			retCode = readV3ObsEpoch(input);
+			break;
+		default:
+			retCode = 9;
+		}
+		endEpochRead(input);
 	}
+	if (indexBuilding) indexObsEpoch(pos, retCode);
+	return retCode;
 }
 
 /**readNavEpoch reads from the RINEX navigation file data and ephemeris for one setellite - epoch and store them into the RinexData object.
@@ -1967,29 +2367,37 @@ int RinexData::readNavEpoch(FILE* input) {
 ///a macro to log the given error and return
 #define RETURN_WITH_ERROR(ERROR_STR, ERROR_CODE) \
 		{ \
-			plog->warning(msgPrfx + ERROR_STR); \
+			endEpochRead(input); \
+			plog->warning(EPOCH_MSG(msgTxt + ERROR_STR)); \
 			return ERROR_CODE; \
 		}
 ///a macro to get data for broadcast orbit in LINE_I COL_J
 #define GET_BO(LINE_I, COL_J) \
-		if (sscanf(startPos1st, "%19lf", &bo[LINE_I][COL_J]) != 1) { \
+		if (!rec.getDouble(pos1st, 19, bo[LINE_I][COL_J])) { \
 			retCode = 5; \
-			msgPrfx += string("Error Broad.Orb.[") + to_string((long long) LINE_I) + string("][") + to_string((long long) COL_J) + string("]."); \
+			msgTxt += string("Error Broad.Orb.[") + to_string((long long) LINE_I) + string("][") + to_string((long long) COL_J) + string("]."); \
 		} \
-		startPos1st += 19;
+		pos1st += 19;
 
-	char lineBuffer[100], sysSat;
+	RINEXrecord rec;
+	char sysSat;
 	int anInt, prnSat, nBroadcastOrbits, nEphemeris;
 	double atow, attag;
-	char *startPos1st;
-	char *startPosBO;
+	int pos1st;
+	int posBO;
 	double bo[8][4];
 	int retCode;
 
-	epochNav.clear();
+	clearNavData();
+	beginEpochRead(input);
 	//read epoch 1st line and extract data and set specific line parameter
-	if (readRinexRecord(lineBuffer, sizeof lineBuffer, input)) return 0;
-	string msgPrfx =  string("Epoch [") + string(lineBuffer, 32) + string("]");
+	if (readRinexRecord(rec, input)) {
+		endEpochRead(input);
+		return 0;
+	}
+	char epochTxt[32];	//the epoch line start, kept to compose log messages only when they are needed
+	rec.copy(0, sizeof epochTxt, epochTxt);
+	string msgTxt;
 	int year = 0, month = 0, day = 0, hour = 0, minute = 0;
 	double second = 0.0;
 	switch (inFileVer) {
@@ -1999,21 +2407,24 @@ int RinexData::readNavEpoch(FILE* input) {
 		case 'G': sysSat = 'R'; break;	//a GLONASS navigation file
 		default: RETURN_WITH_ERROR(string("Wrong version / file type"), 3)
 		}
-		if (sscanf(lineBuffer, "%2d", &prnSat) != 1) RETURN_WITH_ERROR(string("Wrong PRN"), 3)
-		if (sscanf(lineBuffer+3, "%2d %2d %2d %2d %2d%5lf", &year, &month, &day, &hour, &minute, &second) != 6)
+		if (!rec.getInt(0, 2, prnSat)) RETURN_WITH_ERROR(string("Wrong PRN"), 3)
+		if (!(rec.getInt(3, 2, year) && rec.getInt(6, 2, month) && rec.getInt(9, 2, day)
+			&& rec.getInt(12, 2, hour) && rec.getInt(15, 2, minute) && rec.getDouble(17, 5, second)))
 			RETURN_WITH_ERROR(string("Wrong date-time"), 4)
 		if (year >= 80) year += 1900;
 		else year += 2000;
-		startPos1st = lineBuffer + 22;	//start position of SV clock data in the 1st line
-		startPosBO = lineBuffer + 3;	//start position of broadcat orbit data
+		pos1st = 22;	//start position of SV clock data in the 1st line
+		posBO = 3;		//start position of broadcat orbit data
 		break;
 	case V302:
-		if (sscanf(lineBuffer, "%1c%2d", &sysSat, &prnSat) != 2) RETURN_WITH_ERROR(string("Wrong system-PRN"), 3)
-		if (sscanf(lineBuffer+4, "%4d %2d %2d %2d %2d %2d", &year, &month, &day, &hour, &minute, &anInt) != 6)
+		sysSat = rec.at(0);
+		if (!rec.getInt(1, 2, prnSat)) RETURN_WITH_ERROR(string("Wrong system-PRN"), 3)
+		//seconds are I2.2 as per RINEX 3, but V3 files printed by previous versions of this tool have F4.1 seconds: accept both
+		pos1st = rec.at(23) == '.'? 25 : 23;	//start position of SV clock data in the 1st line
+		if (!(rec.getInt(4, 4, year) && rec.getInt(9, 2, month) && rec.getInt(12, 2, day)
+			&& rec.getInt(15, 2, hour) && rec.getInt(18, 2, minute) && rec.getDouble(21, pos1st - 21, second)))
 			RETURN_WITH_ERROR(string("Wrong date-time"), 4)
-		second = (double) anInt;
-		startPos1st = lineBuffer + 22;	//start position of SV clock data in the 1st line
-		startPosBO = lineBuffer + 4;	//start position of broadcat orbit data
+		posBO = 4;		//start position of broadcat orbit data
 		break;
 	default: RETURN_WITH_ERROR(string("Wrong input file version"), 9)
 	}
@@ -2029,8 +2440,11 @@ int RinexData::readNavEpoch(FILE* input) {
 	}
 	//read lines of broadcast orbit data in next lines
 	for (int i = 1; (i < nBroadcastOrbits) && (nEphemeris > 0); i++) {
-		if (readRinexRecord(lineBuffer, sizeof lineBuffer, input)) return 0;
-		startPos1st = startPosBO;
+		if (readRinexRecord(rec, input)) {
+			endEpochRead(input);
+			return 0;
+		}
+		pos1st = posBO;
 		for (int j = 0; (j < 4) && (nEphemeris > 0); j++) {
 			GET_BO(i, j)
 			nEphemeris--;
@@ -2045,17 +2459,103 @@ int RinexData::readNavEpoch(FILE* input) {
 			epochTimeTag = attag;
 		} else if(attag != epochTimeTag) {
 			retCode = 2;
-			msgPrfx += "New epoch.";
+			msgTxt += "New epoch.";
 		}
-		msgPrfx += "Stored.";
-		epochNav.push_back(SatNavData(attag, sysSat, prnSat, bo));
+		msgTxt += "Stored.";
+		pushNavData(attag, sysSat, prnSat, bo);
 	}
-	plog->fine(msgPrfx);
+	endEpochRead(input);
+	LOG_FINE(plog, EPOCH_MSG(msgTxt));
 	return retCode;
 #undef RETURN_WITH_ERROR
 #undef GET_BO
 }
 
+/**setPrintThread states if observation epochs shall be printed by a separate thread.
+ * When it is set, printObsEpoch hands epochs to a printing thread, allowing data of the next epochs to be acquired while
+ * former ones are being formatted and printed. Results are the same than when printing sequentially, but logging messages
+ * generated printing epochs are recorded later.
+ * <p>Before using the output stream for other purposes, endPrintThread shall be called to wait until all epochs have been printed.
+ *
+ * @param useThread true to print epochs by a separate thread, false to print them sequentially
+ * @throws error message string when an epoch handed to the printing thread could not be printed
+ */
+void RinexData::setPrintThread(bool useThread) {
+	printThreadSet = useThread;
+	if (!useThread) endPrintThread();
+}
+
+/**setReadThreads states the number of threads to be used for reading observation epochs with readObsEpoch.
+ * When more than one thread is stated, the input file is split in chunks of epochs which are parsed in parallel
+ * by the given number of threads, and readObsEpoch delivers in order their results.
+ * Parallel reading is only possible when the input file can be mapped into memory. Otherwise epochs are read sequentially.
+ * <p>Results are the same than when reading sequentially. In particular, when epochs with event flags 2 to 5 are found
+ * (they could change header data), or the input stream position is changed by the caller to a place not matching a parsed epoch,
+ * epochs are read sequentially from the input stream.
+ *
+ * @param nThreads the number of threads to use (1 or less means sequential reading)
+ */
+void RinexData::setReadThreads(int nThreads) {
+	endParallelRead();
+	readThreads = nThreads;
+}
+
+/**setEpochIndex states the epoch index file to be used for the observation file being read.
+ * The index file relates epoch time tags with their position in the input file, allowing to seek epochs by time using seekObsEpoch.
+ * It shall be called after reading the input file header, when the input stream is positioned at the first epoch.
+ * <p>If the index file exists and it matches the input file (same size, modification time and first epoch position), it is loaded.
+ * Otherwise, the index is built while epochs are read using readObsEpoch, and it is saved when the EOF is found, but only if
+ * epochs are in time order.
+ * <p>To keep the index small, only epochs separated at least INDEXSTEP seconds are indexed. To avoid seeking beyond
+ * special records which could change header data, epochs after the first event epoch (flags 2 to 5) are not indexed.
+ *
+ * @param input the already open stream where RINEX epochs will be read
+ * @param idxFileName the name of the epoch index file
+ * @return true if the index has been loaded: epochs can be seeked, and they are in time order, false otherwise
+ */
+bool RinexData::setEpochIndex(FILE* input, string idxFileName) {
+	epochIndex.clear();
+	indexName = idxFileName;
+	indexLoaded = indexBuilding = false;
+	if (!MappedFile::fileStamp(input, inFileSize, inFileTime) || ((inFirstEpoch = MappedFile::tell(input)) < 0)) {
+		plog->warning("Input file cannot be indexed");
+		return false;
+	}
+	if (loadEpochIndex()) {
+		plog->info("Epoch index loaded from " + indexName);
+		indexLoaded = true;
+		return true;
+	}
+	plog->info("Epoch index will be built in " + indexName);
+	epochIndex.clear();
+	indexBuilding = indexOrdered = true;
+	indexClosed = false;
+	indexLastTag = 0.0;
+	return false;
+}
+
+/**seekObsEpoch sets the input stream position at the last indexed epoch with time tag before or equal to the given one.
+ * Thus all epochs from the given time will be read by next calls to readObsEpoch.
+ * It needs an epoch index loaded using setEpochIndex.
+ *
+ * @param input the already open stream where RINEX epochs are being read
+ * @param timeTag the time tag of the epochs to be read (see getSecsGPSEphe)
+ * @return true if the input stream has been positioned, false otherwise (no index loaded or error seeking)
+ */
+bool RinexData::seekObsEpoch(FILE* input, double timeTag) {
+	if (!indexLoaded) return false;
+	size_t low = 0, high = epochIndex.size();
+	//binary search of the first entry after timeTag
+	while (low < high) {
+		size_t mid = (low + high) / 2;
+		if (epochIndex[mid].timeTag <= timeTag) low = mid + 1;
+		else high = mid;
+	}
+	long long pos = low == 0? inFirstEpoch : epochIndex[low - 1].offset;
+	LOG_FINE(plog, "Seek epoch at offset " + to_string(pos));
+	return MappedFile::seek(input, pos);
+}
+
 //Class private methods
 //=====================
 /**setDefValues sets default values to optional RINEX data members, generation parameters, and
@@ -2076,6 +2576,18 @@ void RinexData::setDefValues(RINEXversion v, Logger *p) {
 	epochWeek = 0;
 	epochTOW = epochTimeTag = epochClkOffset = 0.0;
 	epochFlag = 0;
+	//Input data
+	inFile = NULL;
+	inData = NULL;
+	inSize = 0;
+	inCursor = 0;
+	readThreads = 1;
+	printThreadSet = false;
+	prtThread = NULL;
+	parRead = NULL;
+	indexLoaded = indexBuilding = false;
+	//Header patching
+	setHeaderPatch(0);
 	//fill vector with label definitions. Order is relevant.
 	labelDef.push_back(LABELdata(VERSION,	"RINEX VERSION / TYPE",	VALL, OBSOBL + NAVOBL));
 	labelDef.push_back(LABELdata(RUNBY,		"PGM / RUN BY / DATE",	VALL, OBSOBL + NAVOBL));
@@ -2134,6 +2646,10 @@ void RinexData::setDefValues(RINEXversion v, Logger *p) {
 	obsNamEq.push_back(EQUIVobs("S2", "S2P"));
 	//by default, do not filter data
 	applyObsFilter = applyNavFilter = false;
+	navSorted = 0;
+	orbits.setEphemerisStore(&ephemerides);
+	applyElevMask = applySnrMask = stationWarned = false;
+	minElevMask = minSnrMask = 0.0;
 }
 
 /**fmtRINEXv2name format a standard RINEX V2.10 file name from the given prefix, GPS week and TOW, and for the given type.
@@ -2374,7 +2890,8 @@ size_t RinexData::getSysIndex(char sysId) {
  * For this reason, continuation lines could exits for the 1st epoch line having more than 12 satellites
  * and for the measurement lines having more than 5 measurements per satellite.
  *
- * @param input the already open print stream where RINEX epoch will be read
+ * @param input the already open print stream where RINEX epoch will be read, or NULL when the epoch is read by a parallel reading thread
+ *	from the input file image. In this case special records following event epochs are not read.
  * @return the status of the RINEX data read, which can can be:
  *		- (0)	EOF found. No epoch data stored.
  *		- (1)	Epoch observable data are well formatted. They have been stored. 
@@ -2387,31 +2904,35 @@ size_t RinexData::getSysIndex(char sysId) {
  *		- (8)	Error in event flag number
  */
 int RinexData::readV2ObsEpoch(FILE* input) {
-	char lineBuffer[100];
+	RINEXrecord rec;
 	int posPRN, nObs, posObs;
 	unsigned int sysInEpoch[64];
 	int prnInEpoch[64];
 	double valObs;
 	int lliObs, strgObs;
 	int i, j, k;
+	bool badObs = false;
 
 	//read epoch 1st line and extract data
-	if (readRinexRecord(lineBuffer, sizeof lineBuffer, input)) return 0;
-	string msgPrfx =  "Epoch [" + string(lineBuffer, 32) + "]";
+	if (readRinexRecord(rec, input)) return 0;
+	char epochTxt[32];	//the epoch line start, kept to compose log messages only when they are needed
+	rec.copy(0, sizeof epochTxt, epochTxt);
+	string msgTxt;
 	bool badEpoch = false;
-	if ((epochFlag = (int) (lineBuffer[28] - '0')) < 0) {
+	if ((epochFlag = (int) (rec.at(28) - '0')) < 0) {
 		badEpoch = true;
-		msgPrfx  += " Missed flag.";
+		msgTxt += " Missed flag.";
 		epochFlag = 999;	//a nonexisting flag
 	}
-	if (isBlank(lineBuffer + 29, 3)) {
+	if (!rec.getInt(29, 3, nSatsEpoch)) {
 		badEpoch = true;
-		msgPrfx += " Missed number of sats or special records.";
+		msgTxt += " Missed number of sats or special records.";
 		nSatsEpoch = 0;
-	} else nSatsEpoch = stoi(string(lineBuffer+29, 3));
+	}
 	int year = 0, month = 0, day = 0, hour = 0, minute = 0;
 	double second = 0.0;
-	bool wrongDate = sscanf(lineBuffer, " %2d %2d %2d %2d %2d%11lf", &year, &month, &day, &hour, &minute, &second) != 6 ;
+	bool wrongDate = !(rec.getInt(1, 2, year) && rec.getInt(4, 2, month) && rec.getInt(7, 2, day)
+		&& rec.getInt(10, 2, hour) && rec.getInt(13, 2, minute) && rec.getDouble(15, 11, second));
 	if (year >= 80) year += 1900;
 	else year += 2000;
 	if (!wrongDate) {	//translate date read to week + tow
@@ -2424,44 +2945,47 @@ int RinexData::readV2ObsEpoch(FILE* input) {
 	case 6:
 		if (wrongDate) {
 			badEpoch = true;
-			msgPrfx += " Wrong date.";
+			msgTxt += " Wrong date.";
 		}
 		if (nSatsEpoch > 64) {
 			badEpoch = true;
-			msgPrfx += " Wrong number of sats (>64).";
+			msgTxt += " Wrong number of sats (>64).";
+		}
+		if (rec.isBlank(68, 12)) epochClkOffset = 0.0;
+		else if (!rec.getDouble(68, 12, epochClkOffset)) {
+			badEpoch = true;
+			msgTxt += " Wrong clock offset.";
 		}
-		if (isBlank(lineBuffer + 68, 12)) epochClkOffset = 0.0;
-		else epochClkOffset = stod(string(lineBuffer + 68, 12));
 		//get satellites from epoch 1st line and eventual continuation lines (max 12 sat id in each one)
 		for (i=0; i<nSatsEpoch; i+=12) {
 			for(j=0, posPRN = 32; j<12 && i+j<nSatsEpoch; j++, posPRN += 3) {
 				try {
-					sysInEpoch[i+j] = getSysIndex(lineBuffer[posPRN]);
+					sysInEpoch[i+j] = getSysIndex(rec.at(posPRN));
 				}  catch (string error) {
 					badEpoch = true;
-					msgPrfx += error;
+					msgTxt += error;
 				}
-				if (sscanf(lineBuffer+posPRN+1, "%2d", &prnInEpoch[i+j]) !=1 ) {
+				if (!rec.getInt(posPRN+1, 2, prnInEpoch[i+j])) {
 					badEpoch = true;
-					msgPrfx += " Wrong PRN.";
+					msgTxt += " Wrong PRN.";
 				}
 			}
 			if (i+j < nSatsEpoch) {	//read continuation line
-				if (readRinexRecord(lineBuffer, sizeof lineBuffer, input)) {
-					msgPrfx += " EOF in epoch cont. line.";
+				if (readRinexRecord(rec, input)) {
+					msgTxt += " EOF in epoch cont. line.";
 				}
 			}
 		}
 		if (badEpoch) {
 			//if any error in epoch line record, try to skip observation data lines
-			for (i=0; i<nSatsEpoch; i++) readRinexRecord(lineBuffer, sizeof lineBuffer, input);
-			plog->warning(msgPrfx);
+			for (i=0; i<nSatsEpoch; i++) readRinexRecord(rec, input);
+			plog->warning(EPOCH_MSG(msgTxt));
 			return 4;
 		}
 		//read the observation records for each satellite in the epoch
 		for (i=0; i<nSatsEpoch; i++) {
-			if (readRinexRecord(lineBuffer, sizeof lineBuffer, input)) {
-				plog->warning(msgPrfx + "Unexpected EOF in obs. record");
+			if (readRinexRecord(rec, input)) {
+				plog->warning(EPOCH_MSG(msgTxt + "Unexpected EOF in obs. record"));
 				return 3;
 			}
 			nObs = systems[sysInEpoch[i]].obsType.size();
@@ -2469,35 +2993,46 @@ int RinexData::readV2ObsEpoch(FILE* input) {
 			//each record can have data for 5 observable types (or less). Continuation records are used when needed 
 			for (j=0; j<nObs; j+=5) {
 				for (k=0, posObs = 0; k<5 && j+k<nObs; k++, posObs += 16) {
-					if (isBlank(lineBuffer + posObs, 14)) {	//empty observable
-						epochObs.push_back(SatObsData(epochTimeTag, sysInEpoch[i], prnInEpoch[i], j+k, 0.0, 0, 0));
+					if (rec.isBlank(posObs, 14)) {	//empty observable
+						epochObs.push_back(epochTimeTag, sysInEpoch[i], prnInEpoch[i], j+k, 0.0, 0, 0);
+					} else if (!rec.getDouble(posObs, 14, valObs)) {	//wrong observable: stored as empty
+						badObs = true;
+						epochObs.push_back(epochTimeTag, sysInEpoch[i], prnInEpoch[i], j+k, 0.0, 0, 0);
 					} else {
-						valObs = stod(string(lineBuffer+posObs, 14));
-						if (lineBuffer[posObs+14] == ' ') lliObs = 0;
-						else lliObs = (int) (lineBuffer[posObs+14] - '0');
-						if (lineBuffer[posObs+15] == ' ') strgObs = 0;
-						else strgObs = (int) (lineBuffer[posObs+15] - '0');
-						epochObs.push_back(SatObsData(epochTimeTag, sysInEpoch[i], prnInEpoch[i], j+k, valObs, lliObs, strgObs ));
+						if (rec.at(posObs+14) == ' ') lliObs = 0;
+						else lliObs = (int) (rec.at(posObs+14) - '0');
+						if (rec.at(posObs+15) == ' ') strgObs = 0;
+						else strgObs = (int) (rec.at(posObs+15) - '0');
+						epochObs.push_back(epochTimeTag, sysInEpoch[i], prnInEpoch[i], j+k, valObs, lliObs, strgObs );
 					}
 				}
 				if (j+k < nObs) {
-					if (readRinexRecord(lineBuffer, sizeof lineBuffer, input)) {
-						plog->warning(msgPrfx + "EOF in obs. cont. record");
+					if (readRinexRecord(rec, input)) {
+						plog->warning(EPOCH_MSG(msgTxt + "EOF in obs. cont. record"));
 						return 3;
 					}
 				}
 			}
 		}
-		plog->fine(msgPrfx);
+		if (badObs) {
+			plog->warning(EPOCH_MSG(msgTxt + " Wrong observable values."));
+			return 3;
+		}
+		LOG_FINE(plog, EPOCH_MSG(msgTxt));
 		return 1;
 	case 2:
 	case 3:
 	case 4:
 	case 5:
-		plog->fine(msgPrfx);
-		return readObsEpochEvent(input, wrongDate);
+		if (input == NULL) return 2;	//parallel reading: the event shall be read again from the input stream
+		LOG_FINE(plog, EPOCH_MSG(msgTxt));
+		//special records following the event are read from the input stream
+		endEpochRead(input);
+		i = readObsEpochEvent(input, wrongDate);
+		beginEpochRead(input);
+		return i;
 	default:
-		plog->warning(msgPrfx + " Wrong flag.");
+		plog->warning(EPOCH_MSG(msgTxt + " Wrong flag."));
 		return 8;
 	}
 }
@@ -2505,7 +3040,8 @@ int RinexData::readV2ObsEpoch(FILE* input) {
 /**readV3ObsEpoch reads from the RINEX version 3.0 observation file an epoch data
  * Note that observation records in RINEX V3.01 do not have a size limit.
  *
- * @param input the already open print stream where RINEX epoch will be read
+ * @param input the already open print stream where RINEX epoch will be read, or NULL when the epoch is read by a parallel reading thread
+ *	from the input file image. In this case special records following event epochs are not read.
  * @return status of observable or event data read according to:
  *		- (0)	EOF found, no epoch or event data available
  *		- (1)	Epoch flag was 0. Observation data read and stored
@@ -2518,35 +3054,38 @@ int RinexData::readV2ObsEpoch(FILE* input) {
  * @throws error string with message describing any error detected in data format
  */
 int RinexData::readV3ObsEpoch(FILE* input) {
-	char lineBuffer[1300]; //enough big to allocate 3 + 2 + 19 x 4 measurements x 16 chars= 1221
+	RINEXrecord rec;
 	int nObs, posObs;
 	int sysSat;
 	int prnSat;
 	double valObs;
 	int lliObs, strgObs;
 	int i, j;
-	string msgPrfx, aStr;
+	bool badObs = false;
+	char epochTxt[35];	//the epoch line start, kept to compose log messages only when they are needed
+	string msgTxt, aStr;
 	//read epoch 1st line and extract data
 	for (;;) {	//synchronize start of epoch
-		if (readRinexRecord(lineBuffer, sizeof lineBuffer, input)) return 0;
-		msgPrfx =  "Epoch [" + string(lineBuffer, 35) + "]";
-		if (lineBuffer[0] == '>') break;
-		plog->warning(msgPrfx + " Start of epoch not found. Line skip");
+		if (readRinexRecord(rec, input)) return 0;
+		rec.copy(0, sizeof epochTxt, epochTxt);
+		if (rec.at(0) == '>') break;
+		plog->warning(EPOCH_MSG(msgTxt + " Start of epoch not found. Line skip"));
 	}
 	bool badEpoch = false;
-	if ((epochFlag = (int) (lineBuffer[31] - '0')) < 0) {
+	if ((epochFlag = (int) (rec.at(31) - '0')) < 0) {
 		badEpoch = true;
-		msgPrfx  += " Missed flag.";
+		msgTxt += " Missed flag.";
 		epochFlag = 999;	//a nonexisting flag
 	}
-	if (isBlank(lineBuffer + 32, 3)) {
+	if (!rec.getInt(32, 3, nSatsEpoch)) {
 		badEpoch = true;
-		msgPrfx += " Missed number of sats or special records.";
+		msgTxt += " Missed number of sats or special records.";
 		nSatsEpoch = 0;
-	} else nSatsEpoch = stoi(string(lineBuffer + 32, 3));
+	}
 	int year = 0, month = 0, day = 0, hour = 0, minute = 0;
 	double second = 0.0;
-	bool wrongDate = sscanf(lineBuffer+2, "%4d %2d %2d %2d %2d%11lf", &year, &month, &day, &hour, &minute, &second) != 6 ;
+	bool wrongDate = !(rec.getInt(2, 4, year) && rec.getInt(7, 2, month) && rec.getInt(10, 2, day)
+		&& rec.getInt(13, 2, hour) && rec.getInt(16, 2, minute) && rec.getDouble(18, 11, second));
 	if (!wrongDate) {	//translate date read to week + tow
 		setWeekTow (year, month, day, hour, minute, second, epochWeek, epochTOW);
 		epochTimeTag = getSecsGPSEphe(epochWeek, epochTOW);
@@ -2557,61 +3096,76 @@ int RinexData::readV3ObsEpoch(FILE* input) {
 	case 6:
 		if (wrongDate) {
 			badEpoch = true;
-			msgPrfx += " Wrong date.";
+			msgTxt += " Wrong date.";
 		}
 		if (badEpoch) {
-			plog->warning(msgPrfx);
+			plog->warning(EPOCH_MSG(msgTxt));
+			return 4;
+		}
+		if (rec.isBlank(41, 15)) epochClkOffset = 0.0;
+		else if (!rec.getDouble(41, 15, epochClkOffset)) {
+			plog->warning(EPOCH_MSG(msgTxt + " Wrong clock offset."));
 			return 4;
 		}
-		if (isBlank(lineBuffer + 41, 15)) epochClkOffset = 0.0;
-		else epochClkOffset = stod(string(lineBuffer + 41, 15));
 		//get the observation record for each satellite and extract data
 		for (i = 0; i < nSatsEpoch; i++) {
-			if (readRinexRecord(lineBuffer, sizeof lineBuffer, input)) {
-				plog->warning(msgPrfx + "EOF in obs. record");
+			if (readRinexRecord(rec, input)) {
+				plog->warning(EPOCH_MSG(msgTxt + "EOF in obs. record"));
 				return 3;
 			}
 			try {
-				sysSat = getSysIndex(lineBuffer[0]);
-				if (sscanf(lineBuffer+1, "%2d", &prnSat) == 1) {
+				sysSat = getSysIndex(rec.at(0));
+				if (rec.getInt(1, 2, prnSat)) {
 					//for each observable type in the system of this satellite
 					nObs = systems[sysSat].obsType.size();
 					for (j = 0, posObs = 3; j < nObs; j++, posObs += 16) {
-						if (isBlank(lineBuffer + posObs, 14)) {
+						if (rec.isBlank(posObs, 14)) {
 							//empty observable: values are considered 0
-							epochObs.push_back(SatObsData(epochTimeTag, sysSat, prnSat, j, 0.0, 0, 0));
+							epochObs.push_back(epochTimeTag, sysSat, prnSat, j, 0.0, 0, 0);
+						} else if (!rec.getDouble(posObs, 14, valObs)) {
+							//wrong observable: stored as empty
+							badObs = true;
+							epochObs.push_back(epochTimeTag, sysSat, prnSat, j, 0.0, 0, 0);
 						} else {
-							valObs = stod(string(lineBuffer+posObs, 14));
-							if (lineBuffer[posObs+14] == ' ') lliObs = 0;
-							else lliObs = stoi(string(lineBuffer+posObs+14, 1));
-							if (lineBuffer[posObs+15] == ' ') strgObs = 0;
-							else strgObs = stoi(string(lineBuffer+posObs+15, 1));
-							epochObs.push_back(SatObsData(epochTimeTag, sysSat, prnSat, j,  valObs, lliObs, strgObs));
+							if (rec.at(posObs+14) == ' ') lliObs = 0;
+							else lliObs = (int) (rec.at(posObs+14) - '0');
+							if (rec.at(posObs+15) == ' ') strgObs = 0;
+							else strgObs = (int) (rec.at(posObs+15) - '0');
+							epochObs.push_back(epochTimeTag, sysSat, prnSat, j,  valObs, lliObs, strgObs);
 						}
 					}
 				} else {
 					badEpoch = true;
-					msgPrfx += " Wrong PRN";
+					msgTxt += " Wrong PRN";
 				}
 			}  catch (string error) {
 				badEpoch = true;
-				msgPrfx += error;
+				msgTxt += error;
 			}
 		}
+		if (badObs) {
+			badEpoch = true;
+			msgTxt += " Wrong observable values.";
+		}
 		if (badEpoch) {
-			plog->warning(msgPrfx);
+			plog->warning(EPOCH_MSG(msgTxt));
 			return 3;
 		}
-		plog->fine(msgPrfx);
+		LOG_FINE(plog, EPOCH_MSG(msgTxt));
 		return 1;
 	case 2:
 	case 3:
 	case 4:
 	case 5:
-		plog->fine(msgPrfx);
-		return readObsEpochEvent(input, wrongDate);
+		if (input == NULL) return 2;	//parallel reading: the event shall be read again from the input stream
+		LOG_FINE(plog, EPOCH_MSG(msgTxt));
+		//special records following the event are read from the input stream
+		endEpochRead(input);
+		i = readObsEpochEvent(input, wrongDate);
+		beginEpochRead(input);
+		return i;
 	default:
-		plog->warning(msgPrfx + " Wrong flag.");
+		plog->warning(EPOCH_MSG(msgTxt + " Wrong flag."));
 		return 8;
 	}
 }
@@ -2939,52 +3493,126 @@ void RinexData::printHdLineData(FILE* out, vector<LABELdata>::iterator lbIter) {
 	#undef PRINT_SYSREC
 }
 
-/**printSatObsValues prints a line with observable values of the firts satellite in "epochObs".
+/**addObsStats accumulates the statistics of the epoch being printed used to patch header records (see setHeaderPatch):
+ * its time, the interval from the previous one (rounded to milliseconds), and the number of observables of each type for each satellite.
+ * Observables with zero or out of range values, printed as empty ones, are not counted.
+ *<p>Observables shall be sorted by system, satellite and observable type, as they are when printed.
+ */
+void RinexData::addObsStats() {
+	size_t i;
+	double secs = (epochWeek - obsStats.lastWeek) * 604800.0 + epochTOW - obsStats.lastTOW;
+	if ((obsStats.epochs > 0) && (secs > 0.0)) obsStats.intervals[(long long) floor(secs * 1000.0 + 0.5)]++;
+	obsStats.epochs++;
+	obsStats.lastWeek = epochWeek;
+	obsStats.lastTOW = epochTOW;
+	vector<int>* counts = NULL;
+	for (i = 0; i < epochObs.size(); i++) {
+		if ((i == 0) || (epochObs.satKey[i] != epochObs.satKey[i-1])) {
+			counts = &obsStats.obsCount[epochObs.satKey[i]];
+			if (counts->empty())
+				counts->resize(version == V210? v2ObsLst.size() : systems[EpochObsData::sysIndexOf(epochObs.satKey[i])].obsType.size(), 0);
+		} else if (epochObs.obsTypeIndex[i] == epochObs.obsTypeIndex[i-1]) continue;	//duplicated observables are printed once
+		if ((epochObs.obsValue[i] != 0.0) && (epochObs.obsValue[i] <= MAXOBSVAL) && (epochObs.obsValue[i] >= MINOBSVAL)
+			&& (epochObs.obsTypeIndex[i] < counts->size())) (*counts)[epochObs.obsTypeIndex[i]]++;
+	}
+}
+
+/**reserveHdLines reserves in the output file the lines for a header record to be patched by patchObsHeader.
+ *<p>One line is reserved for INTERVAL, TIME OF LAST OBS and # OF SATELLITES records, where the current record data are printed
+ * if they exist, or an empty comment otherwise. For PRN / # OF OBS records, empty comment lines are printed for the maximum
+ * number of satellites stated in setHeaderPatch, with the lines needed for the observable types to be printed.
+ *
+ * @param out the already open print stream where RINEX header is being printed
+ * @param lbIter the iterator in labelDef of the record to reserve lines for
+ */
+void RinexData::reserveHdLines(FILE* out, vector<LABELdata>::iterator lbIter) {
+	size_t i, j, nTypes;
+	int lines = 1;
+	long position = ftell(out);
+	if (position < 0) {
+		plog->warning(valueLabel(lbIter->labelID, "cannot be patched, output file cannot be positioned"));
+		if (lbIter->hasData) printHdLineData(out, lbIter);
+		return;
+	}
+	if (lbIter->labelID == PRNOBS) {
+		//compute the maximum number of observable types to be printed for a satellite
+		if (version == V210) nTypes = v2ObsLst.size();
+		else {
+			nTypes = 0;
+			for (i = 0; i < systems.size(); i++) {
+				if (applyObsFilter) {
+					if (!systems[i].selSystem) continue;
+					for (j = 0, lines = 0; j < systems[i].selObsType.size(); j++) if (systems[i].selObsType[j]) lines++;
+					if ((size_t) lines > nTypes) nTypes = lines;
+				} else if (systems[i].obsType.size() > nTypes) nTypes = systems[i].obsType.size();
+			}
+		}
+		lines = patchMaxSats * (int) ((nTypes + 8) / 9);
+		printHdComments(out, lines);
+	} else if (lbIter->hasData) printHdLineData(out, lbIter);
+	else printHdComments(out, lines);
+	hdPatches.push_back(HDpatch(lbIter->labelID, position, lines));
+}
+
+/**printHdComments prints empty COMMENT header lines, used to fill the lines reserved for records to be patched.
+ *
+ * @param out the already open print stream where RINEX header lines will be printed
+ * @param n the number of lines to print
+ */
+void RinexData::printHdComments(FILE* out, int n) {
+	for (int i = 0; i < n; i++) fprintf(out, "%60c%-20.20s\n", ' ', valueLabel(COMM).c_str());
+}
+
+/**formatSatObsValues appends to the epoch text buffer a line with observable values of the satellite in the given position of "epochObs".
  * If the number of observables to print is greather than the maximum number of observable values to be printed
  * in one line, one or several continuation lines would be necessary.
- * After printing observation data of this first satellite, they are removed from the storage.
+ * Observation data are not removed from the storage: the caller shall clear it after formatting all satellites.
  * It is assumed that values in the observables storage  belong to the same epoch and are be sorted by system,
  * satellite PRN and observable type.
  *
- * @param out the already open print stream where RINEX epoch data will be printed
+ * @param first the position in epochObs of the first observable of the satellite to format
  * @param maxPerLine the maximum number of observable values to be printed in one line
- * @return true if they remain observables belonging to the current epoch, false when no data remains to print.
+ * @return the position in epochObs of the first observable of the next satellite, or epochObs.size() when no data remains to print.
  */
-bool RinexData::printSatObsValues(FILE* out, int maxPerLine) {
+size_t RinexData::formatSatObsValues(size_t first, int maxPerLine) {
+	char numBuffer[80];
 	double valueToPrint;
-	if (epochObs.empty()) return false;
-	//satellite data to print are those of the firts satellite in epochObs
-	int sysToPrint = epochObs[0].sysIndex;
-	int satToPrint = epochObs[0].satellite;
+	size_t i = first;
+	if (i >= epochObs.size()) return i;
+	//satellite data to print are those of the satellite in the given position
+	unsigned int satKeyToPrint = epochObs.satKey[i];
+	int sysToPrint = EpochObsData::sysIndexOf(satKeyToPrint);
+	int satToPrint = EpochObsData::satelliteOf(satKeyToPrint);
 	int obsToPrint = 0;
-	while (!epochObs.empty() && (epochObs[0].sysIndex == sysToPrint) && (epochObs[0].satellite == satToPrint)) {
-		if (epochObs[0].obsTypeIndex < obsToPrint) {
-			plog->warning("Epoch " + to_string((long double) epochObs[0].obsTimeTag)
+	while ((i < epochObs.size()) && (epochObs.satKey[i] == satKeyToPrint)) {
+		if (epochObs.obsTypeIndex[i] < obsToPrint) {
+			plog->warning("Epoch " + to_string((long double) epochObs.obsTimeTag)
 						+ " sat=" + string(1,systems[sysToPrint].system) + to_string((long long) satToPrint)
-						+ " obs=" + string(systems[sysToPrint].obsType[epochObs[0].obsTypeIndex])
+						+ " obs=" + string(systems[sysToPrint].obsType[epochObs.obsTypeIndex[i]])
 						+ " Ignored observable already printed");
-			epochObs.erase(epochObs.begin());
-		} else if (epochObs[0].obsTypeIndex == obsToPrint) {
+			i++;
+		} else if (epochObs.obsTypeIndex[i] == obsToPrint) {
 			//there are data for this type of observable
-			valueToPrint = epochObs[0].obsValue;
+			valueToPrint = epochObs.obsValue[i];
 			//discard measurements out of range used in the RINEX format 14.3f
 			if ((valueToPrint > MAXOBSVAL) || (valueToPrint < MINOBSVAL)) valueToPrint = 0.0;
-			fprintf(out, "%14.3lf", valueToPrint);
-			if (epochObs[0].lossOfLock == 0) fprintf(out, " ");
-			else fprintf(out, "%1d", epochObs[0].lossOfLock);
-			if (epochObs[0].strength == 0) fprintf(out, " ");
-			else fprintf(out, "%1d", epochObs[0].strength);
-			epochObs.erase(epochObs.begin());	//remove printed data
+			epochText.append(numBuffer, formatFixed(numBuffer, sizeof numBuffer, 14, 3, valueToPrint));
+			if (epochObs.lossOfLock[i] == 0) epochText += ' ';
+			else epochText.append(numBuffer, formatInt(numBuffer, 1, epochObs.lossOfLock[i]));
+			if (epochObs.strength[i] == 0) epochText += ' ';
+			else epochText.append(numBuffer, formatInt(numBuffer, 1, epochObs.strength[i]));
+			i++;
 			obsToPrint++;
 		} else {
 			//there are no data for this type of observable
-			fprintf(out, "%14.3lf  ", (double) 0.0);
+			epochText.append(numBuffer, formatFixed(numBuffer, sizeof numBuffer, 14, 3, 0.0));
+			epochText.append(2, ' ');
 			obsToPrint++;
 		}
-		if ((obsToPrint % maxPerLine) == 0) fprintf(out, "\n");
+		if ((obsToPrint % maxPerLine) == 0) epochText += '\n';
 	}
-	if ((obsToPrint % maxPerLine) != 0) fprintf(out, "\n");
-	return !epochObs.empty();
+	if ((obsToPrint % maxPerLine) != 0) epochText += '\n';
+	return i;
 }
 
 /**readHdLineData reads a line from input RINEX file identifying the header line type, extracting data contained and storing them into the class members.
@@ -3081,81 +3709,81 @@ RinexData::RINEXlabel RinexData::readHdLineData (FILE* input) {
 			plog->warning(valueLabel(VERSION, "Cannot cope with this input file version. TBD assumed"));
 			inFileVer = VTBD;
 		}
-		plog->finer(valueLabel(VERSION, to_string((long double) aDouble)) + string(" / ") + string(1,fileType) + string(" / ") + string(1,systemId));
+		LOG_FINER(plog, valueLabel(VERSION, to_string((long double) aDouble)) + string(" / ") + string(1,fileType) + string(" / ") + string(1,systemId));
 		break;
 	case RUNBY:		//"PGM / RUN BY / DATE"
 		pgm = string(lineBuffer, 20);
 		runby = string(lineBuffer + 20, 20);
 		date = string(lineBuffer + 40, 20);
-		plog->finer(valueLabel(RUNBY, pgm + "/" + runby));
+		LOG_FINER(plog, valueLabel(RUNBY, pgm + "/" + runby));
 		break;
 	case COMM:		//"COMMENT"
 		//the comment read is inserted as a new label (header record) after the lastRecordSet (last record read)
 		//it is used the LABELdata constructor for COMM records
 		lastRecordSet = labelDef.insert(lastRecordSet + 1, LABELdata(string(lineBuffer, 60)));
-		plog->finer(valueLabel(COMM, string(lineBuffer, 60)));
+		LOG_FINER(plog, valueLabel(COMM, string(lineBuffer, 60)));
 		return COMM;
 	case MRKNAME:	//"MARKER NAME"
 		markerName = string(lineBuffer, 60);
-		plog->finer(valueLabel(MRKNAME, markerName)); 
+		LOG_FINER(plog, valueLabel(MRKNAME, markerName));
 		break;
 	case MRKNUMBER:	//"MARKER N"
 		markerNumber = string(lineBuffer, 20);
-		plog->finer(valueLabel(MRKNUMBER, markerNumber)); 
+		LOG_FINER(plog, valueLabel(MRKNUMBER, markerNumber));
 		break;
 	case MRKTYPE:	//"MARKER TYPE"
 		markerType = string(lineBuffer, 20);
-		plog->finer(valueLabel(MRKTYPE, markerType)); 
+		LOG_FINER(plog, valueLabel(MRKTYPE, markerType));
 		break;
 	case AGENCY:	//"OBSERVER / AGENCY"
 		observer = string(lineBuffer, 20);
 		agency = string(lineBuffer + 20, 40);
-		plog->finer(valueLabel(AGENCY, observer + "/" + agency));
+		LOG_FINER(plog, valueLabel(AGENCY, observer + "/" + agency));
 		break;
 	case RECEIVER:	//"REC # / TYPE / VERS
 		rxNumber = string(lineBuffer, 20);
 		rxType = string(lineBuffer + 20, 20);
 		rxVersion = string(lineBuffer + 40, 20);
-		plog->finer(valueLabel(RECEIVER, rxNumber + "/" + rxType + "/" + rxVersion));
+		LOG_FINER(plog, valueLabel(RECEIVER, rxNumber + "/" + rxType + "/" + rxVersion));
 		break;
 	case ANTTYPE:	//"ANT # / TYPE"
 		antNumber = string(lineBuffer, 20);
 		antType = string(lineBuffer + 20, 20);
-		plog->finer(valueLabel(ANTTYPE, antNumber + "/" + antType));
+		LOG_FINER(plog, valueLabel(ANTTYPE, antNumber + "/" + antType));
 		break;
 	case APPXYZ:	//"APPROX POSITION XYZ"
 		if(sscanf(lineBuffer, "%14lf%14lf%14lf", &aproxX, &aproxY, &aproxZ) != 3) RETURN_WITH_ERROR(string())
-		plog->finer(valueLabel(APPXYZ, to_string((long double) aproxX) + "/" + to_string((long double) aproxY) + "/" + to_string((long double) aproxZ)));
+		LOG_FINER(plog, valueLabel(APPXYZ, to_string((long double) aproxX) + "/" + to_string((long double) aproxY) + "/" + to_string((long double) aproxZ)));
 		break;
 	case ANTHEN:		//"ANTENNA: DELTA H/E/N"
 		if(sscanf(lineBuffer, "%14lf%14lf%14lf", &antHigh, &eccEast, &eccNorth) != 3) RETURN_WITH_ERROR(string())
-		plog->finer(valueLabel(ANTHEN, to_string((long double) antHigh) + "/" + to_string((long double) eccEast) + "/" + to_string((long double) eccNorth)));
+		LOG_FINER(plog, valueLabel(ANTHEN, to_string((long double) antHigh) + "/" + to_string((long double) eccEast) + "/" + to_string((long double) eccNorth)));
 		break;
 	case ANTXYZ:		//"ANTENNA: DELTA X/Y/Z"	V300
 		if(sscanf(lineBuffer, "%14lf%14lf%14lf", &antX, &antY, &antZ) != 3) RETURN_WITH_ERROR(string())
-		plog->finer(valueLabel(ANTXYZ, to_string((long double) antX) + "/" + to_string((long double) antY) + "/" + to_string((long double) antZ)));
+		LOG_FINER(plog, valueLabel(ANTXYZ, to_string((long double) antX) + "/" + to_string((long double) antY) + "/" + to_string((long double) antZ)));
 		break;
 	case ANTPHC:		//"ANTENNA: PHASECENTE"		V300
 		antPhSys = lineBuffer[0];
 		antPhCode = string(lineBuffer+2, 3);
 		if(sscanf(lineBuffer+5, "%9lf%14lf%14lf", &antPhNoX, &antPhEoY, &antPhUoZ) != 3) RETURN_WITH_ERROR(string())
-		plog->finer(valueLabel(ANTPHC, string(&antPhSys, 1) + "/" + antPhCode + "/" + to_string((long double) antPhNoX) + "/" + to_string((long double) antPhEoY) + "/" + to_string((long double) antPhUoZ)));
+		LOG_FINER(plog, valueLabel(ANTPHC, string(&antPhSys, 1) + "/" + antPhCode + "/" + to_string((long double) antPhNoX) + "/" + to_string((long double) antPhEoY) + "/" + to_string((long double) antPhUoZ)));
 		break;
 	case ANTBS:			//"ANTENNA: B.SIGHT XYZ"	V300
 		if(sscanf(lineBuffer, "%14lf%14lf%14lf", &antBoreX, &antBoreY, &antBoreZ) != 3) RETURN_WITH_ERROR(string())
-		plog->finer(valueLabel(ANTBS, to_string((long double) antBoreX) + "/" + to_string((long double) antBoreY) + "/" + to_string((long double) antBoreZ)));
+		LOG_FINER(plog, valueLabel(ANTBS, to_string((long double) antBoreX) + "/" + to_string((long double) antBoreY) + "/" + to_string((long double) antBoreZ)));
 		break;
 	case ANTZDAZI:		//"ANTENNA: ZERODIR AZI"	V300
 		if(sscanf(lineBuffer, "%14lf", &antZdAzi) != 1) RETURN_WITH_ERROR(string())
-		plog->finer(valueLabel(ANTZDAZI, to_string((long double) antZdAzi)));
+		LOG_FINER(plog, valueLabel(ANTZDAZI, to_string((long double) antZdAzi)));
 		break;
 	case ANTZDXYZ:		//"ANTENNA: ZERODIR XYZ"	V300
 		if(sscanf(lineBuffer, "%14lf%14lf%14lf", &antZdX, &antZdY, &antZdZ) !=3) RETURN_WITH_ERROR(string())
-		plog->finer(valueLabel(ANTZDXYZ, to_string((long double) antZdX) + "/" + to_string((long double) antZdY) + "/" + to_string((long double) antZdZ)));
+		LOG_FINER(plog, valueLabel(ANTZDXYZ, to_string((long double) antZdX) + "/" + to_string((long double) antZdY) + "/" + to_string((long double) antZdZ)));
 		break;
 	case COFM :			//"CENTER OF MASS XYZ"		V300
 		if(sscanf(lineBuffer, "%14lf%14lf%14lf", &centerX, &centerY, &centerZ) !=3) RETURN_WITH_ERROR(string())
-		plog->finer(valueLabel(COFM) + to_string((long double) centerX) + "/" + to_string((long double) centerY) + "/" + to_string((long double) centerZ));
+		LOG_FINER(plog, valueLabel(COFM) + to_string((long double) centerX) + "/" + to_string((long double) centerY) + "/" + to_string((long double) centerZ));
 		break;
 	case WVLEN:			//"WAVELENGTH FACT L1/2"	V210
 		if(sscanf(lineBuffer, "%6d%6d", &wf.wvlenFactorL1, &wf.wvlenFactorL2) != 2) RETURN_WITH_ERROR(string())
@@ -3170,7 +3798,7 @@ RinexData::RINEXlabel RinexData::readHdLineData (FILE* input) {
 				wf.satNums.push_back(string(lineBuffer+n+3, 3));
 		}
 		wvlenFactor.push_back(wf);
-		plog->finer(valueLabel(WVLEN, to_string((long long) wf.wvlenFactorL1) + "/" + to_string((long long) wf.wvlenFactorL2) + ":" + to_string((long long) wf.nSats)));
+		LOG_FINER(plog, valueLabel(WVLEN, to_string((long long) wf.wvlenFactorL1) + "/" + to_string((long long) wf.wvlenFactorL2) + ":" + to_string((long long) wf.nSats)));
 		break;
 	case TOBS:		//"# / TYPES OF OBSERV"		V210
 		if((sscanf(lineBuffer, "%6d", &k) == 0) || (k == 0)) RETURN_WITH_ERROR(string())
@@ -3196,7 +3824,7 @@ RinexData::RINEXlabel RinexData::readHdLineData (FILE* input) {
 			systems.push_back(GNSSsystem('S', obsTypes));
 		}
 		else systems.push_back(GNSSsystem(systemId, obsTypes));
-		plog->finer(valueLabel(TOBS, to_string((long long) k) + " types"));
+		LOG_FINER(plog, valueLabel(TOBS, to_string((long long) k) + " types"));
 		break;
 	case SYS :		//"SYS / # / OBS TYPES"		V300
 		if (lineBuffer[0] == ' ') RETURN_WITH_ERROR(msgSysUnk)
@@ -3213,42 +3841,42 @@ RinexData::RINEXlabel RinexData::readHdLineData (FILE* input) {
 		if (k != obsTypes.size()) plog->warning(valueLabel(SYS, "Mismatch in number of expected and existing code types"));
 		//store data on observable types
 		systems.push_back(GNSSsystem(lineBuffer[0], obsTypes));
-		plog->finer(valueLabel(SYS, to_string((long long) k) + " types"));
+		LOG_FINER(plog, valueLabel(SYS, to_string((long long) k) + " types"));
 		break;
 	case SIGU :		//"SIGNAL STRENGTH UNIT"
 		signalUnit = string(lineBuffer, 20);
-		plog->finer(valueLabel(SIGU, signalUnit));
+		LOG_FINER(plog, valueLabel(SIGU, signalUnit));
 		break;
 	case INT :		//"INTERVAL"
 		if(sscanf(lineBuffer, "%10lf", &obsInterval) != 1) RETURN_WITH_ERROR(string())
-		plog->finer(valueLabel(INT, to_string((long double) obsInterval)));
+		LOG_FINER(plog, valueLabel(INT, to_string((long double) obsInterval)));
 		break;
 	case TOFO :		//"TIME OF FIRST OBS"
 		if(sscanf(lineBuffer, "%6d%6d%6d%6d%6d%13lf", &year, &month, &day, &hour, &minute, &second) != 6) RETURN_WITH_ERROR(string())
 		//use date to obtain first observable time
 		setWeekTow (year, month, day, hour, minute, second, firstObsWeek, firstObsTOW);
 		obsTimeSys = string(lineBuffer + 48, 3);
-		plog->finer(valueLabel(TOFO, to_string((long long) firstObsWeek) + "/" + to_string((long double) firstObsTOW)));
+		LOG_FINER(plog, valueLabel(TOFO, to_string((long long) firstObsWeek) + "/" + to_string((long double) firstObsTOW)));
 		break;
 	case TOLO :		//"TIME OF LAST OBS"
 		if(sscanf(lineBuffer, "%6d%6d%6d%6d%6d%13lf", &year, &month, &day, &hour, &minute, &second) != 6) RETURN_WITH_ERROR(string())
 		//use date to obtain last obsrvation time. Time system ignored: same system as per TOFO assumed.
 		setWeekTow (year, month, day, hour, minute, second, lastObsWeek, lastObsTOW);
-		plog->finer(valueLabel(TOLO, to_string((long long) lastObsWeek) + "/" + to_string((long double) lastObsTOW)));
+		LOG_FINER(plog, valueLabel(TOLO, to_string((long long) lastObsWeek) + "/" + to_string((long double) lastObsTOW)));
 		break;
 	case CLKOFFS :	//"RCV CLOCK OFFS APPL"
 		if(sscanf(lineBuffer, "%6d", &rcvClkOffs) != 1) RETURN_WITH_ERROR(string())
-		plog->finer(valueLabel(CLKOFFS, to_string((long long) rcvClkOffs)));
+		LOG_FINER(plog, valueLabel(CLKOFFS, to_string((long long) rcvClkOffs)));
 		break;
 	case DCBS :		//"SYS / DCBS APPLIED"
 		if ((n = sysInx(lineBuffer[0])) < 0) RETURN_WITH_ERROR(msgSysUnk)
 		dcbsApp.push_back(DCBSPCVSapp(n, string(lineBuffer + 1, 17), string(lineBuffer + 20, 40)));
-		plog->finer(valueLabel(DCBS, string(" for sys ") + string(1, lineBuffer[0])));
+		LOG_FINER(plog, valueLabel(DCBS, string(" for sys ") + string(1, lineBuffer[0])));
 		break;
 	case PCVS :		//"SYS / PCVS APPLIED"
 		if ((n = sysInx(lineBuffer[0])) < 0) RETURN_WITH_ERROR(msgSysUnk)
 		pcvsApp.push_back(DCBSPCVSapp(n, string(lineBuffer + 1, 17), string(lineBuffer + 20, 40)));
-		plog->finer(valueLabel(DCBS, string(" for sys ") + string(1, lineBuffer[0])));
+		LOG_FINER(plog, valueLabel(DCBS, string(" for sys ") + string(1, lineBuffer[0])));
 		break;
 	case SCALE :	//"SYS / SCALE FACTOR"
 		if ((i = sysInx(lineBuffer[0])) < 0) RETURN_WITH_ERROR(msgSysUnk)
@@ -3268,7 +3896,7 @@ RinexData::RINEXlabel RinexData::readHdLineData (FILE* input) {
 		if (j != obsTypes.size()) plog->warning(valueLabel(SCALE, "Mismatch in number of expected and existing code types"));
 		//store data on observable types
 		obsScaleFact.push_back(OSCALEfact(i, k, obsTypes));
-		plog->finer(valueLabel(SCALE, to_string((long long) k) + " scale for " + to_string((long long) j) + " types"));
+		LOG_FINER(plog, valueLabel(SCALE, to_string((long long) k) + " scale for " + to_string((long long) j) + " types"));
 		break;
 	case PHSH :		//"SYS / PHASE SHIFTS"
 		if ((i = sysInx(lineBuffer[0])) < 0) RETURN_WITH_ERROR(msgSysUnk)
@@ -3288,7 +3916,7 @@ RinexData::RINEXlabel RinexData::readHdLineData (FILE* input) {
 		if (j != obsTypes.size()) plog->warning(valueLabel(SCALE, "Mismatch in number of expected and existing code types"));
 		//store data on observable types
 		phshCorrection.push_back(PHSHcorr(i, string(lineBuffer+2, 3), aDouble, obsTypes));
-		plog->finer(valueLabel(PHSH, to_string((long double) aDouble) + " phase shift for " + to_string((long long) j) + " types"));
+		LOG_FINER(plog, valueLabel(PHSH, to_string((long double) aDouble) + " phase shift for " + to_string((long long) j) + " types"));
 		break;
 	case GLSLT :	//"GLONASS SLOT / FRQ #"
 		if(sscanf(lineBuffer+8, "%2d", &j) == 1) {
@@ -3306,11 +3934,11 @@ RinexData::RINEXlabel RinexData::readHdLineData (FILE* input) {
 			}
 		}
 		if (j != gloSltFrq.size()) plog->warning(valueLabel(GLSLT, "Mismatch in number of expected and existing slots"));
-		plog->finer(valueLabel(GLSLT, to_string((long long) j) + " slots"));
+		LOG_FINER(plog, valueLabel(GLSLT, to_string((long long) j) + " slots"));
 		break;
 	case LEAP :		//"LEAP SECONDS"
 		if(sscanf(lineBuffer, "%6d", &leapSec) != 1) RETURN_WITH_ERROR(string())
-		plog->finer(valueLabel(LEAP, to_string((long long) leapSec)));
+		LOG_FINER(plog, valueLabel(LEAP, to_string((long long) leapSec)));
 		//V302 additional data
 		if (isBlank(lineBuffer + 6, 6)) deltaLSF = 0;
 		else deltaLSF = stoi(string(lineBuffer + 6, 6));
@@ -3321,7 +3949,7 @@ RinexData::RINEXlabel RinexData::readHdLineData (FILE* input) {
 		break;
 	case SATS :		//"# OF SATELLITES"
 		if(sscanf(lineBuffer, "%6d", &numOfSat) != 1) RETURN_WITH_ERROR(string())
-		plog->finer(valueLabel(SATS, to_string((long long) numOfSat)));
+		LOG_FINER(plog, valueLabel(SATS, to_string((long long) numOfSat)));
 		break;
 	case PRNOBS :	//"PRN / # OF OBS"
 		//get the list with the number of observables
@@ -3340,7 +3968,7 @@ RinexData::RINEXlabel RinexData::readHdLineData (FILE* input) {
 			if (prnObsNum.empty()) RETURN_WITH_ERROR(" Continuation line not following a regular one")
 			prnObsNum.back().obsNum.insert(prnObsNum.back().obsNum.end(), anIntLst.begin(), anIntLst.end());
 		}
-		plog->finer(valueLabel(PRNOBS, " sat " + string(1, prnObsNum.back().sysPrn) + " obs per type " + to_string((long long) prnObsNum.back().obsNum.size())));
+		LOG_FINER(plog, valueLabel(PRNOBS, " sat " + string(1, prnObsNum.back().sysPrn) + " obs per type " + to_string((long long) prnObsNum.back().obsNum.size())));
 		break;
 	case IONC :		//"IONOSPHERIC CORR"	GNSS nav V302
 		aIonoCorr.corrType = string(lineBuffer,4);
@@ -3352,17 +3980,17 @@ RinexData::RINEXlabel RinexData::readHdLineData (FILE* input) {
 			}
 		}
 		ionoCorrection.push_back(aIonoCorr);
-		plog->finer(valueLabel(IONC, n==0? string(" data read."):(string(" errors in iono corrections:")+to_string((long long) n))));
+		LOG_FINER(plog, valueLabel(IONC, n==0? string(" data read."):(string(" errors in iono corrections:")+to_string((long long) n))));
 		break;
 	case TIMC :		//"TIME SYSTEM CORR"	GNSS nav V302
 		aTimCorr.corrType = string(lineBuffer,4);
 		if(sscanf(lineBuffer+5, "%17lf%16lf%7d%5d", &aTimCorr.a0, &aTimCorr.a1, &aTimCorr.refTime, &aTimCorr.refWeek) != 4) RETURN_WITH_ERROR(string())
 		aTimCorr.sbas = string(lineBuffer+51,5);
 		if(sscanf(lineBuffer+58, "%2d", &aTimCorr.utcId) != 1) RETURN_WITH_ERROR(string())
-		plog->finer(valueLabel(TIMC, " data read"));
+		LOG_FINER(plog, valueLabel(TIMC, " data read"));
 		break;
 	case EOH :		//"END OF HEADER"
-		plog->finer(valueLabel(EOH, "found"));
+		LOG_FINER(plog, valueLabel(EOH, "found"));
 		break;
 	default:
 		throw string("Internal error: invalid label Id in readHdLineData");
@@ -3393,6 +4021,613 @@ bool RinexData::readRinexRecord(char* rinexRec, int recSize, FILE* input) {
 	return false;
 }
 
+/**beginEpochRead prepares the reading of epoch records from the given input stream.
+ * When the input file can be mapped into memory, epoch records are read directly from the mapped image,
+ * starting at the current stream position. Otherwise they are read from the input stream.
+ * The file is mapped the first time epochs are read from a new input stream.
+ *
+ * @param input the already open stream where RINEX epochs will be read
+ */
+void RinexData::beginEpochRead(FILE* input) {
+	if (input != inFile) {
+		inFile = input;
+		if (!inMap.map(input)) LOG_FINE(plog, "Input file not mapped. Epochs are read from the input stream");
+		inData = inMap.data();
+		inSize = inMap.size();
+	}
+	if ((inData != NULL) && ((inCursor = MappedFile::tell(input)) < 0)) inCursor = inSize;
+}
+
+/**endEpochRead ends the reading of epoch records, setting the input stream position after the last record read.
+ * It is needed when records have been read from the mapped image of the input file, to allow further reading from the input stream.
+ *
+ * @param input the already open stream where RINEX epochs are being read
+ */
+void RinexData::endEpochRead(FILE* input) {
+	if (inData != NULL) MappedFile::seek(input, inCursor);
+}
+
+/**readRinexRecord reads a line from the RINEX input containing an epoch record, providing a view of it.
+ * Records are read from the mapped image of the input file when available, or from the input stream otherwise.
+ * The view given excludes EOL chars. Chars beyond the end of the line are not padded: they are considered blanks when accessed through the view.
+ * Empty lines are skipped.
+ *
+ * @param rec the record view to be set with the line read
+ * @param input the already open stream where RINEX line will be read
+ * @return true if EOF happens when reading, false otherwise
+ */
+bool RinexData::readRinexRecord(RINEXrecord &rec, FILE* input) {
+	long long len;
+	do {
+		if (inData != NULL) {
+			if (inCursor >= inSize) return true;
+			inCursor = viewRecord(inCursor, rec);
+		} else {
+			if (fgets(inBuffer, sizeof inBuffer, input) == NULL) return true;
+			rec.start = inBuffer;
+			len = strcspn(inBuffer, "\n");
+			if ((len > 0) && (rec.start[len-1] == '\r')) len--;
+			rec.length = (int) len;
+		}
+	} while (rec.isBlank(0, rec.length));
+	return false;
+}
+
+/**viewRecord provides a view of the line starting at the given position in the input file image.
+ * The view given excludes EOL chars.
+ *
+ * @param pos the offset in the input file image of the first char of the line
+ * @param rec the record view to be set with the line
+ * @return the offset in the input file image of the next line
+ */
+long long RinexData::viewRecord(long long pos, RINEXrecord &rec) {
+	const char* eol;
+	long long len;
+	rec.start = inData + pos;
+	eol = (const char*) memchr(rec.start, '\n', (size_t) (inSize - pos));
+	len = eol == NULL? inSize - pos : eol - rec.start;
+	pos += eol == NULL? len : len + 1;
+	if ((len > 0) && (rec.start[len-1] == '\r')) len--;
+	rec.length = (int) len;
+	return pos;
+}
+
+/**getDouble gets the real number contained in a fixed width field of the record.
+ * Chars beyond the end of the line are considered blanks.
+ *
+ * @param col the first column of the field
+ * @param n the field width
+ * @param value the value extracted from the field
+ * @return true if the field contains a well formatted number, false otherwise (blank field or wrong chars)
+ */
+bool RinexData::RINEXrecord::getDouble(int col, int n, double &value) {
+	if (col + n > length) n = length - col;
+	return (n > 0) && fieldToDouble(start + col, n, value);
+}
+
+/**getInt gets the integer number contained in a fixed width field of the record.
+ * Chars beyond the end of the line are considered blanks.
+ *
+ * @param col the first column of the field
+ * @param n the field width
+ * @param value the value extracted from the field
+ * @return true if the field contains a well formatted integer, false otherwise (blank field or wrong chars)
+ */
+bool RinexData::RINEXrecord::getInt(int col, int n, int &value) {
+	if (col + n > length) n = length - col;
+	return (n > 0) && fieldToInt(start + col, n, value);
+}
+
+/**ParallelRead defines the state of a parallel reading of observation epochs.
+ * The input file image is split in chunks starting at epoch boundaries. Chunks are parsed by the reading threads,
+ * each one using its own RinexData object, and parsed epochs are kept until readObsEpoch delivers them in order.
+ */
+struct RinexData::ParallelRead {
+	struct ParsedEpoch {	//defines data of an epoch parsed by a reading thread
+		long long start;	//the offset in the input file image of the epoch first record
+		long long end;		//the offset in the input file image after the epoch last record
+		int retCode;		//the status given by the epoch parser
+		bool event;			//true for epochs with flags 2 to 5: they shall be read again from the input stream
+		int week;			//the epoch week, or -1 if it was not set by the parser (wrong date)
+		double tow;			//the epoch seconds into the week
+		double timeTag;		//the epoch time tag
+		double clkOffset;	//the epoch clock offset, or NaN if it was not set by the parser
+		int flag;			//the epoch flag, or -1 if it was not set by the parser
+		int nSats;			//the number of satellites or special records, or -1 if it was not set by the parser
+		unsigned int firstMsg;	//the index of the first deferred logging message generated parsing the epoch
+		unsigned int lastMsg;	//the index after the last deferred logging message generated parsing the epoch
+		EpochObsData obs;	//the epoch observables
+		//constructor
+		ParsedEpoch () {
+			start = end = 0;
+			retCode = 0;
+			event = false;
+			week = flag = nSats = -1;
+			tow = timeTag = 0.0;
+			clkOffset = NAN;
+			firstMsg = lastMsg = 0;
+		};
+	};
+	struct ReadChunk {	//defines a chunk of the input file image to be parsed by a reading thread
+		long long start;	//the offset of the first epoch in the chunk
+		long long end;		//the offset after the chunk: epochs starting from here are not parsed
+		bool done;			//true when the chunk has been parsed
+		Logger* log;		//the logger deferring messages generated when parsing the chunk
+		vector <ParsedEpoch> epochs;	//the epochs parsed
+		//constructor
+		ReadChunk (long long s, long long e) {
+			start = s;
+			end = e;
+			done = false;
+			log = NULL;
+		};
+	};
+	vector <ReadChunk> chunks;		//the chunks the input file image has been split into
+	size_t toRead;					//the index of the next chunk to be parsed
+	size_t current;					//the index of the chunk being delivered
+	size_t nextEpoch;				//the index in the current chunk of the next epoch to be delivered
+	size_t maxAhead;				//the maximum number of chunks that can be parsed in advance of the current one
+	bool sequential;				//true when epochs shall be read sequentially from the input stream
+	atomic<bool> stop;				//true when reading threads shall end
+	mutex lock;						//to access chunks state shared between threads
+	condition_variable changed;		//to signal changes in chunks parsed or delivered
+	vector <thread> threads;		//the reading threads
+	vector <RinexData*> readers;	//the RinexData object used by each reading thread
+	//constructor & destructor
+	ParallelRead () {
+		toRead = current = nextEpoch = maxAhead = 0;
+		sequential = false;
+		stop = false;
+	};
+	~ParallelRead () {
+		stopThreads();
+	};
+	//stop reading threads, releasing their resources
+	void stopThreads () {
+		{
+			lock_guard<mutex> guard(lock);
+			stop = true;
+		}
+		changed.notify_all();
+		for (size_t i = 0; i < threads.size(); i++) threads[i].join();
+		threads.clear();
+		for (size_t i = 0; i < readers.size(); i++) delete readers[i];
+		readers.clear();
+		for (size_t i = 0; i < chunks.size(); i++) delete chunks[i].log;
+		chunks.clear();
+	};
+};
+
+/**readObsEpochParallel delivers the observation epoch parsed by the reading threads which starts at the current input stream position,
+ * setting the stream position after it. Parsed epochs before the current position are discarded.
+ * Reading threads are started the first time it is called.
+ *
+ * @param input the already open stream where RINEX epochs are being read
+ * @return the status of the epoch delivered, as per readObsEpoch, or -1 if the epoch shall be read sequentially from the input stream
+ */
+int RinexData::readObsEpochParallel(FILE* input) {
+	long long pos;
+	if ((parRead != NULL) && (input != inFile)) endParallelRead();
+	if (parRead == NULL) beginParallelRead(input);
+	ParallelRead* par = parRead;
+	if (par->sequential || ((pos = MappedFile::tell(input)) < 0)) return -1;
+	pos = skipBlankLines(pos);
+	unique_lock<mutex> guard(par->lock);
+	while (par->current < par->chunks.size()) {
+		ParallelRead::ReadChunk &chunk = par->chunks[par->current];
+		while (!chunk.done) par->changed.wait(guard);
+		while ((par->nextEpoch < chunk.epochs.size()) && (chunk.epochs[par->nextEpoch].start < pos)) par->nextEpoch++;
+		if (par->nextEpoch < chunk.epochs.size()) break;
+		//all epochs in the chunk have been delivered or discarded: release it and allow threads to parse further chunks
+		delete chunk.log;
+		chunk.log = NULL;
+		vector<ParallelRead::ParsedEpoch>().swap(chunk.epochs);
+		par->current++;
+		par->nextEpoch = 0;
+		par->changed.notify_all();
+	}
+	if (par->current >= par->chunks.size()) return -1;
+	guard.unlock();
+	ParallelRead::ReadChunk &chunk = par->chunks[par->current];
+	ParallelRead::ParsedEpoch &epoch = chunk.epochs[par->nextEpoch];
+	if (epoch.start != pos) return -1;
+	if (epoch.event) {
+		//special records in events could change data needed to parse further epochs
+		par->stopThreads();
+		par->sequential = true;
+		LOG_FINE(plog, "Event epoch found. Next epochs are read sequentially");
+		return -1;
+	}
+	par->nextEpoch++;
+	epochObs.swap(epoch.obs);
+	if (epoch.week >= 0) {
+		epochWeek = epoch.week;
+		epochTOW = epoch.tow;
+		epochTimeTag = epoch.timeTag;
+	}
+	if (epoch.clkOffset == epoch.clkOffset) epochClkOffset = epoch.clkOffset;
+	if (epoch.flag >= 0) epochFlag = epoch.flag;
+	if (epoch.nSats >= 0) nSatsEpoch = epoch.nSats;
+	chunk.log->forward(epoch.firstMsg, epoch.lastMsg);
+	MappedFile::seek(input, epoch.end);
+	return epoch.retCode;
+}
+
+/**beginParallelRead starts the parallel reading of observation epochs from the current input stream position.
+ * The input file image is split in chunks of epochs, and reading threads are started to parse them.
+ * If parallel reading is not possible (input file not mapped, unknown version, or too few data), epochs will be read sequentially.
+ *
+ * @param input the already open stream where RINEX epochs will be read
+ */
+void RinexData::beginParallelRead(FILE* input) {
+	long long start, end;
+	parRead = new ParallelRead();
+	beginEpochRead(input);
+	if ((inData == NULL) || ((inFileVer != V210) && (inFileVer != V302))) {
+		LOG_FINE(plog, "Parallel reading not possible. Epochs are read sequentially");
+		parRead->sequential = true;
+		return;
+	}
+	//split the input file image in chunks starting at epoch boundaries
+	for (start = skipBlankLines(inCursor); start < inSize; start = end) {
+		end = start + READCHUNKSIZE < inSize? nextEpochStart(start + READCHUNKSIZE) : inSize;
+		parRead->chunks.push_back(ParallelRead::ReadChunk(start, end));
+	}
+	if (parRead->chunks.size() < 2) {
+		parRead->sequential = true;
+		return;
+	}
+	//start reading threads, each one with its own RinexData object having the header data needed to parse epochs
+	parRead->maxAhead = READCHUNKSAHEAD * readThreads;
+	for (int i = 0; i < readThreads; i++) {
+		RinexData* reader = new RinexData(VTBD, plog);
+		reader->inFileVer = inFileVer;
+		reader->systems = systems;
+		reader->inData = inData;
+		reader->inSize = inSize;
+		parRead->readers.push_back(reader);
+		parRead->threads.push_back(thread(readChunks, parRead, reader));
+	}
+	LOG_FINE(plog, "Epochs are read by " + to_string((long long) readThreads) + " threads in " + to_string((long long) parRead->chunks.size()) + " chunks");
+}
+
+/**endParallelRead ends the parallel reading in progress, if any, stopping reading threads and releasing resources.
+ */
+void RinexData::endParallelRead() {
+	if (parRead == NULL) return;
+	delete parRead;
+	parRead = NULL;
+}
+
+/**PrintThread defines the state of the printing of observation epochs by a separate thread.
+ * Epoch data are handed to the printing thread in a pool of buffers. The indexes of buffers filled with epochs to print,
+ * and of buffers already printed, are passed between threads through two rings having one producer and one consumer, without locks.
+ * The printing thread uses its own RinexData object, having the data needed to print epochs.
+ */
+struct RinexData::PrintThread {
+	struct EpochBuffer {	//defines data of an epoch to be printed
+		int week;			//the epoch week
+		double tow;			//the epoch seconds into the week
+		double clkOffset;	//the epoch clock offset
+		int flag;			//the epoch flag
+		EpochObsData obs;	//the epoch observables
+		Logger* log;		//the logger deferring messages generated when printing the epoch
+	};
+	struct IndexRing {	//a ring of buffer indexes pushed by one thread and popped by another one. It can contain all indexes
+		size_t index[PRINTBUFFERS + 1];
+		atomic<size_t> head;	//the position of the next index to pop
+		atomic<size_t> tail;	//the position where the next index will be pushed
+		//constructor
+		IndexRing () {
+			head = tail = 0;
+		};
+		//push an index into the ring
+		void push (size_t inx) {
+			size_t pos = tail.load(memory_order_relaxed);
+			index[pos] = inx;
+			tail.store((pos + 1) % (PRINTBUFFERS + 1), memory_order_release);
+		};
+		//pop an index from the ring, if any
+		bool pop (size_t &inx) {
+			size_t pos = head.load(memory_order_relaxed);
+			if (pos == tail.load(memory_order_acquire)) return false;
+			inx = index[pos];
+			head.store((pos + 1) % (PRINTBUFFERS + 1), memory_order_release);
+			return true;
+		};
+	};
+	EpochBuffer buffers[PRINTBUFFERS];	//the pool of epoch buffers
+	IndexRing filled;				//the buffers with epochs to be printed, in acquisition order
+	IndexRing freed;				//the buffers already printed, available to hand new epochs
+	RinexData* printer;				//the RinexData object used by the printing thread
+	FILE* out;						//the stream where epochs are printed
+	atomic<bool> done;				//true when no more epochs will be handed to the printing thread
+	atomic<bool> failed;			//true when an error happened printing an epoch
+	string error;					//the error message
+	thread worker;					//the printing thread
+	//constructor & destructor
+	PrintThread () {
+		for (size_t i = 0; i < PRINTBUFFERS; i++) buffers[i].log = NULL;
+		printer = NULL;
+		out = NULL;
+		done = failed = false;
+	};
+	~PrintThread () {
+		delete printer;
+		for (size_t i = 0; i < PRINTBUFFERS; i++) delete buffers[i].log;
+	};
+	//wait a while for the other thread, yielding the first times and sleeping later
+	static void backoff (int &tries) {
+		if (tries++ < PRINTSPINS) this_thread::yield();
+		else this_thread::sleep_for(chrono::microseconds(PRINTSLEEP));
+	};
+};
+
+/**queueObsEpoch hands the current epoch data to the printing thread, which is started the first time it is called.
+ * Messages deferred when printing former epochs in the buffer used are forwarded to the logger.
+ *
+ * @param out the already open print stream where RINEX epoch data will be printed
+ * @throws error message string when a former epoch could not be printed
+ */
+void RinexData::queueObsEpoch(FILE* out) {
+	size_t inx;
+	int tries = 0;
+	if ((prtThread != NULL) && ((prtThread->out != out) || prtThread->failed)) endPrintThread();
+	if (prtThread == NULL) beginPrintThread(out);
+	while (!prtThread->freed.pop(inx)) PrintThread::backoff(tries);
+	PrintThread::EpochBuffer &buffer = prtThread->buffers[inx];
+	if (buffer.log->deferredSize() > 0) {
+		buffer.log->forward(0, buffer.log->deferredSize());
+		delete buffer.log;
+		buffer.log = new Logger(plog);
+	}
+	buffer.week = epochWeek;
+	buffer.tow = epochTOW;
+	buffer.clkOffset = epochClkOffset;
+	buffer.flag = epochFlag;
+	buffer.obs.swap(epochObs);
+	prtThread->filled.push(inx);
+}
+
+/**beginPrintThread starts the printing thread, with its own RinexData object having the data needed to print epochs.
+ * The statistics used to patch header records are moved to this object while the thread is running.
+ *
+ * @param out the already open print stream where RINEX epoch data will be printed
+ */
+void RinexData::beginPrintThread(FILE* out) {
+	PrintThread* pt = new PrintThread();
+	pt->out = out;
+	pt->printer = new RinexData(version, plog);
+	pt->printer->systems = systems;
+	pt->printer->v2ObsLst = v2ObsLst;
+	pt->printer->applyObsFilter = applyObsFilter;
+	pt->printer->applySnrMask = applySnrMask;
+	pt->printer->minSnrMask = minSnrMask;
+	pt->printer->patchHeader = patchHeader;
+	swap(obsStats, pt->printer->obsStats);
+	for (size_t i = 0; i < PRINTBUFFERS; i++) {
+		pt->buffers[i].log = new Logger(plog);
+		pt->freed.push(i);
+	}
+	pt->worker = thread(printEpochs, pt);
+	prtThread = pt;
+	LOG_FINE(plog, "Observation epochs are printed by a separate thread");
+}
+
+/**endPrintThread waits until the printing thread has printed all epochs handed to it, and ends it.
+ * Messages deferred when printing epochs are forwarded to the logger, and the statistics used to patch header records are restored.
+ *
+ * @throws error message string when an epoch could not be printed
+ */
+void RinexData::endPrintThread() {
+	size_t inx;
+	if (prtThread == NULL) return;
+	PrintThread* pt = prtThread;
+	prtThread = NULL;
+	pt->done = true;
+	pt->worker.join();
+	while (pt->freed.pop(inx)) pt->buffers[inx].log->forward(0, pt->buffers[inx].log->deferredSize());
+	swap(obsStats, pt->printer->obsStats);
+	bool failed = pt->failed;
+	string error = pt->error;
+	delete pt;
+	if (failed) throw error;
+}
+
+/**printEpochs prints the epochs handed to the printing thread, in the order they were handed, until it is ended.
+ * After an error, remaining epochs are discarded.
+ *
+ * @param pt the printing thread state
+ */
+void RinexData::printEpochs(PrintThread* pt) {
+	RinexData* printer = pt->printer;
+	Logger* targetLog = printer->plog;
+	size_t inx;
+	int tries = 0;
+	for (;;) {
+		if (!pt->filled.pop(inx)) {
+			if (!pt->done) {
+				PrintThread::backoff(tries);
+				continue;
+			}
+			if (!pt->filled.pop(inx)) break;	//epochs handed before ending shall be printed
+		}
+		tries = 0;
+		PrintThread::EpochBuffer &buffer = pt->buffers[inx];
+		if (!pt->failed) {
+			printer->epochWeek = buffer.week;
+			printer->epochTOW = buffer.tow;
+			printer->epochClkOffset = buffer.clkOffset;
+			printer->epochFlag = buffer.flag;
+			printer->epochObs.swap(buffer.obs);
+			printer->plog = buffer.log;
+			try {
+				printer->printObsEpoch(pt->out);
+			} catch (string error) {
+				pt->error = error;
+				pt->failed = true;
+			}
+			printer->epochObs.swap(buffer.obs);
+		}
+		buffer.obs.clear();
+		pt->freed.push(inx);
+	}
+	printer->plog = targetLog;
+}
+
+/**skipBlankLines gives the position of the first non blank line in the input file image from the given one.
+ *
+ * @param pos the offset in the input file image of the first char of a line
+ * @return the offset of the first non blank line from pos, or the image size if there are not more non blank lines
+ */
+long long RinexData::skipBlankLines(long long pos) {
+	RINEXrecord rec;
+	long long next;
+	for (; pos < inSize; pos = next) {
+		next = viewRecord(pos, rec);
+		if (!rec.isBlank(0, rec.length)) break;
+	}
+	return pos;
+}
+
+/**nextEpochStart gives the position of the first line starting an epoch after the given position in the input file image.
+ * Epoch lines are identified by their format: in V3 they start with '>', in V2 they have date, time and flag fields in place.
+ * Note that a line identified could not be a real epoch start (f.e. it is a special record). This is detected when parsing epochs.
+ *
+ * @param pos the offset in the input file image where search starts
+ * @return the offset of the first line starting an epoch, or the image size if it was not found
+ */
+long long RinexData::nextEpochStart(long long pos) {
+	RINEXrecord rec;
+	long long next;
+	const char* eol;
+	if ((pos > 0) && (pos < inSize) && (inData[pos-1] != '\n')) {	//go to the next line start
+		eol = (const char*) memchr(inData + pos, '\n', (size_t) (inSize - pos));
+		pos = eol == NULL? inSize : eol - inData + 1;
+	}
+	for (; pos < inSize; pos = next) {
+		next = viewRecord(pos, rec);
+		if (inFileVer == V302) {
+			if (rec.at(0) == '>') break;
+		} else if ((rec.at(0) == ' ') && (rec.at(3) == ' ') && (rec.at(6) == ' ') && (rec.at(9) == ' ') && (rec.at(12) == ' ')
+				&& (rec.at(18) == '.') && rec.isBlank(26, 2) && (rec.at(28) >= '0') && (rec.at(28) <= '9')) break;
+	}
+	return pos;
+}
+
+/**readChunks is the body of each reading thread: parses chunks of the input file image while they exist.
+ * Chunks are taken in order, but only when they are not too far from the chunk being delivered.
+ * Logging messages generated are deferred, to be logged when the epoch is delivered.
+ *
+ * @param par the parallel reading state
+ * @param reader the RinexData object used by this thread to parse epochs
+ */
+void RinexData::readChunks(ParallelRead* par, RinexData* reader) {
+	Logger* targetLog = reader->plog;
+	long long start;
+	size_t index;
+	unique_lock<mutex> guard(par->lock);
+	for (;;) {
+		while (!par->stop && (par->toRead < par->chunks.size()) && (par->toRead >= par->current + par->maxAhead)) par->changed.wait(guard);
+		if (par->stop || (par->toRead >= par->chunks.size())) return;
+		index = par->toRead++;
+		guard.unlock();
+		ParallelRead::ReadChunk &chunk = par->chunks[index];
+		chunk.log = new Logger(targetLog);
+		reader->plog = chunk.log;
+		reader->inCursor = chunk.start;
+		while (!par->stop && ((start = reader->skipBlankLines(reader->inCursor)) < chunk.end)) {
+			chunk.epochs.push_back(ParallelRead::ParsedEpoch());
+			ParallelRead::ParsedEpoch &epoch = chunk.epochs.back();
+			epoch.start = reader->inCursor = start;
+			epoch.firstMsg = chunk.log->deferredSize();
+			//epoch data not set by the parser are marked to keep them unchanged when delivered
+			reader->epochObs.clear();
+			reader->epochWeek = reader->epochFlag = reader->nSatsEpoch = -1;
+			reader->epochClkOffset = NAN;
+			epoch.retCode = reader->inFileVer == V210? reader->readV2ObsEpoch(NULL) : reader->readV3ObsEpoch(NULL);
+			epoch.end = reader->inCursor;
+			epoch.lastMsg = chunk.log->deferredSize();
+			epoch.week = reader->epochWeek;
+			epoch.tow = reader->epochTOW;
+			epoch.timeTag = reader->epochTimeTag;
+			epoch.clkOffset = reader->epochClkOffset;
+			epoch.flag = reader->epochFlag;
+			epoch.nSats = reader->nSatsEpoch;
+			epoch.obs.swap(reader->epochObs);
+			if (epoch.retCode == 0) break;
+			if ((epoch.flag >= 2) && (epoch.flag <= 5)) {
+				epoch.event = true;
+				break;
+			}
+		}
+		reader->plog = targetLog;
+		guard.lock();
+		chunk.done = true;
+		par->changed.notify_all();
+	}
+}
+
+/**indexObsEpoch updates the epoch index being built with the epoch just read.
+ * When the EOF is found, the index is saved if epochs were in time order.
+ *
+ * @param pos the offset in the input file where reading of the epoch started
+ * @param retCode the status of the epoch read (see readObsEpoch)
+ */
+void RinexData::indexObsEpoch(long long pos, int retCode) {
+	if (retCode == 0) {
+		indexBuilding = false;
+		if (!indexOrdered) plog->warning("Epochs are not in time order. Epoch index not saved");
+		else if (saveEpochIndex()) plog->info("Epoch index saved in " + indexName);
+		else plog->warning("Cannot save epoch index in " + indexName);
+		return;
+	}
+	if (epochTimeTag < indexLastTag) indexOrdered = false;
+	indexLastTag = epochTimeTag;
+	if ((epochFlag >= 2) && (epochFlag <= 5)) indexClosed = true;
+	if (!indexClosed && (epochIndex.empty() || (epochTimeTag >= epochIndex.back().timeTag + INDEXSTEP)))
+		epochIndex.push_back(EPOCHindex(epochTimeTag, pos));
+}
+
+/**loadEpochIndex loads the epoch index from the index file, checking it matches the current input file.
+ *
+ * @return true if the index has been loaded, false otherwise (file does not exist, wrong format, or data do not match the input file)
+ */
+bool RinexData::loadEpochIndex() {
+	char line[80];
+	long long size, modTime, first, offset;
+	unsigned int nEntries;
+	double timeTag;
+	FILE* idxFile = fopen(indexName.c_str(), "r");
+	if (idxFile == NULL) return false;
+	bool isOk = (fgets(line, sizeof line, idxFile) != NULL) && (INDEXID.compare(0, string::npos, line, strcspn(line, "\r\n")) == 0)
+		&& (fscanf(idxFile, "%lld %lld %lld %u", &size, &modTime, &first, &nEntries) == 4)
+		&& (size == inFileSize) && (modTime == inFileTime) && (first == inFirstEpoch);
+	for (unsigned int i = 0; isOk && (i < nEntries); i++) {
+		if ((fscanf(idxFile, "%lf %lld", &timeTag, &offset) != 2) || (offset < first) || (offset >= size)
+				|| (!epochIndex.empty() && (timeTag < epochIndex.back().timeTag))) isOk = false;
+		else epochIndex.push_back(EPOCHindex(timeTag, offset));
+	}
+	fclose(idxFile);
+	if (!isOk) plog->info("Epoch index in " + indexName + " does not match the input file");
+	return isOk;
+}
+
+/**saveEpochIndex saves the epoch index built into the index file.
+ * The index file is a text file containing a line with the INDEXID identifier, a line with the input file size,
+ * modification time, first epoch offset, and number of entries, and a line for each entry with its time tag and offset.
+ *
+ * @return true if the index has been saved, false otherwise
+ */
+bool RinexData::saveEpochIndex() {
+	FILE* idxFile = fopen(indexName.c_str(), "w");
+	if (idxFile == NULL) return false;
+	fprintf(idxFile, "%s\n%lld %lld %lld %u\n", INDEXID.c_str(), inFileSize, inFileTime, inFirstEpoch, (unsigned int) epochIndex.size());
+	for (vector<EPOCHindex>::iterator it = epochIndex.begin(); it != epochIndex.end(); it++)
+		fprintf(idxFile, "%.17g %lld\n", it->timeTag, it->offset);
+	return fclose(idxFile) == 0;
+}
+
 /**obsV3toV2 provides the observable type name in RINEX V2 of a given system and observable
  * The observable type name returned is empty when:
  * - The system is not GPS, GLONASS or SBAS (the only ones RINEX V210 can cope with)
@@ -3441,6 +4676,178 @@ bool RinexData::isSatSelected(int sysIx, int sat) {
 	return false;
 }
 
+/**isNavSatSelected checks if navigation data of the given system and satellite pass the filter.
+ * They pass when the system-satellite identification (with format S[nn]) begins with any of the identifications in the selected system-satellites list.
+ * 
+ * @param sys the given system identification 
+ * @param sat the given satellite number 
+ * @return true when the given system-satellite is selected, false otherwise
+ */
+bool RinexData::isNavSatSelected(char sys, int sat) {
+	char buffer[16];
+	sprintf(buffer, "%1c%02.2d", sys, sat);	//obtain a string with system-satellite identification
+	for (vector<string>::iterator itsel = selectedSats.begin(); itsel != selectedSats.end(); ++itsel)
+		if (string(buffer).compare(0, (*itsel).size(), *itsel) == 0) return true;
+	return false;
+}
+
+/**compileFilter translates the current filtering data into the bitmaps used to filter epoch data:
+ * - for each system, the bitmap of selected satellites and the bitmask of selected observable types (all clear if the system is not selected)
+ * - for each system in the selected system-satellites list, the bitmap of satellites whose navigation data pass the filter
+ *<p>Satellites out of the bitmaps range are filtered using directly the filtering data.
+ */
+void RinexData::compileFilter() {
+	unsigned int obs;
+	vector<NAVfilter>::iterator itFilter;
+	for (vector<GNSSsystem>::iterator itSystems = systems.begin(); itSystems != systems.end(); itSystems++) {
+		if (itSystems->selSat.empty()) itSystems->selPrn.set();
+		else {
+			itSystems->selPrn.reset();
+			for (vector<int>::iterator itSelSat = itSystems->selSat.begin(); itSelSat != itSystems->selSat.end(); itSelSat++)
+				if ((unsigned int) *itSelSat < (unsigned int) FILTERPRNS) itSystems->selPrn.set(*itSelSat);
+		}
+		itSystems->selObsMask.assign((itSystems->obsType.size() + 31) / 32, 0);
+		if (itSystems->selSystem)
+			for (obs = 0; obs < itSystems->selObsType.size(); obs++)
+				if (itSystems->selObsType[obs]) itSystems->selObsMask[obs >> 5] |= 1u << (obs & 31);
+	}
+	navFilter.clear();
+	for (vector<string>::iterator itSelSat = selectedSats.begin(); itSelSat != selectedSats.end(); itSelSat++) {
+		for (itFilter = navFilter.begin(); (itFilter != navFilter.end()) && (itFilter->system != itSelSat->at(0)); itFilter++);
+		if (itFilter != navFilter.end()) continue;
+		navFilter.push_back(NAVfilter(itSelSat->at(0)));
+		for (int prn = 0; prn < FILTERPRNS; prn++)
+			if (isNavSatSelected(itSelSat->at(0), prn)) navFilter.back().selPrn.set(prn);
+	}
+}
+
+/**maskObsData removes from current epoch observation data all data of satellites below the elevation or the signal to noise ratio masks.
+ * Satellites without valid ephemeris (or if station position is not known), or without signal data, are not removed.
+ */
+void RinexData::maskObsData() {
+	size_t i, j, kept;
+	unsigned int lastKey = 0xFFFFFFFF;
+	int sysIndex;
+	char sys;
+	int sat;
+	//collect the satellites in the epoch and their signal data
+	maskSats.clear();
+	maskData.clear();
+	maskSatInx.resize(epochObs.size());
+	for (i = j = 0; i < epochObs.size(); i++) {
+		sysIndex = EpochObsData::sysIndexOf(epochObs.satKey[i]);
+		if (epochObs.satKey[i] != lastKey) {
+			lastKey = epochObs.satKey[i];
+			sys = systems[sysIndex].system;
+			sat = EpochObsData::satelliteOf(lastKey);
+			for (j = 0; (j < maskSats.size()) && !((maskSats[j].systemId == sys) && (maskSats[j].satellite == sat)); j++);
+			if (j == maskSats.size()) {
+				maskSats.push_back(OrbitEvaluator::SatPosition(sys, sat));
+				maskData.push_back(SatMaskData());
+				maskData[j].s1 = -1.0;
+				maskData[j].strength = 0;
+				maskData[j].rejected = false;
+			}
+		}
+		maskSatInx[i] = j;
+		const string &obsType = systems[sysIndex].obsType[epochObs.obsTypeIndex[i]];
+		if ((obsType[0] == 'S') && (obsType[1] == '1') && (epochObs.obsValue[i] > maskData[j].s1)) maskData[j].s1 = epochObs.obsValue[i];
+		if (epochObs.strength[i] > maskData[j].strength) maskData[j].strength = epochObs.strength[i];
+	}
+	if (applySnrMask) {
+		for (j = 0; j < maskData.size(); j++) {
+			if (maskData[j].s1 > 0.0) maskData[j].rejected = maskData[j].s1 < minSnrMask;
+			else if (maskData[j].strength > 0) maskData[j].rejected = maskData[j].strength * 6 + 5 < minSnrMask;
+		}
+	}
+	if (applyElevMask) {
+		setOrbitParams();
+		if (orbits.isStationSet()) {
+			orbits.compute(getSecsGPSEphe(epochWeek, epochTOW), maskSats);
+			for (j = 0; j < maskSats.size(); j++)
+				if (maskSats[j].valid && (maskSats[j].elevation < minElevMask)) maskData[j].rejected = true;
+		} else if (!stationWarned) {
+			plog->warning("Elevation mask not applied: approximate position not known");
+			stationWarned = true;
+		}
+	}
+	if (plog->isLevel(Logger::FINER)) {
+		char msgBuf[40];
+		for (j = 0; j < maskSats.size(); j++)
+			if (maskData[j].rejected) {
+				sprintf(msgBuf, "Masked sat=%c%02d", maskSats[j].systemId, maskSats[j].satellite);
+				plog->finer(msgBuf);
+			}
+	}
+	//remove data of rejected satellites, moving the kept ones to the front
+	for (i = kept = 0; i < epochObs.size(); i++) {
+		epochObs.copy(kept, i);
+		kept += maskData[maskSatInx[i]].rejected? 0 : 1;
+	}
+	epochObs.truncate(kept);
+}
+
+/**setOrbitParams sets in the orbit evaluator the station position and the leap seconds from the header data, if they exist.
+ */
+void RinexData::setOrbitParams() {
+	if (getLabelFlag(APPXYZ)) orbits.setStation(aproxX, aproxY, aproxZ);
+	if (getLabelFlag(LEAP)) orbits.setLeapSeconds(leapSec);
+}
+
+/**pushNavData appends the given navigation data to the epochNav storage, updating the keys of stored data
+ * and the number of records already sorted. Data are also added to the ephemeris store.
+ *
+ * @param tTag the time tag for the navigation data
+ * @param sys the satellite system identifier (G,E,R, ...)
+ * @param sat the satellite PRN the navigation data belongs
+ * @param bo the broadcast orbit data with the eight lines of RINEX navigation data with four parameters each
+ */
+void RinexData::pushNavData(double tTag, char sys, int sat, double bo[8][4]) {
+	epochNav.push_back(SatNavData(tTag, sys, sat, bo));
+	navKeys.insert(NAVkey(sys, sat, tTag));
+	ephemerides.add(sys, sat, bo, tTag);
+	//data added in order keep sorted the whole storage
+	if ((navSorted == epochNav.size() - 1) && ((navSorted == 0) || (epochNav[navSorted - 1] < epochNav[navSorted]))) navSorted++;
+}
+
+/**dropNavKey removes from the keys of stored navigation data the key of the given one, when it is going to be removed from epochNav.
+ *
+ * @param navData the navigation data to be removed
+ */
+void RinexData::dropNavKey(const SatNavData &navData) {
+	unordered_multiset<NAVkey, NAVkeyHash>::iterator itKey = navKeys.find(NAVkey(navData.systemId, navData.satellite, navData.navTimeTag));
+	if (itKey != navKeys.end()) navKeys.erase(itKey);
+}
+
+/**sortNavData sorts navigation data in epochNav by time tag, system and satellite.
+ * Only records added after the last sorting are sorted, and then merged with the already sorted ones.
+ */
+void RinexData::sortNavData() {
+	if (navSorted >= epochNav.size()) return;
+	sort(epochNav.begin() + navSorted, epochNav.end());
+	inplace_merge(epochNav.begin(), epochNav.begin() + navSorted, epochNav.end());
+	navSorted = epochNav.size();
+}
+
+/**NAVkeyHash computes the hash value for the given navigation data key, combining its system, satellite and time tag.
+ *
+ * @param key the navigation data key
+ * @return the hash value
+ */
+size_t RinexData::NAVkeyHash::operator () (const NAVkey &key) const {
+	return hash<double>()(key.navTimeTag) ^ ((size_t) (unsigned char) key.systemId << 24) ^ ((size_t) key.satellite * 2654435761u);
+}
+
+/**isObsHandle checks if the given observable handle identifies an observable type of a system currently defined
+ *
+ * @param obsHandle the handle to check
+ * @return true if the handle identifies a defined system and observable type, false otherwise
+ */
+bool RinexData::isObsHandle(int obsHandle) {
+	return (obsHandle >= 0) && ((obsHandle >> 16) < (int) systems.size())
+		&& ((obsHandle & 0xFFFF) < (int) systems[obsHandle >> 16].obsType.size());
+}
+
 /**sysInx provides the system index in the systems vector for a given system code
  * 
  * @param sysCode the one character system code (G, R, S, E, ...)
@@ -30,14 +30,22 @@
 
 #include <vector>
 #include <string>
+#include <bitset>
+#include <unordered_set>
+#include <map>
 
 #include "Logger.h"	//from CommonClasses
+#include "MappedFile.h"	//from CommonClasses
+#include "EphemerisStore.h"	//from CommonClasses
+#include "OrbitEvaluator.h"	//from CommonClasses
 
 using namespace std;
 
 //@cond DUMMY
 const double MAXOBSVAL = 9999999999.999; //the maximum value for any observable to fit the F14.4 RINEX format
 const double MINOBSVAL = -999999999.999; //the minimum value for any observable to fit the F14.4 RINEX format
+const int FILTERPRNS = 128;		//satellites with PRN from 0 to FILTERPRNS-1 are filtered using the compiled bitmaps
+const int HDLINELEN = 80;		//the length of RINEX header lines, excluding EOL
 //Mask values to define RINEX header record/label type
 const unsigned int NAP = 0x00;		//Not applicable for the given file type
 const unsigned int OBL = 0x01;		//Obligatory
@@ -76,9 +84,20 @@ const string msgNotNav("Cannot generate V2.10 navigation file for system ");
  * -# Set observation data for the epoch to be printed using setEpochTime first and saveObsData repeatedly for each system/satellite/observable for this epoch.
  * -# Print the RINEX epoch data using the printObsEpoch method.
  * -# Repeat former steps 4 & 5 while epoch data exist.
+ *<p>Epochs can be printed by a separate thread while data for the next ones are being acquired, stating it with setPrintThread.
+ *printObsEpoch then hands the epoch data to the printing thread, and endPrintThread waits until all of them have been printed.
+ *<p>When some header data are not known until all epochs have been processed, epochs can be printed first into a temporary file,
+ *calling prepareObsHeader before printing them. The header is printed at the end, followed by the epochs printed.
+ *<p>Header records with statistics of the epochs printed (TIME OF LAST OBS, INTERVAL, # OF SATELLITES and PRN / # OF OBS) can be
+ *completed in a single pass using setHeaderPatch before printing the header: printObsHeader reserves lines for these records,
+ *printObsEpoch accumulates the statistics, and patchObsHeader overwrites the reserved lines before closing the output file.
+ *<p>Observables can also be saved using a handle obtained with getObsHandle for each system and observable type once the header systems
+ *and observable types are set, avoiding the search of the observable type each time data are saved.
  *<p>Alternatively input data can be obtained from another RINEX observation file. In this case:
  * - The method readRinexHeader is used in step 2 to read from another RINEX file header records data and store them into the RinexData object.
  * - The method readObsEpoch is used in step 4 to read an epoch data from another RINEX observation file.
+ *	Epochs can be read in parallel by several threads, stating before the number of threads to use with setReadThreads.
+ *	An epoch index file can be used, stating it with setEpochIndex, to seek epochs by time with seekObsEpoch.
  *<p>When it is necessary to print a special event epoch in the epochs processing cycle, already existing header records data shall be cleared before processing
  *any special event epoch having header records, that is, special events having flag values 2, 3, 4 or 5. The reason is that when printing such events,
  *after the epoch line they are printed all header line records having data. In sumary, to process a special event it will be encessary to perform
@@ -106,7 +125,8 @@ const string msgNotNav("Cannot generate V2.10 navigation file for system ");
  * -# Use method readRinexHeader to read from the existing input RINEX file header records data. They are stored into the RinexData object.
  * -# Get needed data from the RINEX header records read using getHdLnData methods.
  * -# Use method readObsEpoch to read an epoch data from the input RINEX observation file.
- * -# Get needed observation data from this epoch using getObsData
+ * -# Get needed observation data from this epoch using getObsData. The observable can be obtained as a handle, and its system and type
+ *	can be got from it using getObsHandleData.
  * -# Repeat former two steps while epoch data exist.
  *<p>To obtain satellite ephemeris data from RINEX navigation files the process would be similar:
  * -# Create a RinexData object
@@ -115,9 +135,16 @@ const string msgNotNav("Cannot generate V2.10 navigation file for system ");
  * -# Use method readNavEpoch to read a satellite epoch data from the input RINEX navigation file.
  * -# Get needed navigation data from this epoch using getNavData
  * -# Repeat former two steps while epoch data exist.
+ *<p>All navigation data saved or read are also kept in an EphemerisStore, even after being printed or cleared from the epoch storage.
+ *The ephemeris to be used for a satellite at a given instant can be obtained using getBestNavData, and the store itself using
+ *getEphemerisStore. It is useful to compute satellite positions while observation data are processed: getSatPositions computes
+ *position, clock correction, elevation and azimuth of all satellites in the current observation epoch, using as station the
+ *APPROX POSITION XYZ header record data.
  *<p>Finally, the class provides the possibility to filter observation or navigation data stored into a class object using methods to:
  * - Set the filtering criteria (select an epoch time period, a system/satellite/observation) using the setFilter method
  * - Discard from saved data these not belonging to the selected time period or systems/satellites/observations using the filterObsData or filterNavData.
+ *<p>Observation data can also be filtered by satellite elevation and signal strength, stating the masks with setElevationMask and setSnrMask.
+ *filterObsData removes then all data of satellites below the masks. Note that satellites without valid ephemeris or signal data are not removed.
  *<p>This class uses the Logger class defined also in this package.
  */
 class RinexData {
@@ -226,27 +253,44 @@ public:
 	//methods to process and collect epoch data
 	double setEpochTime(int weeks, double secs, double bias=0.0, int eFlag=0);
 	bool saveObsData(char sys, int sat, string obsType, double value, int lol, int strg, double tTag);
+	bool saveObsData(int obsHandle, int sat, double value, int lol, int strg, double tTag);
 	double getEpochTime(int &weeks, double &secs, double &bias, int &eFlag);
 	bool getObsData(char &sys, int &sat, string &obsType, double &value, int &lol, int &strg, double &tTag, unsigned int index = 0);
+	bool getObsData(int &obsHandle, int &sat, double &value, int &lol, int &strg, double &tTag, unsigned int index = 0);
+	int getObsHandle(char sys, const string &obsType);
+	bool getObsHandleData(int obsHandle, char &sys, string &obsType);
 	bool setFilter(vector<string> &selSat, vector<string> &selObs);
+	void setElevationMask(double minElevation, EphemerisStore* ephStore = NULL);
+	void setSnrMask(double minSnr);
 	bool filterObsData();
 	void clearObsData();
 	bool saveNavData(char sys, int sat, double bo[8][4], double tTag);
 	bool getNavData(char& sys, int &sat, double (&bo)[8][4], double &tTag, unsigned int index = 0);
 	bool filterNavData();
 	void clearNavData();
+	bool getBestNavData(char sys, int sat, double t, double (&bo)[8][4], double &tTag);
+	EphemerisStore* getEphemerisStore();
+	int getSatPositions(vector<OrbitEvaluator::SatPosition> &satPos);
 	//methods to print RINEX files
 	string getObsFileName(string prefix, string country = "---"); 
 	string getNavFileName(string prefix, char suffix = 'N', string country = "---");
+	void prepareObsHeader();
 	void printObsHeader(FILE* out);
 	void printObsEpoch(FILE* out);
 	void printObsEOF(FILE* out);
+	void setHeaderPatch(int maxSats);
+	bool patchObsHeader(FILE* out);
+	void setPrintThread(bool useThread);
+	void endPrintThread();
 	void printNavHeader(FILE* out);
 	void printNavEpoch(FILE* out);
 	//methods to collect data from existing RINEX files
 	RINEXlabel readRinexHeader(FILE* input);
 	int readObsEpoch(FILE* input);
 	int readNavEpoch(FILE* input);
+	void setReadThreads(int nThreads);
+	bool setEpochIndex(FILE* input, string idxFileName);
+	bool seekObsEpoch(FILE* input, double timeTag);
 
 private:
 	struct LABELdata {	//A template for data related to each defined RINEX label and related record
@@ -370,12 +414,16 @@ private:
 		vector <string> obsType;	//identifier of each obsType type: C1C, L1C, D1C, S1C... (see RINEX V302 document: 5.1 Observation codes)
 		vector <bool> selObsType;	//a flag stating if the corresponding obsType is selected (will pass filtering or not)
 		vector <int> selSat;
+		bitset <FILTERPRNS> selPrn;	//compiled filter: the bit for each PRN is set when the satellite is selected
+		vector <unsigned int> selObsMask;	//compiled filter: the bit for each obsType is set when the system and the obsType are selected
 		//constructor
 		GNSSsystem (char sys, const vector<string> &obsT) {
 			system = sys;
 			selSystem = true;
 			obsType.insert(obsType.end(), obsT.begin(), obsT.end());
 			selObsType.insert(selObsType.begin(), obsType.size(), true);
+			selPrn.set();
+			selObsMask.insert(selObsMask.begin(), (obsType.size() + 31) / 32, 0xFFFFFFFF);
 		};
 	};
 	vector <GNSSsystem> systems;
@@ -518,40 +566,74 @@ private:
 	//Epoch observable data
 	int epochFlag;		//The type of data following this epoch record (observation, event, ...). See RINEX definition
 	int nSatsEpoch;		//Number of satellites or special records in current epoch
-	struct SatObsData {	//defines data storage for a satellite observable (pseudorrange, phase, ...) in an epoch.
-		double obsTimeTag;	//A tag to identify the epoch of this measurement. Could be the estimated time of current epoch before fix (f.e in Sirf from MID28)
-		int sysIndex;		//the system this observable belongs: its index in systems vector (see above)
-		int satellite;		//the satellite this observable belongs: PRN of satellite
-		int obsTypeIndex;	//the observable type: its index in obsType vector (inside the GNSSsystem object referred by sysIndex)
- 		double obsValue;	//the value of this observable
-		int lossOfLock;		//if loss of lock happened when observable was taken
-		int strength;		//the signal strength when observable was taken
+	struct EpochObsData {	//defines data storage for the observables (pseudorrange, phase, ...) of one epoch.
+		//Data of each observable are stored in the same position of parallel arrays. Capacity is kept when cleared, to be reused in next epochs
+		double obsTimeTag;	//A tag to identify the epoch of these measurements. Could be the estimated time of current epoch before fix (f.e in Sirf from MID28)
+		vector <unsigned int> satKey;	//the system and satellite each observable belongs: the index in systems vector (see above) and the PRN. See makeSatKey
+		vector <unsigned short> obsTypeIndex;	//the observable type: its index in obsType vector (inside the GNSSsystem object referred by the system index)
+		vector <double> obsValue;	//the value of each observable
+		vector <short> lossOfLock;	//if loss of lock happened when observable was taken
+		vector <short> strength;	//the signal strength when observable was taken
+		vector <unsigned long long> sortKey;	//a working area used to sort observables
+		//satellite keys have the system index in the high bits and the PRN (offset to be unsigned) in the 16 low bits: they sort by system and PRN
+		static unsigned int makeSatKey(int sysIdx, int sat) {
+			return ((unsigned int) sysIdx << 16) | ((unsigned int) (sat + 32768) & 0xFFFF);
+		};
+		static int sysIndexOf(unsigned int key) {
+			return (int) (key >> 16);
+		};
+		static int satelliteOf(unsigned int key) {
+			return (int) (key & 0xFFFF) - 32768;
+		};
 		//constructor
-		SatObsData (double obsTag, int sysIdx, int sat, int obsIdx, double obsVal, int lol, int str) {
-			obsTimeTag = obsTag;
-			sysIndex = sysIdx;
-			satellite = sat;
-			obsTypeIndex = obsIdx;
-			obsValue = obsVal;
-			lossOfLock = lol;
-			strength = str;
+		EpochObsData () {
+			obsTimeTag = 0.0;
 		};
-		//define operator for comparisons and sorting
-		bool operator < (const SatObsData &param) {
-			if (obsTimeTag > param.obsTimeTag) return false;
-			if (obsTimeTag < param.obsTimeTag) return true;
-			//same time tag
-			if (sysIndex > param.sysIndex) return false;
-			if (sysIndex < param.sysIndex) return true;
-			//same time tag and system
-			if (satellite > param.satellite) return false;
-			if (satellite < param.satellite) return true;
-			//same time tag, system and satellite
-			if (obsTypeIndex > param.obsTypeIndex) return false;
-			return true;
+		size_t size() {
+			return obsValue.size();
+		};
+		bool empty() {
+			return obsValue.empty();
+		};
+		void push_back(double obsTag, int sysIdx, int sat, int obsIdx, double obsVal, int lol, int str) {
+			if (obsValue.empty()) obsTimeTag = obsTag;
+			satKey.push_back(makeSatKey(sysIdx, sat));
+			obsTypeIndex.push_back((unsigned short) obsIdx);
+			obsValue.push_back(obsVal);
+			lossOfLock.push_back((short) lol);
+			strength.push_back((short) str);
+		};
+		void copy(size_t to, size_t from) {	//copies data of the observable in position from to position to
+			satKey[to] = satKey[from];
+			obsTypeIndex[to] = obsTypeIndex[from];
+			obsValue[to] = obsValue[from];
+			lossOfLock[to] = lossOfLock[from];
+			strength[to] = strength[from];
 		};
+		void truncate(size_t n) {	//keeps data of the first n observables
+			satKey.resize(n);
+			obsTypeIndex.resize(n);
+			obsValue.resize(n);
+			lossOfLock.resize(n);
+			strength.resize(n);
+		};
+		void clear() {
+			truncate(0);
+		};
+		void swap(EpochObsData &other) {
+			double tag = obsTimeTag;
+			obsTimeTag = other.obsTimeTag;
+			other.obsTimeTag = tag;
+			satKey.swap(other.satKey);
+			obsTypeIndex.swap(other.obsTypeIndex);
+			obsValue.swap(other.obsValue);
+			lossOfLock.swap(other.lossOfLock);
+			strength.swap(other.strength);
+		};
+		void sort();	//sorts observables by system, satellite and observable type
 	};
-	vector <SatObsData> epochObs;	//A place to store observable data (pseudorange, phase, ...) for one epoch
+	EpochObsData epochObs;	//A place to store observable data (pseudorange, phase, ...) for one epoch
+	string epochText;		//A place to build the text lines of one observation epoch before printing them
 	//Epoch navigation data
 	struct SatNavData {	//defines storage for navigation data for a given GNSS satellite
 		double navTimeTag;	//a tag to identify the epoch of this data
@@ -568,18 +650,38 @@ private:
 					broadcastOrbit[i][j] = bo[i][j];
 		};
 		//define operator for comparisons and sorting
-		bool operator < (const SatNavData &param) {
+		bool operator < (const SatNavData &param) const {
 			if(navTimeTag > param.navTimeTag) return false;
 			if(navTimeTag < param.navTimeTag) return true;
 			//same time tag
 			if (systemId > param.systemId) return false;
 			if (systemId < param.systemId) return true;
 			//same time tag and system
-			if (satellite > param.satellite) return false;
-			return true;
+			return satellite < param.satellite;
 		};
 	};
 	vector <SatNavData> epochNav;		//A place to store navigation data for one epoch
+	struct NAVkey {	//identifies navigation data of a satellite: system, PRN and time tag
+		char systemId;
+		int satellite;
+		double navTimeTag;
+		//constructor
+		NAVkey (char sys, int sat, double tT) {
+			systemId = sys;
+			satellite = sat;
+			navTimeTag = tT;
+		};
+		bool operator == (const NAVkey &param) const {
+			return (systemId == param.systemId) && (satellite == param.satellite) && (navTimeTag == param.navTimeTag);
+		};
+	};
+	struct NAVkeyHash {	//computes the hash value of a NAVkey
+		size_t operator () (const NAVkey &key) const;
+	};
+	unordered_multiset <NAVkey, NAVkeyHash> navKeys;	//the keys of data stored in epochNav, to detect duplicates in constant time
+	size_t navSorted;	//the number of records at the beginning of epochNav already sorted
+	EphemerisStore ephemerides;	//all navigation data saved or read, indexed by satellite and time
+	OrbitEvaluator orbits;		//computes satellite positions from the ephemerides stored
 	//A state variable used to store reference to the label of the last record which data has been modified
 	vector<LABELdata>::iterator lastRecordSet;
 	//A equivalence table between observable type names in RINEX V2 and V3 
@@ -600,6 +702,118 @@ private:
 	bool applyObsFilter;	//when true, parameters has been stated to filter observation data 
 	bool applyNavFilter;	//when true, parameters has been stated to filter navigation data 
 	vector<string> selectedSats;	//list of selected systems-satellites that would pass navigation data filter
+	struct NAVfilter {	//defines the compiled filter for navigation data of a system in the selectedSats list
+		char system;	//the system identification
+		bitset <FILTERPRNS> selPrn;	//the bit for each PRN is set when its navigation data pass the filter
+		//constructor
+		NAVfilter (char sys) {
+			system = sys;
+		};
+	};
+	vector<NAVfilter> navFilter;
+	//Elevation and signal to noise ratio masks
+	bool applyElevMask;		//when true, satellites below the minimum elevation are removed from observation data
+	double minElevMask;		//the minimum elevation, in degrees
+	bool applySnrMask;		//when true, satellites with signal to noise ratio below the minimum are removed from observation data
+	double minSnrMask;		//the minimum signal to noise ratio (S1 observable), in dB-Hz
+	bool stationWarned;		//true when the lack of station position to apply the elevation mask has been logged
+	struct SatMaskData {	//data of a satellite in the epoch to evaluate the masks
+		double s1;		//the greatest S1 observable value, or -1 if unknown
+		int strength;	//the greatest signal strength, or 0 if unknown
+		bool rejected;	//true if the satellite does not pass the masks
+	};
+	vector<OrbitEvaluator::SatPosition> maskSats;	//the satellites in the epoch to evaluate the masks
+	vector<SatMaskData> maskData;	//signal data and result for each satellite in maskSats
+	vector<size_t> maskSatInx;		//the position in maskSats of the satellite each epoch observable belongs
+	//Header back-patching
+	bool patchHeader;		//when true, header lines are reserved for records with statistics of the epochs printed, to be patched at the end
+	int patchMaxSats;		//the maximum number of satellites with lines reserved for PRN / # OF OBS records
+	struct HDpatch {		//defines the lines reserved in the output file for a header record
+		RINEXlabel labelID;	//the header record label
+		long position;		//the position in the output file of the first line reserved
+		int lines;			//the number of lines reserved
+		//constructor
+		HDpatch (RINEXlabel l, long p, int n) {
+			labelID = l;
+			position = p;
+			lines = n;
+		};
+	};
+	vector<HDpatch> hdPatches;
+	struct OBSstats {		//statistics of the observation epochs printed
+		int epochs;			//number of epochs with observables printed
+		int lastWeek;		//the week of the last epoch printed
+		double lastTOW;		//the TOW of the last epoch printed
+		map<long long, int> intervals;	//for each time difference between consecutive epochs (in milliseconds), the times it has been found
+		map<unsigned int, vector<int> > obsCount;	//for each satellite key, the number of observables printed of each type
+	} obsStats;
+	//Input data for reading epochs
+	struct RINEXrecord {	//defines a view of a RINEX line read from the input file (mapped image or stream buffer)
+		const char* start;	//the first char of the line
+		int length;			//the line length, excluding EOL chars. Columns beyond it are considered blanks
+		//constructor
+		RINEXrecord () {
+			start = NULL;
+			length = 0;
+		};
+		//get the char at the given column
+		char at(int col) {
+			return (col >= 0) && (col < length)? start[col] : ' ';
+		};
+		//check if all n chars from the given column are blanks
+		bool isBlank(int col, int n) {
+			for (; n > 0 && col < length; n--, col++) if (start[col] != ' ') return false;
+			return true;
+		};
+		//get the real number in the field of n chars from the given column
+		bool getDouble(int col, int n, double &value);
+		//get the integer number in the field of n chars from the given column
+		bool getInt(int col, int n, int &value);
+		//copy n chars from the given column to the given buffer
+		void copy(int col, int n, char* buffer) {
+			for (int i = 0; i < n; i++) buffer[i] = at(col + i);
+		};
+		//get a string with n chars from the given column
+		string str(int col, int n) {
+			string s(n, ' ');
+			for (int i = 0; i < n; i++) s[i] = at(col + i);
+			return s;
+		};
+	};
+	FILE* inFile;			//the input stream epochs are being read from
+	MappedFile inMap;		//the mapped image of the input file, if it could be mapped
+	const char* inData;		//the image of the input file where records are read from, or NULL if they are read from the input stream
+	long long inSize;		//the size in bytes of the input file image
+	long long inCursor;		//the offset in the input file image of the next record to read
+	char inBuffer[1300];	//a place to read records from the input stream when the file could not be mapped
+	//Parallel reading of observation epochs
+	int readThreads;		//the number of threads used to read observation epochs (1 means sequential reading)
+	struct ParallelRead;	//the state of a parallel reading (defined in the implementation file)
+	ParallelRead* parRead;	//the parallel reading in progress, or NULL if not started
+	//Printing of observation epochs by a separate thread
+	bool printThreadSet;	//true when observation epochs shall be printed by a separate thread
+	struct PrintThread;		//the state of the printing thread (defined in the implementation file)
+	PrintThread* prtThread;	//the printing thread in progress, or NULL if not started
+	//Index of observation epochs
+	struct EPOCHindex {	//defines an entry of the epoch index
+		double timeTag;		//the time tag of the epoch
+		long long offset;	//the offset in the input file of the epoch first record
+		//constructor
+		EPOCHindex (double t, long long o) {
+			timeTag = t;
+			offset = o;
+		};
+	};
+	vector <EPOCHindex> epochIndex;	//the index entries, in time order
+	string indexName;		//the name of the epoch index file
+	bool indexLoaded;		//true when the index has been loaded from a file matching the input file
+	bool indexBuilding;		//true when the index is being built while epochs are read
+	bool indexOrdered;		//true while epochs read to build the index are in time order
+	bool indexClosed;		//true after reading an event epoch: no more entries are added to the index being built
+	double indexLastTag;	//the time tag of the last epoch read to build the index
+	long long inFileSize;	//the input file size, to check the index validity
+	long long inFileTime;	//the input file modification time, to check the index validity
+	long long inFirstEpoch;	//the offset in the input file of the first epoch, to check the index validity
 
 	//private methods
 	void setDefValues(RINEXversion v, Logger* p);
@@ -615,13 +829,40 @@ private:
 	int readV3ObsEpoch(FILE* input);
 	int readObsEpochEvent(FILE* input, bool wrongDate);
 	void printHdLineData (FILE* out, vector<LABELdata>::iterator lbIter);
-	bool printSatObsValues(FILE* out, int maxPerLine);
+	size_t formatSatObsValues(size_t first, int maxPerLine);
+	void addObsStats();
+	void reserveHdLines(FILE* out, vector<LABELdata>::iterator lbIter);
+	void printHdComments(FILE* out, int n);
 	RINEXlabel readHdLineData(FILE* input);
 	bool readRinexRecord(char* rinexRec, int recSize, FILE* input);
+	void beginEpochRead(FILE* input);
+	void endEpochRead(FILE* input);
+	bool readRinexRecord(RINEXrecord &rec, FILE* input);
+	long long viewRecord(long long pos, RINEXrecord &rec);
+	int readObsEpochParallel(FILE* input);
+	void beginParallelRead(FILE* input);
+	void endParallelRead();
+	long long skipBlankLines(long long pos);
+	long long nextEpochStart(long long pos);
+	static void readChunks(ParallelRead* par, RinexData* reader);
+	void queueObsEpoch(FILE* out);
+	void beginPrintThread(FILE* out);
+	static void printEpochs(PrintThread* pt);
+	void indexObsEpoch(long long pos, int retCode);
+	bool loadEpochIndex();
+	bool saveEpochIndex();
 	string obsV3toV2(int, int);
 	int v2ObsInx(const string&);
 	bool isSatSelected(int sysIx, int sat);
+	void maskObsData();
+	void setOrbitParams();
+	bool isNavSatSelected(char sys, int sat);
+	void pushNavData(double tTag, char sys, int sat, double bo[8][4]);
+	void dropNavKey(const SatNavData &navData);
+	void sortNavData();
+	void compileFilter();
 	int sysInx(char sysCode);
+	bool isObsHandle(int obsHandle);
 	int nSysSel();
 	string getSysDes(char s);
 };
@@ -7,6 +7,10 @@
 #include <ctype.h>
 #include <time.h>
 #include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <mutex>
 
 /**getTokens gets tokens from a string separated by the given separator
  *
@@ -34,6 +38,174 @@ bool isBlank (char* buffer, int n) {
 	return true;
 }
 
+/**fieldToDouble converts the text in a fixed width field containing a real number, as written in RINEX files.
+ * Leading and trailing blanks are allowed. The number can have sign, decimal point and exponent, where the exponent
+ * letter can be E, e, D or d (FORTRAN double precision format). Locale settings are not taken into account.
+ * The value is computed directly from the field chars without allocating memory. Only when the number has too many significant digits
+ * or a large exponent (rare in RINEX files) it is computed using strtod, to give always the same result it would give.
+ *
+ * @param buffer the first char of the field
+ * @param n the field width
+ * @param value the value converted
+ * @return true if the field contains a well formatted number, false otherwise (empty field or wrong chars)
+ */
+bool fieldToDouble (const char* buffer, int n, double &value) {
+	//powers of 10 exactly represented as double
+	static const double POW10[] = {1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+		1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+	const char* pos = buffer;
+	const char* end = buffer + n;
+	unsigned long long mantissa = 0;
+	bool overflow = false;	//mantissa does not fit in the 53 bits of a double
+	int scale = 0;			//power of 10 to apply to the mantissa
+	int nDigits = 0;
+	int exponent = 0;
+	bool negative = false;
+	bool negExponent = false;
+	while ((pos < end) && (*pos == ' ')) pos++;
+	if ((pos < end) && ((*pos == '+') || (*pos == '-'))) negative = *(pos++) == '-';
+	//integer and fraction digits are accumulated into the mantissa
+	for (; (pos < end) && isdigit(*pos); pos++, nDigits++) {
+		if (mantissa < 0x0019999999999999ULL) mantissa = mantissa * 10 + (*pos - '0');
+		else overflow = true;
+	}
+	if ((pos < end) && (*pos == '.')) {
+		for (pos++; (pos < end) && isdigit(*pos); pos++, nDigits++, scale--) {
+			if (mantissa < 0x0019999999999999ULL) mantissa = mantissa * 10 + (*pos - '0');
+			else overflow = true;
+		}
+	}
+	if (nDigits == 0) return false;
+	if ((pos < end) && (strchr("EeDd", *pos) != NULL)) {
+		pos++;
+		if ((pos < end) && ((*pos == '+') || (*pos == '-'))) negExponent = *(pos++) == '-';
+		if ((pos == end) || !isdigit(*pos)) return false;
+		for (; (pos < end) && isdigit(*pos); pos++) if (exponent < 1000) exponent = exponent * 10 + (*pos - '0');
+		if (negExponent) exponent = -exponent;
+	}
+	while ((pos < end) && (*pos == ' ')) pos++;
+	if (pos != end) return false;
+	scale += exponent;
+	if (overflow || (mantissa > 0x001FFFFFFFFFFFFFULL) || (scale < -22) || (scale > 22)) {
+		char numBuffer[64];
+		if (n >= (int) sizeof numBuffer) return false;
+		for (int i = 0; i < n; i++) numBuffer[i] = (buffer[i] == 'D') || (buffer[i] == 'd')? 'E' : buffer[i];
+		numBuffer[n] = 0;
+		value = strtod(numBuffer, NULL);
+		return true;
+	}
+	//mantissa and power of 10 are exact doubles: only one rounding is done
+	value = (double) mantissa;
+	if (scale < 0) value /= POW10[-scale];
+	else value *= POW10[scale];
+	if (negative) value = -value;
+	return true;
+}
+
+/**fieldToInt converts the text in a fixed width field containing an integer number, as written in RINEX files.
+ * Leading and trailing blanks are allowed. The number can have sign.
+ *
+ * @param buffer the first char of the field
+ * @param n the field width
+ * @param value the value converted
+ * @return true if the field contains a well formatted integer, false otherwise (empty field or wrong chars)
+ */
+bool fieldToInt (const char* buffer, int n, int &value) {
+	const char* pos = buffer;
+	const char* end = buffer + n;
+	bool negative = false;
+	int nDigits = 0;
+	while ((pos < end) && (*pos == ' ')) pos++;
+	if ((pos < end) && ((*pos == '+') || (*pos == '-'))) negative = *(pos++) == '-';
+	for (value = 0; (pos < end) && isdigit(*pos); pos++, nDigits++) value = value * 10 + (*pos - '0');
+	while ((pos < end) && (*pos == ' ')) pos++;
+	if ((nDigits == 0) || (pos != end)) return false;
+	if (negative) value = -value;
+	return true;
+}
+
+/**formatFixed writes into the buffer the text of a real number in fixed point notation, right aligned in a field of the given width.
+ * The text is the same than the one given by sprintf using the "%*.*f" format, but it is computed directly from the digits
+ * of the number, avoiding format parsing and locale handling. Numbers which cannot be rounded exactly this way (too large,
+ * too many decimals, halfway cases, NaN or infinite) are formatted using snprintf.
+ * A null char is placed after the text.
+ *
+ * @param buffer the text buffer where the number is placed
+ * @param bufferSize of the text buffer in bytes
+ * @param width the minimum width of the field
+ * @param decimals the number of digits after the decimal point
+ * @param value the number to format
+ * @return the number of chars placed in the buffer, excluding the null char
+ */
+int formatFixed (char* buffer, int bufferSize, int width, int decimals, double value) {
+	static const double POW10[] = {1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11, 1e12, 1e13, 1e14, 1e15};
+	const int MAXDIGITS = 24;		//buffer size for the digits of the greatest number formatted directly
+	char digits[MAXDIGITS];
+	char* pos = digits + MAXDIGITS;
+	double scaled, intPart, fraction;
+	unsigned long long number;
+	int n;
+	if ((decimals >= 0) && (decimals <= 15) && (value == value)) {
+		scaled = fabs(value) * POW10[decimals];
+		if (scaled < 1e15) {
+			//rounding of scaled is the one of the exact value when fraction is not too close to 0.5
+			intPart = floor(scaled);
+			fraction = scaled - intPart;
+			if (fabs(fraction - 0.5) > scaled * 4.5e-16) {
+				number = (unsigned long long) intPart + (fraction > 0.5? 1 : 0);
+				for (n = 0; n < decimals; n++, number /= 10) *(--pos) = (char) ('0' + number % 10);
+				if (decimals > 0) *(--pos) = '.';
+				do {
+					*(--pos) = (char) ('0' + number % 10);
+					number /= 10;
+				} while (number != 0);
+				if (signbit(value)) *(--pos) = '-';
+				n = (int) (digits + MAXDIGITS - pos);
+				if (n < width) n = width;
+				if (n < bufferSize) {
+					memset(buffer, ' ', n);
+					memcpy(buffer + n - (digits + MAXDIGITS - pos), pos, digits + MAXDIGITS - pos);
+					buffer[n] = 0;
+					return n;
+				}
+			}
+		}
+	}
+	n = snprintf(buffer, bufferSize, "%*.*f", width, decimals, value);
+	if (n >= bufferSize) n = bufferSize - 1;
+	return n < 0? 0 : n;
+}
+
+/**formatInt writes into the buffer the text of an integer number, right aligned in a field of the given width.
+ * The text is the same than the one given by sprintf using the "%*d" format (fill with spaces) or the "%0*d" format (fill with zeroes).
+ * The buffer shall have room for the text and a null char placed after it.
+ *
+ * @param buffer the text buffer where the number is placed
+ * @param width the minimum width of the field
+ * @param value the number to format
+ * @param fill the char used to fill the field on the left: ' ' or '0'
+ * @return the number of chars placed in the buffer, excluding the null char
+ */
+int formatInt (char* buffer, int width, int value, char fill) {
+	const int MAXDIGITS = 12;		//buffer size for the digits of the greatest int
+	char digits[MAXDIGITS];
+	char* pos = digits + MAXDIGITS;
+	unsigned int number = value < 0? 0u - (unsigned int) value : (unsigned int) value;
+	int nDigits, n;
+	do {
+		*(--pos) = (char) ('0' + number % 10);
+		number /= 10;
+	} while (number != 0);
+	nDigits = (int) (digits + MAXDIGITS - pos);
+	n = nDigits + (value < 0? 1 : 0);
+	if (n < width) n = width;
+	memset(buffer, fill, n);
+	memcpy(buffer + n - nDigits, pos, nDigits);
+	if (value < 0) buffer[fill == '0'? 0 : n - nDigits - 1] = '-';
+	buffer[n] = 0;
+	return n;
+}
+
 /**formatGPStime format a GPS time point giving text GPS calendar data using time formats provided. 
  *
  * @param buffer the text buffer where calendar data are placed
@@ -43,7 +215,7 @@ bool isBlank (char* buffer, int n) {
  * @param week the GPS week from 6/1/1980
  * @param tow the GPS time of week, or seconds from the beginning of the week
  */
-void formatGPStime (char* buffer, int bufferSize, char* fmtYtoM, char * fmtSec, int week, double tow) {
+void formatGPStime (char* buffer, int bufferSize, const char* fmtYtoM, const char* fmtSec, int week, double tow) {
 	//get integer and fractional part of tow
 	double intTow;
 	double modTow;
@@ -66,6 +238,7 @@ void formatGPStime (char* buffer, int bufferSize, char* fmtYtoM, char * fmtSec,
 }
 
 /**formatLocalTime gives text calendar data of local time using the format provided (as per strftime). 
+ * It can be called from several threads: the static data used by localtime are accessed one thread at a time.
  *
  * @param buffer the text buffer where calendar data are placed
  * @param bufferSize of the text buffer in bytes
@@ -73,9 +246,11 @@ void formatGPStime (char* buffer, int bufferSize, char* fmtYtoM, char * fmtSec,
  */
 void formatLocalTime (char* buffer, int bufferSize, char* fmt) {
 	//get local time and format it as needed
+	static mutex timeLock;
 	time_t rawtime;
 	struct tm * timeinfo;
 	time (&rawtime);
+	lock_guard<mutex> guard(timeLock);
 	timeinfo = localtime (&rawtime);
 	strftime (buffer, bufferSize, fmt, timeinfo);
 }
@@ -274,17 +449,33 @@ unsigned int reverseWord(unsigned int wordToReverse, int nBits) {
 *The bit stream is an array of 32 bits words, being bit position 0 of the stream the bit 0 of word 0,
 *position 1 of the stream the bit 1 of word 0, and so on
 *The extracted bits are returned in a 32 bits word.
+*Bits are extracted shifting and masking the word containing bitpos, and the next one when the field spans two words.
 *
  * @param stream the array of 32 bits words containing the bit stream
  * @param bitpos the position in the stream of the LSB to extract (bitpos = 0 is the position of the first bit)
  * @param len the number of bits to extract (from bitpos to bitpos+len-1). It shall be: 32 >= len >= 0
  * @return a 32 bits word with extracted bits, with stream bit bitpos in bit position 0 of this word 
  */
-unsigned int getBits(unsigned int *stream, int bitpos, int len) {
-	unsigned int bits = 0;
-	for (int i=bitpos+len-1; i>=bitpos; i--) {
-		bits = (bits << 1) | ((stream[i/32] >> i%32) & 0x01);
-	}
-	return bits;
+unsigned int getBits(const unsigned int *stream, int bitpos, int len) {
+	if (len <= 0) return 0;
+	int word = bitpos / 32;
+	int shift = bitpos % 32;
+	unsigned long long bits = stream[word] >> shift;
+	if (shift + len > 32) bits |= (unsigned long long) stream[word+1] << (32 - shift);
+	if (len < 32) bits &= (1ULL << len) - 1;
+	return (unsigned int) bits;
+}
+
+/*bitParity computes the parity (the XOR of all bits) of a 32 bits word.
+*The word is folded onto its 4 LSB, and the parity of the resulting nibble is taken from the 16 bits table 0x6996.
+*
+ * @param word the 32 bits word
+ * @return 1 if the number of bits set in the word is odd, 0 otherwise
+ */
+unsigned int bitParity(unsigned int word) {
+	word ^= word >> 16;
+	word ^= word >> 8;
+	word ^= word >> 4;
+	return (0x6996 >> (word & 0x0F)) & 0x01;
 }
 
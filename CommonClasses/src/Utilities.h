@@ -27,7 +27,11 @@ using namespace std;
 
 vector<string> getTokens (string source, char separator);			//extract tokens from a string
 bool isBlank (char* buffer, int n);		//checks if all chars in the buffer are spaces
-void formatGPStime (char* buffer, int bufferSize, char* fmtYtoM, char * fmtSec, int week, double tow); //convert to printable format the given GPS time
+bool fieldToDouble (const char* buffer, int n, double &value);	//converts a fixed width field containing a real number (FORTRAN E or D formats allowed)
+bool fieldToInt (const char* buffer, int n, int &value);		//converts a fixed width field containing an integer number
+int formatFixed (char* buffer, int bufferSize, int width, int decimals, double value);	//formats a real number in fixed point notation, as per "%*.*f"
+int formatInt (char* buffer, int width, int value, char fill = ' ');	//formats an integer number, as per "%*d" or "%0*d"
+void formatGPStime (char* buffer, int bufferSize, const char* fmtYtoM, const char* fmtSec, int week, double tow); //convert to printable format the given GPS time
 void formatLocalTime (char* buffer, int bufferSize, char* fmt);		//convert to printable format the computer current local time
 int getGPSweek (int year, int month, int day, int hour, int min, float sec); //computes GPS weeks from the GPS ephemeris (6/1/1980) to a given date
 int getGPSweek (double secs); //computes GPS weeks from the GPS ephemeris (6/1/1980) to a given instant
@@ -40,5 +44,6 @@ string strToUpper(string strToConvert);
 int getTwosComplement(unsigned int number, unsigned int nbits);
 int getSigned(unsigned int number, int nbits);
 unsigned int reverseWord(unsigned int wordToReverse, int nBits=32);
-unsigned int getBits(unsigned int *stream, int bitpos, int len);
+unsigned int getBits(const unsigned int *stream, int bitpos, int len);
+unsigned int bitParity(unsigned int word);
 #endif
\ No newline at end of file